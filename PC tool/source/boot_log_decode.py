@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""
+Bootloader 延迟日志解码
+----------------
+BOOT_CONFIG_LOG_DEFERRED = 1 时 Bootloader 的日志口（F407 / CH32 示例为 USART1）输出的是二进制记录：
+
+    EB [参数个数 n] [tick 低 16 位 2B] [格式串地址 4B] [参数 4B * n]      多字节均为小端
+
+格式串地址指向固件中名为 boot_log_fmt 的静态数组（BOOT_LOG 宏生成），本工具从固件 ELF（Keil 的 .axf、
+GCC 的 .elf）的符号表中取出全部格式串得到格式表，按记录中的地址查表并用原始参数还原日志文本。
+地址为 0 的记录表示设备端日志环满后丢弃的记录数。不是记录的字节（如示例中 uart_printf 的文本）原样输出。
+
+用法：
+    python boot_log_decode.py table <固件.axf|.elf> [-o table.json]
+        生成格式表，可作为构建后步骤与固件一起归档
+    python boot_log_decode.py decode (--elf <固件.axf|.elf> | --table table.json) (--port COM5 [--baud 115200] | --file 抓包.bin)
+        解码串口实时输出或保存的原始字节
+
+格式表必须来自设备上运行的同一次构建，否则地址对不上，记录会被当作普通字节输出。
+
+运行要求：Python 3.8+，串口模式需要 pyserial (`pip install pyserial`)
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import struct
+import sys
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional
+
+LOG_SYNC = 0xEB
+LOG_HEADER_SIZE = 8
+LOG_MAX_ARGS = 8
+FMT_SYMBOL = "boot_log_fmt"
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+# printf 转换说明：标志、宽度、精度、长度修饰（全部参数按 32 位记录，长度修饰忽略）、转换字符
+_CONV = re.compile(r"%([-+ 0#]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXoc%])")
+
+
+def _sections(data: bytes) -> List[dict]:
+    if data[:4] != b"\x7fELF":
+        raise ValueError("不是 ELF 文件")
+    is64 = data[4] == 2
+    end = "<" if data[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(end + "Q", data, 0x28)
+        shentsize, shnum = struct.unpack_from(end + "HH", data, 0x3A)
+        fields = "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", data, 0x20)
+        shentsize, shnum = struct.unpack_from(end + "HH", data, 0x2E)
+        fields = "IIIIIIIIII"
+    sections = []
+    for i in range(shnum):
+        name, stype, flags, addr, offset, size, link, _, _, entsize = struct.unpack_from(
+            end + fields, data, shoff + i * shentsize)
+        sections.append({"type": stype, "flags": flags, "addr": addr, "offset": offset,
+                         "size": size, "link": link, "entsize": entsize})
+    for s in sections:
+        s["is64"], s["end"] = is64, end
+    return sections
+
+
+def _cstring(data: bytes, offset: int) -> str:
+    stop = data.index(b"\0", offset)
+    return data[offset:stop].decode("utf-8", errors="replace")
+
+
+def _read_string(data: bytes, sections: List[dict], addr: int) -> Optional[str]:
+    """从固件的已加载段中读取 addr 处的字符串"""
+    for s in sections:
+        if s["flags"] & SHF_ALLOC and s["type"] != SHT_NOBITS and s["addr"] <= addr < s["addr"] + s["size"]:
+            return _cstring(data, s["offset"] + addr - s["addr"])
+    return None
+
+
+def build_table(elf_path: Path) -> Dict[int, str]:
+    """从 ELF 符号表取出全部 boot_log_fmt 静态数组，返回 {地址: 格式串}"""
+    data = elf_path.read_bytes()
+    sections = _sections(data)
+    table: Dict[int, str] = {}
+    for symtab in sections:
+        if symtab["type"] != SHT_SYMTAB:
+            continue
+        strtab = sections[symtab["link"]]
+        end = symtab["end"]
+        for pos in range(symtab["offset"], symtab["offset"] + symtab["size"], symtab["entsize"]):
+            if symtab["is64"]:
+                name, _, _, _, value, _ = struct.unpack_from(end + "IBBHQQ", data, pos)
+            else:
+                name, value, _, _, _, _ = struct.unpack_from(end + "IIIBBH", data, pos)
+            if not _cstring(data, strtab["offset"] + name).startswith(FMT_SYMBOL):
+                continue
+            text = _read_string(data, sections, value)
+            if text is not None:
+                table[value & 0xFFFFFFFF] = text
+    return table
+
+
+def load_table(path: Path) -> Dict[int, str]:
+    return {int(addr, 16): fmt for addr, fmt in json.loads(path.read_text(encoding="utf-8")).items()}
+
+
+def format_record(fmt: str, args: List[int]) -> str:
+    """按 C printf 语义用 32 位原始参数还原文本，%d/%i 按有符号解释"""
+    values = iter(args)
+
+    def convert(m: re.Match) -> str:
+        spec, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        return ("%" + spec + conv) % value
+
+    return _CONV.sub(convert, fmt)
+
+
+class LogDecoder:
+    """按字节流增量解码，输入可以在任意位置切开"""
+
+    def __init__(self, table: Dict[int, str]) -> None:
+        self.table = table
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> Iterator[str]:
+        self.buf.extend(data)
+        text = bytearray()
+        while self.buf:
+            if self.buf[0] != LOG_SYNC:
+                text.append(self.buf.pop(0))
+                continue
+            if len(self.buf) < LOG_HEADER_SIZE:
+                break
+            nargs = self.buf[1]
+            tick, addr = struct.unpack_from("<HI", self.buf, 2)
+            if nargs > LOG_MAX_ARGS or (addr != 0 and addr not in self.table):
+                text.append(self.buf.pop(0))        # 不是记录：当作普通字节，从下一字节重新同步
+                continue
+            size = LOG_HEADER_SIZE + 4 * nargs
+            if len(self.buf) < size:
+                break
+            args = list(struct.unpack_from("<%dI" % nargs, self.buf, LOG_HEADER_SIZE))
+            del self.buf[:size]
+            if text:
+                yield text.decode("utf-8", errors="replace")
+                text = bytearray()
+            if addr == 0:
+                yield f"[{tick:5d}] <设备端日志环满，丢弃 {args[0] if args else 0} 条记录>\n"
+            else:
+                yield f"[{tick:5d}] " + format_record(self.table[addr], args).rstrip("\r\n") + "\n"
+        if text:
+            yield text.decode("utf-8", errors="replace")
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="Bootloader 延迟日志解码")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p_table = sub.add_parser("table", help="从固件 ELF 生成格式表")
+    p_table.add_argument("elf", type=Path)
+    p_table.add_argument("-o", "--output", type=Path)
+    p_decode = sub.add_parser("decode", help="解码日志输出")
+    src = p_decode.add_mutually_exclusive_group(required=True)
+    src.add_argument("--elf", type=Path)
+    src.add_argument("--table", type=Path)
+    inp = p_decode.add_mutually_exclusive_group(required=True)
+    inp.add_argument("--port")
+    inp.add_argument("--file", type=Path)
+    p_decode.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args(argv[1:])
+
+    if args.command == "table":
+        table = build_table(args.elf)
+        text = json.dumps({f"0x{addr:08X}": fmt for addr, fmt in sorted(table.items())},
+                          ensure_ascii=False, indent=1)
+        if args.output:
+            args.output.write_text(text + "\n", encoding="utf-8")
+            print(f"{len(table)} 条格式串写入 {args.output}")
+        else:
+            print(text)
+        return 0 if table else 1
+
+    table = build_table(args.elf) if args.elf else load_table(args.table)
+    if not table:
+        print("格式表为空：固件未启用 BOOT_CONFIG_LOG_DEFERRED 或 ELF 不含符号表")
+        return 1
+    decoder = LogDecoder(table)
+    if args.file:
+        for text in decoder.feed(args.file.read_bytes()):
+            sys.stdout.write(text)
+        return 0
+
+    import serial
+
+    port = serial.Serial(args.port, args.baud, timeout=0.1)
+    try:
+        while True:
+            data = port.read(port.in_waiting or 1)
+            for text in decoder.feed(data):
+                sys.stdout.write(text)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+RS-485 总线仿真
+----------------
+在上位机内模拟挂在同一总线上的多个 Bootloader 节点（只实现广播升级相关的帧：扫描、广播启动/数据、
+状态查询、完成帧），用于在没有硬件时验证 rs485_flash.py 的广播流程并估算不同丢包率下的总线耗时：
+
+    python rs485_flash.py broadcast <固件.bin> --simulate 32 --loss 0.05
+
+丢包按“每个节点、每个上位机帧”独立计算，被丢弃的帧对该节点等同于校验失败；设备应答不丢。
+"""
+
+from __future__ import annotations
+
+import hashlib
+import random
+
+ACK = bytes([0x55, 0xAA, 0xFF, 0xFE, 0x55, 0x55])
+BCAST_ADDR = 0x00
+STATE_IDLE = 0
+STATE_BROADCAST = 3
+
+
+class SimNode:
+    """
+    单个节点的广播接收状态机，与 easy_bootloader.c 中的 bootloader_bcast_* 行为一致
+    （test/test_rs485_bus.py 把同一帧序列送给本模型与真实核心，逐字节比较两者的状态应答）
+    """
+
+    def __init__(self, addr: int) -> None:
+        self.addr = addr
+        self.state = STATE_IDLE
+        self.session = 0
+        self.size = 0
+        self.chunk = 0
+        self.frames = 0
+        self.bitmap = bytearray()
+        self.image = bytearray()
+        self.version = 0xFFFFFFFF
+        self.committed = False
+
+    @property
+    def missing(self) -> int:
+        return sum(1 for i in range(self.frames) if not self.bitmap[i >> 3] & (1 << (i & 7)))
+
+    def handle(self, msg: bytes) -> bytes:
+        """处理一个完整的上位机帧，返回本节点的应答（无应答返回空）"""
+        if len(msg) < 7 or msg[:2] != b"\x55\xAA" or msg[-2:] != b"\x55\x55":
+            return b""
+        addr, body = msg[2], msg[3:-2]
+        if addr == BCAST_ADDR:
+            self._handle_bcast(body)
+            return b""
+        if addr != self.addr:
+            return b""
+        if body == b"\xFF\xF8":
+            state = self.state if not self.committed else 0x80
+            return b"\x55\xAA\xFF\xF8" + bytes([self.addr, state]) + self.version.to_bytes(4, "big") + b"\x55\x55"
+        if body == b"\xFF\xF5":
+            return self._status()
+        if len(body) in (42, 106) and body[-2] == 0xFF and body[-1] in (0xFB, 0xFA):
+            return self._finish(body)
+        return b""
+
+    def _handle_bcast(self, body: bytes) -> None:
+        if len(body) < 4 or body[0] != 0xFF:
+            return
+        payload, checksum = body[2:-2], int.from_bytes(body[-2:], "big")
+        if (BCAST_ADDR + sum(payload)) & 0xFFFF != checksum:
+            return
+        if body[1] == 0xF7 and len(payload) == 6:
+            session = payload[0]
+            if self.state == STATE_BROADCAST and session == self.session:
+                return  # 同一会话的重复启动帧
+            self.session = session
+            self.size = int.from_bytes(payload[1:4], "big")
+            self.chunk = int.from_bytes(payload[4:6], "big")
+            self.frames = (self.size + self.chunk - 1) // self.chunk
+            self.bitmap = bytearray((self.frames + 7) // 8)
+            self.image = bytearray(b"\xFF" * self.size)
+            self.state = STATE_BROADCAST
+            self.committed = False
+        elif body[1] == 0xF6 and len(payload) >= 5 and self.state == STATE_BROADCAST:
+            if payload[0] != self.session:
+                return
+            index = int.from_bytes(payload[1:3], "big")
+            length = int.from_bytes(payload[3:5], "big")
+            if index >= self.frames or length != len(payload) - 5:
+                return
+            offset = index * self.chunk
+            self.image[offset : offset + length] = payload[5:]
+            self.bitmap[index >> 3] |= 1 << (index & 7)
+
+    def _status(self) -> bytes:
+        if self.state != STATE_BROADCAST:
+            return b"\x55\xAA\xFF\xF5" + bytes([self.addr, 0, 0, 0, 0, 0]) + b"\x55\x55"
+        head = bytes([self.addr, self.session]) + self.frames.to_bytes(2, "big") + self.missing.to_bytes(2, "big")
+        return b"\x55\xAA\xFF\xF5" + head + bytes(self.bitmap) + b"\x55\x55"
+
+    def _finish(self, body: bytes) -> bytes:
+        if self.state != STATE_BROADCAST or self.missing:
+            return b""
+        if hashlib.sha256(self.image).digest() != body[8:40]:
+            return b""  # 摘要不符时保留会话，等待重发
+        self.version = int.from_bytes(body[0:4], "big")
+        self.committed = True
+        self.state = STATE_IDLE
+        return ACK
+
+
+class SimBus:
+    """与 SerialLink 接口相同：send() 发出一帧，poll() 把节点应答收进 rx_data"""
+
+    def __init__(self, count: int, loss: float = 0.0, baud: int = 115200, seed: int = 1) -> None:
+        self.nodes = {addr: SimNode(addr) for addr in range(1, count + 1)}
+        self.loss = loss
+        self.baud = baud
+        self.rng = random.Random(seed)
+        self.rx_data = bytearray()
+        self.tx_bytes = 0
+        self.rx_bytes = 0
+        self._pending = bytearray()
+
+    def send(self, msg: bytes) -> None:
+        self.tx_bytes += len(msg)
+        for node in self.nodes.values():
+            if self.loss and self.rng.random() < self.loss:
+                continue
+            reply = node.handle(msg)
+            self.rx_bytes += len(reply)
+            self._pending.extend(reply)
+
+    def poll(self, timeout: float) -> bool:
+        if not self._pending:
+            return False
+        self.rx_data.extend(self._pending)
+        self._pending.clear()
+        return True
+
+    @property
+    def airtime(self) -> float:
+        """按 10 位/字节估算的总线占用时间（秒）"""
+        return (self.tx_bytes + self.rx_bytes) * 10 / self.baud
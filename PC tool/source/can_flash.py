@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+CAN 刷写工具
+----------------
+通过 Linux SocketCAN 以 ISO-TP (ISO 15765-2) 承载 Bootloader 协议，与串口上位机的帧格式完全一致，
+设备侧需启用 BOOT_CONFIG_LINK_CAN。
+
+用法：
+    python can_flash.py <固件.bin|.hex> [--channel can0] [--fd] [--window 4] [--packet 1024]
+                        [--version 1] [--date 0x20260101] [--sign-key <私钥文件>] [--enter]
+
+    --enter      先向 APP 发送升级命令（55 AA FF EE 55 55），等待其复位进入 Bootloader
+    --fd         使用 CAN-FD 64 字节帧（接口需已配置 fd on）
+
+本地测试可使用虚拟总线：
+    sudo modprobe vcan && sudo ip link add vcan0 type vcan && sudo ip link set vcan0 up
+
+运行要求：Linux，Python 3.8+，无额外依赖。
+"""
+
+from __future__ import annotations
+
+import argparse
+import errno
+import select
+import socket
+import struct
+import sys
+import time
+from typing import Optional
+
+from link_flash import CMD_START_FLASH, LinkFlasher, add_flash_arguments, load_firmware
+
+DEFAULT_TX_ID = 0x7E0  # 上位机 -> 设备，对应 BOOT_CAN_RX_ID
+DEFAULT_RX_ID = 0x7E8  # 设备 -> 上位机，对应 BOOT_CAN_TX_ID
+
+CAN_SFF_MASK = 0x7FF
+CAN_FD_DLENS = (8, 12, 16, 20, 24, 32, 48, 64)
+ISOTP_PADDING = 0xCC
+ISOTP_TIMEOUT = 1.0  # N_Bs / N_Cr
+
+
+class SocketCanBus:
+    """原始 CAN_RAW 套接字，只接收 rx_id 的标准帧"""
+
+    CLASSIC_FMT = "=IB3x8s"
+    FD_FMT = "=IBB2x64s"
+
+    def __init__(self, channel: str, rx_id: int, fd: bool = False) -> None:
+        self.fd = fd
+        self.sock = socket.socket(socket.AF_CAN, socket.SOCK_RAW, socket.CAN_RAW)
+        if fd:
+            self.sock.setsockopt(socket.SOL_CAN_RAW, socket.CAN_RAW_FD_FRAMES, 1)
+        self.sock.setsockopt(
+            socket.SOL_CAN_RAW, socket.CAN_RAW_FILTER, struct.pack("=II", rx_id, CAN_SFF_MASK)
+        )
+        self.sock.bind((channel,))
+
+    def send(self, can_id: int, data: bytes) -> None:
+        if len(data) > 8:
+            frame = struct.pack(self.FD_FMT, can_id, len(data), 0, data)
+        else:
+            frame = struct.pack(self.CLASSIC_FMT, can_id, len(data), data)
+        while True:
+            try:
+                self.sock.send(frame)
+                return
+            except OSError as exc:
+                # 发送队列满时稍等重试
+                if exc.errno != errno.ENOBUFS:
+                    raise
+                time.sleep(0.001)
+
+    def recv(self, timeout: float) -> Optional[tuple[int, bytes]]:
+        ready, _, _ = select.select([self.sock], [], [], max(timeout, 0.0))
+        if not ready:
+            return None
+        frame = self.sock.recv(72)
+        if len(frame) == 72:
+            can_id, length, _flags, data = struct.unpack(self.FD_FMT, frame)
+        else:
+            can_id, length, data = struct.unpack(self.CLASSIC_FMT, frame)
+        return (can_id & socket.CAN_EFF_MASK, data[:length])
+
+
+class IsoTpLink:
+    """ISO-TP 收发：发送时按对端流控分块，接收到的报文拼接成字节流供 ACK 解析"""
+
+    def __init__(self, bus, tx_id: int, rx_id: int, frame_len: int = 8) -> None:
+        if frame_len not in CAN_FD_DLENS:
+            raise ValueError("frame_len 须为 8 或 CAN-FD 合法帧长")
+        self.bus = bus
+        self.tx_id = tx_id
+        self.rx_id = rx_id
+        self.frame_len = frame_len
+        self.rx_data = bytearray()
+        self._rx_msg = bytearray()
+        self._rx_remain = 0
+        self._rx_sn = 0
+        self._fc: Optional[bytes] = None
+
+    def _send_frame(self, data: bytes) -> None:
+        dlen = next(n for n in CAN_FD_DLENS if n >= len(data))
+        self.bus.send(self.tx_id, data + bytes([ISOTP_PADDING]) * (dlen - len(data)))
+
+    def _handle_frame(self, data: bytes) -> None:
+        if not data:
+            return
+        pci = data[0] & 0xF0
+        if pci == 0x00:
+            size, offset = data[0] & 0x0F, 1
+            if size == 0 and len(data) > 8:
+                size, offset = data[1], 2
+            self._rx_remain = 0
+            self.rx_data.extend(data[offset : offset + size])
+        elif pci == 0x10 and len(data) >= 8:
+            size, offset = ((data[0] & 0x0F) << 8) | data[1], 2
+            if size == 0:
+                size, offset = int.from_bytes(data[2:6], "big"), 6
+            self._rx_msg = bytearray(data[offset:])
+            self._rx_remain = size - len(self._rx_msg)
+            self._rx_sn = 1
+            self._send_frame(bytes([0x30, 0, 0]))
+        elif pci == 0x20 and self._rx_remain > 0:
+            if (data[0] & 0x0F) != self._rx_sn:
+                self._rx_remain = 0
+                return
+            chunk = data[1 : 1 + self._rx_remain]
+            self._rx_msg.extend(chunk)
+            self._rx_remain -= len(chunk)
+            self._rx_sn = (self._rx_sn + 1) & 0x0F
+            if self._rx_remain == 0:
+                self.rx_data.extend(self._rx_msg)
+        elif pci == 0x30 and len(data) >= 3:
+            self._fc = bytes(data[:3])
+
+    def poll(self, timeout: float) -> bool:
+        """处理最多 timeout 秒内到达的帧，收到任意帧返回 True"""
+        got = False
+        deadline = time.monotonic() + timeout
+        while True:
+            item = self.bus.recv(deadline - time.monotonic() if not got else 0.0)
+            if item is None:
+                return got
+            can_id, data = item
+            if can_id == self.rx_id:
+                self._handle_frame(data)
+                got = True
+
+    def _wait_fc(self) -> tuple[int, float]:
+        deadline = time.monotonic() + ISOTP_TIMEOUT
+        while True:
+            if self._fc is not None:
+                status, bs, st_min = self._fc
+                self._fc = None
+                if status == 0x30:
+                    if st_min <= 0x7F:
+                        gap = st_min / 1000.0
+                    elif 0xF1 <= st_min <= 0xF9:
+                        gap = (st_min - 0xF0) / 10000.0
+                    else:
+                        gap = 0.127
+                    return (bs, gap)
+                if status == 0x31:
+                    deadline = time.monotonic() + ISOTP_TIMEOUT
+                    continue
+                raise RuntimeError("设备接收缓存溢出 (FC overflow)")
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                raise RuntimeError("等待流控帧超时")
+            self.poll(remaining)
+
+    def send(self, msg: bytes) -> None:
+        dlen = self.frame_len
+        if len(msg) <= 7:
+            self._send_frame(bytes([len(msg)]) + msg)
+            return
+        if dlen > 8 and len(msg) <= dlen - 2:
+            self._send_frame(bytes([0x00, len(msg)]) + msg)
+            return
+
+        if len(msg) <= 0xFFF:
+            head = bytes([0x10 | (len(msg) >> 8), len(msg) & 0xFF])
+        else:
+            head = bytes([0x10, 0x00]) + len(msg).to_bytes(4, "big")
+        first = dlen - len(head)
+        self._fc = None
+        self._send_frame(head + msg[:first])
+        offset = first
+        sn = 1
+        while offset < len(msg):
+            bs, gap = self._wait_fc()
+            sent = 0
+            while offset < len(msg) and (bs == 0 or sent < bs):
+                if sent and gap:
+                    time.sleep(gap)
+                chunk = msg[offset : offset + dlen - 1]
+                self._send_frame(bytes([0x20 | sn]) + chunk)
+                offset += len(chunk)
+                sn = (sn + 1) & 0x0F
+                sent += 1
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="通过 SocketCAN + ISO-TP 刷写 easy_bootloader")
+    add_flash_arguments(parser)
+    parser.add_argument("--channel", default="can0")
+    parser.add_argument("--tx-id", type=lambda s: int(s, 0), default=DEFAULT_TX_ID)
+    parser.add_argument("--rx-id", type=lambda s: int(s, 0), default=DEFAULT_RX_ID)
+    parser.add_argument("--fd", action="store_true", help="使用 CAN-FD 64 字节帧")
+    parser.add_argument("--enter", action="store_true", help="先让 APP 复位进入 Bootloader")
+    args = parser.parse_args(argv[1:])
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    bus = SocketCanBus(args.channel, args.rx_id, args.fd)
+    link = IsoTpLink(bus, args.tx_id, args.rx_id, 64 if args.fd else 8)
+    if args.enter:
+        link.send(CMD_START_FLASH)
+        time.sleep(1.0)
+
+    flasher = LinkFlasher(link, args.window, args.packet)
+    try:
+        ok = flasher.flash(data, args.version, args.date, args.sign_key)
+    except RuntimeError as exc:
+        print(f"刷写失败：{exc}")
+        ok = False
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""
+前向纠错（FEC）单向刷写工具
+----------------
+用于单向电台、光隔离等收不到（或收不可靠）应答的链路，设备侧需启用 BOOT_CONFIG_ENABLE_FEC。
+固件按 --chunk 分帧，每 --group 个数据帧后附 --parity 个 Reed-Solomon 校验帧，一组内收到任意 group 帧
+即可恢复整组；整个固件按轮重复发送（--passes），某组丢帧超过校验帧数时由下一轮补齐。
+设备收齐后按启动帧中的 SHA-256 摘要（及签名）校验，通过即写标志位并复位，全程不需要应答。
+
+用法：
+    python fec_flash.py <固件.bin|.hex> --port COM3 [--baud 115200] [--group 16] [--parity 4] [--chunk 512]
+                        [--passes 3] [--erase-wait 10] [--gap 0.012] [--addr 0] [--version 1] [--date ...]
+                        [--sign-key <私钥文件>] [--enter]
+    python fec_flash.py <固件.bin|.hex> --simulate 0.01,0.05,0.1 [--group 16] [--parity 4] [--baud 115200]
+
+    --parity     每组校验帧数，冗余度 = parity / group，须不大于设备 BOOT_FEC_MAX_PARITY
+    --chunk      每帧数据长度，4 的倍数，须不大于设备 BOOT_FEC_CHUNK_MAX
+    --erase-wait 首个启动帧后等待设备擦除 APP 区的时间（秒），期间只重复发送启动帧
+    --addr       多点总线模式下的目标地址，0 为所有节点；不指定时帧中不带地址
+    --enter      先向 APP 发送升级命令（55 AA FF EE 55 55），等待其复位进入 Bootloader
+    --simulate   不连接设备，按给定的逐帧丢包率模拟接收（与设备相同的分组恢复逻辑），
+                 输出完成所需轮数与有效吞吐，并与不加校验帧的重复发送对比
+
+运行要求：Python 3.8+，pyserial (`pip install pyserial`，仅实际刷写时需要)
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import random
+import sys
+import time
+from pathlib import Path
+from typing import Iterator, Optional
+
+from image_sign import sign_digest
+from link_flash import CMD_START_FLASH, build_command, frame_head, load_firmware
+
+FEC_CHUNK = 512  # 对应设备侧 BOOT_FEC_CHUNK_MAX
+FEC_GROUP = 16
+FEC_PARITY = 4
+FEC_PASSES = 3
+FEC_GAP = 0.012  # 略大于设备调度周期，保证每个周期最多到达一帧
+FEC_ERASE_WAIT = 10.0
+FEC_SIM_MAX_PASSES = 20
+
+# GF(2^8)，本原多项式 0x11D，与 boot_fec.c 一致
+GF_EXP = [0] * 510
+GF_LOG = [0] * 256
+_x = 1
+for _i in range(255):
+    GF_EXP[_i] = GF_EXP[_i + 255] = _x
+    GF_LOG[_x] = _i
+    _x <<= 1
+    if _x & 0x100:
+        _x ^= 0x11D
+
+
+def gf_mul(a: int, b: int) -> int:
+    return 0 if a == 0 or b == 0 else GF_EXP[GF_LOG[a] + GF_LOG[b]]
+
+
+def gf_inv(a: int) -> int:
+    return GF_EXP[255 - GF_LOG[a]]
+
+
+def fec_coef(row: int, col: int) -> int:
+    """校验帧 row 中数据帧 col 的柯西系数 1 / ((0x80 + row) ^ col)"""
+    return gf_inv((0x80 + row) ^ col)
+
+
+_MUL_TABLES: dict[int, bytes] = {}
+
+
+def _mul_bytes(coef: int, data: bytes) -> int:
+    """coef * data（逐字节），以整数返回便于异或累加"""
+    table = _MUL_TABLES.get(coef)
+    if table is None:
+        table = _MUL_TABLES[coef] = bytes(gf_mul(coef, v) for v in range(256))
+    return int.from_bytes(data.translate(table), "big")
+
+
+def gf_invert(matrix: list[list[int]]) -> list[list[int]]:
+    """高斯-约当求逆（柯西矩阵方阵子块必可逆）"""
+    n = len(matrix)
+    a = [row[:] + [1 if i == j else 0 for j in range(n)] for i, row in enumerate(matrix)]
+    for col in range(n):
+        pivot = next(r for r in range(col, n) if a[r][col])
+        a[col], a[pivot] = a[pivot], a[col]
+        scale = gf_inv(a[col][col])
+        a[col] = [gf_mul(v, scale) for v in a[col]]
+        for r in range(n):
+            if r != col and a[r][col]:
+                factor = a[r][col]
+                a[r] = [v ^ gf_mul(factor, p) for v, p in zip(a[r], a[col])]
+    return [row[n:] for row in a]
+
+
+def _frames(data: bytes, chunk: int) -> list[bytes]:
+    return [data[i : i + chunk] for i in range(0, len(data), chunk)]
+
+
+def encode_groups(data: bytes, chunk: int, k: int, m: int) -> list[tuple[list[bytes], list[bytes]]]:
+    """按组生成 (数据帧, 校验帧)，最后一帧按 0xFF 补齐到 chunk 参与运算"""
+    frames = _frames(data, chunk)
+    groups = []
+    for first in range(0, len(frames), k):
+        members = frames[first : first + k]
+        padded = [f + b"\xFF" * (chunk - len(f)) for f in members]
+        parity = []
+        for row in range(m):
+            acc = 0
+            for col, frame in enumerate(padded):
+                acc ^= _mul_bytes(fec_coef(row, col), frame)
+            parity.append(acc.to_bytes(chunk, "big"))
+        groups.append((members, parity))
+    return groups
+
+
+def _checksum(addr: Optional[int], body: bytes) -> bytes:
+    return (((addr or 0) + sum(body)) & 0xFFFF).to_bytes(2, "big")
+
+
+def build_fec_start(session: int, size: int, chunk: int, k: int, m: int, version: int, date: int,
+                    digest: bytes, signature: Optional[bytes], addr: Optional[int] = None) -> bytes:
+    """启动帧: 55 AA [addr] FF F4 [session] [size 3B] [chunk 2B] [k] [m] [ver 4B] [date 4B] [sha256] [sig] [累加和] 55 55"""
+    body = (
+        bytes([session]) + size.to_bytes(3, "big") + chunk.to_bytes(2, "big") + bytes([k, m])
+        + version.to_bytes(4, "big") + date.to_bytes(4, "big") + digest + (signature or bytes(64))
+    )
+    return frame_head(addr) + b"\xFF\xF4" + body + _checksum(addr, body) + b"\x55\x55"
+
+
+def build_fec_data(session: int, group: int, row: int, payload: bytes, addr: Optional[int] = None) -> bytes:
+    """数据帧: 55 AA [addr] FF F3 [session] [group 2B] [row] [len 2B] payload [累加和] 55 55，row >= k 为校验帧"""
+    body = bytes([session]) + group.to_bytes(2, "big") + bytes([row]) + len(payload).to_bytes(2, "big") + payload
+    return frame_head(addr) + b"\xFF\xF3" + body + _checksum(addr, body) + b"\x55\x55"
+
+
+def stream_frames(groups, session: int, k: int, start_frame: bytes, addr: Optional[int]) -> Iterator[tuple[int, int, bytes]]:
+    """一轮发送的帧序列 (group, row, frame)，每组前重发一次启动帧（row = -1）"""
+    for group, (members, parity) in enumerate(groups):
+        yield (group, -1, start_frame)
+        rows = list(enumerate(members)) + [(k + i, payload) for i, payload in enumerate(parity)]
+        for row, payload in rows:
+            yield (group, row, build_fec_data(session, group, row, payload, addr))
+
+
+class FecReceiver:
+    """设备侧 bootloader_fec_data / bootloader_fec_decode 的等价模型，用于仿真"""
+
+    def __init__(self, size: int, chunk: int, k: int, m: int) -> None:
+        self.size, self.chunk, self.k, self.m = size, chunk, k, m
+        self.frames = (size + chunk - 1) // chunk
+        self.image = bytearray(b"\xFF" * (self.frames * chunk))
+        self.have = [False] * self.frames
+        self.missing = self.frames
+        self.joined = False
+        self.group = -1
+        self.parity: dict[int, bytes] = {}
+
+    def receive(self, group: int, row: int, payload: bytes) -> None:
+        if row < 0:
+            self.joined = True
+            return
+        if not self.joined:
+            return
+        if group != self.group:
+            self.group, self.parity = group, {}
+        if row < self.k:
+            index = group * self.k + row
+            if self.have[index]:
+                return
+            self.image[index * self.chunk : index * self.chunk + len(payload)] = payload
+            self.have[index] = True
+            self.missing -= 1
+        else:
+            self.parity[row - self.k] = payload
+        self._decode()
+
+    def _decode(self) -> None:
+        first = self.group * self.k
+        count = min(self.k, self.frames - first)
+        lost = [c for c in range(count) if not self.have[first + c]]
+        rows = sorted(self.parity)
+        if len(lost) > len(rows):
+            return
+        parity, self.parity = self.parity, {}
+        if not lost:
+            return
+        rows = rows[: len(lost)]
+        chunk = self.chunk
+        reduced = [int.from_bytes(parity[r], "big") for r in rows]
+        for c in range(count):
+            if self.have[first + c]:
+                frame = bytes(self.image[(first + c) * chunk : (first + c + 1) * chunk])
+                for i, r in enumerate(rows):
+                    reduced[i] ^= _mul_bytes(fec_coef(r, c), frame)
+        inverse = gf_invert([[fec_coef(r, c) for c in lost] for r in rows])
+        for j, c in enumerate(lost):
+            acc = 0
+            for i in range(len(rows)):
+                acc ^= _mul_bytes(inverse[j][i], reduced[i].to_bytes(chunk, "big"))
+            index = first + c
+            self.image[index * chunk : (index + 1) * chunk] = acc.to_bytes(chunk, "big")
+            self.have[index] = True
+            self.missing -= 1
+
+    @property
+    def complete(self) -> bool:
+        return self.joined and self.missing == 0
+
+
+def simulate(data: bytes, chunk: int, k: int, m: int, loss: float, baud: int, seed: int = 1):
+    """逐帧独立丢包的仿真，返回 (是否恢复且一致, 完成时已发送字节数, 轮数)"""
+    rng = random.Random(seed)
+    groups = encode_groups(data, chunk, k, m)
+    start_frame = build_fec_start(1, len(data), chunk, k, m, 1, 0, hashlib.sha256(data).digest(), None)
+    receiver = FecReceiver(len(data), chunk, k, m)
+    sent = 0
+    for passes in range(1, FEC_SIM_MAX_PASSES + 1):
+        for group, row, frame in stream_frames(groups, 1, k, start_frame, None):
+            sent += len(frame)
+            if rng.random() < loss:
+                continue
+            payload = start_frame if row < 0 else _payload_of(groups, group, row, k)
+            receiver.receive(group, row, payload)
+            if receiver.complete:
+                return (bytes(receiver.image[: len(data)]) == data, sent, passes)
+    return (False, sent, FEC_SIM_MAX_PASSES)
+
+
+def _payload_of(groups, group: int, row: int, k: int) -> bytes:
+    members, parity = groups[group]
+    return members[row] if row < k else parity[row - k]
+
+
+def run_simulation(data: bytes, chunk: int, k: int, m: int, losses: list[float], baud: int) -> None:
+    print(f"固件 {len(data)} 字节，每帧 {chunk} 字节，每组 {k} 个数据帧，{baud}bps（10 位/字节）")
+    print(f"{'丢包率':>6}  {'校验帧':>6}  {'轮数':>4}  {'发送字节':>10}  {'有效吞吐':>12}  结果")
+    for loss in losses:
+        for parity in (m, 0) if m else (0,):
+            ok, sent, passes = simulate(data, chunk, k, parity, loss, baud)
+            seconds = sent * 10 / baud
+            goodput = len(data) / seconds if ok else 0.0
+            verdict = "恢复一致" if ok else "未完成"
+            print(f"{loss:>6.1%}  {parity:>6}  {passes:>4}  {sent:>10}  {goodput:>8.0f} B/s  {verdict}")
+
+
+def fec_flash(link, data: bytes, version: int, date: int, sign_key: Optional[Path], chunk: int, k: int, m: int,
+              passes: int, erase_wait: float, gap: float, addr: Optional[int]) -> None:
+    session = random.randint(1, 0xFF)
+    digest = hashlib.sha256(data).digest()
+    signature = sign_digest(sign_key, digest) if sign_key is not None else None
+    start_frame = build_fec_start(session, len(data), chunk, k, m, version, date, digest, signature, addr)
+    groups = encode_groups(data, chunk, k, m)
+
+    # 设备擦除 APP 区期间收不到数据，只每秒重复一次启动帧
+    deadline = time.monotonic() + erase_wait
+    while True:
+        link.send(start_frame)
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            break
+        time.sleep(min(1.0, remaining))
+
+    start = time.monotonic()
+    sent = 0
+    for pass_idx in range(passes):
+        for group, _row, frame in stream_frames(groups, session, k, start_frame, addr):
+            link.send(frame)
+            sent += len(frame)
+            if gap:
+                time.sleep(gap)
+            print(f"\r第 {pass_idx + 1}/{passes} 轮：第 {group + 1}/{len(groups)} 组", end="", flush=True)
+    print()
+    elapsed = time.monotonic() - start
+    print(
+        f"发送完成：{len(data)} 字节固件，共发送 {sent} 字节（冗余 {m}/{k}，{passes} 轮），"
+        f"耗时 {elapsed:.1f}s，单轮有效吞吐 {len(data) * passes / elapsed:.0f} B/s"
+    )
+
+
+class SerialLink:
+    """只发不收的串口"""
+
+    def __init__(self, port: str, baud: int) -> None:
+        import serial
+
+        self.serial = serial.Serial(port, baud, timeout=0)
+
+    def send(self, msg: bytes) -> None:
+        self.serial.write(msg)
+        self.serial.flush()
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="通过单向链路以前向纠错方式刷写 easy_bootloader")
+    parser.add_argument("firmware", type=Path)
+    parser.add_argument("--port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--group", type=int, default=FEC_GROUP, help="每组数据帧数 (1-128)")
+    parser.add_argument("--parity", type=int, default=FEC_PARITY, help="每组校验帧数 (0-8)")
+    parser.add_argument("--chunk", type=int, default=FEC_CHUNK, help="每帧数据长度，4 的倍数")
+    parser.add_argument("--passes", type=int, default=FEC_PASSES, help="整个固件重复发送的轮数")
+    parser.add_argument("--erase-wait", type=float, default=FEC_ERASE_WAIT, help="等待设备擦除的时间（秒）")
+    parser.add_argument("--gap", type=float, default=FEC_GAP, help="帧间隔（秒）")
+    parser.add_argument("--addr", type=lambda s: int(s, 0), default=None, help="多点总线地址，0 为所有节点")
+    parser.add_argument("--version", type=lambda s: int(s, 0), default=1)
+    parser.add_argument("--date", type=lambda s: int(s, 0), default=int(time.strftime("0x%Y%m%d"), 16))
+    parser.add_argument("--sign-key", type=Path, default=None)
+    parser.add_argument("--enter", action="store_true", help="先让 APP 复位进入 Bootloader")
+    parser.add_argument("--simulate", type=lambda s: [float(x) for x in s.split(",")], default=None,
+                        metavar="LOSS[,LOSS...]", help="按给定丢包率仿真，不连接设备")
+    args = parser.parse_args(argv[1:])
+
+    if not 1 <= args.group <= 128 or not 0 <= args.parity <= 8 or args.chunk <= 0 or args.chunk % 4:
+        print("参数错误：--group 须在 1-128，--parity 须在 0-8，--chunk 须为 4 的正整数倍")
+        return 1
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    if args.simulate is not None:
+        run_simulation(data, args.chunk, args.group, args.parity, args.simulate, args.baud)
+        return 0
+    if args.port is None:
+        parser.error("需要 --port 或 --simulate")
+
+    link = SerialLink(args.port, args.baud)
+    if args.enter:
+        link.send(build_command(CMD_START_FLASH, args.addr))
+        time.sleep(1.0)
+    fec_flash(link, data, args.version, args.date, args.sign_key, args.chunk, args.group, args.parity,
+              args.passes, args.erase_wait, args.gap, args.addr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+存储转发网关刷写工具
+----------------
+上位机只连接网关（如 STM32F407 主控），网关 APP 启用 BOOT_APP_CONFIG_ENABLE_GATEWAY 后，先把带下游目标的固件
+后台接收到暂存区并校验摘要，再按串口升级协议经各下游串口并行刷写子节点（如 CH32V307 协处理器）。
+
+用法：
+    python gateway_flash.py <固件.bin|.hex> --port COM3 --children 0,1 [--addr 5] [--packet 1024]
+                            [--version 1] [--date 0x20260101] [--sign-key <私钥文件>] [--interval 0.5]
+    python gateway_flash.py <固件.bin|.hex> --children 0,1 --simulate [--loss 0.002]
+
+    --children   下游链路编号（对应网关移植层 boot_port_app_child_write/read 的 child），逗号分隔
+    --addr       网关挂在 RS-485 多点总线上时的节点地址（BOOT_APP_CONFIG_ENABLE_ADDRESS）
+    --sign-key   子节点 Bootloader 启用签名校验时，用子节点信任的私钥签名（网关原样转发完成帧）
+    --simulate   不连接串口，在本机模拟网关与子节点（见 gateway_sim.py），--loss 为下游链路的丢帧率
+
+流程：
+    1. 目标帧 55 AA [addr] FF F2 [mask] 55 55，网关应答 ACK
+    2. 数据帧 + 完成帧，与 APP 后台接收相同；网关校验摘要后应答 ACK 并开始转发（不复位）
+    3. 周期发送进度查询 55 AA [addr] FF F1 55 55，网关应答 55 AA FF F1 [n] ([state][percent]) * n 55 55
+
+运行要求：Python 3.8+，pyserial (`pip install pyserial`)
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+import time
+from typing import Optional
+
+from gateway_sim import SimGateway
+from link_flash import LinkFlasher, add_flash_arguments, frame_head, load_firmware
+from rs485_flash import SerialLink, parse_addr
+
+CMD_TARGET = 0xF2
+CMD_STATUS = 0xF1
+STATUS_HEAD = bytes([0x55, 0xAA, 0xFF, CMD_STATUS])
+TARGET_TIMEOUT = 2.0
+STATUS_TIMEOUT = 0.5
+STATUS_MISSES = 5  # 连续多少次查询无应答后放弃
+
+CHILD_STATES = {
+    0: "空闲",
+    1: "进入 Bootloader",
+    2: "发送数据",
+    3: "等待校验",
+    4: "等待重试",
+    5: "完成",
+    6: "失败",
+}
+CHILD_DONE = 5
+CHILD_FAILED = 6
+
+
+def build_target(mask: int, addr: Optional[int] = None) -> bytes:
+    return frame_head(addr) + bytes([0xFF, CMD_TARGET, mask, 0x55, 0x55])
+
+
+def build_status_query(addr: Optional[int] = None) -> bytes:
+    return frame_head(addr) + bytes([0xFF, CMD_STATUS, 0x55, 0x55])
+
+
+def _take_status_reply(buf: bytearray) -> Optional[list[tuple[int, int]]]:
+    """从接收流中取出一条进度应答，返回 [(state, percent), ...]"""
+    while True:
+        idx = buf.find(STATUS_HEAD)
+        if idx == -1 or len(buf) < idx + 5:
+            return None
+        count = buf[idx + 4]
+        end = idx + 7 + 2 * count
+        if len(buf) < end:
+            return None
+        if buf[end - 2 : end] != b"\x55\x55":
+            del buf[: idx + 1]
+            continue
+        body = bytes(buf[idx + 5 : end - 2])
+        del buf[:end]
+        return [(body[i], body[i + 1]) for i in range(0, len(body), 2)]
+
+
+def query_progress(link, addr: Optional[int], timeout: float = STATUS_TIMEOUT) -> Optional[list[tuple[int, int]]]:
+    link.send(build_status_query(addr))
+    deadline = time.monotonic() + timeout
+    while True:
+        reply = _take_status_reply(link.rx_data)
+        if reply is not None:
+            return reply
+        remaining = deadline - time.monotonic()
+        if remaining <= 0:
+            return None
+        link.poll(remaining)
+
+
+def gateway_flash(link, children: list[int], data: bytes, args, interval: float) -> dict[int, bool]:
+    """上传到网关并跟踪转发进度，返回 {子节点: 是否成功}"""
+    mask = sum(1 << child for child in children)
+    flasher = LinkFlasher(link, 1, args.packet, args.addr)
+    link.send(build_target(mask, args.addr))
+    if not flasher.wait_ack(1, TARGET_TIMEOUT):
+        print("网关未应答目标帧（未启用网关、正在转发或子节点编号超出范围）")
+        return {child: False for child in children}
+    flasher.ack_count = 0
+
+    print("上传到网关：")
+    if not flasher.flash(data, args.version, args.date, args.sign_key):
+        return {child: False for child in children}
+
+    print("网关转发中：")
+    misses = 0
+    while True:
+        reply = query_progress(link, args.addr)
+        if reply is None:
+            misses += 1
+            if misses >= STATUS_MISSES:
+                print("\n网关无应答，放弃查询")
+                return {child: False for child in children}
+            continue
+        misses = 0
+        states = {child: reply[child] for child in children if child < len(reply)}
+        total = sum(100 if state == CHILD_DONE else percent for state, percent in states.values())
+        line = " | ".join(
+            f"子节点 {child}: {CHILD_STATES.get(state, state)} {percent}%" for child, (state, percent) in states.items()
+        )
+        print(f"\r{line} | 总进度 {total // max(len(children), 1)}%", end="", flush=True)
+        if len(states) == len(children) and all(state in (CHILD_DONE, CHILD_FAILED) for state, _ in states.values()):
+            print()
+            return {child: state == CHILD_DONE for child, (state, _percent) in states.items()}
+        time.sleep(interval)
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="经存储转发网关并行刷写下游子节点")
+    add_flash_arguments(parser)
+    parser.add_argument("--children", type=lambda s: [int(x, 0) for x in s.split(",")], required=True)
+    parser.add_argument("--addr", type=parse_addr, default=None, help="网关在多点总线上的地址")
+    parser.add_argument("--interval", type=float, default=0.5, help="进度查询间隔（秒）")
+    parser.add_argument("--port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--simulate", action="store_true", help="模拟网关与子节点，不连接串口")
+    parser.add_argument("--loss", type=float, default=0.0, help="模拟时下游链路的丢帧率")
+    args = parser.parse_args(argv[1:])
+
+    if not args.children or any(not 0 <= child < 8 for child in args.children):
+        parser.error("--children 须为 0-7 之间的编号")
+    if args.simulate:
+        link = SimGateway(max(args.children) + 1, args.loss, args.addr, args.baud)
+        args.interval = 0.0
+    elif args.port is None:
+        parser.error("需要 --port 或 --simulate")
+    else:
+        link = SerialLink(args.port, args.baud)
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    start = time.monotonic()
+    result = gateway_flash(link, sorted(set(args.children)), data, args, args.interval)
+    for child, ok in result.items():
+        print(f"子节点 {child}: {'升级成功' if ok else '升级失败'}")
+    print(f"总耗时 {time.monotonic() - start:.2f}s")
+    if args.simulate:
+        upstream, downstream = link.airtime
+        direct = len(result) * len(data) * 10 / args.baud
+        retries = sum(link.retries[child] for child in result)
+        print(f"模拟链路耗时：上行 {upstream:.2f}s + 下行并行 {downstream:.2f}s（重试 {retries} 次），"
+              f"上位机逐个直连约 {direct:.2f}s")
+    return 0 if result and all(result.values()) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+存储转发网关仿真
+----------------
+在上位机内模拟一台网关（APP 启用 BOOT_APP_CONFIG_ENABLE_GATEWAY）及其下游的若干子节点 Bootloader，
+上位机 -> 网关 -> 子节点两级链路都按真实帧格式收发，用于在没有硬件时验证 gateway_flash.py：
+
+    python gateway_flash.py <固件.bin> --children 0,1,2 --simulate --loss 0.002
+
+丢帧只发生在下游链路（每帧独立计算），子节点收不到帧时不应答，由网关超时后从头重发该子节点。
+"""
+
+from __future__ import annotations
+
+import hashlib
+import random
+
+ACK = bytes([0x55, 0xAA, 0xFF, 0xFE, 0x55, 0x55])
+CMD_ENTER = bytes([0x55, 0xAA, 0xFF, 0xEE, 0x55, 0x55])
+
+# 与 boot_gateway.h 中 boot_gateway_child_state_t 一致
+CHILD_IDLE, CHILD_ENTER, CHILD_DATA, CHILD_FINISH, CHILD_RETRY, CHILD_DONE, CHILD_FAILED = range(7)
+GATEWAY_CHUNK = 256  # BOOT_APP_GATEWAY_CHUNK
+GATEWAY_RETRIES = 2  # BOOT_APP_GATEWAY_RETRIES
+
+
+def _parse_data_frame(msg: bytes, addr_len: int) -> tuple[int, bytes] | None:
+    """数据帧 55 AA [addr] [剩余 3B] [长度 2B] 数据 [累加和 2B] 55 55，返回 (剩余, 数据)"""
+    body = msg[2 + addr_len : -2]
+    if len(body) < 7 or body[0] == 0xFF:
+        return None
+    length = int.from_bytes(body[3:5], "big")
+    if len(body) != 7 + length:
+        return None
+    checksum = (sum(msg[2 : 2 + addr_len]) + sum(body[3:-2])) & 0xFFFF
+    if checksum != int.from_bytes(body[-2:], "big"):
+        return None
+    return int.from_bytes(body[0:3], "big"), body[5:-2]
+
+
+class SimChild:
+    """子节点 Bootloader（非地址模式）：顺序接收数据帧，完成帧摘要一致后提交"""
+
+    def __init__(self) -> None:
+        self.image = bytearray()
+        self.receiving = False
+        self.version = 0xFFFFFFFF
+        self.committed = b""
+
+    def reset(self) -> None:
+        """对应 BOOT_UART_TIMEOUT_MS 到期后放弃本次接收"""
+        self.image = bytearray()
+        self.receiving = False
+
+    def handle(self, msg: bytes) -> bytes:
+        if msg == CMD_ENTER:
+            return b""  # 已在 Bootloader 中，忽略升级命令
+        if len(msg) in (46, 110) and msg[-4] == 0xFF and msg[-3] in (0xFB, 0xFA):
+            if self.receiving or hashlib.sha256(self.image).digest() != msg[10:42]:
+                self.reset()
+                return b""
+            self.version = int.from_bytes(msg[2:6], "big")
+            self.committed = bytes(self.image)
+            return ACK
+        frame = _parse_data_frame(msg, 0)
+        if frame is None:
+            return b""
+        remaining, payload = frame
+        if not self.receiving:
+            self.image = bytearray()
+            self.receiving = True
+        self.image.extend(payload)
+        if remaining == 0:
+            self.receiving = False
+        return ACK
+
+
+class SimGateway:
+    """网关 APP：与 SerialLink 接口相同，send() 收上位机帧，poll() 推进下游转发并交付应答"""
+
+    def __init__(self, children: int, loss: float = 0.0, addr: int | None = None,
+                 baud: int = 115200, child_baud: int = 115200, seed: int = 1) -> None:
+        self.children = [SimChild() for _ in range(children)]
+        self.loss = loss
+        self.addr = addr
+        self.baud = baud
+        self.child_baud = child_baud
+        self.rng = random.Random(seed)
+        self.rx_data = bytearray()
+        self.up_bytes = 0
+        self.down_bytes = [0] * children
+        self.retries = [0] * children
+        self._pending = bytearray()
+        self._target = 0
+        self._stage = bytearray()
+        self._image = b""
+        self._finish = b""
+        self._state = [CHILD_IDLE] * children
+        self._acked = [0] * children
+
+    # ---- 上行：与 easy_bootloader_app.c 的后台接收一致 ----
+    def send(self, msg: bytes) -> None:
+        self.up_bytes += len(msg)
+        addr_len = 0 if self.addr is None else 1
+        if len(msg) < 6 + addr_len or msg[:2] != b"\x55\xAA" or msg[-2:] != b"\x55\x55":
+            return
+        if addr_len and msg[2] != self.addr:
+            return
+        body = msg[2 + addr_len : -2]
+        if body == b"\xFF\xF1":
+            self._reply(self._status())
+        elif len(body) == 3 and body[:2] == b"\xFF\xF2":
+            if not self.busy and not self._stage and not body[2] >> len(self.children):
+                self._target = body[2]
+                self._reply(ACK)
+        elif len(body) in (42, 106) and body[-2] == 0xFF and body[-1] in (0xFB, 0xFA):
+            self._finish_upload(body)
+        else:
+            frame = _parse_data_frame(msg, addr_len)
+            if frame is not None and not self.busy:
+                self._stage.extend(frame[1])
+                self._reply(ACK)
+
+    def _finish_upload(self, body: bytes) -> None:
+        image, self._stage = bytes(self._stage), bytearray()
+        if hashlib.sha256(image).digest() != body[8:40]:
+            self._target = 0
+            return
+        if self._target:
+            self._image, self._finish = image, bytes(body)
+            for idx in range(len(self.children)):
+                if self._target >> idx & 1:
+                    self._state[idx] = CHILD_ENTER
+                    self._acked[idx] = 0
+                    self.retries[idx] = 0
+            self._target = 0
+        self._reply(ACK)
+
+    def _status(self) -> bytes:
+        out = bytearray(b"\x55\xAA\xFF\xF1") + bytes([len(self.children)])
+        for idx in range(len(self.children)):
+            percent = self._acked[idx] * 100 // len(self._image) if self._image else 0
+            out += bytes([self._state[idx], percent])
+        return bytes(out + b"\x55\x55")
+
+    def _reply(self, msg: bytes) -> None:
+        self._pending.extend(msg)
+
+    # ---- 下行：与 boot_gateway.c 的子节点状态机一致，每步每个子节点最多一帧 ----
+    @property
+    def busy(self) -> bool:
+        return any(state in (CHILD_ENTER, CHILD_DATA, CHILD_FINISH, CHILD_RETRY) for state in self._state)
+
+    def _down(self, idx: int, msg: bytes) -> bytes:
+        self.down_bytes[idx] += len(msg)
+        if self.loss and self.rng.random() < self.loss:
+            return b""
+        return self.children[idx].handle(msg)
+
+    def _step_child(self, idx: int) -> None:
+        state = self._state[idx]
+        if state == CHILD_ENTER:
+            self._down(idx, CMD_ENTER)
+            self._state[idx] = CHILD_DATA
+        elif state == CHILD_DATA:
+            offset = self._acked[idx]
+            chunk = self._image[offset : offset + GATEWAY_CHUNK]
+            remaining = len(self._image) - offset - len(chunk)
+            length = len(chunk).to_bytes(2, "big")
+            checksum = ((sum(length) + sum(chunk)) & 0xFFFF).to_bytes(2, "big")
+            frame = b"\x55\xAA" + remaining.to_bytes(3, "big") + length + chunk + checksum + b"\x55\x55"
+            if self._down(idx, frame) != ACK:
+                self._fail(idx)
+                return
+            self._acked[idx] += len(chunk)
+            if self._acked[idx] == len(self._image):
+                self._state[idx] = CHILD_FINISH
+        elif state == CHILD_FINISH:
+            if self._down(idx, b"\x55\xAA" + self._finish + b"\x55\x55") == ACK:
+                self._state[idx] = CHILD_DONE
+            else:
+                self._fail(idx)
+        elif state == CHILD_RETRY:
+            self._state[idx] = CHILD_ENTER
+
+    def _fail(self, idx: int) -> None:
+        self.children[idx].reset()
+        self._acked[idx] = 0
+        if self.retries[idx] < GATEWAY_RETRIES:
+            self.retries[idx] += 1
+            self._state[idx] = CHILD_RETRY
+        else:
+            self._state[idx] = CHILD_FAILED
+
+    def poll(self, timeout: float) -> bool:
+        for _ in range(16):
+            for idx in range(len(self.children)):
+                self._step_child(idx)
+        if not self._pending:
+            return False
+        self.rx_data.extend(self._pending)
+        self.up_bytes += len(self._pending)
+        self._pending.clear()
+        return True
+
+    @property
+    def airtime(self) -> tuple[float, float]:
+        """按 10 位/字节估算 (上行链路耗时, 下行并行耗时)，下行取最慢的子节点"""
+        return self.up_bytes * 10 / self.baud, max(self.down_bytes) * 10 / self.child_baud
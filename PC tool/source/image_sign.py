@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+固件签名工具
+----------------
+对固件 SHA-256 摘要做 Ed25519 签名（RFC 8032，纯 Python 实现，无额外依赖）。
+
+用法：
+    python image_sign.py keygen <私钥文件>        生成私钥并打印 BOOT_SIGN_PUBLIC_KEY 配置
+    python image_sign.py pubkey <私钥文件>        打印私钥对应的公钥配置
+    python image_sign.py sign <私钥文件> <固件>   打印固件摘要与签名
+
+私钥文件内容为 32 字节种子的十六进制字符串，请妥善保管，不要提交到仓库。
+"""
+
+from __future__ import annotations
+
+import hashlib
+import os
+import sys
+from pathlib import Path
+
+# 曲线参数
+_P = 2**255 - 19
+_L = 2**252 + 27742317777372353535851937790883648493
+_D = -121665 * pow(121666, _P - 2, _P) % _P
+_SQRT_M1 = pow(2, (_P - 1) // 4, _P)
+_BY = 4 * pow(5, _P - 2, _P) % _P
+
+
+def _recover_x(y: int, sign: int) -> int | None:
+    if y >= _P:
+        return None
+    x2 = (y * y - 1) * pow(_D * y * y + 1, _P - 2, _P) % _P
+    if x2 == 0:
+        return None if sign else 0
+    x = pow(x2, (_P + 3) // 8, _P)
+    if (x * x - x2) % _P != 0:
+        x = x * _SQRT_M1 % _P
+    if (x * x - x2) % _P != 0:
+        return None
+    if (x & 1) != sign:
+        x = _P - x
+    return x
+
+
+_BX = _recover_x(_BY, 0)
+# 扩展坐标 (X, Y, Z, T)
+_B = (_BX, _BY, 1, _BX * _BY % _P)
+_IDENTITY = (0, 1, 1, 0)
+
+
+def _point_add(p: tuple, q: tuple) -> tuple:
+    a = (p[1] - p[0]) * (q[1] - q[0]) % _P
+    b = (p[1] + p[0]) * (q[1] + q[0]) % _P
+    c = 2 * p[3] * q[3] * _D % _P
+    d = 2 * p[2] * q[2] % _P
+    e, f, g, h = b - a, d - c, d + c, b + a
+    return (e * f % _P, g * h % _P, f * g % _P, e * h % _P)
+
+
+def _point_mul(s: int, p: tuple) -> tuple:
+    q = _IDENTITY
+    while s > 0:
+        if s & 1:
+            q = _point_add(q, p)
+        p = _point_add(p, p)
+        s >>= 1
+    return q
+
+
+def _point_compress(p: tuple) -> bytes:
+    zinv = pow(p[2], _P - 2, _P)
+    x = p[0] * zinv % _P
+    y = p[1] * zinv % _P
+    return int.to_bytes(y | ((x & 1) << 255), 32, "little")
+
+
+def _sha512_modl(data: bytes) -> int:
+    return int.from_bytes(hashlib.sha512(data).digest(), "little") % _L
+
+
+def _expand_seed(seed: bytes) -> tuple[int, bytes]:
+    if len(seed) != 32:
+        raise ValueError("私钥种子长度必须为 32 字节")
+    h = hashlib.sha512(seed).digest()
+    a = int.from_bytes(h[:32], "little")
+    a &= (1 << 254) - 8
+    a |= 1 << 254
+    return a, h[32:]
+
+
+def public_key(seed: bytes) -> bytes:
+    a, _ = _expand_seed(seed)
+    return _point_compress(_point_mul(a, _B))
+
+
+def sign(seed: bytes, msg: bytes) -> bytes:
+    """Ed25519 签名，返回 64 字节 R || S"""
+    a, prefix = _expand_seed(seed)
+    pub = _point_compress(_point_mul(a, _B))
+    r = _sha512_modl(prefix + msg)
+    rs = _point_compress(_point_mul(r, _B))
+    k = _sha512_modl(rs + pub + msg)
+    s = (r + k * a) % _L
+    return rs + int.to_bytes(s, 32, "little")
+
+
+def load_seed(path: Path) -> bytes:
+    text = path.read_text().strip()
+    try:
+        seed = bytes.fromhex(text)
+    except ValueError as exc:
+        raise ValueError("私钥文件格式错误（应为 64 个十六进制字符）") from exc
+    if len(seed) != 32:
+        raise ValueError("私钥文件格式错误（应为 64 个十六进制字符）")
+    return seed
+
+
+def sign_digest(key_path: Path, digest: bytes) -> bytes:
+    """对固件 SHA-256 摘要签名（Bootloader 校验的消息即该 32 字节摘要）"""
+    return sign(load_seed(key_path), digest)
+
+
+def c_initializer(data: bytes) -> str:
+    return ", ".join(f"0x{b:02X}U" for b in data)
+
+
+def _print_pubkey(seed: bytes) -> None:
+    print("/* 填入 boot_config.h */")
+    print(f"#define BOOT_SIGN_PUBLIC_KEY          {{{c_initializer(public_key(seed))}}}")
+
+
+def main(argv: list[str]) -> int:
+    if len(argv) < 3 or argv[1] not in ("keygen", "pubkey", "sign"):
+        print(__doc__)
+        return 1
+    key_path = Path(argv[2])
+    if argv[1] == "keygen":
+        if key_path.exists():
+            print(f"{key_path} 已存在，拒绝覆盖")
+            return 1
+        seed = os.urandom(32)
+        key_path.write_text(seed.hex() + "\n")
+        _print_pubkey(seed)
+        return 0
+    seed = load_seed(key_path)
+    if argv[1] == "pubkey":
+        _print_pubkey(seed)
+        return 0
+    if len(argv) < 4:
+        print(__doc__)
+        return 1
+    digest = hashlib.sha256(Path(argv[3]).read_bytes()).digest()
+    print(f"sha256:    {digest.hex()}")
+    print(f"signature: {sign(seed, digest).hex()}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+分包链路刷写公共部分
+----------------
+CAN（ISO-TP）、UDP 等以报文为单位的链路共用的帧构造、固件加载与窗口发送逻辑，帧格式与串口上位机完全一致。
+RS-485 多点总线（BOOT_CONFIG_ENABLE_ADDRESS）下传入 addr，上位机发出的帧在帧头后插入节点地址。
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import time
+from pathlib import Path
+from typing import Optional
+
+from image_sign import sign_digest
+
+CMD_START_FLASH = bytes([0x55, 0xAA, 0xFF, 0xEE, 0x55, 0x55])
+ACK_PATTERN = bytes([0x55, 0xAA, 0xFF, 0xFE, 0x55, 0x55])
+ACK_COUNT_HEAD = bytes([0x55, 0xAA, 0xFF, 0xF9])
+
+# Bootloader 帧固定开销: 2B 头 + 3B 剩余 + 2B 长度 + 2B 校验 + 2B 尾
+BOOT_FRAME_OVERHEAD = 11
+ACK_TIMEOUT_FIRST = 10.0
+ACK_TIMEOUT_OTHERS = 5.0
+
+
+def frame_head(addr: Optional[int] = None) -> bytes:
+    """帧头 55 AA，多点总线模式下后跟 1 字节节点地址"""
+    return bytes([0x55, 0xAA]) if addr is None else bytes([0x55, 0xAA, addr])
+
+
+def build_command(cmd: bytes, addr: Optional[int] = None) -> bytes:
+    """APP 命令帧，cmd 为 55 AA FF xx 55 55 形式，按需插入节点地址"""
+    return frame_head(addr) + cmd[2:]
+
+
+def build_data_frame(payload: bytes, remaining: int, addr: Optional[int] = None) -> bytes:
+    """数据帧: 55 AA [地址] [剩余 3B] [长度 2B] payload [累加和 2B] 55 55，地址参与累加和"""
+    length = len(payload).to_bytes(2, "big")
+    checksum = (sum(length) + sum(payload) + (addr or 0)) & 0xFFFF
+    return (
+        frame_head(addr) + remaining.to_bytes(3, "big") + length + payload
+        + checksum.to_bytes(2, "big") + bytes([0x55, 0x55])
+    )
+
+
+def build_finish_frame(
+    version: int, date: int, digest: bytes, signature: Optional[bytes], addr: Optional[int] = None
+) -> bytes:
+    """扩展完成帧（FF FB），携带签名时为签名完成帧（FF FA），格式同串口上位机"""
+    head = frame_head(addr) + version.to_bytes(4, "big") + date.to_bytes(4, "big") + digest
+    if signature is None:
+        return head + bytes([0xFF, 0xFB, 0x55, 0x55])
+    return head + signature + bytes([0xFF, 0xFA, 0x55, 0x55])
+
+
+def load_firmware(path: Path) -> bytes:
+    if path.suffix.lower() != ".hex":
+        return path.read_bytes()
+    upper = 0
+    data_map: dict[int, int] = {}
+    for idx, line in enumerate(path.read_text().splitlines(), 1):
+        line = line.strip()
+        if not line:
+            continue
+        raw = bytes.fromhex(line[1:])
+        if not line.startswith(":") or sum(raw) & 0xFF:
+            raise ValueError(f"第 {idx} 行不是合法的 Intel HEX 行")
+        count, offset, rtype = raw[0], int.from_bytes(raw[1:3], "big"), raw[3]
+        payload = raw[4 : 4 + count]
+        if rtype == 0x00:
+            for i, val in enumerate(payload):
+                data_map[upper + offset + i] = val
+        elif rtype == 0x01:
+            break
+        elif rtype == 0x04:
+            upper = int.from_bytes(payload, "big") << 16
+    if not data_map:
+        return b""
+    base = min(data_map)
+    image = bytearray([0xFF] * (max(data_map) - base + 1))
+    for addr, val in data_map.items():
+        image[addr - base] = val
+    return bytes(image)
+
+
+class LinkFlasher:
+    """按窗口发送数据帧并解析（计数）ACK，link 需提供 send(msg)、poll(timeout) 与 rx_data 字节流"""
+
+    def __init__(self, link, window: int = 4, packet_size: int = 1024, addr: Optional[int] = None) -> None:
+        self.link = link
+        self.window = max(1, window)
+        self.addr = addr
+        self.max_payload = packet_size - BOOT_FRAME_OVERHEAD - (0 if addr is None else 1)
+        self.ack_count = 0
+
+    def _parse_acks(self) -> None:
+        buf = self.link.rx_data
+        while True:
+            idx = buf.find(ACK_PATTERN)
+            cnt_idx = buf.find(ACK_COUNT_HEAD)
+            if cnt_idx != -1 and (idx == -1 or cnt_idx < idx):
+                end = cnt_idx + len(ACK_COUNT_HEAD) + 3
+                if len(buf) < end:
+                    return
+                if buf[end - 2 : end] == b"\x55\x55":
+                    self.ack_count += buf[end - 3]
+                    del buf[:end]
+                else:
+                    del buf[: cnt_idx + 1]
+                continue
+            if idx == -1:
+                return
+            del buf[: idx + len(ACK_PATTERN)]
+            self.ack_count += 1
+
+    def wait_ack(self, count: int, timeout: float) -> bool:
+        deadline = time.monotonic() + timeout
+        while True:
+            self._parse_acks()
+            if self.ack_count >= count:
+                return True
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return False
+            self.link.poll(remaining)
+
+    def flash(self, data: bytes, version: int, date: int, sign_key: Optional[Path]) -> bool:
+        total = len(data)
+        offset = 0
+        frame_ends: list[int] = []
+        start = time.monotonic()
+        while offset < total or self.ack_count < len(frame_ends):
+            while offset < total and len(frame_ends) - self.ack_count < self.window:
+                chunk = data[offset : offset + self.max_payload]
+                offset += len(chunk)
+                self.link.send(build_data_frame(chunk, total - offset, self.addr))
+                frame_ends.append(offset)
+            timeout = ACK_TIMEOUT_FIRST if self.ack_count == 0 else ACK_TIMEOUT_OTHERS
+            if not self.wait_ack(self.ack_count + 1, timeout):
+                print("等待 ACK 超时，刷写中断")
+                return False
+            acked = frame_ends[min(self.ack_count, len(frame_ends)) - 1]
+            print(f"\r已发送 {acked}/{total} 字节 ({acked * 100 // total}%)", end="", flush=True)
+        print()
+
+        digest = hashlib.sha256(data).digest()
+        signature = sign_digest(sign_key, digest) if sign_key is not None else None
+        expected = self.ack_count + 1
+        self.link.send(build_finish_frame(version, date, digest, signature, self.addr))
+        if not self.wait_ack(expected, ACK_TIMEOUT_OTHERS):
+            print("等待完成帧 ACK 超时（摘要或签名校验失败时 Bootloader 不会应答）")
+            return False
+        elapsed = time.monotonic() - start
+        print(f"升级完成：{total} 字节，耗时 {elapsed:.2f}s（{total / elapsed / 1024:.1f} KB/s）")
+        return True
+
+
+def add_flash_arguments(parser: argparse.ArgumentParser) -> None:
+    """各链路工具共用的命令行参数"""
+    parser.add_argument("firmware", type=Path)
+    parser.add_argument("--window", type=int, default=4, help="在途帧数，须不大于设备 link_window")
+    parser.add_argument("--packet", type=int, default=1024, help="整包长度（含 11 字节帧开销，多点总线为 12）")
+    parser.add_argument("--version", type=lambda s: int(s, 0), default=1)
+    parser.add_argument("--date", type=lambda s: int(s, 0), default=int(time.strftime("0x%Y%m%d"), 16))
+    parser.add_argument("--sign-key", type=Path, default=None)
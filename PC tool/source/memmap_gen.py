@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""
+Flash / RAM 布局生成
+----------------
+板级 Flash 布局只在 memmap.json 中写一次，由本工具检查后生成：
+    boot_memmap.h       Bootloader 侧布局宏（boot_config.h 包含）与 Flash 扇区表
+    boot_memmap_app.h   APP 侧布局宏（boot_config_app.h 包含）与 Flash 扇区表
+    GNU ld 链接脚本     MEMORY 中 FLASH / RAM 两个区域（替换生成标记之间的内容）
+    Keil 工程           Target 选项中的 IROM1 / IRAM1 / IRAM2（.uvprojx）
+
+用法：
+    python memmap_gen.py <memmap.json> [--check]
+
+    --check  只检查布局并比较生成结果与磁盘上的文件，不写文件；布局错误或文件过期时返回 1，
+             可作为构建前步骤（Keil：Options -> User -> Before Build/Rebuild；MounRiver：Pre-build steps）
+
+布局检查：Bootloader 位于 Flash 起始，各区域落在 Flash 内、起止对齐扇区边界且互不重叠，
+APP 起始地址满足向量表对齐，暂存区按擦除单元对齐，交接区在 RAM 末尾并从链接区域中扣除。
+
+扇区大小一致时生成 BOOT_FLASH_SECTOR_SIZE，扇区号直接由偏移换算；不一致时生成扇区起始地址表
+BOOT_FLASH_SECTOR_STARTS（末项为 Flash 结束地址），移植层按二分查找定位扇区。
+
+运行要求：Python 3.8+，无额外依赖
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+LD_BEGIN = "/* memmap_gen.py 生成开始，不要手工修改 */"
+LD_END = "/* memmap_gen.py 生成结束 */"
+
+# Keil 工程中 OnChipMemories 的编号：IROM1 / IRAM1 / IRAM2
+KEIL_IROM1 = "OCR_RVCT4"
+KEIL_IRAM1 = "OCR_RVCT9"
+KEIL_IRAM2 = "OCR_RVCT10"
+
+
+class LayoutError(Exception):
+    pass
+
+
+def num(value) -> int:
+    return value if isinstance(value, int) else int(value, 0)
+
+
+def hex32(value: int) -> str:
+    return f"0x{value:08X}U"
+
+
+class Layout:
+    def __init__(self, manifest: dict) -> None:
+        self.name: str = manifest["name"]
+        self.staging_enabled = bool(manifest.get("enable_staging", False))
+        self.vector_align = num(manifest.get("vector_align", 4))
+
+        flash = manifest["flash"]
+        self.flash_base = num(flash["base"])
+        self.sector_starts: List[int] = []
+        addr = self.flash_base
+        for run in flash["sectors"]:
+            for _ in range(num(run["count"])):
+                self.sector_starts.append(addr)
+                addr += num(run["size"])
+        self.flash_end = addr
+        self.sector_sizes = {b - a for a, b in zip(self.sector_starts, self.sector_starts[1:] + [self.flash_end])}
+
+        self.ram_base = num(manifest["ram"]["base"])
+        self.ram_size = num(manifest["ram"]["size"])
+        ccm = manifest.get("ccm")
+        self.ccm: Optional[Tuple[int, int]] = (num(ccm["base"]), num(ccm["size"])) if ccm else None
+
+        regions = manifest["regions"]
+        self.boot = (num(regions["bootloader"]["addr"]), num(regions["bootloader"]["size"]))
+        self.staging = (num(regions["staging"]["addr"]), num(regions["staging"]["size"]))
+        self.staging_unit = num(regions["staging"].get("erase_unit", 0))
+        self.flag = (num(regions["flag"]["addr"]), num(regions["flag"]["size"]))
+        self.handoff_size = num(regions["handoff"]["size"])
+        self.handoff_addr = self.ram_base + self.ram_size - self.handoff_size
+
+        # APP 从 Bootloader 之后开始，延伸到其上方最近的区域（启用暂存时为暂存区，否则为标志位区）
+        app_start = self.boot[0] + self.boot[1]
+        above = [start for start, _ in ([self.staging] if self.staging_enabled else []) + [self.flag]
+                 if start >= app_start]
+        if not above:
+            raise LayoutError("标志位区须位于 APP 之后")
+        self.app = (app_start, min(above) - app_start)
+
+    def sector_uniform(self) -> Optional[int]:
+        return next(iter(self.sector_sizes)) if len(self.sector_sizes) == 1 else None
+
+    def on_boundary(self, addr: int) -> bool:
+        return addr == self.flash_end or addr in self.sector_starts
+
+    def check(self) -> List[str]:
+        """返回警告；布局错误时抛出 LayoutError"""
+        errors: List[str] = []
+        warnings: List[str] = []
+        # 未启用暂存时暂存区属于 APP 区，只检查它自身的对齐
+        regions = {"bootloader": self.boot, "app": self.app, "flag": self.flag}
+        if self.staging_enabled:
+            regions["staging"] = self.staging
+
+        if self.boot[0] != self.flash_base:
+            errors.append(f"bootloader 须从 Flash 起始 {self.flash_base:#x} 开始（复位向量）")
+        for name, (start, size) in regions.items():
+            if size == 0:
+                errors.append(f"{name} 大小为 0")
+                continue
+            if start < self.flash_base or start + size > self.flash_end:
+                errors.append(f"{name} [{start:#x}, {start + size:#x}) 超出 Flash [{self.flash_base:#x}, {self.flash_end:#x})")
+                continue
+            if not self.on_boundary(start) or not self.on_boundary(start + size):
+                errors.append(f"{name} [{start:#x}, {start + size:#x}) 未对齐扇区边界，擦除会波及相邻区域")
+        ordered = sorted(regions.items(), key=lambda item: item[1][0])
+        for (name_a, (start_a, size_a)), (name_b, (start_b, _)) in zip(ordered, ordered[1:]):
+            if start_a + size_a > start_b:
+                errors.append(f"{name_a} 与 {name_b} 重叠")
+        if self.app[0] % self.vector_align:
+            errors.append(f"APP 起始地址 {self.app[0]:#x} 不满足向量表 {self.vector_align:#x} 字节对齐")
+
+        start, size = self.staging
+        unit = self.staging_unit or self.sector_uniform() or max(self.sector_sizes)
+        if start % unit or size % unit or start < self.flash_base or start + size > self.flash_end:
+            errors.append(f"暂存区未按擦除单元 {unit:#x} 对齐或超出 Flash")
+        elif not all(self.on_boundary(a) for a in range(start, start + size + unit, unit)):
+            errors.append(f"暂存区擦除单元 {unit:#x} 不是整数个扇区")
+        self.staging_unit = unit
+        if self.staging_enabled and size < self.app[1]:
+            warnings.append(f"暂存区 {size:#x} 小于 APP 区 {self.app[1]:#x}，大于暂存区的 APP 无法后台升级")
+
+        if self.handoff_size % 4 or self.handoff_size >= self.ram_size:
+            errors.append("交接区大小须为 4 的倍数且小于 RAM")
+
+        if errors:
+            raise LayoutError("\n".join(errors))
+        return warnings
+
+    # ---- 生成 ----
+
+    def header_lines(self, prefix: str, guard: str) -> List[str]:
+        def define(name: str, value: str, comment: str = "") -> str:
+            line = f"#define {prefix}{name}".ljust(len(prefix) + 33) + value
+            return line.ljust(len(prefix) + 47) + f"// {comment}" if comment else line
+
+        lines = [
+            f"// {self.name} Flash / RAM 布局，由 PC tool/source/memmap_gen.py 根据 memmap.json 生成，不要手工修改",
+            f"#ifndef {guard}",
+            f"#define {guard}",
+            "",
+            define("MEMMAP_STAGING", "1U" if self.staging_enabled else "0U", "生成时的暂存区开关，须与配置头文件中的开关一致"),
+            "",
+        ]
+        if prefix == "BOOT_":
+            lines += [
+                define("BOOTLOADER_START_ADDR", hex32(self.boot[0])),
+                define("BOOTLOADER_SIZE", hex32(self.boot[1])),
+                define("APP_START_ADDR", hex32(self.app[0])),
+                define("APP_MAX_SIZE", hex32(self.app[1]), "APP 链接区域同此大小"),
+                define("APP_END_ADDR", "(BOOT_APP_START_ADDR + BOOT_APP_MAX_SIZE - 1U)"),
+                define("STAGING_ADDR", hex32(self.staging[0])),
+                define("STAGING_SIZE", hex32(self.staging[1])),
+                define("FLAG_REGION_ADDR", hex32(self.flag[0])),
+                define("FLAG_REGION_SIZE", hex32(self.flag[1])),
+                "",
+                "/* RAM 范围（校验 APP 栈指针，结束地址即初始栈顶的上限） */",
+                define("SRAM_START_ADDR", hex32(self.ram_base)),
+                define("SRAM_END_ADDR", hex32(self.ram_base + self.ram_size)),
+                define("HAS_CCM", "1U" if self.ccm else "0U"),
+            ]
+            if self.ccm:
+                lines += [
+                    define("CCM_START_ADDR", hex32(self.ccm[0])),
+                    define("CCM_END_ADDR", hex32(self.ccm[0] + self.ccm[1])),
+                ]
+            lines += [
+                "",
+                "/* Bootloader -> APP 交接区：RAM 末尾，两侧链接区域均已扣除 */",
+                define("HANDOFF_ADDR", hex32(self.handoff_addr)),
+                define("HANDOFF_SIZE", hex32(self.handoff_size)),
+            ]
+        else:
+            lines += [
+                define("FLAG_REGION_ADDR", hex32(self.flag[0])),
+                define("FLAG_REGION_SIZE", hex32(self.flag[1])),
+                define("STAGING_ADDR", hex32(self.staging[0])),
+                define("STAGING_SIZE", hex32(self.staging[1])),
+                define("STAGING_ERASE_UNIT", hex32(self.staging_unit), "边写边擦的粒度"),
+                "",
+                "/* Bootloader -> APP 交接区：RAM 末尾，两侧链接区域均已扣除 */",
+                define("HANDOFF_ADDR", hex32(self.handoff_addr)),
+            ]
+
+        lines += [
+            "",
+            define("FLASH_START_ADDR", hex32(self.flash_base)),
+            define("FLASH_END_ADDR", hex32(self.flash_end)),
+            define("FLASH_SECTOR_COUNT", f"{len(self.sector_starts)}U"),
+        ]
+        uniform = self.sector_uniform()
+        if uniform is not None:
+            lines += [define("FLASH_SECTOR_SIZE", hex32(uniform), "扇区大小一致，扇区号 = 偏移 / 扇区大小")]
+        else:
+            starts = [hex32(a) for a in self.sector_starts + [self.flash_end]]
+            body = [", ".join(starts[i:i + 4]) for i in range(0, len(starts), 4)]
+            lines += [f"/* 各扇区起始地址，扇区号即下标，末项为 Flash 结束地址（{prefix}FLASH_SECTOR_COUNT + 1 项） */",
+                      f"#define {prefix}FLASH_SECTOR_STARTS".ljust(len(prefix) + 33) + "{" + body[0] + ", \\"]
+            indent = " " * (len(prefix) + 34)
+            lines += [indent + row + (", \\" if i < len(body) - 1 else "}") for i, row in enumerate(body[1:], 1)]
+        lines += ["", f"#endif // {guard}", ""]
+        return lines
+
+    def gnu_ld(self, text: str, image: str) -> str:
+        start, size = self.boot if image == "boot" else self.app
+        region = [
+            LD_BEGIN,
+            f"\tFLASH (rx) : ORIGIN = 0x{start:08X}, LENGTH = 0x{size:08X}",
+            f"\tRAM (xrw) : ORIGIN = 0x{self.ram_base:08X}, LENGTH = 0x{self.ram_size - self.handoff_size:08X}"
+            f"\t/* 末尾 {self.handoff_size} 字节为 Bootloader->APP 交接区 */",
+            LD_END,
+        ]
+        pattern = re.compile(re.escape(LD_BEGIN) + r".*?" + re.escape(LD_END), re.S)
+        if not pattern.search(text):
+            raise LayoutError("链接脚本中没有生成标记")
+        return pattern.sub(lambda _: "\n".join(region), text, count=1)
+
+    def keil(self, text: str, image: str) -> str:
+        start, size = self.boot if image == "boot" else self.app
+        wanted: Dict[str, Tuple[int, int]] = {
+            KEIL_IROM1: (start, size),
+            KEIL_IRAM1: (self.ram_base, self.ram_size - self.handoff_size),
+        }
+        if self.ccm:
+            wanted[KEIL_IRAM2] = self.ccm
+        for tag, (addr, length) in wanted.items():
+            pattern = re.compile(rf"(<{tag}>\s*<Type>\d+</Type>\s*<StartAddress>)([^<]*)(</StartAddress>\s*<Size>)([^<]*)(</Size>)")
+            m = pattern.search(text)
+            if m is None:
+                raise LayoutError(f"Keil 工程中没有 {tag}")
+            # 数值相同则保留原写法，避免无意义的改动
+            new_addr = m.group(2) if int(m.group(2), 0) == addr else f"0x{addr:X}"
+            new_size = m.group(4) if int(m.group(4), 0) == length else f"0x{length:X}"
+            text = text[:m.start()] + m.group(1) + new_addr + m.group(3) + new_size + m.group(5) + text[m.end():]
+        return text
+
+
+def render(layout: Layout, kind: str, path: Path, image: str) -> str:
+    if kind == "boot_header":
+        return "\n".join(layout.header_lines("BOOT_", "BOOT_MEMMAP_H"))
+    if kind == "app_header":
+        return "\n".join(layout.header_lines("BOOT_APP_", "BOOT_MEMMAP_APP_H"))
+    current = path.read_bytes().decode("utf-8")
+    if kind == "gnu_ld":
+        return layout.gnu_ld(current, image)
+    if kind == "keil":
+        return layout.keil(current, image)
+    raise LayoutError(f"未知的输出类型 {kind}")
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="根据 memmap.json 生成布局头文件与链接配置")
+    parser.add_argument("manifest", type=Path, help="板级布局清单 memmap.json")
+    parser.add_argument("--check", action="store_true", help="只检查，不写文件；过期时返回 1")
+    args = parser.parse_args(argv[1:])
+
+    manifest = json.loads(args.manifest.read_text(encoding="utf-8"))
+    try:
+        layout = Layout(manifest)
+        for warning in layout.check():
+            print(f"警告：{warning}")
+        outputs = []
+        for out in manifest["outputs"]:
+            path = args.manifest.parent / out["path"]
+            outputs.append((path, render(layout, out["kind"], path, out.get("image", "boot"))))
+    except LayoutError as e:
+        print(f"布局错误：\n{e}")
+        return 1
+
+    stale = 0
+    for path, content in outputs:
+        current = path.read_bytes().decode("utf-8") if path.exists() else None
+        if current == content:
+            continue
+        stale += 1
+        if args.check:
+            print(f"已过期：{path}")
+        else:
+            path.write_bytes(content.encode("utf-8"))
+            print(f"已生成：{path}")
+    if args.check and stale:
+        print(f"{stale} 个文件与 {args.manifest} 不一致，请运行 python memmap_gen.py {args.manifest}")
+        return 1
+    print(f"{layout.name}：APP {layout.app[0]:#x} + {layout.app[1]:#x}，{len(layout.sector_starts)} 个扇区，布局检查通过")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
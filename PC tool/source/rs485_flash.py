@@ -0,0 +1,420 @@
+#!/usr/bin/env python3
+"""
+RS-485 多点总线刷写工具
+----------------
+一条总线挂多个节点，上位机发出的帧在帧头后带节点地址（55 AA [addr] ...），设备侧需启用
+BOOT_CONFIG_ENABLE_ADDRESS（APP 侧 BOOT_APP_CONFIG_ENABLE_ADDRESS），且各节点地址互不相同。
+
+用法：
+    python rs485_flash.py scan  --port COM3 [--baud 115200] [--range 1-32] [--timeout 0.03]
+    python rs485_flash.py flash <固件.bin|.hex> --port COM3 --addr 5 [--enter] [--packet 1024]
+                                [--version 1] [--date 0x20260101] [--sign-key <私钥文件>]
+    python rs485_flash.py broadcast <固件.bin|.hex> --port COM3 [--range 1-32 | --addrs 3,5,9] [--enter]
+                                [--chunk 1008] [--gap 0.012] [--rounds 10] [--version 1] [--date ...]
+    python rs485_flash.py broadcast <固件.bin|.hex> --simulate 32 [--loss 0.05]
+
+    scan         依次向地址发送探测帧 55 AA [addr] FF F8 55 55，列出应答的节点、运行状态与版本号
+    flash        单播刷写一个节点
+    broadcast    广播升级（设备侧需启用 BOOT_CONFIG_ENABLE_BROADCAST）：固件只广播一遍，
+                 再逐个查询节点的收帧位图，合并后只补发缺失的帧，最后逐个节点发送完成帧
+    --enter      先向 APP 发送升级命令，等待其复位进入 Bootloader
+    --gap        广播帧间隔（秒），广播帧没有应答，靠间隔避免节点接收缓冲溢出
+    --simulate   不连接串口，在本机模拟 N 个节点（见 bus_sim.py），--loss 为每个节点的丢帧率，
+                 输出按 --baud 估算的总线耗时
+
+收发方向切换（DE/RE）由 USB-485 转换器自动完成；设备侧由移植层的 data_write 负责。
+
+运行要求：Python 3.8+，pyserial (`pip install pyserial`)
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import random
+import sys
+import time
+from pathlib import Path
+from typing import Optional
+
+from bus_sim import SimBus
+from image_sign import sign_digest
+from link_flash import (
+    CMD_START_FLASH,
+    LinkFlasher,
+    add_flash_arguments,
+    build_command,
+    build_finish_frame,
+    frame_head,
+    load_firmware,
+)
+
+CMD_SCAN = bytes([0x55, 0xAA, 0xFF, 0xF8, 0x55, 0x55])
+SCAN_REPLY_HEAD = bytes([0x55, 0xAA, 0xFF, 0xF8])
+SCAN_REPLY_LEN = 12  # 55 AA FF F8 [addr] [state] [ver 4B] 55 55
+SCAN_TIMEOUT = 0.03  # 单个地址的等待时间，须大于设备调度周期（10ms）加上往返时间
+
+BCAST_ADDR = 0x00
+CMD_BCAST_STATUS = bytes([0x55, 0xAA, 0xFF, 0xF5, 0x55, 0x55])
+BCAST_STATUS_HEAD = bytes([0x55, 0xAA, 0xFF, 0xF5])
+BCAST_CHUNK = 1008  # 对应设备侧 BOOT_BCAST_CHUNK_MAX（BOOT_PACKET_MAX_SIZE = 1024）
+BCAST_GAP = 0.012  # 略大于设备调度周期，保证每个周期最多到达一帧
+BCAST_ROUNDS = 10
+BCAST_STATUS_TIMEOUT = 0.05
+BCAST_JOIN_TIMEOUT = 30.0  # 等待节点擦除 APP 区并加入会话
+FINISH_TIMEOUT = 5.0  # 完成帧需回读整个固件计算摘要
+FINISH_RETRIES = 3
+
+STATE_APP = 0x80
+BOOT_STATES = {
+    0: "Bootloader 空闲",
+    1: "Bootloader 接收中",
+    2: "Bootloader 等待完成帧",
+    3: "Bootloader 广播接收中",
+    4: "Bootloader FEC 接收中",
+}
+APP_STATES = {0: "APP", 1: "APP 后台接收中", 2: "APP 后台接收完成"}
+
+
+class SerialLink:
+    """串口收发，收到的字节拼接成字节流供应答解析"""
+
+    def __init__(self, port: str, baud: int) -> None:
+        import serial
+
+        self.serial = serial.Serial(port, baud, timeout=0)
+        self.rx_data = bytearray()
+
+    def send(self, msg: bytes) -> None:
+        self.serial.write(msg)
+        self.serial.flush()
+
+    def poll(self, timeout: float) -> bool:
+        """等待最多 timeout 秒，读到任意字节返回 True"""
+        deadline = time.monotonic() + timeout
+        while True:
+            waiting = self.serial.in_waiting
+            if waiting:
+                self.rx_data.extend(self.serial.read(waiting))
+                return True
+            if time.monotonic() >= deadline:
+                return False
+            time.sleep(0.001)
+
+
+def describe_state(state: int) -> str:
+    if state & STATE_APP:
+        return APP_STATES.get(state & 0x7F, f"APP 状态 {state & 0x7F}")
+    return BOOT_STATES.get(state, f"Bootloader 状态 {state}")
+
+
+def _take_scan_reply(buf: bytearray) -> Optional[tuple[int, int, int]]:
+    """从字节流中取出一个探测应答 (addr, state, version)，不完整时返回 None"""
+    while True:
+        idx = buf.find(SCAN_REPLY_HEAD)
+        if idx == -1:
+            del buf[: max(0, len(buf) - len(SCAN_REPLY_HEAD) + 1)]
+            return None
+        if len(buf) < idx + SCAN_REPLY_LEN:
+            del buf[:idx]
+            return None
+        reply = bytes(buf[idx : idx + SCAN_REPLY_LEN])
+        if reply[-2:] != b"\x55\x55":
+            del buf[: idx + 1]
+            continue
+        del buf[: idx + SCAN_REPLY_LEN]
+        return (reply[4], reply[5], int.from_bytes(reply[6:10], "big"))
+
+
+def scan_bus(link, addrs, timeout: float = SCAN_TIMEOUT) -> list[tuple[int, int, int]]:
+    """逐个地址探测，收到本地址应答即转入下一个，返回 [(addr, state, version)]"""
+    found = []
+    for addr in addrs:
+        link.rx_data.clear()
+        link.send(build_command(CMD_SCAN, addr))
+        deadline = time.monotonic() + timeout
+        while True:
+            reply = _take_scan_reply(link.rx_data)
+            if reply is not None and reply[0] == addr:
+                found.append(reply)
+                break
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not link.poll(remaining):
+                break
+    return found
+
+
+def _checksum(addr: int, body: bytes) -> bytes:
+    return ((addr + sum(body)) & 0xFFFF).to_bytes(2, "big")
+
+
+def build_bcast_start(session: int, size: int, chunk: int) -> bytes:
+    """广播启动帧: 55 AA 00 FF F7 [session] [size 3B] [chunk 2B] [累加和 2B] 55 55"""
+    body = bytes([session]) + size.to_bytes(3, "big") + chunk.to_bytes(2, "big")
+    return frame_head(BCAST_ADDR) + b"\xFF\xF7" + body + _checksum(BCAST_ADDR, body) + b"\x55\x55"
+
+
+def build_bcast_data(session: int, index: int, payload: bytes) -> bytes:
+    """广播数据帧: 55 AA 00 FF F6 [session] [index 2B] [len 2B] payload [累加和 2B] 55 55"""
+    body = bytes([session]) + index.to_bytes(2, "big") + len(payload).to_bytes(2, "big") + payload
+    return frame_head(BCAST_ADDR) + b"\xFF\xF6" + body + _checksum(BCAST_ADDR, body) + b"\x55\x55"
+
+
+def _take_status_reply(buf: bytearray) -> Optional[tuple[int, int, int, int, bytes]]:
+    """取出一个状态应答 (addr, session, frames, missing, bitmap)，不完整时返回 None"""
+    while True:
+        idx = buf.find(BCAST_STATUS_HEAD)
+        if idx == -1:
+            del buf[: max(0, len(buf) - len(BCAST_STATUS_HEAD) + 1)]
+            return None
+        if len(buf) < idx + 12:
+            return None
+        frames = int.from_bytes(buf[idx + 6 : idx + 8], "big")
+        end = idx + 12 + (frames + 7) // 8
+        if len(buf) < end:
+            return None
+        reply = bytes(buf[idx:end])
+        if reply[-2:] != b"\x55\x55":
+            del buf[: idx + 1]
+            continue
+        del buf[:end]
+        return (reply[4], reply[5], frames, int.from_bytes(reply[8:10], "big"), reply[10:-2])
+
+
+def query_status(link, addr: int, timeout: float = BCAST_STATUS_TIMEOUT, late: Optional[dict] = None):
+    """
+    查询节点广播接收状态 (session, frames, missing, bitmap)，无应答返回 None
+    late 收集其他节点超时后才到的应答，之后查询该节点时直接使用（位图只增不减，旧应答最多导致多补发）
+    """
+    late = {} if late is None else late
+    if addr in late:
+        return late.pop(addr)
+    link.send(build_command(CMD_BCAST_STATUS, addr))
+    deadline = time.monotonic() + timeout
+    while True:
+        reply = _take_status_reply(link.rx_data)
+        while reply is not None:
+            if reply[0] == addr:
+                return reply[1:]
+            late[reply[0]] = reply[1:]
+            reply = _take_status_reply(link.rx_data)
+        remaining = deadline - time.monotonic()
+        if remaining <= 0 or not link.poll(remaining):
+            return None
+
+
+def finish_node(link, addr: int, frame: bytes, timeout: float = FINISH_TIMEOUT) -> bool:
+    """单播完成帧并等待 ACK，完成帧丢失时重发"""
+    link.rx_data.clear()
+    for _ in range(FINISH_RETRIES):
+        flasher = LinkFlasher(link, 1, addr=addr)
+        link.send(frame)
+        if flasher.wait_ack(1, timeout):
+            return True
+    return False
+
+
+def broadcast_flash(
+    link,
+    addrs,
+    data: bytes,
+    version: int,
+    date: int,
+    sign_key: Optional[Path] = None,
+    chunk: int = BCAST_CHUNK,
+    gap: float = BCAST_GAP,
+    rounds: int = BCAST_ROUNDS,
+    finish_timeout: float = FINISH_TIMEOUT,
+) -> dict[int, bool]:
+    """广播升级多个节点，返回 {addr: 是否成功}"""
+    session = random.randint(1, 0xFF)
+    frames = (len(data) + chunk - 1) // chunk
+    start_frame = build_bcast_start(session, len(data), chunk)
+    result = {addr: False for addr in addrs}
+    late: dict = {}
+    start = time.monotonic()
+
+    # 1. 启动会话：节点擦除 APP 区期间不应答，重复广播启动帧直到各节点加入（同一会话的重复启动帧被忽略）
+    joined: list[int] = []
+    pending = list(addrs)
+    deadline = time.monotonic() + BCAST_JOIN_TIMEOUT
+    while pending and time.monotonic() < deadline:
+        link.send(start_frame)
+        time.sleep(gap)
+        for addr in list(pending):
+            status = query_status(link, addr, late=late)
+            if status is not None and status[0] == session and status[1] == frames:
+                pending.remove(addr)
+                joined.append(addr)
+    for addr in pending:
+        print(f"节点 0x{addr:02X} 未加入广播会话")
+    join_time = time.monotonic() - start
+
+    # 2. 全量广播一遍，再按各节点位图的并集补发
+    todo = list(range(frames))
+    complete: set[int] = set()
+    dropped: set[int] = set()
+    sent = 0
+    for round_idx in range(rounds + 1):
+        for index in todo:
+            link.send(build_bcast_data(session, index, data[index * chunk : (index + 1) * chunk]))
+            sent += 1
+            if gap:
+                time.sleep(gap)
+
+        missing: set[int] = set()
+        for addr in joined:
+            if addr in complete or addr in dropped:
+                continue
+            status = query_status(link, addr, late=late)
+            if status is None:
+                continue  # 应答丢失，下一轮再查
+            session_now, node_frames, node_missing, bitmap = status
+            if session_now != session or node_frames != frames:
+                print(f"\n节点 0x{addr:02X} 已退出广播会话")
+                dropped.add(addr)
+                continue
+            if node_missing == 0:
+                complete.add(addr)
+                continue
+            missing.update(i for i in range(frames) if not bitmap[i >> 3] & (1 << (i & 7)))
+        todo = sorted(missing)
+        print(f"\r第 {round_idx + 1} 轮：{len(complete)}/{len(joined)} 个节点收齐，待补发 {len(todo)} 帧",
+              end="", flush=True)
+        if len(complete) + len(dropped) == len(joined):
+            break
+    print()
+    transfer_time = time.monotonic() - start - join_time
+
+    # 3. 逐个节点提交
+    digest = hashlib.sha256(data).digest()
+    signature = sign_digest(sign_key, digest) if sign_key is not None else None
+    for addr in sorted(complete):
+        frame = build_finish_frame(version, date, digest, signature, addr)
+        result[addr] = finish_node(link, addr, frame, finish_timeout)
+    elapsed = time.monotonic() - start
+    ok = sum(1 for v in result.values() if v)
+    print(
+        f"广播升级完成：{ok}/{len(result)} 个节点成功，{frames} 帧共发送 {sent} 帧，"
+        f"加入 {join_time:.2f}s + 传输 {transfer_time:.2f}s，总耗时 {elapsed:.2f}s"
+    )
+    return result
+
+
+def parse_range(text: str) -> range:
+    lo, _, hi = text.partition("-")
+    first, last = int(lo, 0), int(hi or lo, 0)
+    if not 1 <= first <= last <= 0xFE:
+        raise argparse.ArgumentTypeError("地址范围须在 1-254 之内")
+    return range(first, last + 1)
+
+
+def parse_addr(text: str) -> int:
+    addr = int(text, 0)
+    if not 1 <= addr <= 0xFE:
+        raise argparse.ArgumentTypeError("节点地址须在 1-254 之内")
+    return addr
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="通过 RS-485 多点总线扫描节点并刷写 easy_bootloader")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    scan_parser = sub.add_parser("scan", help="扫描总线上的节点")
+    scan_parser.add_argument("--range", type=parse_range, default=parse_range("1-32"))
+    scan_parser.add_argument("--timeout", type=float, default=SCAN_TIMEOUT, help="单个地址的等待时间（秒）")
+
+    flash_parser = sub.add_parser("flash", help="刷写指定节点")
+    add_flash_arguments(flash_parser)
+    flash_parser.add_argument("--addr", type=parse_addr, required=True)
+    flash_parser.add_argument("--enter", action="store_true", help="先让 APP 复位进入 Bootloader")
+    # 串口链路一次只能缓存一帧，窗口固定为 1
+    flash_parser.set_defaults(window=1)
+
+    bcast_parser = sub.add_parser("broadcast", help="广播升级多个节点")
+    add_flash_arguments(bcast_parser)
+    bcast_parser.add_argument("--range", type=parse_range, default=parse_range("1-32"), help="扫描范围")
+    bcast_parser.add_argument("--addrs", type=lambda s: [parse_addr(x) for x in s.split(",")], default=None,
+                              help="直接指定节点地址，逗号分隔，不再扫描")
+    bcast_parser.add_argument("--enter", action="store_true", help="先让运行 APP 的节点复位进入 Bootloader")
+    bcast_parser.add_argument("--chunk", type=int, default=BCAST_CHUNK, help="每帧数据长度，须为 4 的倍数")
+    bcast_parser.add_argument("--gap", type=float, default=BCAST_GAP, help="广播帧间隔（秒）")
+    bcast_parser.add_argument("--rounds", type=int, default=BCAST_ROUNDS, help="最多补发轮数")
+    bcast_parser.add_argument("--simulate", type=int, default=0, metavar="N", help="模拟 N 个节点，不连接串口")
+    bcast_parser.add_argument("--loss", type=float, default=0.0, help="模拟时每个节点的丢帧率")
+
+    for sub_parser in (scan_parser, flash_parser, bcast_parser):
+        sub_parser.add_argument("--port", required=sub_parser is not bcast_parser)
+        sub_parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args(argv[1:])
+
+    simulate = getattr(args, "simulate", 0)
+    if simulate:
+        if not 1 <= simulate <= 0xFE:
+            print("--simulate 须在 1-254 之内")
+            return 1
+        link = SimBus(simulate, args.loss, args.baud)
+        args.addrs = list(link.nodes)
+        args.gap = 0.0
+    elif args.port is None:
+        parser.error("需要 --port 或 --simulate")
+    else:
+        link = SerialLink(args.port, args.baud)
+    if args.command == "scan":
+        start = time.monotonic()
+        nodes = scan_bus(link, args.range, args.timeout)
+        for addr, state, version in nodes:
+            print(f"0x{addr:02X}  {describe_state(state)}  版本 {version}")
+        elapsed = time.monotonic() - start
+        print(f"共 {len(nodes)} 个节点，扫描 {len(args.range)} 个地址耗时 {elapsed * 1000:.0f}ms")
+        return 0
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    if args.command == "broadcast":
+        addrs = args.addrs
+        if addrs is None or args.enter:
+            nodes = scan_bus(link, args.addrs or args.range)
+            if args.enter:
+                for addr, state, _version in nodes:
+                    if state & STATE_APP:
+                        link.send(build_command(CMD_START_FLASH, addr))
+                time.sleep(1.0)
+                nodes = scan_bus(link, [addr for addr, _state, _version in nodes])
+            addrs = [addr for addr, state, _version in nodes if not state & STATE_APP]
+        if not addrs:
+            print("没有处于 Bootloader 的节点")
+            return 1
+        if args.chunk <= 0 or args.chunk % 4:
+            print("--chunk 须为 4 的正整数倍")
+            return 1
+        print("广播升级节点：" + ", ".join(f"0x{addr:02X}" for addr in addrs))
+        result = broadcast_flash(link, addrs, data, args.version, args.date, args.sign_key,
+                                 args.chunk, args.gap, args.rounds, 0.01 if simulate else FINISH_TIMEOUT)
+        for addr, ok in result.items():
+            if not ok:
+                print(f"节点 0x{addr:02X} 升级失败")
+        if simulate:
+            # 逐个单播相当于每个节点各传一遍完整固件
+            unicast = len(addrs) * len(data) * 10 / args.baud
+            print(f"模拟总线耗时 {link.airtime:.2f}s（{args.baud}bps），逐个单播约 {unicast:.2f}s")
+        return 0 if all(result.values()) else 1
+
+    if args.enter:
+        link.send(build_command(CMD_START_FLASH, args.addr))
+        time.sleep(1.0)
+
+    flasher = LinkFlasher(link, args.window, args.packet, args.addr)
+    try:
+        ok = flasher.flash(data, args.version, args.date, args.sign_key)
+    except RuntimeError as exc:
+        print(f"刷写失败：{exc}")
+        ok = False
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -17,6 +17,7 @@
 
 from __future__ import annotations
 
+import hashlib
 import queue
 import sys
 import threading
@@ -29,6 +30,8 @@ import serial.tools.list_ports
 import tkinter as tk
 from tkinter import filedialog, messagebox, scrolledtext, ttk
 
+from image_sign import sign_digest
+
 
 BAUD_RATES = (
     "9600",
@@ -67,6 +70,8 @@ STOP_BITS = {
 
 # Bootloader 最大包大小选项
 PACKET_SIZES = ("128", "256", "512", "1024")
+# 在途帧数选项（需与 Bootloader 移植层 link_window 一致，UART 保持 1）
+WINDOW_SIZES = ("1", "2", "4", "8")
 
 # APP 端命令帧
 CMD_QUERY_VERSION = bytes([0x55, 0xAA, 0xFF, 0xDD, 0x55, 0x55])
@@ -80,16 +85,28 @@ ACK_TIMEOUT_FIRST = 10.0
 ACK_TIMEOUT_OTHERS = 5.0
 
 
-def build_finish_frame(version: int, date: int) -> bytes:
-    """构建完成帧: 55 AA [ver 4B] [date 4B] FF FD 55 55"""
-    return bytes([
+def build_finish_frame(
+    version: int, date: int, digest: Optional[bytes] = None, signature: Optional[bytes] = None
+) -> bytes:
+    """构建完成帧: 55 AA [ver 4B] [date 4B] FF FD 55 55
+    携带摘要时为扩展完成帧: 55 AA [ver 4B] [date 4B] [sha256 32B] FF FB 55 55
+    同时携带签名时为签名完成帧: 55 AA [ver 4B] [date 4B] [sha256 32B] [sig 64B] FF FA 55 55"""
+    head = bytes([
         0x55, 0xAA,
         (version >> 24) & 0xFF, (version >> 16) & 0xFF,
         (version >> 8) & 0xFF, version & 0xFF,
         (date >> 24) & 0xFF, (date >> 16) & 0xFF,
         (date >> 8) & 0xFF, date & 0xFF,
-        0xFF, 0xFD, 0x55, 0x55
     ])
+    if digest is None:
+        return head + bytes([0xFF, 0xFD, 0x55, 0x55])
+    if len(digest) != 32:
+        raise ValueError("SHA-256 摘要长度必须为 32 字节")
+    if signature is None:
+        return head + digest + bytes([0xFF, 0xFB, 0x55, 0x55])
+    if len(signature) != 64:
+        raise ValueError("Ed25519 签名长度必须为 64 字节")
+    return head + digest + signature + bytes([0xFF, 0xFA, 0x55, 0x55])
 
 
 def hex_string(data: bytes) -> str:
@@ -193,6 +210,8 @@ class BootloaderUploader:
     """负责固件（HEX/BIN）分包、发送以及 ACK 检测。"""
 
     ACK_PATTERN = bytes([0x55, 0xAA, 0xFF, 0xFE, 0x55, 0x55])
+    # 计数 ACK: 55 AA FF F9 [n] 55 55，一次确认 n 个数据帧
+    ACK_COUNT_HEAD = bytes([0x55, 0xAA, 0xFF, 0xF9])
     APP_BASE_ADDR = 0x08010000  # 默认 STM32F4 基址，可在 UI 中修改
 
     def __init__(
@@ -213,13 +232,18 @@ class BootloaderUploader:
         # max_payload 表示纯数据长度，UI 里配置的是"整包长度"，需扣掉帧固定开销
         self.max_payload = 1024 - self.frame_overhead
         self._upload_thread: Optional[threading.Thread] = None
-        self._ack_event = threading.Event()
+        self._ack_cond = threading.Condition()
+        self._ack_count = 0
         self._ack_buffer = bytearray()
         self._listener_registered = False
         self._lock = threading.Lock()
         # 版本号和日期，用于完成帧
         self.version: int = 1
         self.date: int = 0
+        # 签名私钥文件，设置后发送签名完成帧
+        self.sign_key_path: Optional[Path] = None
+        # 在途帧数，>1 时不等 ACK 连续发送，适合高延迟的分包链路
+        self.window = 1
 
     def is_running(self) -> bool:
         return bool(self._upload_thread and self._upload_thread.is_alive())
@@ -274,47 +298,64 @@ class BootloaderUploader:
         offset = 0
         success = True
         try:
-            # 阶段1：发送所有数据帧
-            while offset < total:
-                chunk = data[offset : offset + self.max_payload]
-                offset += len(chunk)
-                remaining = total - offset
-                frame = self._build_frame(chunk, remaining)
-                self._ack_event.clear()
-                try:
-                    self.worker.write(frame)
-                except RuntimeError as exc:
-                    self.logger(f"发送失败：{exc}")
-                    success = False
+            # 阶段1：发送所有数据帧，最多 window 帧在途
+            frame_ends: list[int] = []
+            while offset < total or self._ack_count < len(frame_ends):
+                while offset < total and len(frame_ends) - self._ack_count < self.window:
+                    chunk = data[offset : offset + self.max_payload]
+                    offset += len(chunk)
+                    frame = self._build_frame(chunk, total - offset)
+                    try:
+                        self.worker.write(frame)
+                    except RuntimeError as exc:
+                        self.logger(f"发送失败：{exc}")
+                        success = False
+                        break
+                    frame_ends.append(offset)
+                if not success:
                     break
 
                 # 首包可能耗时长（擦除 Flash），拉长超时窗口
-                ack_timeout = ACK_TIMEOUT_FIRST if offset == len(chunk) else ACK_TIMEOUT_OTHERS
-                if not self._ack_event.wait(timeout=ack_timeout):
+                ack_timeout = ACK_TIMEOUT_FIRST if self._ack_count == 0 else ACK_TIMEOUT_OTHERS
+                if not self._wait_ack(self._ack_count + 1, ack_timeout):
                     self.logger("等待 ACK 超时，刷写中断")
                     success = False
                     break
 
-                percent = offset * 100 // total
-                self.status_cb(f"已发送 {offset}/{total} 字节 ({percent}%)")
+                acked = frame_ends[min(self._ack_count, len(frame_ends)) - 1]
+                percent = acked * 100 // total
+                self.status_cb(f"已发送 {acked}/{total} 字节 ({percent}%)")
 
             # 阶段2：发送完成帧
             if success and offset == total:
                 self.logger("数据发送完成，发送完成帧...")
                 self.status_cb("发送完成帧...")
 
-                finish_frame = build_finish_frame(self.version, self.date)
-                self._ack_event.clear()
-                try:
-                    self.worker.write(finish_frame)
-                    self.logger(f"完成帧: ver={self.version}, date=0x{self.date:08X}")
-                except RuntimeError as exc:
-                    self.logger(f"发送完成帧失败：{exc}")
-                    success = False
+                # 摘要覆盖实际发送的全部数据字节，与 Bootloader 接收时累计的摘要一致
+                digest = hashlib.sha256(data).digest()
+                signature = None
+                if self.sign_key_path is not None:
+                    try:
+                        signature = sign_digest(self.sign_key_path, digest)
+                    except (OSError, ValueError) as exc:
+                        self.logger(f"固件签名失败：{exc}")
+                        success = False
+
+                if success:
+                    finish_frame = build_finish_frame(self.version, self.date, digest, signature)
+                    expected = self._ack_count + 1
+                    try:
+                        self.worker.write(finish_frame)
+                        self.logger(f"完成帧: ver={self.version}, date=0x{self.date:08X}, sha256={digest.hex()}")
+                        if signature is not None:
+                            self.logger(f"签名: {signature.hex()}")
+                    except RuntimeError as exc:
+                        self.logger(f"发送完成帧失败：{exc}")
+                        success = False
 
                 if success:
-                    if not self._ack_event.wait(timeout=ACK_TIMEOUT_OTHERS):
-                        self.logger("等待完成帧 ACK 超时")
+                    if not self._wait_ack(expected, ACK_TIMEOUT_OTHERS):
+                        self.logger("等待完成帧 ACK 超时（摘要或签名校验失败时 Bootloader 不会应答）")
                         success = False
 
         finally:
@@ -340,18 +381,39 @@ class BootloaderUploader:
                 self.worker.remove_listener(self._on_serial_data)
                 self._listener_registered = False
         self._ack_buffer.clear()
-        self._ack_event.clear()
+        with self._ack_cond:
+            self._ack_count = 0
+
+    def _wait_ack(self, count: int, timeout: float) -> bool:
+        """等待累计 ACK 数达到 count"""
+        with self._ack_cond:
+            return self._ack_cond.wait_for(lambda: self._ack_count >= count, timeout=timeout)
 
     def _on_serial_data(self, data: bytes) -> None:
         self._ack_buffer.extend(data)
-        ack = self.ACK_PATTERN
+        acked = 0
         while True:
-            idx = self._ack_buffer.find(ack)
+            idx = self._ack_buffer.find(self.ACK_PATTERN)
+            cnt_idx = self._ack_buffer.find(self.ACK_COUNT_HEAD)
+            if cnt_idx != -1 and (idx == -1 or cnt_idx < idx):
+                end = cnt_idx + len(self.ACK_COUNT_HEAD) + 3
+                if len(self._ack_buffer) < end:
+                    break
+                if self._ack_buffer[end - 2 : end] == b"\x55\x55":
+                    acked += self._ack_buffer[end - 3]
+                    del self._ack_buffer[:end]
+                else:
+                    del self._ack_buffer[: cnt_idx + 1]
+                continue
             if idx == -1:
                 break
             # 移除已匹配的 ACK 之前部分
-            del self._ack_buffer[: idx + len(ack)]
-            self._ack_event.set()
+            del self._ack_buffer[: idx + len(self.ACK_PATTERN)]
+            acked += 1
+        if acked:
+            with self._ack_cond:
+                self._ack_count += acked
+                self._ack_cond.notify_all()
 
     @staticmethod
     def _build_frame(payload: bytes, remaining: int) -> bytes:
@@ -470,8 +532,10 @@ class SerialTerminal(tk.Tk):
         self.bin_path_var = tk.StringVar(value="")
         self.boot_status_var = tk.StringVar(value="未选择文件")
         self.packet_size_var = tk.StringVar(value="1024")
+        self.window_var = tk.StringVar(value="1")
         self.app_base_var = tk.StringVar(value=f"0x{BootloaderUploader.APP_BASE_ADDR:08X}")
         self.new_version_var = tk.StringVar(value="1")
+        self.sign_key_var = tk.StringVar(value="")
 
         self.bootloader = BootloaderUploader(
             self.worker,
@@ -571,6 +635,14 @@ class SerialTerminal(tk.Tk):
             state="readonly",
         )
         self.packet_size_combo.pack(side="left", padx=(2, 0))
+        ttk.Label(file_opt_frame, text="  窗口:").pack(side="left")
+        ttk.Combobox(
+            file_opt_frame,
+            textvariable=self.window_var,
+            values=WINDOW_SIZES,
+            width=3,
+            state="readonly",
+        ).pack(side="left", padx=(2, 0))
 
         base_frame = ttk.Frame(boot_frame)
         base_frame.grid(row=2, column=0, padx=4, pady=2, sticky="we")
@@ -586,11 +658,18 @@ class SerialTerminal(tk.Tk):
         ttk.Entry(ver_frame, textvariable=self.new_version_var, width=8).pack(side="left", padx=(4, 0))
         ttk.Label(ver_frame, text="(刷写完成后写入)", foreground="gray").pack(side="left", padx=(4, 0))
 
+        # 签名私钥行（留空则不签名，Bootloader 开启签名校验时必须填写）
+        key_frame = ttk.Frame(boot_frame)
+        key_frame.grid(row=4, column=0, padx=4, pady=2, sticky="we")
+        ttk.Label(key_frame, text="签名私钥:").pack(side="left")
+        ttk.Entry(key_frame, textvariable=self.sign_key_var, width=14).pack(side="left", padx=(4, 0))
+        ttk.Button(key_frame, text="选择", command=self._select_sign_key).pack(side="left", padx=(4, 0))
+
         self.flash_btn = ttk.Button(boot_frame, text="开始刷写", command=self._start_bin_upload)
-        self.flash_btn.grid(row=4, column=0, padx=4, pady=2, sticky="we")
+        self.flash_btn.grid(row=5, column=0, padx=4, pady=2, sticky="we")
         ttk.Label(
             boot_frame, textvariable=self.boot_status_var, wraplength=180, foreground="gray"
-        ).grid(row=5, column=0, padx=4, pady=(2, 4), sticky="w")
+        ).grid(row=6, column=0, padx=4, pady=(2, 4), sticky="w")
 
         # 快捷命令区域
         cmd_frame = ttk.LabelFrame(settings_frame, text="快捷命令")
@@ -659,6 +738,14 @@ class SerialTerminal(tk.Tk):
         self.bin_path_var.set(path)
         self.bootloader.set_file(Path(path))
 
+    def _select_sign_key(self) -> None:
+        path = filedialog.askopenfilename(
+            title="选择签名私钥",
+            filetypes=[("Key", "*.key *.txt"), ("All Files", "*.*")],
+        )
+        if path:
+            self.sign_key_var.set(path)
+
     def _start_bin_upload(self) -> None:
         path = self.bin_path_var.get().strip()
         if path:
@@ -672,6 +759,7 @@ class SerialTerminal(tk.Tk):
             self.bootloader.set_max_payload(packet_size)
         except ValueError:
             self.bootloader.set_max_payload(1024)
+        self.bootloader.window = int(self.window_var.get())
         # 设置基址
         try:
             base_str = self.app_base_var.get().strip().lower()
@@ -688,6 +776,9 @@ class SerialTerminal(tk.Tk):
         # 设置日期（自动使用当前日期）
         now = time.localtime()
         self.bootloader.date = (now.tm_year << 16) | (now.tm_mon << 8) | now.tm_mday
+        # 设置签名私钥
+        key_str = self.sign_key_var.get().strip()
+        self.bootloader.sign_key_path = Path(key_str) if key_str else None
 
         self.flash_btn.configure(state="disabled")
         self.bootloader.start()
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+Bootloader 体积报告
+----------------
+读取链接结果（GCC 的 .elf、Keil 的 .axf），按符号列出 Flash 占用并检查体积预算，超出预算时返回 1，
+可作为构建后步骤（Keil：Options -> User -> After Build/Rebuild -> Run #1）让超预算的构建直接失败。
+
+用法：
+    python size_report.py <固件.elf|.axf> [--budget 字节数 | --config boot_config.h] [--objects a.o b.o ...] [--top N]
+
+    --budget   Flash 占用上限；--config 时取其中的 BOOT_TINY_SIZE_BUDGET
+    --objects  只统计这些目标文件中定义的符号（如 easy_bootloader.o 与移植层 .o），预算也按这部分计算；
+               不指定时统计整个镜像（含向量表、启动代码与库函数）
+    --top      只列出最大的 N 个符号，0 为全部（默认 30）
+
+Flash 占用 = 代码 + 只读数据 + 已初始化数据的初值；RAM 占用 = 已初始化数据 + 零初始化数据。
+统计的是链接（段回收）之后的结果，未被引用的函数不计入；需开启 -ffunction-sections -fdata-sections -Wl,--gc-sections
+（Keil 为 One ELF Section per Function）段回收才会生效。
+
+运行要求：Python 3.8+，无额外依赖
+"""
+
+from __future__ import annotations
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Set
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+SHN_UNDEF = 0
+SHN_LORESERVE = 0xFF00
+SHN_COMMON = 0xFFF2
+STT_OBJECT = 1
+STT_FUNC = 2
+
+BUDGET_MACRO = "BOOT_TINY_SIZE_BUDGET"
+
+
+class Elf:
+    """只解析体积统计需要的节头与符号表"""
+
+    def __init__(self, path: Path) -> None:
+        data = path.read_bytes()
+        if data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} 不是 ELF 文件")
+        self.is64 = data[4] == 2
+        end = "<" if data[5] == 1 else ">"
+        if self.is64:
+            shoff, = struct.unpack_from(end + "Q", data, 0x28)
+            shentsize, shnum = struct.unpack_from(end + "HH", data, 0x3A)
+            fields = "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(end + "I", data, 0x20)
+            shentsize, shnum = struct.unpack_from(end + "HH", data, 0x2E)
+            fields = "IIIIIIIIII"
+        self.sections: List[dict] = []
+        for i in range(shnum):
+            _, stype, flags, addr, offset, size, link, _, _, entsize = struct.unpack_from(
+                end + fields, data, shoff + i * shentsize)
+            self.sections.append({"type": stype, "flags": flags, "addr": addr, "offset": offset,
+                                  "size": size, "link": link, "entsize": entsize})
+        self.symbols: List[dict] = []
+        for symtab in self.sections:
+            if symtab["type"] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[symtab["link"]]
+            for pos in range(symtab["offset"], symtab["offset"] + symtab["size"], symtab["entsize"]):
+                if self.is64:
+                    name, info, _, shndx, value, size = struct.unpack_from(end + "IBBHQQ", data, pos)
+                else:
+                    name, value, size, info, _, shndx = struct.unpack_from(end + "IIIBBH", data, pos)
+                start = strtab["offset"] + name
+                self.symbols.append({"name": data[start:data.index(b"\0", start)].decode("utf-8", "replace"),
+                                     "type": info & 0xF, "shndx": shndx, "size": size})
+
+    def section_of(self, sym: dict) -> Optional[dict]:
+        if sym["shndx"] == SHN_UNDEF or sym["shndx"] >= SHN_LORESERVE:
+            return None
+        return self.sections[sym["shndx"]]
+
+
+def in_flash(section: dict) -> bool:
+    return bool(section["flags"] & SHF_ALLOC) and section["type"] != SHT_NOBITS
+
+
+def in_ram(section: dict) -> bool:
+    return bool(section["flags"] & SHF_ALLOC) and bool(section["flags"] & SHF_WRITE)
+
+
+def kind_of(section: dict) -> str:
+    if section["flags"] & SHF_EXECINSTR:
+        return "code"
+    if section["type"] == SHT_NOBITS:
+        return "bss"
+    return "data" if section["flags"] & SHF_WRITE else "rodata"
+
+
+def defined_names(objects: List[Path]) -> Set[str]:
+    """目标文件中定义的函数与变量名（含 static），用于从镜像中挑出这些文件贡献的符号"""
+    names: Set[str] = set()
+    for path in objects:
+        for sym in Elf(path).symbols:
+            if sym["type"] in (STT_FUNC, STT_OBJECT) and sym["shndx"] != SHN_UNDEF and \
+                    (sym["shndx"] < SHN_LORESERVE or sym["shndx"] == SHN_COMMON):
+                names.add(sym["name"])
+    return names
+
+
+def read_budget(config: Path) -> int:
+    text = config.read_text(encoding="utf-8", errors="replace")
+    m = re.search(r"#define\s+" + BUDGET_MACRO + r"\s+(0[xX][0-9A-Fa-f]+|\d+)", text)
+    if m is None:
+        raise ValueError(f"{config} 中没有 {BUDGET_MACRO}")
+    return int(m.group(1), 0)
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="Bootloader 体积报告与预算检查")
+    parser.add_argument("image", type=Path, help="链接结果 .elf / .axf")
+    budget = parser.add_mutually_exclusive_group()
+    budget.add_argument("--budget", type=lambda s: int(s, 0), help="Flash 占用上限（字节）")
+    budget.add_argument("--config", type=Path, help="从 boot_config.h 读取 " + BUDGET_MACRO)
+    parser.add_argument("--objects", type=Path, nargs="+", help="只统计这些目标文件定义的符号")
+    parser.add_argument("--top", type=int, default=30, help="列出的符号数，0 为全部")
+    args = parser.parse_args(argv[1:])
+
+    image = Elf(args.image)
+    limit = read_budget(args.config) if args.config else args.budget
+    wanted = defined_names(args.objects) if args.objects else None
+
+    image_flash = sum(s["size"] for s in image.sections if in_flash(s))
+    image_ram = sum(s["size"] for s in image.sections if in_ram(s))
+
+    # 同名 static 符号（不同文件各一份）按地址区分不了，合并计入
+    rows: Dict[tuple, int] = {}
+    symbol_flash = 0
+    for sym in image.symbols:
+        section = image.section_of(sym)
+        if section is None or sym["type"] not in (STT_FUNC, STT_OBJECT) or sym["size"] == 0:
+            continue
+        if not section["flags"] & SHF_ALLOC:
+            continue
+        if in_flash(section):
+            symbol_flash += sym["size"]
+        if wanted is not None and sym["name"] not in wanted:
+            continue
+        key = (sym["name"], kind_of(section))
+        rows[key] = rows.get(key, 0) + sym["size"]
+
+    ordered = sorted(rows.items(), key=lambda item: item[1], reverse=True)
+    shown = ordered if args.top == 0 else ordered[:args.top]
+    print(f"{'字节':>6}  {'类型':<4}  符号")
+    for (name, kind), size in shown:
+        print(f"{size:8d}  {kind:<6}  {name}")
+    if len(shown) < len(ordered):
+        rest = ordered[len(shown):]
+        print(f"{sum(size for _, size in rest):8d}  {'':<6}  其余 {len(rest)} 个符号")
+
+    counted_flash = sum(size for (_, kind), size in rows.items() if kind != "bss")
+    counted_ram = sum(size for (_, kind), size in rows.items() if kind in ("data", "bss"))
+    print()
+    print(f"镜像 Flash 占用 {image_flash} 字节（其中 {image_flash - symbol_flash} 字节不属于任何有大小的符号：对齐填充、汇编启动代码等）")
+    print(f"镜像 RAM 占用   {image_ram} 字节")
+    if wanted is not None:
+        print(f"所选目标文件 Flash 占用 {counted_flash} 字节，RAM 占用 {counted_ram} 字节")
+        total = counted_flash
+    else:
+        total = image_flash
+
+    if limit is None:
+        return 0
+    if total > limit:
+        print(f"超出预算：{total} > {limit} 字节（超出 {total - limit} 字节）")
+        return 1
+    print(f"预算内：{total} / {limit} 字节（剩余 {limit - total} 字节）")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""
+SPI 刷写工具
+----------------
+上位机（如树莓派、带 spidev 的 Linux 板卡）作为 SPI 主机，设备侧启用 BOOT_CONFIG_LINK_SPI 作为从机。
+一个事务承载一个协议帧，帧格式与串口上位机完全一致，事务格式见 boot_spi.h：
+
+    MOSI: A5 00 [len 2B] [协议帧] [填充]
+    MISO: 5A [status] [len 2B] [应答] [填充]
+
+从机在启动 DMA 时就确定了 MISO 内容，应答随后续事务返回；没有帧要发时发送 len = 0 的空事务取回应答。
+每次事务前等待就绪线为高（从机已启动 DMA 且有空闲接收缓冲），Flash 擦写期间就绪线为低即为流控。
+
+用法：
+    python spi_flash.py <固件.bin|.hex> [--bus 0] [--dev 0] [--speed 8000000] --ready /sys/class/gpio/gpio17/value
+                        [--window 4] [--packet 1024] [--version 1] [--date 0x20260101] [--sign-key <私钥文件>]
+    python spi_flash.py <固件.bin|.hex> --loopback
+
+    --ready      就绪线的电平文件（读出 0/1，如 sysfs GPIO 的 value），接设备 PB0
+    --loopback   不接硬件，在本机模拟从机的事务分帧（双缓冲、就绪线、应答延后一次事务），用于验证上位机逻辑
+
+运行要求：Python 3.8+，硬件模式需要 spidev (`pip install spidev`)。
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+import time
+from pathlib import Path
+
+from gateway_sim import SimChild
+from link_flash import ACK_TIMEOUT_FIRST, LinkFlasher, add_flash_arguments, load_firmware
+
+MOSI_MAGIC = 0xA5
+MISO_MAGIC = 0x5A
+HEADER_SIZE = 4       # BOOT_SPI_HEADER_SIZE
+PAYLOAD_MAX = 1024    # BOOT_SPI_PAYLOAD_MAX
+REPLY_MAX = 64        # BOOT_SPI_REPLY_MAX
+STATUS_OVERRUN = 0x01
+STATUS_REPLY_LOST = 0x02
+POLL_INTERVAL = 0.0005
+
+
+class SpidevBus:
+    """Linux spidev 主机 + 就绪线电平文件"""
+
+    def __init__(self, bus: int, dev: int, speed: int, ready_path: Path) -> None:
+        import spidev  # 只有硬件模式需要
+
+        self.spi = spidev.SpiDev()
+        self.spi.open(bus, dev)
+        self.spi.mode = 0
+        self.spi.max_speed_hz = speed
+        self.ready_file = open(ready_path, "rb", buffering=0)
+
+    def ready(self) -> bool:
+        self.ready_file.seek(0)
+        return self.ready_file.read(1) == b"1"
+
+    def transfer(self, mosi: bytes) -> bytes:
+        return bytes(self.spi.xfer3(list(mosi)))
+
+
+class LoopbackBus:
+    """模拟从机：与 boot_spi.c 相同的双缓冲与就绪线规则，核心每轮处理一个接收缓冲"""
+
+    def __init__(self) -> None:
+        self.device = SimChild()
+        self.rx: list[bytes | None] = [None, None]
+        self.rx_head = 0
+        self.next = 0
+        self.armed = False
+        self.status = 0
+        self.tx_fill = bytearray()
+        self.tx_armed = b""
+        self.transfers = 0
+        self.empty = 0
+        self.clocked = 0
+        self._arm()
+
+    def _arm(self) -> None:
+        if self.rx[self.next] is not None:
+            return  # 两个缓冲都在等核心处理，就绪线保持为低
+        self.tx_armed = bytes([MISO_MAGIC, self.status]) + len(self.tx_fill).to_bytes(2, "big") + self.tx_fill
+        self.tx_fill = bytearray()
+        self.status = 0
+        self.armed = True
+
+    def ready(self) -> bool:
+        # 主循环：处理最早的接收缓冲，应答追加到发送缓冲，归还后若未启动则重新启动
+        frame = self.rx[self.rx_head]
+        if frame is not None:
+            reply = self.device.handle(frame)
+            if len(self.tx_fill) + len(reply) > REPLY_MAX:
+                self.status |= STATUS_REPLY_LOST
+            else:
+                self.tx_fill += reply
+            self.rx[self.rx_head] = None
+            self.rx_head ^= 1
+            if not self.armed:
+                self._arm()
+        return self.armed
+
+    def transfer(self, mosi: bytes) -> bytes:
+        self.transfers += 1
+        self.clocked += len(mosi)
+        if not self.armed:
+            self.status |= STATUS_OVERRUN
+            return bytes(len(mosi))
+        miso = self.tx_armed.ljust(len(mosi), b"\x00")[: len(mosi)]
+        self.armed = False
+        length = int.from_bytes(mosi[2:4], "big")
+        if mosi[0] == MOSI_MAGIC and 0 < length <= min(PAYLOAD_MAX, len(mosi) - HEADER_SIZE):
+            self.rx[self.next] = bytes(mosi[HEADER_SIZE : HEADER_SIZE + length])
+            self.next ^= 1
+        else:
+            self.empty += 1
+        self._arm()
+        return miso
+
+
+class SpiLink:
+    """SPI 事务收发：send() 一个协议帧一次事务，poll() 发送空事务取回应答，应答拼接成字节流供 ACK 解析"""
+
+    def __init__(self, bus, ready_timeout: float = ACK_TIMEOUT_FIRST) -> None:
+        self.bus = bus
+        self.ready_timeout = ready_timeout
+        self.rx_data = bytearray()
+
+    def _wait_ready(self, timeout: float) -> bool:
+        deadline = time.monotonic() + timeout
+        while not self.bus.ready():
+            if time.monotonic() >= deadline:
+                return False
+            time.sleep(POLL_INTERVAL)
+        return True
+
+    def _transact(self, frame: bytes) -> int:
+        """发起一次事务，返回本次取回的应答字节数"""
+        if len(frame) > PAYLOAD_MAX:
+            raise ValueError(f"协议帧 {len(frame)} 字节超过 BOOT_SPI_PAYLOAD_MAX")
+        mosi = bytes([MOSI_MAGIC, 0]) + len(frame).to_bytes(2, "big") + frame
+        miso = self.bus.transfer(mosi.ljust(HEADER_SIZE + max(len(frame), REPLY_MAX), b"\x00"))
+        if miso[0] != MISO_MAGIC:
+            return 0
+        status = miso[1]
+        if status & STATUS_OVERRUN:
+            raise RuntimeError("从机报告事务溢出：有帧在就绪线为低时发出被丢弃")
+        if status & STATUS_REPLY_LOST:
+            raise RuntimeError("从机报告应答缓冲溢出")
+        length = min(int.from_bytes(miso[2:4], "big"), REPLY_MAX)
+        self.rx_data.extend(miso[HEADER_SIZE : HEADER_SIZE + length])
+        return length
+
+    def send(self, msg: bytes) -> None:
+        # 首帧触发擦除时就绪线会长时间为低，超时与首帧 ACK 一致
+        if not self._wait_ready(self.ready_timeout):
+            raise RuntimeError("等待就绪线超时")
+        self._transact(msg)
+
+    def poll(self, timeout: float) -> bool:
+        """发送空事务直到取回应答或超时，取回任意应答返回 True"""
+        deadline = time.monotonic() + timeout
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not self._wait_ready(remaining):
+                return False
+            if self._transact(b"") > 0:
+                return True
+            time.sleep(POLL_INTERVAL)
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="通过 SPI 刷写 easy_bootloader")
+    add_flash_arguments(parser)
+    parser.add_argument("--bus", type=int, default=0)
+    parser.add_argument("--dev", type=int, default=0)
+    parser.add_argument("--speed", type=int, default=8_000_000, help="SPI 时钟（Hz），不超过从机 PCLK2/2")
+    parser.add_argument("--ready", type=Path, default=None, help="就绪线电平文件")
+    parser.add_argument("--loopback", action="store_true", help="模拟从机，不接硬件")
+    args = parser.parse_args(argv[1:])
+
+    if args.packet > PAYLOAD_MAX:
+        parser.error(f"--packet 不能超过 {PAYLOAD_MAX}")
+    if args.loopback:
+        bus = LoopbackBus()
+    elif args.ready is None:
+        parser.error("需要 --ready 或 --loopback")
+    else:
+        bus = SpidevBus(args.bus, args.dev, args.speed, args.ready)
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    link = SpiLink(bus)
+    try:
+        ok = LinkFlasher(link, args.window, args.packet).flash(data, args.version, args.date, args.sign_key)
+    except RuntimeError as exc:
+        print(f"\n{exc}")
+        return 1
+    if args.loopback:
+        ok = ok and bus.device.committed == data
+        print(f"模拟事务 {bus.transfers} 次（空事务 {bus.empty} 次），共 {bus.clocked} 字节，"
+              f"{args.speed / 1e6:g}MHz 时钟下传输约 {bus.clocked * 8 / args.speed:.3f}s，镜像{'一致' if ok else '不一致'}")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+串口高波特率回放测试
+----------------
+按真实升级流程向设备连续回放数据帧，统计丢帧率，用于验证设备串口在高波特率下的接收链路
+（F407 例程 USART2 使用循环 DMA 接收环，见 Myapp/myusart.c）。
+
+每一轮：
+    1. 发送升级命令 55 AA FF EE 55 55（设备在 APP 中时复位进入 Bootloader，已在 Bootloader 中时忽略）
+    2. 发送首帧并等待 ACK（首帧触发擦除，耗时较长）
+    3. 其余数据帧背靠背发送，在途帧数不超过 --window，不等 ACK 逐帧停顿
+    4. 发送完成帧，设备校验摘要通过后应答 ACK 并跳转 APP
+
+丢帧率 = 未应答的数据帧 / 已发送的数据帧。丢失或校验失败的帧设备不应答，之后的帧仍逐帧应答，
+但镜像摘要不一致，完成帧不会被应答；在 --ack-timeout 内等不到应答时本轮结束，已发送未应答的帧全部计为丢失。
+
+用法：
+    python uart_replay.py <固件.bin|.hex> --port COM3 --baud 2000000 [--window 3] [--runs 10] [--packet 1024]
+                          [--settle 1.0] [--ack-timeout 0.5]
+
+    --window   在途帧数，设备接收环须能容纳 window 个整包（F407 例程 4096 字节，window 不超过 3）
+    --settle   升级命令后等待设备复位进入 Bootloader 的时间（秒）
+
+运行要求：Python 3.8+，pyserial (`pip install pyserial`)，USB 转串口须支持所选波特率（如 CP2102N、FT232H）
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import sys
+import time
+
+from link_flash import (
+    ACK_TIMEOUT_FIRST,
+    CMD_START_FLASH,
+    LinkFlasher,
+    add_flash_arguments,
+    build_data_frame,
+    build_finish_frame,
+    load_firmware,
+)
+from rs485_flash import SerialLink
+
+
+class ReplayResult:
+    def __init__(self) -> None:
+        self.sent = 0
+        self.acked = 0
+        self.finished = False
+        self.elapsed = 0.0
+
+    @property
+    def lost(self) -> int:
+        return self.sent - self.acked
+
+
+def replay_once(link, data: bytes, window: int, packet: int, ack_timeout: float,
+                version: int, date: int, settle: float) -> ReplayResult:
+    """回放一轮完整升级，返回统计"""
+    result = ReplayResult()
+    flasher = LinkFlasher(link, window, packet)
+    link.send(CMD_START_FLASH)
+    time.sleep(settle)
+    link.rx_data.clear()
+
+    frames = []
+    offset = 0
+    while offset < len(data):
+        chunk = data[offset : offset + flasher.max_payload]
+        offset += len(chunk)
+        frames.append(build_data_frame(chunk, len(data) - offset))
+
+    start = time.monotonic()
+    for frame in frames:
+        # 首帧单独等待擦除完成，之后保持 window 帧在途
+        while result.sent and result.sent - flasher.ack_count >= (window if flasher.ack_count else 1):
+            timeout = ACK_TIMEOUT_FIRST if flasher.ack_count == 0 else ack_timeout
+            if not flasher.wait_ack(flasher.ack_count + 1, timeout):
+                result.acked = flasher.ack_count
+                result.elapsed = time.monotonic() - start
+                return result
+        link.send(frame)
+        result.sent += 1
+    flasher.wait_ack(result.sent, ack_timeout if result.sent > 1 else ACK_TIMEOUT_FIRST)
+    result.acked = flasher.ack_count
+    if result.acked == result.sent:
+        link.send(build_finish_frame(version, date, hashlib.sha256(data).digest(), None))
+        result.finished = flasher.wait_ack(result.sent + 1, ack_timeout + 1.0)
+        result.acked = min(flasher.ack_count, result.sent)
+    result.elapsed = time.monotonic() - start
+    return result
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="串口连续回放升级帧并统计丢帧率")
+    add_flash_arguments(parser)
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=2_000_000)
+    parser.add_argument("--runs", type=int, default=10)
+    parser.add_argument("--settle", type=float, default=1.0, help="升级命令后等待设备进入 Bootloader 的时间（秒）")
+    parser.add_argument("--ack-timeout", type=float, default=0.5, help="非首帧的 ACK 超时（秒）")
+    parser.set_defaults(window=3)
+    args = parser.parse_args(argv[1:])
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    link = SerialLink(args.port, args.baud)
+    total_sent = total_lost = finished = 0
+    for run in range(1, args.runs + 1):
+        result = replay_once(link, data, max(1, args.window), args.packet, args.ack_timeout,
+                             args.version, args.date, args.settle)
+        total_sent += result.sent
+        total_lost += result.lost
+        finished += result.finished
+        wire = len(data) * 10 / args.baud
+        print(f"第 {run} 轮：发送 {result.sent} 帧，应答 {result.acked} 帧，"
+              f"完成帧{'已' if result.finished else '未'}应答，耗时 {result.elapsed:.2f}s（线上传输约 {wire:.2f}s）")
+
+    rate = total_lost / total_sent if total_sent else 0.0
+    print(f"共 {args.runs} 轮 {total_sent} 帧，丢失 {total_lost} 帧，丢帧率 {rate:.4%}，完成 {finished}/{args.runs} 轮")
+    return 0 if total_lost == 0 and finished == args.runs else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""
+UDP 刷写工具
+----------------
+通过以太网 UDP 承载 Bootloader 协议，一个 UDP 报文承载一个协议帧，帧格式与串口上位机完全一致，
+设备侧需启用 BOOT_CONFIG_LINK_UDP。
+
+用法：
+    python udp_flash.py <固件.bin|.hex> [--ip 169.254.x.y] [--port 47000] [--window 4] [--packet 1024]
+                        [--version 1] [--date 0x20260101] [--sign-key <私钥文件>]
+
+    --ip         设备地址，缺省时向 255.255.255.255 广播首帧，收到应答后锁定应答方地址
+                 （设备未配置静态 IP 时使用 169.254.x.y 链路本地地址，主机网卡需在同一网段）
+
+帧无序号，丢包后设备等不到完整帧不会应答，超时后需重新刷写。
+
+运行要求：Python 3.8+，无额外依赖。
+"""
+
+from __future__ import annotations
+
+import argparse
+import select
+import socket
+import sys
+from typing import Optional
+
+from link_flash import LinkFlasher, add_flash_arguments, load_firmware
+
+DEFAULT_PORT = 47000  # 对应 BOOT_UDP_PORT
+BROADCAST_IP = "255.255.255.255"
+
+
+class UdpLink:
+    """UDP 收发：每个协议帧一个报文，收到的报文拼接成字节流供 ACK 解析"""
+
+    def __init__(self, ip: Optional[str], port: int, local_port: int = 0) -> None:
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+        self.sock.bind(("", local_port))
+        self.peer = (ip or BROADCAST_IP, port)
+        self.locked = ip is not None
+        self.rx_data = bytearray()
+
+    def send(self, msg: bytes) -> None:
+        self.sock.sendto(msg, self.peer)
+
+    def poll(self, timeout: float) -> bool:
+        """处理最多 timeout 秒内到达的报文，收到任意报文返回 True"""
+        got = False
+        while True:
+            ready, _, _ = select.select([self.sock], [], [], 0.0 if got else max(timeout, 0.0))
+            if not ready:
+                return got
+            data, addr = self.sock.recvfrom(2048)
+            if addr[1] != self.peer[1] or (self.locked and addr[0] != self.peer[0]):
+                continue
+            if not self.locked:
+                # 广播发现：之后只与首个应答的设备单播通信
+                self.peer = addr
+                self.locked = True
+                print(f"设备地址 {addr[0]}:{addr[1]}")
+            self.rx_data.extend(data)
+            got = True
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(description="通过 UDP 刷写 easy_bootloader")
+    add_flash_arguments(parser)
+    parser.add_argument("--ip", default=None, help="设备 IP，缺省时广播发现")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--local-port", type=int, default=0)
+    args = parser.parse_args(argv[1:])
+
+    data = load_firmware(args.firmware)
+    if not data:
+        print("固件为空")
+        return 1
+
+    link = UdpLink(args.ip, args.port, args.local_port)
+    flasher = LinkFlasher(link, args.window, args.packet)
+    ok = flasher.flash(data, args.version, args.date, args.sign_key)
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
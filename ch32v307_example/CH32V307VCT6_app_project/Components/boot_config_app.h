@@ -4,12 +4,27 @@
 #include <stdint.h>
 
 #define BOOT_APP_CONFIG_ENABLE_LOG        1U      // 1启用日志输出 0禁用日志输出
+#define BOOT_APP_CONFIG_ENABLE_STAGING    0U      // 1运行中后台接收新固件到暂存区 0禁用
+#define BOOT_APP_CONFIG_ENABLE_ADDRESS    0U      // 1多点总线（RS-485）模式，须与 Bootloader 侧一致 0禁用
+#define BOOT_APP_CONFIG_ENABLE_GATEWAY    0U      // 存储转发网关，本示例在网关方案中作为子节点，保持 0
 
 /*
- * Flash 布局（使用 CH32 别名地址 0x00000000 -> 0x08000000）
+ * 多点总线节点地址（0x01~0xFE，与 Bootloader 侧 BOOT_NODE_ADDR 一致）
  */
-#define BOOT_APP_FLAG_REGION_ADDR         0x0003F800U       // 别名地址
-#define BOOT_APP_FLAG_REGION_SIZE         0x00000800U       // 2KB
+#define BOOT_APP_NODE_ADDR                1U
+#define BOOT_APP_CONFIG_LINK_CAN          0U      // 1升级链路使用 CAN1 + ISO-TP（与 Bootloader 一致） 0使用 USART2
+
+/*
+ * Flash / RAM 布局（标志位区、暂存区及其擦除粒度、交接区与扇区表，与 Bootloader 侧共用一份清单）
+ * 由 ch32v307_example/memmap.json 经 PC tool/source/memmap_gen.py 生成，同时更新 Link.ld 中的 MEMORY 区域，不要手工修改 boot_memmap_app.h
+ */
+#include "boot_memmap_app.h"
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING != BOOT_APP_MEMMAP_STAGING
+#error "BOOT_APP_CONFIG_ENABLE_STAGING differs from enable_staging in memmap.json, regenerate boot_memmap_app.h"
+#endif
+
+#define BOOT_APP_STAGING_WRITE_BUDGET     256U
 
 /*
  * 标志位区布局
@@ -22,6 +37,15 @@
 #define BOOT_APP_VERSION_ADDR             (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_VERSION_OFFSET)
 #define BOOT_APP_DATE_ADDR                (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_DATE_OFFSET)
 
+#define BOOT_APP_FLAG_ERASED              0xE339E339U       // CH32 Flash 擦除后的默认值
+
+/*
+ * 暂存记录（与 Bootloader 一致）
+ */
+#define BOOT_APP_STAGING_RECORD_OFFSET    0x100U
+#define BOOT_APP_STAGING_RECORD_ADDR      (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_STAGING_RECORD_OFFSET)
+#define BOOT_APP_STAGING_MAGIC            0x53544744U
+
 /*
  * 协议缓冲配置
  */
@@ -29,4 +53,12 @@
 #define BOOT_APP_RINGBUFFER_SIZE          1013U
 #define BOOT_APP_UART_TIMEOUT_MS          5000U
 
+/*
+ * CAN 链路配置（与 Bootloader 侧 BOOT_CAN_* 一致）
+ */
+#define BOOT_APP_CAN_RX_ID                0x7E0U
+#define BOOT_APP_CAN_TX_ID                0x7E8U
+#define BOOT_APP_CAN_BLOCK_SIZE           48U
+#define BOOT_APP_CAN_ST_MIN               0U
+
 #endif // BOOT_CONFIG_APP_H
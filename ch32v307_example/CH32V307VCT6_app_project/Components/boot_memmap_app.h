@@ -0,0 +1,21 @@
+// CH32V307VCT6 Flash / RAM 布局，由 PC tool/source/memmap_gen.py 根据 memmap.json 生成，不要手工修改
+#ifndef BOOT_MEMMAP_APP_H
+#define BOOT_MEMMAP_APP_H
+
+#define BOOT_APP_MEMMAP_STAGING           0U            // 生成时的暂存区开关，须与配置头文件中的开关一致
+
+#define BOOT_APP_FLAG_REGION_ADDR         0x0003F800U
+#define BOOT_APP_FLAG_REGION_SIZE         0x00000800U
+#define BOOT_APP_STAGING_ADDR             0x00020000U
+#define BOOT_APP_STAGING_SIZE             0x0001A000U
+#define BOOT_APP_STAGING_ERASE_UNIT       0x00001000U   // 边写边擦的粒度
+
+/* Bootloader -> APP 交接区：RAM 末尾，两侧链接区域均已扣除 */
+#define BOOT_APP_HANDOFF_ADDR             0x2000FF00U
+
+#define BOOT_APP_FLASH_START_ADDR         0x00000000U
+#define BOOT_APP_FLASH_END_ADDR           0x00040000U
+#define BOOT_APP_FLASH_SECTOR_COUNT       1024U
+#define BOOT_APP_FLASH_SECTOR_SIZE        0x00000100U   // 扇区大小一致，扇区号 = 偏移 / 扇区大小
+
+#endif // BOOT_MEMMAP_APP_H
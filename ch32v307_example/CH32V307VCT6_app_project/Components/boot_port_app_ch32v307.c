@@ -1,6 +1,9 @@
 #include "boot_config_app.h"
 #include "easy_bootloader_app.h"
 #include "bsp_sys.h"
+#if BOOT_APP_CONFIG_LINK_CAN
+#include "boot_isotp.h"
+#endif
 
 #define FLASH_BASE_ADDR       0x08000000U
 #define FLASH_PHYS_ADDR(addr) ((uint32_t)((addr) + FLASH_BASE_ADDR))
@@ -10,6 +13,16 @@ uint32_t boot_port_app_get_tick(void)
     return get_uwtick();
 }
 
+#if BOOT_APP_CONFIG_LINK_CAN
+static boot_isotp_t boot_port_app_isotp;
+
+static const boot_isotp_ops_t boot_port_app_isotp_ops = {
+    .can_send = mycan1_send,
+    .can_recv = mycan1_recv,
+    .get_tick = boot_port_app_get_tick,
+};
+#endif
+
 boot_port_app_status_t boot_port_app_flash_erase(uint32_t addr, uint32_t size)
 {
     if ((addr % 256U) || (size % 256U))
@@ -76,16 +89,13 @@ boot_port_app_status_t boot_port_app_data_write(const uint8_t *data, uint32_t le
         return BOOT_PORT_APP_ERROR;
     }
 
-    for (uint32_t i = 0; i < len; i++) {
-        while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) == RESET) {
-        }
-        USART_SendData(USART2, data[i]);
-    }
-
-    while (USART_GetFlagStatus(USART2, USART_FLAG_TC) == RESET) {
-    }
-
+#if BOOT_APP_CONFIG_LINK_CAN
+    return (boot_isotp_write(&boot_port_app_isotp, data, len) == BOOT_ISOTP_OK) ? BOOT_PORT_APP_OK : BOOT_PORT_APP_ERROR;
+#else
+    /* 拷入 DMA 发送缓冲后立即返回，发送完成由 DMA 中断通知 */
+    uart_dma_send(&uart2_tx, data, len);
     return BOOT_PORT_APP_OK;
+#endif
 }
 
 uint32_t boot_port_app_data_read(uint8_t *buf, uint32_t max_len)
@@ -94,13 +104,12 @@ uint32_t boot_port_app_data_read(uint8_t *buf, uint32_t max_len)
         return 0U;
     }
 
-    rt_uint16_t data_len = rt_ringbuffer_data_len(&uart2_ringbuffer);
-    if (data_len == 0U) {
-        return 0U;
-    }
-
-    rt_uint16_t request = (data_len > max_len) ? (rt_uint16_t)max_len : data_len;
-    return rt_ringbuffer_get(&uart2_ringbuffer, buf, request);
+#if BOOT_APP_CONFIG_LINK_CAN
+    return boot_isotp_read(&boot_port_app_isotp, buf, max_len);
+#else
+    /* 直接从循环 DMA 接收环中取数据 */
+    return uart_dma_ring_read(&uart2_rx_ring, buf, (max_len > 0xFFFFU) ? 0xFFFFU : (uint16_t)max_len);
+#endif
 }
 
 void boot_port_app_log(const char *fmt, ...)
@@ -117,18 +126,15 @@ void boot_port_app_log(const char *fmt, ...)
         if (tx_len >= sizeof(buffer)) {
             tx_len = sizeof(buffer) - 1U;
         }
-        for (uint32_t i = 0; i < tx_len; i++) {
-            while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET) {
-            }
-            USART_SendData(USART1, buffer[i]);
-        }
-        while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET) {
-        }
+        uart_dma_send(&uart1_tx, (const uint8_t *)buffer, tx_len);
     }
 }
 
 void boot_port_app_system_reset(void)
 {
+    /* 复位前等最后的应答与日志发完 */
+    uart_dma_flush(&uart1_tx);
+    uart_dma_flush(&uart2_tx);
     NVIC_SystemReset();
 }
 
@@ -145,6 +151,16 @@ boot_app_ops_t boot_port_app_ops = {
 
 void bootloader_app_init(void)
 {
+#if BOOT_APP_CONFIG_LINK_CAN
+    const boot_isotp_config_t isotp_cfg = {
+        .tx_id = BOOT_APP_CAN_TX_ID,
+        .rx_id = BOOT_APP_CAN_RX_ID,
+        .frame_len = BOOT_ISOTP_CAN_DLEN,
+        .block_size = BOOT_APP_CAN_BLOCK_SIZE,
+        .st_min = BOOT_APP_CAN_ST_MIN,
+    };
+    (void)boot_isotp_init(&boot_port_app_isotp, &boot_port_app_isotp_ops, &isotp_cfg);
+#endif
     (void)easy_bootloader_app_init(&boot_port_app_ops);
 }
 
@@ -1,6 +1,15 @@
 // APP 应用层源文件
 #include "easy_bootloader_app.h"
 #include "boot_config_app.h"
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+#include "boot_sha256.h"
+#endif
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+#include "boot_gateway.h"
+#if !BOOT_APP_CONFIG_ENABLE_STAGING
+    #error "BOOT_APP_CONFIG_ENABLE_GATEWAY requires BOOT_APP_CONFIG_ENABLE_STAGING"
+#endif
+#endif
 
 #include <stdbool.h>
 #include <string.h>
@@ -23,10 +32,21 @@
 #define BOOT_FRAME_TAIL0          0x55U
 #define BOOT_FRAME_TAIL1          0x55U
 
+/* 多点总线模式下帧头后带一个节点地址字节：55 AA [addr] ... */
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+#define APP_FRAME_ADDR_LEN        1U
+#if BOOT_APP_NODE_ADDR == 0U || BOOT_APP_NODE_ADDR >= 0xFFU
+    #error "BOOT_APP_NODE_ADDR must be in 0x01..0xFE"
+#endif
+#else
+#define APP_FRAME_ADDR_LEN        0U
+#endif
+#define APP_FRAME_BODY            (2U + APP_FRAME_ADDR_LEN)    // 帧头（及地址）之后第一个字节的下标
+
 /* 命令帧长度 */
-#define CMD_QUERY_VERSION_LEN     6U    // 55 AA FF DD 55 55
-#define CMD_QUERY_DATE_LEN        6U    // 55 AA FF CC 55 55
-#define CMD_START_FLASH_LEN       6U    // 55 AA FF EE 55 55 (简化版，不携带版本/日期)
+#define CMD_QUERY_VERSION_LEN     (6U + APP_FRAME_ADDR_LEN)    // 55 AA FF DD 55 55
+#define CMD_QUERY_DATE_LEN        (6U + APP_FRAME_ADDR_LEN)    // 55 AA FF CC 55 55
+#define CMD_START_FLASH_LEN       (6U + APP_FRAME_ADDR_LEN)    // 55 AA FF EE 55 55 (简化版，不携带版本/日期)
 
 /* 命令特征字节 */
 #define CMD_QUERY_VERSION_BYTE0   0xFFU
@@ -36,10 +56,51 @@
 #define CMD_START_FLASH_BYTE0     0xFFU
 #define CMD_START_FLASH_BYTE1     0xEEU
 
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+/* 总线扫描：探测帧 55 AA [addr] FF F8 55 55，应答 55 AA FF F8 [addr] [state] [ver 4B] 55 55 */
+#define CMD_SCAN_BYTE0            0xFFU
+#define CMD_SCAN_BYTE1            0xF8U
+#define CMD_SCAN_LEN              7U
+#define CMD_SCAN_REPLY_LEN        12U
+#define CMD_SCAN_STATE_APP        0x80U   // 应答状态字节：APP 运行中（低位为后台接收状态）
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+/*
+ * 网关目标帧 55 AA [addr] FF F2 [mask] 55 55：下一次后台接收的固件转发给 mask 中的子节点而不安装到本机，应答 ACK
+ * 网关进度查询 55 AA [addr] FF F1 55 55，应答 55 AA FF F1 [n] ([state][percent]) * n 55 55
+ */
+#define CMD_GATEWAY_BYTE0         0xFFU
+#define CMD_GATEWAY_TARGET_BYTE1  0xF2U
+#define CMD_GATEWAY_TARGET_LEN    (7U + APP_FRAME_ADDR_LEN)
+#define CMD_GATEWAY_STATUS_BYTE1  0xF1U
+#define CMD_GATEWAY_STATUS_LEN    (6U + APP_FRAME_ADDR_LEN)
+#define GATEWAY_STATUS_REPLY_LEN  (7U + 2U * BOOT_APP_GATEWAY_CHILDREN)
+#endif
+
 /* 标志位值 */
 #define BOOT_FLAG_BOOTLOADER      1U
 #define BOOT_FLAG_APP             2U
-#define BOOT_FLAG_ERASED          0xFFFFFFFFU
+#define BOOT_FLAG_ERASED          BOOT_APP_FLAG_ERASED
+
+/* 数据帧: 55 AA [剩余 3B] [长度 2B] [数据] [校验 2B] 55 55 */
+#define BOOT_FRAME_FIXED_SIZE     (11U + APP_FRAME_ADDR_LEN)
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+#define APP_RX_CACHE_SIZE         (BOOT_APP_PACKET_MAX_SIZE + BOOT_FRAME_FIXED_SIZE)
+
+/* 完成帧（与 Bootloader 一致），暂存模式下必须携带摘要 */
+#define FINISH_EXT_LEN            (46U + APP_FRAME_ADDR_LEN)    // 55 AA [ver 4B] [date 4B] [sha256 32B] FF FB 55 55
+#define FINISH_EXT_BYTE1          0xFBU
+#define FINISH_SIGNED_LEN         (110U + APP_FRAME_ADDR_LEN)   // 55 AA [ver 4B] [date 4B] [sha256 32B] [sig 64B] FF FA 55 55
+#define FINISH_SIGNED_BYTE1       0xFAU
+
+/* 主记录：flag/version/date/sign_state + 摘要 + 签名，清除暂存记录时原样恢复 */
+#define APP_PRIMARY_RECORD_SIZE   0x70U
+#define APP_STAGING_RECORD_SIZE   0x70U
+#else
+#define APP_RX_CACHE_SIZE         (CMD_QUERY_VERSION_LEN * 2)  // 最大命令长度的2倍
+#endif
 
 /* ACK 应答帧 */
 static const uint8_t g_boot_ack[] = {0x55U, 0xAAU, 0xFFU, 0xFEU, 0x55U, 0x55U};
@@ -49,13 +110,58 @@ typedef enum {
     BL_APP_CMD_NONE = 0,
     BL_APP_CMD_QUERY_VERSION = 1,
     BL_APP_CMD_QUERY_DATE = 2,
-    BL_APP_CMD_START_FLASH = 3
+    BL_APP_CMD_START_FLASH = 3,
+    BL_APP_CMD_STAGE_DATA = 4,
+    BL_APP_CMD_STAGE_FINISH = 5,
+    BL_APP_CMD_GATEWAY_TARGET = 6,
+    BL_APP_CMD_GATEWAY_STATUS = 7
 } bl_app_cmd_t;
 
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+/* 后台接收状态 */
+typedef enum {
+    APP_STAGE_IDLE,           // 未开始
+    APP_STAGE_RECEIVING,      // 接收数据帧并写入暂存区
+    APP_STAGE_WAIT_FINISH,    // 数据写完，等待完成帧
+} app_stage_state_t;
+
+/* 暂存记录，布局与 Flash 中一致 */
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t version;
+    uint32_t date;
+    uint8_t  digest[BOOT_SHA256_DIGEST_SIZE];
+    uint8_t  signature[64];
+} app_staging_record_t;
+
+typedef struct {
+    app_stage_state_t state;
+    uint8_t  buf[BOOT_APP_PACKET_MAX_SIZE + 4U];  // 上一帧未对齐的尾部 + 本帧数据
+    uint32_t buf_len;                           // 本帧需要写入的字节数（已含尾部）
+    uint32_t buf_pos;                           // 已写入字节数，< write_len 表示有帧待写
+    uint32_t write_len;                         // 本帧可写的 4 字节对齐部分
+    bool     last_frame;
+    uint32_t write_addr;
+    uint32_t erased_end;                        // 已擦除区域的结束地址
+    uint32_t image_size;
+    uint32_t last_frame_tick;
+    boot_sha256_ctx_t sha;
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+    uint8_t  target_mask;                       // 非 0 时本次接收的固件转发给这些子节点
+#endif
+} app_staging_t;
+#endif
+
 /* APP 上下文结构体 */
 typedef struct {
-    uint8_t  rx_cache[CMD_QUERY_VERSION_LEN * 2];  // 线性解析缓存（最大命令长度的2倍）
+    uint8_t  rx_cache[APP_RX_CACHE_SIZE];    // 线性解析缓存
     uint16_t rx_cache_len;
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+    app_staging_t stage;
+    uint32_t frame_remaining;               // 最近解析出的数据帧剩余字节
+    uint16_t frame_payload_len;
+#endif
 
     uint32_t boot_flag;
     uint32_t app_version;
@@ -65,12 +171,16 @@ typedef struct {
 
 static bootloader_app_context_t g_app_ctx;
 static const boot_app_ops_t *g_boot_app_ops;
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+static uint8_t g_app_node_addr;         // 本节点总线地址
+#endif
 
 /* 内部函数声明 */
 static void app_reset_context(void);
 static void app_read_flag_region(void);
 static void app_poll_data(void);
 static void app_consume_cache(uint16_t count);
+static bool app_seek_frame(uint16_t min_len);
 static bl_app_cmd_t app_check_dataframe(void);
 static void app_handle_query_version(void);
 static void app_handle_query_date(void);
@@ -78,6 +188,29 @@ static void app_handle_start_flash(void);
 static boot_port_app_status_t app_write_flag_only(uint32_t flag);
 static void app_send_string(const char *str);
 static void app_uint_to_str(uint32_t value, char *buf, uint8_t width);
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+typedef enum {
+    APP_PARSE_NONE,           // 不是该类型的帧
+    APP_PARSE_NEED_MORE,      // 可能是，但数据未收全
+    APP_PARSE_FOUND,
+} app_parse_result_t;
+
+static app_parse_result_t app_try_data_frame(void);
+static app_parse_result_t app_try_finish_frame(void);
+static void app_stage_reset(void);
+static void app_stage_poll(void);
+static void app_handle_stage_data(void);
+static void app_handle_stage_finish(void);
+static boot_port_app_status_t app_stage_begin(void);
+static boot_port_app_status_t app_restore_primary_record(void);
+static boot_port_app_status_t app_write_staging_record(const app_staging_record_t *record, bool has_signature);
+#endif
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+static app_parse_result_t app_try_gateway_frame(bl_app_cmd_t *cmd);
+static void app_handle_gateway_target(void);
+static void app_handle_gateway_status(void);
+static void app_gateway_forward(const app_staging_record_t *record, bool has_signature);
+#endif
 
 boot_port_app_status_t easy_bootloader_app_init(const boot_app_ops_t *ops)
 {
@@ -95,15 +228,28 @@ boot_port_app_status_t easy_bootloader_app_init(const boot_app_ops_t *ops)
     }
 
     g_boot_app_ops = ops;
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+    g_app_node_addr = (ops->node_addr != 0U) ? ops->node_addr : (uint8_t)BOOT_APP_NODE_ADDR;
+#endif
 
     BOOT_APP_LOG("=== Easy Bootloader APP Start ===\r\n");
 
     app_reset_context();
     app_read_flag_region();
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+    boot_gateway_init(ops);
+#endif
 
     BOOT_APP_LOG("Current Version: 0x%08X, Date: 0x%08X\r\n",
                  g_app_ctx.app_version, g_app_ctx.update_date);
 
+    const boot_app_handoff_t *handoff = easy_bootloader_app_get_handoff();
+    if (handoff != NULL) {
+        BOOT_APP_LOG("Boot residency: %lu cycles (%s)\r\n",
+                     (unsigned long)(handoff->stamp[BOOT_APP_STAGE_JUMP] - handoff->stamp[BOOT_APP_STAGE_RESET]),
+                     (handoff->boot_flags & BOOT_APP_HANDOFF_FLAG_FAST) ? "fast" : "normal");
+    }
+
     g_app_ctx.initialized = true;
     BOOT_APP_LOG("APP ready, waiting for commands...\r\n");
 
@@ -118,6 +264,25 @@ void easy_bootloader_app_run(void)
 
     app_poll_data();
 
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+    boot_gateway_poll();
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+    /* 上一帧尚未写完时只推进写入，不解析新帧（ACK 在写完后发出，形成流控） */
+    if (g_app_ctx.stage.buf_pos < g_app_ctx.stage.write_len) {
+        app_stage_poll();
+        return;
+    }
+
+    /* 传输中断超时，放弃本次后台接收 */
+    if (g_app_ctx.stage.state != APP_STAGE_IDLE && g_boot_app_ops->get_tick != NULL &&
+        (uint32_t)(g_boot_app_ops->get_tick() - g_app_ctx.stage.last_frame_tick) > BOOT_APP_UART_TIMEOUT_MS) {
+        BOOT_APP_LOG("Staging timeout, transfer dropped\r\n");
+        app_stage_reset();
+    }
+#endif
+
     bl_app_cmd_t cmd = app_check_dataframe();
 
     switch (cmd) {
@@ -133,12 +298,47 @@ void easy_bootloader_app_run(void)
             app_handle_start_flash();
             break;
 
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+        case BL_APP_CMD_STAGE_DATA:
+            app_handle_stage_data();
+            break;
+
+        case BL_APP_CMD_STAGE_FINISH:
+            app_handle_stage_finish();
+            break;
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+        case BL_APP_CMD_GATEWAY_TARGET:
+            app_handle_gateway_target();
+            break;
+
+        case BL_APP_CMD_GATEWAY_STATUS:
+            app_handle_gateway_status();
+            break;
+#endif
+
         case BL_APP_CMD_NONE:
         default:
             break;
     }
 }
 
+/**
+ * @brief 获取 Bootloader 交接区
+ * @return 交接区指针，Bootloader 未写入（魔数不符）时返回 NULL
+ * @note  Cortex-M 下 Bootloader 保持 DWT 计数器运行，APP 可继续读取
+ *        DWT->CYCCNT 与 stamp[BOOT_APP_STAGE_JUMP] 相减得到跳转耗时
+ */
+const boot_app_handoff_t *easy_bootloader_app_get_handoff(void)
+{
+    const boot_app_handoff_t *handoff = (const boot_app_handoff_t *)BOOT_APP_HANDOFF_ADDR;
+    if (handoff->magic != BOOT_APP_HANDOFF_MAGIC) {
+        return NULL;
+    }
+    return handoff;
+}
+
 static void app_reset_context(void)
 {
     memset(&g_app_ctx, 0, sizeof(g_app_ctx));
@@ -187,52 +387,150 @@ static void app_consume_cache(uint16_t count)
     g_app_ctx.rx_cache_len = remain;
 }
 
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
 /**
- * @brief 解析数据帧，识别命令类型
- * @return 命令类型
+ * @brief 发给其他节点的帧：已整帧收到且按数据帧布局能对上帧尾时整帧跳过（不做校验和累加），
+ *        否则只跳过帧头与地址，从后面继续找帧头
  */
-static bl_app_cmd_t app_check_dataframe(void)
+static uint16_t app_foreign_frame_size(const uint8_t *buf, uint16_t len)
 {
-    /* 最小帧长度检查 */
-    if (g_app_ctx.rx_cache_len < CMD_QUERY_VERSION_LEN) {
-        return BL_APP_CMD_NONE;
+    if (len >= BOOT_FRAME_FIXED_SIZE) {
+        uint32_t frame_size = BOOT_FRAME_FIXED_SIZE +
+                              (((uint32_t)buf[APP_FRAME_BODY + 3U] << 8) | buf[APP_FRAME_BODY + 4U]);
+        if (frame_size <= len &&
+            buf[frame_size - 2U] == BOOT_FRAME_TAIL0 && buf[frame_size - 1U] == BOOT_FRAME_TAIL1) {
+            return (uint16_t)frame_size;
+        }
     }
+    return APP_FRAME_BODY;
+}
 
-    /* 查找帧头 */
-    while (g_app_ctx.rx_cache_len >= CMD_QUERY_VERSION_LEN) {
-        if (g_app_ctx.rx_cache[0] != BOOT_FRAME_HEADER0 ||
-            g_app_ctx.rx_cache[1] != BOOT_FRAME_HEADER1) {
-            app_consume_cache(1U);
-            continue;
+static void app_send_scan_reply(void)
+{
+    uint8_t reply[CMD_SCAN_REPLY_LEN] = {BOOT_FRAME_HEADER0, BOOT_FRAME_HEADER1, CMD_SCAN_BYTE0, CMD_SCAN_BYTE1};
+    reply[4] = g_app_node_addr;
+    reply[5] = CMD_SCAN_STATE_APP;
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+    reply[5] |= (uint8_t)g_app_ctx.stage.state;
+#endif
+    reply[6] = (uint8_t)(g_app_ctx.app_version >> 24);
+    reply[7] = (uint8_t)(g_app_ctx.app_version >> 16);
+    reply[8] = (uint8_t)(g_app_ctx.app_version >> 8);
+    reply[9] = (uint8_t)g_app_ctx.app_version;
+    reply[10] = BOOT_FRAME_TAIL0;
+    reply[11] = BOOT_FRAME_TAIL1;
+    g_boot_app_ops->boot_port_app_data_write(reply, sizeof(reply));
+}
+#endif
+
+/**
+ * @brief 丢弃缓存头部的无关字节，直到缓存以（发给本节点的）帧头开始
+ * @param min_len 候选帧至少需要的字节数
+ * @return 缓存头部是候选帧且已收到 min_len 字节时返回 true
+ * @note  地址模式下，地址不符的帧直接跳过，不做校验；总线扫描探测帧在这里应答
+ */
+static bool app_seek_frame(uint16_t min_len)
+{
+    for (;;) {
+        const uint8_t *buf = g_app_ctx.rx_cache;
+        uint16_t len = g_app_ctx.rx_cache_len;
+
+        /* 先定位下一个帧头再一次性前移，避免逐字节 memmove */
+        uint16_t drop = 0U;
+        while (drop + 1U < len && (buf[drop] != BOOT_FRAME_HEADER0 || buf[drop + 1U] != BOOT_FRAME_HEADER1)) {
+            drop++;
         }
 
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+        if (drop == 0U && len > APP_FRAME_BODY) {
+            if (buf[2] != g_app_node_addr) {
+                drop = app_foreign_frame_size(buf, len);
+            } else if (len >= CMD_SCAN_LEN &&
+                       buf[3] == CMD_SCAN_BYTE0 && buf[4] == CMD_SCAN_BYTE1 &&
+                       buf[5] == BOOT_FRAME_TAIL0 && buf[6] == BOOT_FRAME_TAIL1) {
+                drop = CMD_SCAN_LEN;
+                app_send_scan_reply();
+            }
+        }
+#endif
+        if (drop == 0U) {
+            return len >= min_len;
+        }
+        app_consume_cache(drop);
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+        /* 总线上发给其他节点的数据远多于发给本节点的，丢弃后立即补读，避免移植层接收缓冲积压 */
+        app_poll_data();
+#endif
+    }
+}
+
+/**
+ * @brief 解析数据帧，识别命令类型
+ * @return 命令类型
+ */
+static bl_app_cmd_t app_check_dataframe(void)
+{
+    /* 查找帧头（及本节点地址），最小帧长度为命令帧长度 */
+    while (app_seek_frame(CMD_QUERY_VERSION_LEN)) {
+        const uint8_t *body = &g_app_ctx.rx_cache[APP_FRAME_BODY];
+
         /* 检查查询版本命令: 55 AA FF DD 55 55 (6字节) */
-        if (g_app_ctx.rx_cache[2] == CMD_QUERY_VERSION_BYTE0 &&
-            g_app_ctx.rx_cache[3] == CMD_QUERY_VERSION_BYTE1 &&
-            g_app_ctx.rx_cache[4] == BOOT_FRAME_TAIL0 &&
-            g_app_ctx.rx_cache[5] == BOOT_FRAME_TAIL1) {
+        if (body[0] == CMD_QUERY_VERSION_BYTE0 &&
+            body[1] == CMD_QUERY_VERSION_BYTE1 &&
+            body[2] == BOOT_FRAME_TAIL0 &&
+            body[3] == BOOT_FRAME_TAIL1) {
             app_consume_cache(CMD_QUERY_VERSION_LEN);
             return BL_APP_CMD_QUERY_VERSION;
         }
 
         /* 检查查询更新时间命令: 55 AA FF CC 55 55 (6字节) */
-        if (g_app_ctx.rx_cache[2] == CMD_QUERY_DATE_BYTE0 &&
-            g_app_ctx.rx_cache[3] == CMD_QUERY_DATE_BYTE1 &&
-            g_app_ctx.rx_cache[4] == BOOT_FRAME_TAIL0 &&
-            g_app_ctx.rx_cache[5] == BOOT_FRAME_TAIL1) {
+        if (body[0] == CMD_QUERY_DATE_BYTE0 &&
+            body[1] == CMD_QUERY_DATE_BYTE1 &&
+            body[2] == BOOT_FRAME_TAIL0 &&
+            body[3] == BOOT_FRAME_TAIL1) {
             app_consume_cache(CMD_QUERY_DATE_LEN);
             return BL_APP_CMD_QUERY_DATE;
         }
 
         /* 检查触发升级命令: 55 AA FF EE 55 55 (6字节，简化版) */
-        if (g_app_ctx.rx_cache[2] == CMD_START_FLASH_BYTE0 &&
-            g_app_ctx.rx_cache[3] == CMD_START_FLASH_BYTE1 &&
-            g_app_ctx.rx_cache[4] == BOOT_FRAME_TAIL0 &&
-            g_app_ctx.rx_cache[5] == BOOT_FRAME_TAIL1) {
+        if (body[0] == CMD_START_FLASH_BYTE0 &&
+            body[1] == CMD_START_FLASH_BYTE1 &&
+            body[2] == BOOT_FRAME_TAIL0 &&
+            body[3] == BOOT_FRAME_TAIL1) {
             app_consume_cache(CMD_START_FLASH_LEN);
             return BL_APP_CMD_START_FLASH;
         }
 
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+        bl_app_cmd_t gateway_cmd;
+        app_parse_result_t gateway_result = app_try_gateway_frame(&gateway_cmd);
+        if (gateway_result == APP_PARSE_FOUND) {
+            return gateway_cmd;
+        }
+        if (gateway_result == APP_PARSE_NEED_MORE) {
+            return BL_APP_CMD_NONE;
+        }
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+        /* 后台升级：等待完成帧时识别完成帧，否则识别数据帧（剩余字节数高字节不会是 0xFF） */
+        app_parse_result_t result;
+        bl_app_cmd_t found;
+        if (g_app_ctx.stage.state == APP_STAGE_WAIT_FINISH) {
+            result = app_try_finish_frame();
+            found = BL_APP_CMD_STAGE_FINISH;
+        } else {
+            result = app_try_data_frame();
+            found = BL_APP_CMD_STAGE_DATA;
+        }
+        if (result == APP_PARSE_FOUND) {
+            return found;
+        }
+        if (result == APP_PARSE_NEED_MORE) {
+            return BL_APP_CMD_NONE;
+        }
+#endif
+
         /* 帧头匹配但命令不匹配，跳过帧头继续查找 */
         app_consume_cache(2U);
     }
@@ -388,3 +686,425 @@ static boot_port_app_status_t app_write_flag_only(uint32_t flag)
 
     return g_boot_app_ops->boot_port_app_flash_write(BOOT_APP_FLAG_ADDR, buf, 4U);
 }
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING
+/**
+ * @brief 尝试解析数据帧，成功时数据追加到暂存写缓冲
+ */
+static app_parse_result_t app_try_data_frame(void)
+{
+    const uint8_t *body = &g_app_ctx.rx_cache[APP_FRAME_BODY];
+    if (body[0] == 0xFFU) {
+        return APP_PARSE_NONE;
+    }
+    if (g_app_ctx.rx_cache_len < APP_FRAME_BODY + 5U) {
+        return APP_PARSE_NEED_MORE;
+    }
+
+    uint32_t remain = ((uint32_t)body[0] << 16) |
+                      ((uint32_t)body[1] << 8) |
+                      body[2];
+    uint16_t packet_len = ((uint16_t)body[3] << 8) | body[4];
+    if (packet_len > BOOT_APP_PACKET_MAX_SIZE) {
+        return APP_PARSE_NONE;
+    }
+
+    uint32_t frame_size = BOOT_FRAME_FIXED_SIZE + packet_len;
+    if (g_app_ctx.rx_cache_len < frame_size) {
+        return APP_PARSE_NEED_MORE;
+    }
+
+    uint32_t checksum_pos = APP_FRAME_BODY + 5U + packet_len;
+    uint16_t received_crc = ((uint16_t)g_app_ctx.rx_cache[checksum_pos] << 8) |
+                            g_app_ctx.rx_cache[checksum_pos + 1U];
+    uint16_t calc_crc = 0U;
+#if BOOT_APP_CONFIG_ENABLE_ADDRESS
+    calc_crc = g_app_ctx.rx_cache[2];   // 地址字节参与校验
+#endif
+    for (uint32_t idx = APP_FRAME_BODY + 3U; idx < checksum_pos; idx++) {
+        calc_crc += g_app_ctx.rx_cache[idx];
+    }
+    if (calc_crc != received_crc ||
+        g_app_ctx.rx_cache[checksum_pos + 2U] != BOOT_FRAME_TAIL0 ||
+        g_app_ctx.rx_cache[checksum_pos + 3U] != BOOT_FRAME_TAIL1) {
+        return APP_PARSE_NONE;
+    }
+
+    app_staging_t *stage = &g_app_ctx.stage;
+    memcpy(&stage->buf[stage->buf_len], &body[5], packet_len);
+    g_app_ctx.frame_remaining = remain;
+    g_app_ctx.frame_payload_len = packet_len;
+    app_consume_cache((uint16_t)frame_size);
+    return APP_PARSE_FOUND;
+}
+
+/**
+ * @brief 尝试解析完成帧，成功时帧保留在 rx_cache 头部，由处理函数消费
+ */
+static app_parse_result_t app_try_finish_frame(void)
+{
+    static const struct {
+        uint16_t len;
+        uint8_t  cmd1;
+    } formats[] = {
+        {FINISH_EXT_LEN,    FINISH_EXT_BYTE1},
+        {FINISH_SIGNED_LEN, FINISH_SIGNED_BYTE1},
+    };
+
+    for (uint32_t i = 0U; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        uint16_t len = formats[i].len;
+        if (g_app_ctx.rx_cache_len < len) {
+            return APP_PARSE_NEED_MORE;
+        }
+        if (g_app_ctx.rx_cache[len - 4U] == 0xFFU &&
+            g_app_ctx.rx_cache[len - 3U] == formats[i].cmd1 &&
+            g_app_ctx.rx_cache[len - 2U] == BOOT_FRAME_TAIL0 &&
+            g_app_ctx.rx_cache[len - 1U] == BOOT_FRAME_TAIL1) {
+            g_app_ctx.frame_payload_len = len;
+            return APP_PARSE_FOUND;
+        }
+    }
+    return APP_PARSE_NONE;
+}
+
+static void app_stage_reset(void)
+{
+    memset(&g_app_ctx.stage, 0, sizeof(g_app_ctx.stage));
+    g_app_ctx.stage.state = APP_STAGE_IDLE;
+}
+
+/**
+ * @brief 开始一次后台接收：清除上次残留的暂存记录，暂存区改为边写边擦
+ */
+static boot_port_app_status_t app_stage_begin(void)
+{
+    uint32_t words[APP_STAGING_RECORD_SIZE / 4U];
+    if (g_boot_app_ops->boot_port_app_flash_read(BOOT_APP_STAGING_RECORD_ADDR, (uint8_t *)words,
+                                                 sizeof(words)) != BOOT_PORT_APP_OK) {
+        return BOOT_PORT_APP_ERROR;
+    }
+    for (uint32_t i = 0U; i < APP_STAGING_RECORD_SIZE / 4U; i++) {
+        if (words[i] != BOOT_FLAG_ERASED) {
+            BOOT_APP_LOG("Clearing stale staging record\r\n");
+            if (app_restore_primary_record() != BOOT_PORT_APP_OK) {
+                return BOOT_PORT_APP_ERROR;
+            }
+            break;
+        }
+    }
+
+    g_app_ctx.stage.state = APP_STAGE_RECEIVING;
+    g_app_ctx.stage.buf_len = 0U;
+    g_app_ctx.stage.image_size = 0U;
+    g_app_ctx.stage.write_addr = BOOT_APP_STAGING_ADDR;
+    g_app_ctx.stage.erased_end = BOOT_APP_STAGING_ADDR;
+    boot_sha256_init(&g_app_ctx.stage.sha);
+    BOOT_APP_LOG("Background download started\r\n");
+    return BOOT_PORT_APP_OK;
+}
+
+/**
+ * @brief 处理数据帧：数据已在 stage.buf 中，这里只做校验与记账，实际写入由 app_stage_poll 分批完成
+ */
+static void app_handle_stage_data(void)
+{
+    app_staging_t *stage = &g_app_ctx.stage;
+    uint16_t payload_len = g_app_ctx.frame_payload_len;
+
+    if (stage->state != APP_STAGE_RECEIVING) {
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+        /* 暂存区中的固件正在转发给子节点，不能覆盖 */
+        if (boot_gateway_busy()) {
+            BOOT_APP_LOG("Gateway busy, transfer rejected\r\n");
+            return;
+        }
+#endif
+        /* 新的传输（空闲时 buf_len 为 0，本帧数据位于 buf 起始处，app_stage_begin 不会覆盖） */
+        if (app_stage_begin() != BOOT_PORT_APP_OK) {
+            BOOT_APP_LOG("Staging start failed\r\n");
+            app_stage_reset();
+            return;
+        }
+    }
+
+    uint32_t total = stage->buf_len + payload_len;
+    uint32_t aligned = (total + 3U) & ~0x3U;
+    if (stage->write_addr + aligned > BOOT_APP_STAGING_ADDR + BOOT_APP_STAGING_SIZE) {
+        BOOT_APP_LOG("Staging slot overflow\r\n");
+        app_stage_reset();
+        return;
+    }
+
+    boot_sha256_update(&stage->sha, &stage->buf[stage->buf_len], payload_len);
+    stage->image_size += payload_len;
+    stage->buf_len = total;
+    stage->last_frame = (g_app_ctx.frame_remaining == 0U);
+    if (stage->last_frame) {
+        /* 最后一帧补齐到 4 字节，填充擦除值 */
+        memset(&stage->buf[total], 0xFF, aligned - total);
+        stage->buf_len = aligned;
+    }
+    stage->write_len = stage->buf_len & ~0x3U;
+    stage->buf_pos = 0U;
+    if (g_boot_app_ops->get_tick != NULL) {
+        stage->last_frame_tick = g_boot_app_ops->get_tick();
+    }
+    app_stage_poll();
+}
+
+/**
+ * @brief 推进暂存区写入，每次调用最多擦除一个单元或写入 BOOT_APP_STAGING_WRITE_BUDGET 字节
+ */
+static void app_stage_poll(void)
+{
+    app_staging_t *stage = &g_app_ctx.stage;
+
+    if (stage->write_addr >= stage->erased_end) {
+        if (g_boot_app_ops->boot_port_app_flash_erase(stage->erased_end, BOOT_APP_STAGING_ERASE_UNIT) != BOOT_PORT_APP_OK) {
+            BOOT_APP_LOG("Staging erase failed\r\n");
+            app_stage_reset();
+            return;
+        }
+        stage->erased_end += BOOT_APP_STAGING_ERASE_UNIT;
+        return;
+    }
+
+    uint32_t chunk = stage->write_len - stage->buf_pos;
+    if (chunk > BOOT_APP_STAGING_WRITE_BUDGET) {
+        chunk = BOOT_APP_STAGING_WRITE_BUDGET;
+    }
+    if (chunk > stage->erased_end - stage->write_addr) {
+        chunk = stage->erased_end - stage->write_addr;
+    }
+    if (chunk > 0U) {
+        if (g_boot_app_ops->boot_port_app_flash_write(stage->write_addr, &stage->buf[stage->buf_pos], chunk) != BOOT_PORT_APP_OK) {
+            BOOT_APP_LOG("Staging write failed\r\n");
+            app_stage_reset();
+            return;
+        }
+        stage->write_addr += chunk;
+        stage->buf_pos += chunk;
+    }
+    if (stage->buf_pos < stage->write_len) {
+        return;
+    }
+
+    /* 本帧写完：未对齐的尾部留到下一帧，随后应答 */
+    uint32_t tail = stage->buf_len - stage->write_len;
+    memmove(stage->buf, &stage->buf[stage->write_len], tail);
+    stage->buf_len = tail;
+    stage->buf_pos = 0U;
+    stage->write_len = 0U;
+    if (stage->last_frame) {
+        stage->state = APP_STAGE_WAIT_FINISH;
+        BOOT_APP_LOG("Staging data complete, %lu bytes\r\n", (unsigned long)stage->image_size);
+    }
+    g_boot_app_ops->boot_port_app_data_write(g_boot_ack, sizeof(g_boot_ack));
+}
+
+/**
+ * @brief 处理完成帧：摘要一致后写入暂存记录并复位，由 Bootloader 安装
+ */
+static void app_handle_stage_finish(void)
+{
+    app_staging_t *stage = &g_app_ctx.stage;
+    uint16_t frame_len = g_app_ctx.frame_payload_len;
+    app_staging_record_t record;
+    uint8_t calc_digest[BOOT_SHA256_DIGEST_SIZE];
+
+    const uint8_t *body = &g_app_ctx.rx_cache[APP_FRAME_BODY];
+
+    record.version = ((uint32_t)body[0] << 24) | ((uint32_t)body[1] << 16) |
+                     ((uint32_t)body[2] << 8) | (uint32_t)body[3];
+    record.date = ((uint32_t)body[4] << 24) | ((uint32_t)body[5] << 16) |
+                  ((uint32_t)body[6] << 8) | (uint32_t)body[7];
+    memcpy(record.digest, &body[8], BOOT_SHA256_DIGEST_SIZE);
+    bool has_signature = (frame_len == FINISH_SIGNED_LEN);
+    if (has_signature) {
+        memcpy(record.signature, &body[8U + BOOT_SHA256_DIGEST_SIZE], sizeof(record.signature));
+    }
+    app_consume_cache(frame_len);
+
+    boot_sha256_final(&stage->sha, calc_digest);
+    if (memcmp(calc_digest, record.digest, BOOT_SHA256_DIGEST_SIZE) != 0) {
+        BOOT_APP_LOG("Staged image digest mismatch, dropped\r\n");
+        app_stage_reset();
+        return;
+    }
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+    if (stage->target_mask != 0U) {
+        app_gateway_forward(&record, has_signature);
+        return;
+    }
+#endif
+
+    record.magic = BOOT_APP_STAGING_MAGIC;
+    record.size = stage->image_size;
+    if (app_write_staging_record(&record, has_signature) != BOOT_PORT_APP_OK) {
+        BOOT_APP_LOG("Write staging record failed\r\n");
+        app_stage_reset();
+        return;
+    }
+
+    BOOT_APP_LOG("Staged ver=0x%08X verified, resetting to install...\r\n", record.version);
+    g_boot_app_ops->boot_port_app_data_write(g_boot_ack, sizeof(g_boot_ack));
+
+    /* 短暂延时确保 ACK 和日志发送完成 */
+    for (volatile uint32_t i = 0; i < 100000; i++);
+
+    g_boot_app_ops->boot_port_app_system_reset();
+}
+
+/**
+ * @brief 写入暂存记录，魔数最后写入，掉电时不会留下半条有效记录
+ */
+static boot_port_app_status_t app_write_staging_record(const app_staging_record_t *record, bool has_signature)
+{
+    const uint8_t *raw = (const uint8_t *)record;
+    uint32_t body_len = has_signature ? APP_STAGING_RECORD_SIZE : (APP_STAGING_RECORD_SIZE - sizeof(record->signature));
+
+    boot_port_app_status_t status = g_boot_app_ops->boot_port_app_flash_write(BOOT_APP_STAGING_RECORD_ADDR + 4U,
+                                                                              &raw[4], body_len - 4U);
+    if (status != BOOT_PORT_APP_OK) {
+        return status;
+    }
+    return g_boot_app_ops->boot_port_app_flash_write(BOOT_APP_STAGING_RECORD_ADDR, raw, 4U);
+}
+
+/**
+ * @brief 擦除标志位区并原样写回主记录，用于清除残留的暂存记录
+ */
+static boot_port_app_status_t app_restore_primary_record(void)
+{
+    uint32_t words[APP_PRIMARY_RECORD_SIZE / 4U];
+    boot_port_app_status_t status = g_boot_app_ops->boot_port_app_flash_read(BOOT_APP_FLAG_REGION_ADDR,
+                                                                             (uint8_t *)words, sizeof(words));
+    if (status != BOOT_PORT_APP_OK) {
+        return status;
+    }
+
+    status = g_boot_app_ops->boot_port_app_flash_erase(BOOT_APP_FLAG_REGION_ADDR, BOOT_APP_FLAG_REGION_SIZE);
+    if (status != BOOT_PORT_APP_OK) {
+        return status;
+    }
+
+    /* 只写回非擦除值的字 */
+    for (uint32_t i = 0U; i < APP_PRIMARY_RECORD_SIZE / 4U; i++) {
+        if (words[i] == BOOT_FLAG_ERASED) {
+            continue;
+        }
+        status = g_boot_app_ops->boot_port_app_flash_write(BOOT_APP_FLAG_REGION_ADDR + i * 4U,
+                                                           (const uint8_t *)&words[i], 4U);
+        if (status != BOOT_PORT_APP_OK) {
+            return status;
+        }
+    }
+    return BOOT_PORT_APP_OK;
+}
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+/**
+ * @brief 识别网关目标帧与进度查询帧，目标帧保留在 rx_cache 头部，由处理函数消费
+ */
+static app_parse_result_t app_try_gateway_frame(bl_app_cmd_t *cmd)
+{
+    const uint8_t *body = &g_app_ctx.rx_cache[APP_FRAME_BODY];
+    if (body[0] != CMD_GATEWAY_BYTE0) {
+        return APP_PARSE_NONE;
+    }
+
+    if (body[1] == CMD_GATEWAY_STATUS_BYTE1 &&
+        body[2] == BOOT_FRAME_TAIL0 && body[3] == BOOT_FRAME_TAIL1) {
+        app_consume_cache(CMD_GATEWAY_STATUS_LEN);
+        *cmd = BL_APP_CMD_GATEWAY_STATUS;
+        return APP_PARSE_FOUND;
+    }
+
+    if (body[1] == CMD_GATEWAY_TARGET_BYTE1) {
+        if (g_app_ctx.rx_cache_len < CMD_GATEWAY_TARGET_LEN) {
+            return APP_PARSE_NEED_MORE;
+        }
+        if (body[3] == BOOT_FRAME_TAIL0 && body[4] == BOOT_FRAME_TAIL1) {
+            *cmd = BL_APP_CMD_GATEWAY_TARGET;
+            return APP_PARSE_FOUND;
+        }
+    }
+    return APP_PARSE_NONE;
+}
+
+/**
+ * @brief 处理网关目标帧：记录下一次后台接收的转发目标，正在接收或转发时不应答
+ */
+static void app_handle_gateway_target(void)
+{
+    uint8_t mask = g_app_ctx.rx_cache[APP_FRAME_BODY + 2U];
+    app_consume_cache(CMD_GATEWAY_TARGET_LEN);
+
+    if (g_app_ctx.stage.state != APP_STAGE_IDLE || boot_gateway_busy() ||
+        (mask >> BOOT_APP_GATEWAY_CHILDREN) != 0U) {
+        BOOT_APP_LOG("Gateway target 0x%02X rejected\r\n", mask);
+        return;
+    }
+
+    g_app_ctx.stage.target_mask = mask;
+    BOOT_APP_LOG("Next image targets children 0x%02X\r\n", mask);
+    g_boot_app_ops->boot_port_app_data_write(g_boot_ack, sizeof(g_boot_ack));
+}
+
+/**
+ * @brief 应答各子节点的刷写状态与进度
+ */
+static void app_handle_gateway_status(void)
+{
+    uint8_t reply[GATEWAY_STATUS_REPLY_LEN] = {BOOT_FRAME_HEADER0, BOOT_FRAME_HEADER1,
+                                               CMD_GATEWAY_BYTE0, CMD_GATEWAY_STATUS_BYTE1};
+    uint32_t pos = 4U;
+
+    reply[pos++] = (uint8_t)BOOT_APP_GATEWAY_CHILDREN;
+    for (uint8_t i = 0U; i < BOOT_APP_GATEWAY_CHILDREN; i++) {
+        uint8_t percent;
+        reply[pos++] = (uint8_t)boot_gateway_child_state(i, &percent);
+        reply[pos++] = percent;
+    }
+    reply[pos++] = BOOT_FRAME_TAIL0;
+    reply[pos++] = BOOT_FRAME_TAIL1;
+    g_boot_app_ops->boot_port_app_data_write(reply, pos);
+}
+
+/**
+ * @brief 已校验的暂存固件交给网关转发：完成帧按原格式重组后原样发给子节点，本机不写暂存记录、不复位
+ */
+static void app_gateway_forward(const app_staging_record_t *record, bool has_signature)
+{
+    uint8_t finish[BOOT_GATEWAY_FINISH_MAX];
+    uint16_t len = 8U;
+
+    finish[0] = (uint8_t)(record->version >> 24);
+    finish[1] = (uint8_t)(record->version >> 16);
+    finish[2] = (uint8_t)(record->version >> 8);
+    finish[3] = (uint8_t)record->version;
+    finish[4] = (uint8_t)(record->date >> 24);
+    finish[5] = (uint8_t)(record->date >> 16);
+    finish[6] = (uint8_t)(record->date >> 8);
+    finish[7] = (uint8_t)record->date;
+    memcpy(&finish[len], record->digest, BOOT_SHA256_DIGEST_SIZE);
+    len += BOOT_SHA256_DIGEST_SIZE;
+    if (has_signature) {
+        memcpy(&finish[len], record->signature, sizeof(record->signature));
+        len += sizeof(record->signature);
+    }
+    finish[len++] = 0xFFU;
+    finish[len++] = has_signature ? FINISH_SIGNED_BYTE1 : FINISH_EXT_BYTE1;
+
+    if (boot_gateway_start(g_app_ctx.stage.target_mask, BOOT_APP_STAGING_ADDR, g_app_ctx.stage.image_size,
+                           finish, len)) {
+        BOOT_APP_LOG("Staged ver=0x%08X verified, forwarding to children\r\n", record->version);
+        g_boot_app_ops->boot_port_app_data_write(g_boot_ack, sizeof(g_boot_ack));
+    } else {
+        BOOT_APP_LOG("Gateway start failed\r\n");
+    }
+    app_stage_reset();
+}
+#endif
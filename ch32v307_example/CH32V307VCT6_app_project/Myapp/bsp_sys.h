@@ -9,6 +9,7 @@
 #include "mytimer.h"
 #include "scheduler.h"
 #include "myuart.h"
+#include "mycan.h"
 #include "easy_bootloader_app.h"
 
 #endif
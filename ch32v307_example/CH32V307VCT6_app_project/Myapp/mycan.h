@@ -0,0 +1,14 @@
+#ifndef MYCAN_H_
+#define MYCAN_H_
+
+#include "bsp_sys.h"
+
+#define CAN1_RX_QUEUE_SIZE     64U     // 接收帧队列，须为 2 的幂且不小于 ISO-TP 一块连续帧数
+
+
+void mycan1_init(uint32_t rx_id);
+int mycan1_send(uint32_t id, const uint8_t *data, uint8_t len);
+int mycan1_recv(uint32_t *id, uint8_t *data, uint8_t *len);
+
+
+#endif /* MYCAN_H_ */
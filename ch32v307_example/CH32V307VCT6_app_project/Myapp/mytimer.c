@@ -4,7 +4,7 @@
  --ʱ2ڲmsʱ
 
 */
-uint32_t  uwtick;
+volatile uint32_t  uwtick;
 void TIM6_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void TIM6_IRQHandler(void)
 {
@@ -56,3 +56,21 @@ uint32_t get_uwtick(void)
     return uwtick;
 }
 
+//΢ʱ TIM6 ֵ1MHzжδִУжϻȼжеãʱ 1ms
+uint32_t get_ustick(void)
+{
+    uint32_t ms;
+    uint32_t cnt;
+
+    do
+    {
+        ms = uwtick;
+        cnt = TIM6->CNT;
+        if (TIM_GetITStatus(TIM6, TIM_IT_Update) == SET)
+        {
+            cnt = TIM6->CNT + 1000U;
+        }
+    } while (ms != uwtick);
+    return ms * 1000U + cnt;
+}
+
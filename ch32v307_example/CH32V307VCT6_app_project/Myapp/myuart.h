@@ -2,16 +2,48 @@
 #define MYUART_H_
 
 #include "bsp_sys.h"
-#include "ringbuffer.h"
+#include "boot_ring.h"
 
-#define UART2_RX_BUFFER_SIZE   1024U
+#define UART2_RX_BUFFER_SIZE   4096U   // 循环 DMA 接收环，容纳 Flash 写入与调度间隔内连续到达的数据
+#define UART_TX_BUFFER_SIZE    256U    // DMA 发送缓冲，更长的数据分段发送
 
-extern struct rt_ringbuffer uart2_ringbuffer;
+/* 循环 DMA 接收环：DMA 为生产者，空闲中断与半满/全满中断按 DMA 写位置提交写入，读取方直接从 buf 取数据 */
+typedef struct {
+    DMA_Channel_TypeDef *channel;
+    uint8_t *buf;
+    uint16_t size;                      // 须为 2 的幂
+    boot_ring_t ring;
+    volatile uint8_t overrun;           // 未读数据被覆盖，读取方丢弃全部未读数据
+    volatile uint32_t lost;             // 覆盖次数，调试用
+} uart_dma_ring_t;
 
+/* DMA 发送：数据拷入 buf 后启动 DMA 立即返回，发送完成中断释放缓冲并调用 done */
+typedef struct {
+    USART_TypeDef *usart;
+    DMA_Channel_TypeDef *channel;
+    IRQn_Type irqn;
+    uint32_t tc_it;                     // 通道的传输完成中断标志，如 DMA1_IT_TC7
+    uint8_t buf[UART_TX_BUFFER_SIZE];
+    volatile uint8_t busy;
+    uint8_t enabled;                    // 未初始化 DMA 时按字节查询发送
+    void (*done)(void);                 // 发送完成回调，在中断中调用，可为 NULL
+} uart_dma_tx_t;
 
+extern uart_dma_ring_t uart2_rx_ring;
+extern uart_dma_tx_t uart1_tx;
+extern uart_dma_tx_t uart2_tx;
+
+
+void myuart1_init(void);
 void myuart2_init(void);
+void myuart_deinit(void);
 void uart2_task(void);
 int uart_printf(USART_TypeDef *USARTx, const char* format, ...);
 
+uint16_t uart_dma_ring_data_len(const uart_dma_ring_t *ring);
+uint16_t uart_dma_ring_read(uart_dma_ring_t *ring, uint8_t *buf, uint16_t max_len);
+void uart_dma_send(uart_dma_tx_t *tx, const uint8_t *data, uint32_t len);
+void uart_dma_flush(uart_dma_tx_t *tx);
+
 
 #endif /* MYUART_H_ */
@@ -2,56 +2,156 @@
 
 extern void bootloader_app_init(void);
 
-// 全局变量，用于存储任务数量
-uint8_t task_num;
-
+/*
+ * 事件驱动调度：中断里 scheduler_post 投递事件，任务在下一轮立即执行；
+ * rate_ms 不为 0 的任务同时按截止时间执行（超时、ACK 合并等与收数据无关的工作），每次执行后截止时间顺延。
+ * 一轮下来没有任务执行时 WFI 休眠，由任意中断唤醒
+ */
 typedef struct {
     void (*task_func)(void);
-    uint32_t rate_ms;
-    uint32_t last_run;
+    uint32_t rate_ms;                   // 截止周期(毫秒)，0 表示只由事件触发
+    uint32_t next_run;                  // 下次到期时间(毫秒)
+    volatile uint8_t pending;           // 事件已投递尚未执行
+    volatile uint32_t post_stamp;       // 第一次投递的时间戳
+    task_stats_t stats;
 } task_t;
 
 void printf_tick(void)
 {
     static uint32_t tick = 0;
     tick++;
-    printf("systick:%d\r\n", tick);
+    uart_printf(USART1, "systick:%d\r\n", tick);    // 与日志共用 USART1 的 DMA 发送，不能再用查询方式的 printf
 }
 
-// 静态任务数组，每个任务包含：任务函数、执行周期(毫秒)、上次运行时间(毫秒)
-static task_t scheduler_task[] =
+// 静态任务数组，下标为 task_id_t
+static task_t scheduler_task[TASK_NUM] =
 {
-    {easy_bootloader_app_run, 10, 0},
-    {printf_tick, 1000, 0},
+    [TASK_BOOTLOADER]  = {easy_bootloader_app_run, 10},  // 接收事件立即执行，10ms 截止用于网关等超时检查
+    [TASK_PRINTF_TICK] = {printf_tick, 1000},
 };
 
+static uint32_t scheduler_idle;
+
+/* 时间戳取 TIM6 微秒计数 */
+static uint32_t scheduler_stamp(void)
+{
+    return get_ustick();
+}
+
+static uint32_t scheduler_stamp_us(uint32_t delta)
+{
+    return delta;
+}
+
+static void scheduler_account(task_stats_t *stats, uint32_t latency_us, uint32_t run_us)
+{
+    stats->runs++;
+    stats->total_run_us += run_us;
+    if (latency_us > stats->max_latency_us)
+        stats->max_latency_us = latency_us;
+    if (run_us > stats->max_run_us)
+        stats->max_run_us = run_us;
+}
+
+/* 关中断后再确认没有事件才休眠：关全局中断时 WFI 仍会被 PFIC 中挂起的中断唤醒，开中断后中断立即执行，不会漏掉事件 */
+static void scheduler_sleep(void)
+{
+#if SCHEDULER_IDLE_SLEEP
+    __disable_irq();
+    for (uint8_t i = 0; i < TASK_NUM; i++)
+    {
+        if (scheduler_task[i].pending)
+        {
+            __enable_irq();
+            return;
+        }
+    }
+    uint32_t start = scheduler_stamp();
+    __WFI();
+    scheduler_idle += scheduler_stamp_us(scheduler_stamp() - start);
+    __enable_irq();
+#endif
+}
+
 /**
  * @brief 调度器初始化函数
- * 计算任务数组元素个数，并将其存储到 task_num 中
+ * 初始化时间戳、日志串口与所选链路，再初始化升级组件
  */
 void scheduler_init(void)
 {
-    task_num = sizeof(scheduler_task) / sizeof(task_t);
     mytim6_init();
+    myuart1_init();
+#if BOOT_APP_CONFIG_LINK_CAN
+    mycan1_init(BOOT_APP_CAN_RX_ID);
+#else
     myuart2_init();
+#endif
     __enable_irq();
     bootloader_app_init();
 }
 
+/**
+ * @brief 投递事件，可在中断中调用
+ * 同一任务执行前多次投递只执行一次，延迟从第一次投递算起
+ */
+void scheduler_post(task_id_t id)
+{
+    task_t *task = &scheduler_task[id];
+
+    if (!task->pending)
+    {
+        task->post_stamp = scheduler_stamp();
+        task->pending = 1;
+    }
+}
+
 /**
  * @brief 调度器运行函数
- * 遍历任务数组，检查是否有任务需要执行。如果当前时间已经超过任务执行周期，则执行该任务并更新上次运行时间
+ * 执行已投递事件或已到期的任务，都没有时休眠到下一个中断
  */
 void scheduler_run(void)
 {
-    for (uint8_t i = 0; i < task_num; i++)
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < TASK_NUM; i++)
     {
+        task_t *task = &scheduler_task[i];
         uint32_t now_time = get_uwtick();
+        uint32_t start = scheduler_stamp();
+        uint32_t latency_us;
 
-        if (now_time >= scheduler_task[i].rate_ms + scheduler_task[i].last_run)
+        if (task->pending)
+        {
+            latency_us = scheduler_stamp_us(start - task->post_stamp);
+            task->pending = 0;          // 先清标志再执行，执行期间到达的事件留到下一轮
+            task->stats.event_runs++;
+        }
+        else if (task->rate_ms != 0U && (int32_t)(now_time - task->next_run) >= 0)    // 按差值比较，tick 回绕后仍正确
         {
-            scheduler_task[i].last_run = now_time;
-            scheduler_task[i].task_func();
+            latency_us = (now_time - task->next_run) * 1000U;
         }
+        else
+        {
+            continue;
+        }
+
+        task->next_run = now_time + task->rate_ms;
+        task->task_func();
+        scheduler_account(&task->stats, latency_us, scheduler_stamp_us(scheduler_stamp() - start));
+        ran = 1;
     }
+
+    if (!ran)
+        scheduler_sleep();
+}
+
+const task_stats_t *scheduler_get_stats(task_id_t id)
+{
+    return &scheduler_task[id].stats;
+}
+
+/* 累计休眠时间，运行时间减去它即为 CPU 忙碌时间 */
+uint32_t scheduler_idle_us(void)
+{
+    return scheduler_idle;
 }
@@ -4,61 +4,209 @@
 
 #include <stdint.h>
 
+#define BOOT_CONFIG_PROFILE_TINY      0U      // 1精简构建：只保留点对点串口刷写，关闭下列全部可选功能，配合寄存器级移植层 boot_port_stm32f407_tiny.c（不依赖 HAL）使用 0按下列开关
+
+#if BOOT_CONFIG_PROFILE_TINY
+#define BOOT_CONFIG_ENABLE_LOG        0U
+#define BOOT_CONFIG_LOG_DEFERRED      0U
+#define BOOT_CONFIG_ENABLE_PROFILE    0U
+#define BOOT_CONFIG_ENABLE_FAST_BOOT  0U
+#define BOOT_CONFIG_ENABLE_SHA256     0U
+#define BOOT_CONFIG_ENABLE_SIGNATURE  0U
+#define BOOT_CONFIG_ENABLE_STAGING    0U
+#define BOOT_CONFIG_ENABLE_ADDRESS    0U
+#define BOOT_CONFIG_ENABLE_BROADCAST  0U
+#define BOOT_CONFIG_ENABLE_FEC        0U
+#define BOOT_CONFIG_LINK_CAN          0U
+#define BOOT_CONFIG_LINK_UDP          0U
+#define BOOT_CONFIG_ENABLE_RX_DIRECT  1U      // 直通路径不需要整帧缓存与 memmove
+#define BOOT_CONFIG_STATIC_PORT       1U      // 热路径直接内联寄存器级移植层
+#define BOOT_CONFIG_DMA_READ          0U
+#else
 #define BOOT_CONFIG_ENABLE_LOG        1U      // 1启用日志输出 0禁用日志输出
+#define BOOT_CONFIG_LOG_DEFERRED      1U      // 1日志只记录格式串地址与原始参数，由 ops.log_write 在主循环中非阻塞发出，上位机 boot_log_decode.py 按固件 ELF 还原（核心不再依赖 stdio） 0经 ops.log 格式化后发送
+#define BOOT_CONFIG_ENABLE_PROFILE    1U      // 1启用启动耗时打点（结果经交接区传给 APP） 0禁用
+#define BOOT_CONFIG_ENABLE_FAST_BOOT  1U      // 1启用快速跳转（flag=APP 时跳过日志与外设初始化） 0禁用
+#define BOOT_CONFIG_ENABLE_SHA256     1U      // 1接收时流式计算 SHA-256，完成帧摘要一致才写 flag 0禁用
+#define BOOT_CONFIG_ENABLE_SIGNATURE  0U      // 1完成帧须携带 Ed25519 签名，校验结果缓存在标志位区（依赖 SHA-256） 0禁用
+#define BOOT_CONFIG_ENABLE_STAGING    0U      // 1启用暂存区，APP 后台接收的新固件在复位后由 Bootloader 校验并安装（依赖 SHA-256） 0禁用
+#define BOOT_CONFIG_ENABLE_ADDRESS    0U      // 1多点总线（RS-485）模式：帧头后带节点地址，只处理发给本节点的帧 0禁用
+#define BOOT_CONFIG_ENABLE_BROADCAST  0U      // 1广播升级：地址 0x00 的帧所有节点同时接收，按位图补发丢帧（依赖多点总线与 SHA-256） 0禁用
+#define BOOT_CONFIG_ENABLE_FEC        0U      // 1前向纠错传输：单向链路按组发送数据帧与 RS 校验帧，收齐后自动校验提交（依赖 SHA-256） 0禁用
+#define BOOT_CONFIG_LINK_CAN          0U      // 1升级链路使用 CAN1 + ISO-TP（PB8/PB9 500kbps） 0使用 USART2
+#define BOOT_CONFIG_LINK_UDP          0U      // 1升级链路使用内置 10M 以太网 + UDP（与 CAN 二选一） 0使用 USART2
+#define BOOT_CONFIG_ENABLE_RX_DIRECT  0U      // 1数据帧直接在串口 DMA 接收环中校验并写 Flash，核心不再保留整帧缓存（仅点对点串口，需 ops.rx_peek/rx_consume） 0拷入核心缓存解析
+#define BOOT_CONFIG_STATIC_PORT       0U      // 1读写 Flash、收发数据、tick 等热路径编译期绑定到 BOOT_STATIC_PORT_HEADER 中的 static inline 实现（可内联，全部实例共用同一移植层） 0经 ops 函数指针调用
+#define BOOT_CONFIG_DMA_READ          0U      // 1整段摘要与擦除检查读 Flash 由 DMA2 Stream1 存储器到存储器传输完成，与 CPU 处理上一块重叠（F407 移植层的 ops.flash_read_start/wait） 0 CPU 拷贝
+#endif
+
+#if BOOT_CONFIG_PROFILE_TINY || BOOT_CONFIG_STATIC_PORT || BOOT_CONFIG_DMA_READ
+#error "BOOT_CONFIG_PROFILE_TINY / STATIC_PORT / DMA_READ need the STM32F407 port, keep them 0 on CH32V307"
+#endif
 
 /*
  * CPU 架构选择
+ * 移植时根据目标 MCU 修改
  */
-#define BOOT_ARCH_ARM_CORTEX_M        1U
-#define BOOT_ARCH_RISCV               2U
+#define BOOT_ARCH_ARM_CORTEX_M        1U      // ARM Cortex-M (STM32, GD32 等)
+#define BOOT_ARCH_RISCV               2U      // RISC-V (CH32V 等)
 
 #define BOOT_ARCH                     BOOT_ARCH_RISCV  // 当前架构
 
 /*
- * Flash 布局（CH32V 采用 0x00000000 别名地址映射到物理 0x08000000）
+ * Flash / RAM 布局（Bootloader、APP、暂存区、标志位区、SRAM 范围、交接区与扇区大小，Flash 使用 0x00000000 别名地址）
+ * 由 ch32v307_example/memmap.json 经 PC tool/source/memmap_gen.py 生成，同时生成 APP 侧 boot_memmap_app.h 与两侧 Link.ld 中的 MEMORY 区域，
+ * 修改布局请改清单后重新生成，不要手工修改 boot_memmap.h
  */
-#define BOOT_BOOTLOADER_START_ADDR    0x00000000U       // 别名地址
-#define BOOT_BOOTLOADER_SIZE          0x00006000U       // 24KB
+#include "boot_memmap.h"
 
-#define BOOT_APP_START_ADDR           0x00006000U       // 别名地址（物理 0x08006000）
-#define BOOT_APP_MAX_SIZE             0x00039800U       // 230KB
-#define BOOT_APP_END_ADDR             (BOOT_APP_START_ADDR + BOOT_APP_MAX_SIZE - 1U)
+#if BOOT_CONFIG_ENABLE_STAGING != BOOT_MEMMAP_STAGING
+#error "BOOT_CONFIG_ENABLE_STAGING differs from enable_staging in memmap.json, regenerate boot_memmap.h"
+#endif
 
-#define BOOT_FLAG_REGION_ADDR         0x0003F800U       // 别名地址（物理 0x0803F800）
-#define BOOT_FLAG_REGION_SIZE         0x00000800U       // 2KB
+/*
+ * 启动打点（BOOT_CONFIG_ENABLE_PROFILE）使用的交接区与周期计数
+ * 交接区默认为 boot_memmap.h 中 RAM 末尾的 BOOT_HANDOFF_ADDR，周期数按 BOOT_ARCH 读 DWT->CYCCNT / mcycle；
+ * 在 PC 上运行核心（test/ 主机测试）时把交接区改为普通变量的地址，并定义 BOOT_CYCLE_GET() 代替周期计数器
+ */
+#define BOOT_HANDOFF_BASE             BOOT_HANDOFF_ADDR
+// #define BOOT_CYCLE_GET()           host_cycle_get()   // 定义后不再开启、读取 DWT / mcycle
 
 /*
- * 标志位区布局
+ * 标志位区布局 (基于 BOOT_FLAG_REGION_ADDR)
+ * Word 0: bootloader_flag  - 启动标志 (1=Bootloader模式, 2=APP模式)，擦除后最后写入，作为提交点
+ * Word 1: app_version      - 应用版本号
+ * Word 2: update_date      - 更新日期 (格式: 0xYYYYMMDD, 如 0x20251201)
+ * Word 3: sign_state       - 签名校验结果，BOOT_SIGN_STATE_VERIFIED 表示已通过（在摘要与签名之后、flag 之前写入）
+ * 0x10:   image_digest     - 固件 SHA-256 摘要 (32B)
+ * 0x30:   image_signature  - 摘要的 Ed25519 签名 (64B)
  */
 #define BOOT_FLAG_OFFSET              0x00U
 #define BOOT_VERSION_OFFSET           0x04U
 #define BOOT_DATE_OFFSET              0x08U
+#define BOOT_SIGN_STATE_OFFSET        0x0CU
+#define BOOT_DIGEST_OFFSET            0x10U
+#define BOOT_SIGNATURE_OFFSET         0x30U
 
 #define BOOT_FLAG_ADDR                (BOOT_FLAG_REGION_ADDR + BOOT_FLAG_OFFSET)
 #define BOOT_VERSION_ADDR             (BOOT_FLAG_REGION_ADDR + BOOT_VERSION_OFFSET)
 #define BOOT_DATE_ADDR                (BOOT_FLAG_REGION_ADDR + BOOT_DATE_OFFSET)
+#define BOOT_SIGN_STATE_ADDR          (BOOT_FLAG_REGION_ADDR + BOOT_SIGN_STATE_OFFSET)
+#define BOOT_DIGEST_ADDR              (BOOT_FLAG_REGION_ADDR + BOOT_DIGEST_OFFSET)
+#define BOOT_SIGNATURE_ADDR           (BOOT_FLAG_REGION_ADDR + BOOT_SIGNATURE_OFFSET)
 
-/* 标志位值定义 */
-#define BOOT_FLAG_BOOTLOADER          1U
-#define BOOT_FLAG_APP                 2U
-#define BOOT_FLAG_ERASED              0xE339E339U      // CH32 Flash 擦除后的默认值
+/*
+ * 暂存记录 (基于 BOOT_STAGING_RECORD_ADDR，由 APP 写入，安装完成后随标志位区一起擦除)
+ * Word 0: magic    - BOOT_STAGING_MAGIC 表示暂存区有待安装的固件（最后写入）
+ * Word 1: size     - 固件字节数
+ * Word 2: version  / Word 3: date
+ * 0x10:   digest   - 固件 SHA-256 摘要 (32B)
+ * 0x30:   signature - 摘要的 Ed25519 签名 (64B，启用签名时必需)
+ */
+#define BOOT_STAGING_RECORD_OFFSET    0x100U
+#define BOOT_STAGING_RECORD_ADDR      (BOOT_FLAG_REGION_ADDR + BOOT_STAGING_RECORD_OFFSET)
+#define BOOT_STAGING_MAGIC            0x53544744U  // "STGD"
 
 /*
- * SRAM 范围（用于校验 APP 栈指针有效性）
+ * 安装进度 (基于 BOOT_INSTALL_PROGRESS_ADDR，Bootloader 安装暂存固件时写入)
+ * 每个擦除单元完成后在对应字写入 BOOT_INSTALL_UNIT_DONE，掉电重启后跳过已完成单元
+ * 超出 BOOT_INSTALL_PROGRESS_COUNT 的单元不记录，重启后靠内容比较判断是否需要重写
  */
-#define BOOT_SRAM_START_ADDR          0x20000000U
-#define BOOT_SRAM_END_ADDR            0x2000FFFFU       // 64KB RAM
+#define BOOT_INSTALL_PROGRESS_OFFSET  0x180U
+#define BOOT_INSTALL_PROGRESS_ADDR    (BOOT_FLAG_REGION_ADDR + BOOT_INSTALL_PROGRESS_OFFSET)
+#define BOOT_INSTALL_PROGRESS_COUNT   32U
+#define BOOT_INSTALL_UNIT_DONE        0x444F4E45U  // "DONE"
+
+#if BOOT_INSTALL_PROGRESS_OFFSET + BOOT_INSTALL_PROGRESS_COUNT * 4U > BOOT_FLAG_REGION_SIZE
+#error "BOOT_FLAG_REGION_SIZE cannot hold the install progress records"
+#endif
+
+/* 标志位值定义 */
+#define BOOT_FLAG_BOOTLOADER          1U      // 停留在 Bootloader 模式
+#define BOOT_FLAG_APP                 2U      // 跳转到 APP 模式
+#define BOOT_FLAG_ERASED              0xE339E339U  // 未初始化（CH32 Flash 擦除后读出的值）
+#define BOOT_SIGN_STATE_VERIFIED      0x5349474EU  // "SIGN"，签名已在完成帧阶段校验通过
 
 /*
- * CH32V 无 CCM RAM
+ * 固件签名公钥（Ed25519，32 字节），BOOT_CONFIG_ENABLE_SIGNATURE = 1 时必须定义，没有默认值（全 0 的占位公钥会拒绝所有固件）
+ * 用 PC tool/source/image_sign.py keygen 生成，把打印出的 #define 行取消注释替换到这里；私钥只保存在打包机器上
  */
-#define BOOT_HAS_CCM                  0U
+// #define BOOT_SIGN_PUBLIC_KEY          {0x..U, ... 共 32 字节}
 
 /*
  * 协议缓冲配置
+ * BOOT_PACKET_MAX_SIZE: 整帧最大长度（含帧头帧尾等固定开销 11 字节）
+ * 如上位机配置 1024 字节包大小，则此值需 >= 1024
+ * 拷贝解析时核心按此值保留整帧缓存；接收环直通时核心不占用，帧长只受接收环容量限制（环须容纳上位机窗口内的全部帧）
  */
 #define BOOT_PACKET_MAX_SIZE          1024U
-#define BOOTLOADER_RINGBUFFER_SIZE    1024U
-#define BOOT_UART_TIMEOUT_MS          5000U
+#define BOOT_UART_TIMEOUT_MS          5000U   // 单播传输中断（数据帧间隔、等待完成帧）超过该时间则放弃本次接收
+#define BOOT_LINK_ACK_DELAY_MS        5U      // 分包链路（ops.link_window > 1）下 ACK 最长合并等待时间
+
+/*
+ * 延迟日志（BOOT_CONFIG_LOG_DEFERRED = 1 时生效）
+ * 每条记录为 8 字节头（EB [参数个数] [tick 低 16 位] [格式串地址]）加每个参数 4 字节，记录格式见 协议.md；
+ * 环满时丢弃新记录，下次发送时补一条丢弃计数
+ */
+#define BOOT_LOG_RING_SIZE            512U    // 2 的幂
+#define BOOT_LOG_FLUSH_TIMEOUT_MS     100U    // 跳转、复位前等待日志发完的最长时间
+
+/*
+ * 精简构建（BOOT_CONFIG_PROFILE_TINY = 1 时生效）
+ * 寄存器级移植层直接配置 USART2（PA2/PA3）与 DMA1 Stream5 循环接收，时钟沿用 CMSIS SystemInit 之后的 SystemCoreClock（默认 HSI 16MHz），
+ * 链接时需开启段回收（GCC: -ffunction-sections -fdata-sections -Wl,--gc-sections；Keil: One ELF Section per Function），
+ * 构建后用 PC tool/source/size_report.py 按 BOOT_TINY_SIZE_BUDGET 检查镜像大小
+ */
+#define BOOT_TINY_BAUDRATE            115200U
+#define BOOT_TINY_RX_RING_SIZE        4096U   // 2 的幂，须容纳上位机窗口内的全部在途帧
+#define BOOT_TINY_SIZE_BUDGET         4096U   // 整个 Bootloader 镜像（含向量表与启动代码）的 Flash 占用上限，字节
+
+/*
+ * 静态移植层绑定（BOOT_CONFIG_STATIC_PORT = 1 时生效）
+ * 核心包含该头文件，其中以 static inline 提供与 ops 成员同名的热路径函数（tick 为 boot_port_get_tick）：
+ * flash_write/flash_read/data_write/data_read，接收环直通时另需 rx_peek/rx_consume，
+ * 零拷贝接收时需 data_peek/data_release，延迟日志时需 log_write；擦除、跳转、复位仍经 ops 调用
+ */
+#define BOOT_STATIC_PORT_HEADER       "boot_port_stm32f407_tiny.h"
+
+/*
+ * 多点总线地址（BOOT_CONFIG_ENABLE_ADDRESS = 1 时生效）
+ * 上位机发出的所有帧变为 55 AA [addr] ...，数据帧校验和额外累加地址字节；应答帧格式不变
+ * 有效地址 0x01~0xFE，0xFF 与应答帧 55 AA FF xx 冲突、0x00 为广播地址，均不可用
+ * ops.node_addr 非 0 时覆盖本值，便于由拨码开关或芯片 UID 决定地址
+ */
+#define BOOT_NODE_ADDR                1U
+
+/*
+ * 广播升级（BOOT_CONFIG_ENABLE_BROADCAST = 1 时生效）
+ * 固件按帧序号乱序写入，已收到的帧记在 RAM 位图中（每帧 1 bit），
+ * BOOT_BCAST_MAX_FRAMES * 每帧长度须覆盖最大固件，如 256 帧 * 1008 字节 ≈ 252KB
+ */
+#define BOOT_BCAST_MAX_FRAMES         256U
+
+/*
+ * 前向纠错传输（BOOT_CONFIG_ENABLE_FEC = 1 时生效）
+ * 每组 k 个数据帧后跟 m 个 Reed-Solomon 校验帧，一组内收到任意 k 帧即可恢复；数据帧直接写 Flash，
+ * 只有当前组的校验帧暂存在 RAM 中，RAM 占用约 BOOT_FEC_MAX_PARITY * BOOT_FEC_CHUNK_MAX + BOOT_FEC_MAX_FRAMES / 8
+ */
+#define BOOT_FEC_MAX_PARITY           4U      // 每组校验帧数上限（m），同时是一组内可恢复的丢帧数上限
+#define BOOT_FEC_CHUNK_MAX            512U    // 每帧数据长度上限，4 的倍数
+#define BOOT_FEC_MAX_FRAMES           512U    // 数据帧数上限，BOOT_FEC_MAX_FRAMES * 每帧长度须覆盖最大固件
+
+/*
+ * CAN 链路配置（BOOT_CONFIG_LINK_CAN = 1 时生效，CH32V307 的 bxCAN 不支持 CAN-FD，帧长固定 8）
+ */
+#define BOOT_CAN_RX_ID                0x7E0U  // 上位机 -> 设备
+#define BOOT_CAN_TX_ID                0x7E8U  // 设备 -> 上位机
+#define BOOT_CAN_BLOCK_SIZE           48U     // 流控 BS，一块连续帧须能放进 CAN1_RX_QUEUE_SIZE
+#define BOOT_CAN_ST_MIN               0U      // 流控 STmin，接收走中断队列，不需要帧间隔
+#define BOOT_CAN_LINK_WINDOW          4U      // 允许上位机在途帧数，ACK 合并后减少总线占用
+
+/*
+ * UDP 链路配置（BOOT_CONFIG_LINK_UDP = 1 时生效，一个 UDP 报文承载一个协议帧）
+ */
+#define BOOT_UDP_IP                   {0U, 0U, 0U, 0U}    // 静态 IP，全 0 使用由 MAC 派生的 169.254.x.y
+#define BOOT_UDP_PORT                 47000U  // 本端监听端口
+#define BOOT_UDP_LINK_WINDOW          4U      // 允许上位机在途帧数，须小于 ETH_RX_DESC_NUM
 
 #endif // BOOT_CONFIG_H
@@ -0,0 +1,26 @@
+// Reed-Solomon 纠删码头文件：GF(2^8) 上的柯西矩阵，k 个数据帧生成 m 个校验帧，收到任意 k 帧即可恢复整组
+#ifndef BOOT_FEC_H
+#define BOOT_FEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_FEC_MAX_DATA             128U    // 每组数据帧数上限（列元素 0x00~0x7F，行元素 0x80 起）
+#define BOOT_FEC_MAX_SOLVE            8U      // 一次求解的缺失帧数上限（矩阵求逆规模）
+
+/*
+ * 校验帧 row 中数据帧 col 的系数：1 / (x_row + y_col)，x_row = 0x80 + row，y_col = col
+ * 柯西矩阵任意方阵子块均可逆，因此任意 e 个缺失数据帧都可由任意 e 个校验帧解出
+ * 第 row 个校验帧 = Σ coef(row, col) * 数据帧 col，最后一帧不足整帧时按 0xFF 补齐参与运算
+ */
+uint8_t boot_fec_coef(uint8_t row, uint8_t col);
+
+uint8_t boot_fec_mul(uint8_t a, uint8_t b);
+
+/* dst ^= coef * src（逐字节 GF(2^8) 乘加），解码的主要耗时所在 */
+void boot_fec_mul_add(uint8_t *dst, const uint8_t *src, uint8_t coef, uint32_t len);
+
+/* n x n 矩阵（行主序）原地求逆，n <= BOOT_FEC_MAX_SOLVE，奇异时返回 false */
+bool boot_fec_invert(uint8_t *matrix, uint8_t n);
+
+#endif // BOOT_FEC_H
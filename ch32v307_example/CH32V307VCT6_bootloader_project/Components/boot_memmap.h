@@ -0,0 +1,31 @@
+// CH32V307VCT6 Flash / RAM 布局，由 PC tool/source/memmap_gen.py 根据 memmap.json 生成，不要手工修改
+#ifndef BOOT_MEMMAP_H
+#define BOOT_MEMMAP_H
+
+#define BOOT_MEMMAP_STAGING           0U            // 生成时的暂存区开关，须与配置头文件中的开关一致
+
+#define BOOT_BOOTLOADER_START_ADDR    0x00000000U
+#define BOOT_BOOTLOADER_SIZE          0x00006000U
+#define BOOT_APP_START_ADDR           0x00006000U
+#define BOOT_APP_MAX_SIZE             0x00039800U   // APP 链接区域同此大小
+#define BOOT_APP_END_ADDR             (BOOT_APP_START_ADDR + BOOT_APP_MAX_SIZE - 1U)
+#define BOOT_STAGING_ADDR             0x00020000U
+#define BOOT_STAGING_SIZE             0x0001A000U
+#define BOOT_FLAG_REGION_ADDR         0x0003F800U
+#define BOOT_FLAG_REGION_SIZE         0x00000800U
+
+/* RAM 范围（校验 APP 栈指针，结束地址即初始栈顶的上限） */
+#define BOOT_SRAM_START_ADDR          0x20000000U
+#define BOOT_SRAM_END_ADDR            0x20010000U
+#define BOOT_HAS_CCM                  0U
+
+/* Bootloader -> APP 交接区：RAM 末尾，两侧链接区域均已扣除 */
+#define BOOT_HANDOFF_ADDR             0x2000FF00U
+#define BOOT_HANDOFF_SIZE             0x00000100U
+
+#define BOOT_FLASH_START_ADDR         0x00000000U
+#define BOOT_FLASH_END_ADDR           0x00040000U
+#define BOOT_FLASH_SECTOR_COUNT       1024U
+#define BOOT_FLASH_SECTOR_SIZE        0x00000100U   // 扇区大小一致，扇区号 = 偏移 / 扇区大小
+
+#endif // BOOT_MEMMAP_H
@@ -1,6 +1,15 @@
 #include "easy_bootloader.h"
 #include "boot_config.h"
 #include "bsp_sys.h"
+#if BOOT_CONFIG_LINK_CAN && BOOT_CONFIG_LINK_UDP
+#error "BOOT_CONFIG_LINK_CAN and BOOT_CONFIG_LINK_UDP are mutually exclusive"
+#endif
+#if BOOT_CONFIG_LINK_CAN
+#include "boot_isotp.h"
+#endif
+#if BOOT_CONFIG_LINK_UDP
+#include "boot_udp.h"
+#endif
 
 #define FLASH_HW_ADDR(addr)   ((uint32_t)((addr) - BOOT_BOOTLOADER_START_ADDR) + FLASH_BASE)
 
@@ -9,6 +18,28 @@ uint32_t boot_port_get_tick(void)
     return get_uwtick();
 }
 
+#if BOOT_CONFIG_LINK_CAN
+static boot_isotp_t boot_port_isotp;
+
+static const boot_isotp_ops_t boot_port_isotp_ops = {
+    .can_send = mycan1_send,
+    .can_recv = mycan1_recv,
+    .get_tick = boot_port_get_tick,
+};
+#endif
+
+#if BOOT_CONFIG_LINK_UDP
+static boot_udp_t boot_port_udp;
+
+static const boot_udp_ops_t boot_port_udp_ops = {
+    .eth_rx_peek = myeth_rx_peek,
+    .eth_rx_release = myeth_rx_release,
+    .eth_tx_acquire = myeth_tx_acquire,
+    .eth_tx_submit = myeth_tx_submit,
+    .get_tick = boot_port_get_tick,
+};
+#endif
+
 boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
 {
     if ((addr % 256U) || (size % 256U))
@@ -43,6 +74,17 @@ boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
     return BOOT_PORT_OK;
 }
 
+/* 对齐到 32KB 时按块擦除，否则以页擦除补齐到下一个块边界 */
+uint32_t boot_port_flash_erase_unit(uint32_t addr)
+{
+    const uint32_t block_size = 32U * 1024U;
+
+    if (addr % 256U) {
+        return 0U;
+    }
+    return block_size - (FLASH_HW_ADDR(addr) & (block_size - 1U));
+}
+
 boot_port_status_t boot_port_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
 {
     if ((addr % 4U) || (len % 4U) || data == NULL)
@@ -85,16 +127,15 @@ boot_port_status_t boot_port_data_write(const uint8_t *data, uint32_t len)
         return BOOT_PORT_ERROR;
     }
 
-    for (uint32_t i = 0; i < len; i++) {
-        while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) == RESET) {
-        }
-        USART_SendData(USART2, data[i]);
-    }
-
-    while (USART_GetFlagStatus(USART2, USART_FLAG_TC) == RESET) {
-    }
-
+#if BOOT_CONFIG_LINK_CAN
+    return (boot_isotp_write(&boot_port_isotp, data, len) == BOOT_ISOTP_OK) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+#elif BOOT_CONFIG_LINK_UDP
+    return (boot_udp_write(&boot_port_udp, data, len) == BOOT_UDP_OK) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+#else
+    /* 拷入 DMA 发送缓冲后立即返回，发送完成由 DMA 中断通知 */
+    uart_dma_send(&uart2_tx, data, len);
     return BOOT_PORT_OK;
+#endif
 }
 
 uint32_t boot_port_data_read(uint8_t *buf, uint32_t max_len)
@@ -103,15 +144,45 @@ uint32_t boot_port_data_read(uint8_t *buf, uint32_t max_len)
         return 0U;
     }
 
-    rt_uint16_t data_len = rt_ringbuffer_data_len(&uart2_ringbuffer);
-    if (data_len == 0U) {
-        return 0U;
-    }
+#if BOOT_CONFIG_LINK_CAN
+    return boot_isotp_read(&boot_port_isotp, buf, max_len);
+#elif BOOT_CONFIG_LINK_UDP
+    return boot_udp_read(&boot_port_udp, buf, max_len);
+#else
+    /* 直接从循环 DMA 接收环中取数据 */
+    return uart_dma_ring_read(&uart2_rx_ring, buf, (max_len > 0xFFFFU) ? 0xFFFFU : (uint16_t)max_len);
+#endif
+}
+
+#if BOOT_CONFIG_LINK_UDP
+/* 以太网帧留在接收描述符中，数据帧由核心直接校验写 Flash */
+uint32_t boot_port_data_peek(const uint8_t **data)
+{
+    return boot_udp_peek(&boot_port_udp, data);
+}
 
-    rt_uint16_t request = (data_len > max_len) ? (rt_uint16_t)max_len : data_len;
-    return rt_ringbuffer_get(&uart2_ringbuffer, buf, request);
+void boot_port_data_release(void)
+{
+    boot_udp_release(&boot_port_udp);
 }
+#endif
 
+#if BOOT_CONFIG_LOG_DEFERRED
+/* 延迟日志经 USART1 DMA 发送：上一段还没发完时返回 0，不等待；跳转、复位前由 uart_dma_flush 收尾 */
+uint32_t boot_port_log_write(const uint8_t *data, uint32_t len)
+{
+    if (uart1_tx.busy)
+    {
+        return 0U;
+    }
+    if (len > UART_TX_BUFFER_SIZE)
+    {
+        len = UART_TX_BUFFER_SIZE;
+    }
+    uart_dma_send(&uart1_tx, data, len);
+    return len;
+}
+#else
 void boot_port_log(const char *fmt, ...)
 {
     char buffer[256];
@@ -126,26 +197,29 @@ void boot_port_log(const char *fmt, ...)
         if (tx_len >= sizeof(buffer)) {
             tx_len = sizeof(buffer) - 1U;
         }
-        for (uint32_t i = 0; i < tx_len; i++) {
-            while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET) {
-            }
-            USART_SendData(USART1, buffer[i]);
-        }
-        while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET) {
-        }
+        uart_dma_send(&uart1_tx, (const uint8_t *)buffer, tx_len);
     }
 }
+#endif
 
 void boot_port_jump_to_app(uint32_t app_addr)
 {
     (void)app_addr;
 
+    /* 发送由 DMA 中断收尾，关中断前先等最后的应答与日志发完 */
+    myuart_deinit();
     __disable_irq();
 
     TIM_ITConfig(TIM6, TIM_IT_Update, DISABLE);
     TIM_Cmd(TIM6, DISABLE);
-    USART_ITConfig(USART2, USART_IT_RXNE, DISABLE);
     USART_Cmd(USART2, DISABLE);
+#if BOOT_CONFIG_LINK_CAN
+    CAN_ITConfig(CAN1, CAN_IT_FMP0, DISABLE);
+    CAN_DeInit(CAN1);
+#endif
+#if BOOT_CONFIG_LINK_UDP
+    myeth_deinit();
+#endif
 
     SysTick->CTLR = 0;
     SysTick->SR   = 0;
@@ -159,10 +233,15 @@ void boot_port_jump_to_app(uint32_t app_addr)
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, DISABLE);
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, DISABLE);
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM6, DISABLE);
+#if BOOT_CONFIG_LINK_CAN
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_CAN1, DISABLE);
+#endif
 
     RCC_DeInit();
 
-    Delay_Ms(10);
+    /* 等待系统时钟切回 HSI，替代固定 10ms 延时 */
+    while (RCC_GetSYSCLKSource() != 0x00U) {
+    }
 
     NVIC_DisableIRQ(Software_IRQn);
     NVIC_ClearPendingIRQ(Software_IRQn);
@@ -176,6 +255,8 @@ void boot_port_jump_to_app(uint32_t app_addr)
 
 void boot_port_system_reset(void)
 {
+    uart_dma_flush(&uart1_tx);
+    uart_dma_flush(&uart2_tx);
     NVIC_SystemReset();
 }
 
@@ -186,13 +267,58 @@ boot_ops_t boot_port_ops = {
     .boot_port_flash_read = boot_port_flash_read,
     .boot_port_data_write = boot_port_data_write,
     .boot_port_data_read = boot_port_data_read,
+#if BOOT_CONFIG_LOG_DEFERRED
+    .boot_port_log_write = boot_port_log_write,
+#else
     .boot_port_log = boot_port_log,
+#endif
     .boot_port_jump_to_app = boot_port_jump_to_app,
     .boot_port_system_reset = boot_port_system_reset,
+    .boot_port_flash_erase_unit = boot_port_flash_erase_unit,
+#if BOOT_CONFIG_LINK_CAN
+    .link_window = BOOT_CAN_LINK_WINDOW,
+#endif
+#if BOOT_CONFIG_LINK_UDP
+    .link_mtu = BOOT_UDP_PAYLOAD_MAX,
+    .link_window = BOOT_UDP_LINK_WINDOW,
+    .boot_port_data_peek = boot_port_data_peek,
+    .boot_port_data_release = boot_port_data_release,
+#endif
 };
 
+//在 main 最开始调用：启动打点并尝试快速跳转，未跳转时返回继续正常初始化
+void bootloader_fast_boot(void)
+{
+    easy_bootloader_profile_start();
+    (void)easy_bootloader_fast_boot(&boot_port_ops);
+}
+
 void bootloader_app_init(void)
 {
+#if BOOT_CONFIG_LINK_CAN
+    const boot_isotp_config_t isotp_cfg = {
+        .tx_id = BOOT_CAN_TX_ID,
+        .rx_id = BOOT_CAN_RX_ID,
+        .frame_len = BOOT_ISOTP_CAN_DLEN,
+        .block_size = BOOT_CAN_BLOCK_SIZE,
+        .st_min = BOOT_CAN_ST_MIN,
+    };
+    (void)boot_isotp_init(&boot_port_isotp, &boot_port_isotp_ops, &isotp_cfg);
+#endif
+#if BOOT_CONFIG_LINK_UDP
+    boot_udp_config_t udp_cfg = {
+        .ip = BOOT_UDP_IP,
+        .port = BOOT_UDP_PORT,
+    };
+    myeth_get_mac(udp_cfg.mac);
+    if (boot_udp_init(&boot_port_udp, &boot_port_udp_ops, &udp_cfg) == BOOT_UDP_OK) {
+        boot_udp_announce(&boot_port_udp);
+#if BOOT_CONFIG_ENABLE_LOG
+        boot_port_log("UDP link %d.%d.%d.%d:%d\r\n", boot_port_udp.cfg.ip[0], boot_port_udp.cfg.ip[1],
+                      boot_port_udp.cfg.ip[2], boot_port_udp.cfg.ip[3], BOOT_UDP_PORT);
+#endif
+    }
+#endif
     (void)easy_bootloader_init(&boot_port_ops);
 }
 
@@ -0,0 +1,161 @@
+// SPI 从机传输层：每个事务承载一个协议帧，事务结束中断里立即换到空闲缓冲启动下一次 DMA
+#include "boot_spi.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static uint16_t spi_get16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void spi_put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+/*
+ * 用下一个接收缓冲启动 DMA 并拉高就绪线，该缓冲仍在等核心处理时不启动
+ * 只在没有事务进行（armed 为 BOOT_SPI_IDLE）时调用：中断中事务刚结束，或主循环归还缓冲时
+ */
+static void spi_arm(boot_spi_t *ctx)
+{
+    uint8_t idx = ctx->next;
+    if (ctx->rx_len[idx] != 0U) {
+        return;
+    }
+
+    /* 发送缓冲在启动 DMA 时定稿：主循环正在追加应答时本次先发空应答，否则交换双缓冲 */
+    uint8_t send;
+    if (ctx->tx_writing) {
+        send = (uint8_t)(ctx->tx_fill ^ 1U);
+        ctx->tx_len[send] = 0U;
+    } else {
+        send = ctx->tx_fill;
+        ctx->tx_fill = (uint8_t)(send ^ 1U);
+        ctx->tx_len[send ^ 1U] = 0U;
+    }
+
+    uint8_t *tx = ctx->tx[send];
+    tx[0] = BOOT_SPI_MISO_MAGIC;
+    tx[1] = ctx->status;
+    spi_put16(&tx[2], ctx->tx_len[send]);
+    ctx->status = 0U;
+
+    ctx->armed = idx;
+    ctx->ops->arm(ctx->rx[idx], BOOT_SPI_RX_SIZE, tx, BOOT_SPI_TX_SIZE);
+    ctx->ops->set_ready(1U);
+}
+
+boot_spi_status_t boot_spi_init(boot_spi_t *ctx, const boot_spi_ops_t *ops)
+{
+    if (ctx == NULL || ops == NULL || ops->arm == NULL || ops->set_ready == NULL) {
+        return BOOT_SPI_ERROR;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->ops = ops;
+    ctx->armed = BOOT_SPI_IDLE;
+    spi_arm(ctx);
+    return BOOT_SPI_OK;
+}
+
+void boot_spi_xfer_done(boot_spi_t *ctx, uint32_t clocked)
+{
+    uint8_t idx = ctx->armed;
+
+    ctx->ops->set_ready(0U);
+    if (idx == BOOT_SPI_IDLE) {
+        /* 主机没等就绪线就发起了事务，DMA 未启动，数据已丢失 */
+        ctx->status |= BOOT_SPI_STATUS_OVERRUN;
+        return;
+    }
+    ctx->armed = BOOT_SPI_IDLE;
+
+    /* 空事务与无效事务不占用缓冲，下一次事务继续使用同一个缓冲，保证先收先交 */
+    const uint8_t *rx = ctx->rx[idx];
+    if (clocked >= BOOT_SPI_HEADER_SIZE && rx[0] == BOOT_SPI_MOSI_MAGIC) {
+        uint16_t len = spi_get16(&rx[2]);
+        if (len > 0U && len <= BOOT_SPI_PAYLOAD_MAX && len <= clocked - BOOT_SPI_HEADER_SIZE) {
+            ctx->rx_len[idx] = len;
+            ctx->next = (uint8_t)(idx ^ 1U);
+        }
+    }
+    spi_arm(ctx);
+}
+
+uint32_t boot_spi_peek(boot_spi_t *ctx, const uint8_t **data)
+{
+    uint8_t idx = ctx->rx_head;
+    uint32_t len = ctx->rx_len[idx];
+
+    if (len == 0U) {
+        return 0U;
+    }
+    *data = &ctx->rx[idx][BOOT_SPI_HEADER_SIZE + ctx->rx_offset];
+    return len - ctx->rx_offset;
+}
+
+void boot_spi_release(boot_spi_t *ctx)
+{
+    uint8_t idx = ctx->rx_head;
+
+    if (ctx->rx_len[idx] == 0U) {
+        return;
+    }
+    ctx->rx_offset = 0U;
+    ctx->rx_head = (uint8_t)(idx ^ 1U);
+    ctx->rx_len[idx] = 0U;
+
+    /* 两个缓冲都满时就绪线一直为低，归还后在这里重新启动 */
+    if (ctx->armed == BOOT_SPI_IDLE) {
+        spi_arm(ctx);
+    }
+}
+
+uint32_t boot_spi_read(boot_spi_t *ctx, uint8_t *buf, uint32_t max_len)
+{
+    const uint8_t *data;
+
+    if (ctx == NULL || buf == NULL || max_len == 0U) {
+        return 0U;
+    }
+
+    uint32_t len = boot_spi_peek(ctx, &data);
+    if (len == 0U) {
+        return 0U;
+    }
+    if (len > max_len) {
+        len = max_len;
+    }
+    memcpy(buf, data, len);
+    ctx->rx_offset += len;
+    if (ctx->rx_offset >= ctx->rx_len[ctx->rx_head]) {
+        boot_spi_release(ctx);
+    }
+    return len;
+}
+
+boot_spi_status_t boot_spi_write(boot_spi_t *ctx, const uint8_t *data, uint32_t len)
+{
+    if (ctx == NULL || data == NULL || len == 0U) {
+        return BOOT_SPI_ERROR;
+    }
+
+    ctx->tx_writing = 1U;
+    uint8_t fill = ctx->tx_fill;
+    uint32_t used = ctx->tx_len[fill];
+    boot_spi_status_t status = BOOT_SPI_OK;
+    if (used + len > BOOT_SPI_REPLY_MAX) {
+        ctx->status |= BOOT_SPI_STATUS_REPLY_LOST;
+        status = BOOT_SPI_FULL;
+    } else {
+        memcpy(&ctx->tx[fill][BOOT_SPI_HEADER_SIZE + used], data, len);
+        ctx->tx_len[fill] = (uint16_t)(used + len);
+    }
+    ctx->tx_writing = 0U;
+
+    /* 两个接收缓冲都满时不会有新事务，应答要等核心归还缓冲后随下一次事务发出 */
+    return status;
+}
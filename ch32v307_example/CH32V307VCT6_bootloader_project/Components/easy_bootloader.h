@@ -3,6 +3,13 @@
 #define EASY_BOOTLOADER_H
 
 #include "boot_config.h"
+#include <stdbool.h>
+#if BOOT_CONFIG_ENABLE_SHA256
+#include "boot_sha256.h"
+#endif
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+#include "boot_ring.h"
+#endif
 
 
 typedef enum {
@@ -20,13 +27,185 @@ typedef struct
     boot_port_status_t (*boot_port_flash_read)(uint32_t addr, uint8_t *data, uint32_t len);
     boot_port_status_t (*boot_port_data_write)(const uint8_t *data, uint32_t len);
     uint32_t (*boot_port_data_read)(uint8_t *buf, uint32_t max_len);
-    void (*boot_port_log)(const char *fmt, ...);
+    void (*boot_port_log)(const char *fmt, ...);            // 格式化日志输出（BOOT_CONFIG_LOG_DEFERRED 时不使用）
     void (*boot_port_jump_to_app)(uint32_t app_addr);
     void (*boot_port_system_reset)(void);
+    uint32_t (*boot_port_flash_erase_unit)(uint32_t addr);   // 可选：addr 处单次可擦除的最大单元大小（暂存安装按单元擦写）
+
+    /* 链路参数（可选，0 表示 UART 等字节流链路，行为与之前一致） */
+    uint16_t link_mtu;      // 单次 boot_port_data_write 的最大字节数，超出时由核心分片发送
+    uint8_t  link_window;   // 上位机允许的在途帧数，>1 时每轮解析只回一个计数 ACK: 55 AA FF F9 [n] 55 55
+    uint8_t  node_addr;     // 多点总线节点地址（BOOT_CONFIG_ENABLE_ADDRESS），0 表示使用 BOOT_NODE_ADDR
+
+    /* 零拷贝接收（可选，需与 boot_port_data_read 同时提供）：peek 返回一个完整链路包在 DMA 缓冲区中的地址与长度，
+     * 恰好是一整个数据帧时核心直接从该缓冲区校验并写 Flash，处理完调用 release 归还缓冲区 */
+    uint32_t (*boot_port_data_peek)(const uint8_t **data);
+    void (*boot_port_data_release)(void);
+
+    /* 接收环直通（BOOT_CONFIG_ENABLE_RX_DIRECT 时必需）：字节流链路把 DMA 接收环直接交给核心，数据帧在环中就地校验并写 Flash
+     * rx_peek    返回未读数据中 offset 处起的连续区域（到环末尾为止），不移动读位置；环被覆盖时丢弃全部未读数据重新同步
+     * rx_consume 释放最早的 len 字节；返回 BOOT_PORT_ERROR 表示被释放的数据在处理期间已被 DMA 覆盖 */
+    uint32_t (*boot_port_rx_peek)(uint32_t offset, const uint8_t **data);
+    boot_port_status_t (*boot_port_rx_consume)(uint32_t len);
+
+    /* 延迟日志输出（BOOT_CONFIG_LOG_DEFERRED 时使用，替代 boot_port_log）：不等待，拷走或开始发送 data 中至多 len 字节，
+     * 返回接受的字节数，发送通道忙时返回 0；未提供时记录留在 RAM 环中，可由调试器读取 */
+    uint32_t (*boot_port_log_write)(const uint8_t *data, uint32_t len);
+
+    /* 异步 Flash 读取（可选，需同时提供）：read_start 发起把 addr 处 len 字节读入 data（如 DMA 存储器到存储器传输）后立即返回，
+     * 同一时刻至多一个读取在途；read_wait 等到它完成并返回结果。整段摘要与擦除检查时核心处理当前块的同时读取下一块，未提供时用 flash_read */
+    boot_port_status_t (*boot_port_flash_read_start)(uint32_t addr, uint8_t *data, uint32_t len);
+    boot_port_status_t (*boot_port_flash_read_wait)(void);
 }boot_ops_t;
 
+/*
+ * 启动阶段打点（单位：CPU 周期，Cortex-M 使用 DWT->CYCCNT，RISC-V 使用 mcycle）
+ */
+typedef enum {
+    BOOT_STAGE_RESET = 0,     // easy_bootloader_profile_start()，main 最开始
+    BOOT_STAGE_INIT,          // 进入 easy_bootloader_init / easy_bootloader_fast_boot（HAL 与外设初始化之后）
+    BOOT_STAGE_FLAG_READ,     // 标志位区读取完成
+    BOOT_STAGE_APP_CHECK,     // APP 有效性检查完成
+    BOOT_STAGE_JUMP,          // 调用 boot_port_jump_to_app 之前
+    BOOT_STAGE_COUNT,
+} boot_stage_t;
+
+#define BOOT_HANDOFF_MAGIC            0x424F4F54U  // "BOOT"
+#define BOOT_HANDOFF_FLAG_FAST        0x00000001U  // 本次经快速跳转路径进入 APP
+
+/* 交接区布局，位于 BOOT_HANDOFF_ADDR，APP 侧 boot_app_handoff_t 与之保持一致 */
+typedef struct {
+    uint32_t magic;
+    uint32_t boot_flags;
+    uint32_t stamp[BOOT_STAGE_COUNT];
+} boot_handoff_t;
+
+
+#define BOOT_DIGEST_SIZE          32U
+#define BOOT_SIGNATURE_SIZE       64U
+
+// 线性解析缓存：接收环直通时数据帧不进缓存，只需容纳最长的完成帧（签名完成帧 110 字节）
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+#define BOOT_RX_CACHE_SIZE        110U
+#else
+#define BOOT_RX_CACHE_SIZE        BOOT_PACKET_MAX_SIZE
+#endif
+
+// 工作缓冲：暂存安装、Flash 摘要回读与 FEC 解码时使用，数据帧不经过它
+#if BOOT_CONFIG_ENABLE_FEC && BOOT_FEC_CHUNK_MAX > 512U
+#define BOOT_WORK_BUF_SIZE        BOOT_FEC_CHUNK_MAX
+#else
+#define BOOT_WORK_BUF_SIZE        512U
+#endif
+
+#if BOOT_CONFIG_ENABLE_BROADCAST
+#define BOOT_BCAST_BITMAP_SIZE    ((BOOT_BCAST_MAX_FRAMES + 7U) / 8U)
+#endif
+#if BOOT_CONFIG_ENABLE_FEC
+#define BOOT_FEC_BITMAP_SIZE      ((BOOT_FEC_MAX_FRAMES + 7U) / 8U)
+#endif
+
+/* Bootloader 状态枚举 */
+typedef enum {
+    BOOT_STATE_IDLE,          // 空闲，等待数据帧
+    BOOT_STATE_RECEIVING,     // 正在接收固件数据
+    BOOT_STATE_WAIT_FINISH,   // 数据接收完成，等待完成帧
+    BOOT_STATE_BROADCAST,     // 广播会话中，按位图接收固件帧
+    BOOT_STATE_FEC,           // FEC 会话中，按组接收数据帧与校验帧
+} boot_state_t;
+
+/* 完成帧解析结果 */
+typedef struct {
+    uint32_t version;
+    uint32_t date;
+    uint8_t  digest[BOOT_DIGEST_SIZE];          // 扩展/签名完成帧有效
+    uint8_t  signature[BOOT_SIGNATURE_SIZE];    // 签名完成帧有效
+    bool     has_digest;
+    bool     has_signature;
+} boot_finish_frame_t;
+
+/*
+ * Bootloader 实例：全部运行状态与缓冲，大小由 boot_config.h 的功能开关决定（sizeof 即实际占用）
+ * 由调用方分配（静态变量或内存池），easy_bootloader_ctx_init 初始化后不要直接访问成员
+ * 各实例共用 boot_config.h 中的 Flash 布局，同一设备上同时只应有一个实例写 Flash；
+ * 多实例用于主机仿真、测试等由 ops 把各实例映射到各自存储的场景
+ */
+typedef struct {
+    uint8_t  rx_cache[BOOT_RX_CACHE_SIZE];      // 线性解析缓存
+    uint16_t rx_cache_len;
+#if BOOT_CONFIG_ENABLE_STAGING || BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+    uint8_t  work_buf[BOOT_WORK_BUF_SIZE];      // 工作缓冲，见 BOOT_WORK_BUF_SIZE
+#endif
+
+    uint32_t current_addr;              //当前写入地址
+    uint8_t  stream_cache[4];           //写流缓存，保证4字节对齐写入
+    uint8_t  stream_cache_len;
+#if BOOT_CONFIG_ENABLE_SHA256
+    boot_sha256_ctx_t sha_ctx;          // 已写入固件数据的流式摘要
+#endif
+
+    uint32_t boot_flag;
+    uint32_t app_version;
+    uint32_t update_date;
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    uint32_t sign_state;                // 完成帧阶段缓存的签名校验结果
+#endif
+
+#if BOOT_CONFIG_ENABLE_BROADCAST
+    uint32_t bcast_size;                // 广播会话的固件长度，0 表示不在广播会话中
+    uint16_t bcast_chunk;               // 每帧数据长度（最后一帧除外）
+    uint16_t bcast_frames;
+    uint16_t bcast_missing;             // 尚未收到的帧数
+    uint8_t  bcast_session;
+    uint8_t  bcast_bitmap[BOOT_BCAST_BITMAP_SIZE];   // 已收到的帧
+#endif
+
+#if BOOT_CONFIG_ENABLE_FEC
+    uint32_t fec_size;                  // FEC 会话的固件长度，0 表示不在 FEC 会话中
+    uint16_t fec_chunk;                 // 每帧数据长度（最后一帧除外）
+    uint16_t fec_frames;                // 数据帧总数
+    uint16_t fec_missing;               // 尚未写入 Flash 的数据帧数
+    uint16_t fec_group;                 // 当前暂存校验帧所属的组
+    uint8_t  fec_k;                     // 每组数据帧数
+    uint8_t  fec_m;                     // 每组校验帧数
+    uint8_t  fec_session;
+    uint8_t  fec_parity_mask;           // 当前组已暂存的校验帧
+    uint8_t  fec_bitmap[BOOT_FEC_BITMAP_SIZE];                  // 已写入 Flash 的数据帧
+    uint8_t  fec_parity[BOOT_FEC_MAX_PARITY][BOOT_FEC_CHUNK_MAX]; // 当前组的校验帧
+    boot_finish_frame_t fec_finish;     // 启动帧携带的版本号、日期、摘要与签名
+#endif
+
+    boot_state_t state;                 // 当前状态
+    uint8_t ack_pending;                // 已写入但尚未应答的数据帧数（计数 ACK 模式）
+    bool ack_urgent;                    // 最后一帧或待应答数将满，数据帧从接收缓冲释放后立即应答
+    uint32_t ack_pending_tick;          // 最近一次有帧待应答的时间
+    uint32_t unicast_tick;              // 最近一次单播数据帧的时间
+    bool unicast_active;                // 单播传输进行中（接收中或等待完成帧），受 BOOT_UART_TIMEOUT_MS 约束
+    bool download_active;
+
+    /* 以下成员在传输出错复位状态时保留 */
+    const boot_ops_t *ops;
+    bool initialized;
+    bool log_muted;                     // 快速跳转路径下屏蔽日志
+#if BOOT_CONFIG_ENABLE_ADDRESS
+    uint8_t node_addr;                  // 本节点总线地址
+#endif
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+    boot_ring_t log_ring;
+    uint32_t log_dropped;               // 环满丢弃的记录数，下次发送时补一条计数记录
+    uint8_t log_buf[BOOT_LOG_RING_SIZE];
+#endif
+} easy_bootloader_t;
+
+
+/* 多实例接口：ctx 由调用方分配 */
+boot_port_status_t easy_bootloader_ctx_init(easy_bootloader_t *ctx, const boot_ops_t *ops);
+void easy_bootloader_ctx_run(easy_bootloader_t *ctx);
 
+/* 单实例接口：使用内部默认实例 */
 boot_port_status_t easy_bootloader_init(const boot_ops_t *ops);
 void easy_bootloader_run(void);
+void easy_bootloader_profile_start(void);
+boot_port_status_t easy_bootloader_fast_boot(const boot_ops_t *ops);
 
 #endif // EASY_BOOTLOADER_H
@@ -9,6 +9,8 @@
 #include "mytimer.h"
 #include "scheduler.h"
 #include "myuart.h"
+#include "mycan.h"
+#include "myeth.h"
 #include "easy_bootloader.h"
 
 #endif
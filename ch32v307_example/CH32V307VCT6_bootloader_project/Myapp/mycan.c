@@ -0,0 +1,132 @@
+#include "mycan.h"
+
+typedef struct {
+    uint32_t id;
+    uint8_t  len;
+    uint8_t  data[8];
+} can1_frame_t;
+
+static can1_frame_t can1_rx_queue[CAN1_RX_QUEUE_SIZE];
+static volatile uint32_t can1_rx_head;
+static volatile uint32_t can1_rx_tail;
+
+
+
+
+void mycan1_init(uint32_t rx_id)
+{
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    CAN_InitTypeDef CAN_InitStructure = {0};
+    CAN_FilterInitTypeDef CAN_FilterInitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO | RCC_APB2Periph_GPIOB, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_CAN1, ENABLE);
+    GPIO_PinRemapConfig(GPIO_Remap1_CAN1, ENABLE);
+
+    /* PB9 -> TX */
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    /* PB8 -> RX */
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_8;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    /* APB1 = 48MHz：48MHz / 6 / (1 + 11 + 4) = 500kbps，采样点 75% */
+    CAN_InitStructure.CAN_Prescaler = 6;
+    CAN_InitStructure.CAN_Mode = CAN_Mode_Normal;
+    CAN_InitStructure.CAN_SJW = CAN_SJW_1tq;
+    CAN_InitStructure.CAN_BS1 = CAN_BS1_11tq;
+    CAN_InitStructure.CAN_BS2 = CAN_BS2_4tq;
+    CAN_InitStructure.CAN_TTCM = DISABLE;
+    CAN_InitStructure.CAN_ABOM = ENABLE;
+    CAN_InitStructure.CAN_AWUM = DISABLE;
+    CAN_InitStructure.CAN_NART = DISABLE;
+    CAN_InitStructure.CAN_RFLM = DISABLE;
+    CAN_InitStructure.CAN_TXFP = ENABLE;    // 邮箱按请求顺序发送，保证同 ID 连续帧不乱序
+    CAN_Init(CAN1, &CAN_InitStructure);
+
+    /* 只接收 rx_id 标准数据帧 */
+    CAN_FilterInitStructure.CAN_FilterNumber = 0;
+    CAN_FilterInitStructure.CAN_FilterMode = CAN_FilterMode_IdMask;
+    CAN_FilterInitStructure.CAN_FilterScale = CAN_FilterScale_32bit;
+    CAN_FilterInitStructure.CAN_FilterIdHigh = (uint16_t)(rx_id << 5);
+    CAN_FilterInitStructure.CAN_FilterIdLow = 0x0000;
+    CAN_FilterInitStructure.CAN_FilterMaskIdHigh = (uint16_t)(0x7FFU << 5);
+    CAN_FilterInitStructure.CAN_FilterMaskIdLow = 0x0006;     // IDE、RTR 位须为 0
+    CAN_FilterInitStructure.CAN_FilterFIFOAssignment = CAN_Filter_FIFO0;
+    CAN_FilterInitStructure.CAN_FilterActivation = ENABLE;
+    CAN_FilterInit(&CAN_FilterInitStructure);
+
+    CAN_ITConfig(CAN1, CAN_IT_FMP0, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = USB_LP_CAN1_RX0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    can1_rx_head = 0U;
+    can1_rx_tail = 0U;
+}
+
+//发送一帧标准数据帧，三个邮箱都满时返回 -1
+int mycan1_send(uint32_t id, const uint8_t *data, uint8_t len)
+{
+    CanTxMsg tx_msg;
+
+    if (len > 8U) {
+        return -1;
+    }
+
+    tx_msg.StdId = id;
+    tx_msg.ExtId = 0;
+    tx_msg.IDE = CAN_Id_Standard;
+    tx_msg.RTR = CAN_RTR_Data;
+    tx_msg.DLC = len;
+    memcpy(tx_msg.Data, data, len);
+
+    return (CAN_Transmit(CAN1, &tx_msg) == CAN_TxStatus_NoMailBox) ? -1 : 0;
+}
+
+//从接收队列取一帧，无数据返回 0
+int mycan1_recv(uint32_t *id, uint8_t *data, uint8_t *len)
+{
+    uint32_t head = can1_rx_head;
+
+    if (head == can1_rx_tail) {
+        return 0;
+    }
+
+    const can1_frame_t *frame = &can1_rx_queue[head & (CAN1_RX_QUEUE_SIZE - 1U)];
+    *id = frame->id;
+    *len = frame->len;
+    memcpy(data, frame->data, frame->len);
+    can1_rx_head = head + 1U;
+    return 1;
+}
+
+void USB_LP_CAN1_RX0_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void USB_LP_CAN1_RX0_IRQHandler(void)
+{
+    while (CAN_MessagePending(CAN1, CAN_FIFO0) != 0U)
+    {
+        CanRxMsg rx_msg;
+        CAN_Receive(CAN1, CAN_FIFO0, &rx_msg);
+
+        uint32_t tail = can1_rx_tail;
+        if ((uint32_t)(tail - can1_rx_head) < CAN1_RX_QUEUE_SIZE)   // 队列满时丢弃，由 ISO-TP 序号检查发现
+        {
+            can1_frame_t *frame = &can1_rx_queue[tail & (CAN1_RX_QUEUE_SIZE - 1U)];
+            frame->id = rx_msg.StdId;
+            frame->len = (rx_msg.DLC > 8U) ? 8U : rx_msg.DLC;
+            memcpy(frame->data, rx_msg.Data, frame->len);
+            can1_rx_tail = tail + 1U;
+        }
+    }
+    scheduler_post(TASK_BOOTLOADER);
+}
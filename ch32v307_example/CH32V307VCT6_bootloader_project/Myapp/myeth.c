@@ -0,0 +1,189 @@
+#include "myeth.h"
+
+/* 描述符与缓冲区都由本文件管理，收发直接在 DMA 缓冲区上进行 */
+static ETH_DMADESCTypeDef eth_rx_desc[ETH_RX_DESC_NUM] __attribute__((aligned(4)));
+static ETH_DMADESCTypeDef eth_tx_desc[ETH_TX_DESC_NUM] __attribute__((aligned(4)));
+static uint8_t eth_rx_buf[ETH_RX_DESC_NUM][ETH_MAX_PACKET_SIZE] __attribute__((aligned(4)));
+static uint8_t eth_tx_buf[ETH_TX_DESC_NUM][ETH_MAX_PACKET_SIZE] __attribute__((aligned(4)));
+
+static uint32_t eth_rx_index;
+static uint32_t eth_tx_index;
+static uint8_t eth_link_up;
+static uint32_t eth_link_tick;
+
+
+
+
+//每 100ms 查询一次 PHY，链路建立后按自协商结果设置双工模式（内置 PHY 只有 10M）
+static void myeth_link_poll(void)
+{
+    if ((uint32_t)(get_uwtick() - eth_link_tick) < 100U) {
+        return;
+    }
+    eth_link_tick = get_uwtick();
+
+    uint16_t bsr = ETH_ReadPHYRegister(ETH_PHY_ADDRESS, PHY_BSR);
+    uint8_t up = ((bsr & PHY_Linked_Status) != 0U) ? 1U : 0U;
+
+    if (up == eth_link_up) {
+        return;
+    }
+    eth_link_up = up;
+    if (up) {
+        uint16_t anar = ETH_ReadPHYRegister(ETH_PHY_ADDRESS, 4U);
+        uint16_t anlpar = ETH_ReadPHYRegister(ETH_PHY_ADDRESS, 5U);
+        if ((anar & anlpar & 0x0040U) != 0U) {          // 双方都支持 10BASE-T 全双工
+            ETH->MACCR |= ETH_MACCR_DM;
+        } else {
+            ETH->MACCR &= ~ETH_MACCR_DM;
+        }
+    }
+}
+
+void myeth_init(void)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    uint8_t mac[6];
+    uint32_t i;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_ETH_MAC | RCC_AHBPeriph_ETH_MAC_Tx | RCC_AHBPeriph_ETH_MAC_Rx, ENABLE);
+    EXTEN->EXTEN_CTR |= EXTEN_ETH_10M_EN;
+
+    ETH_DeInit();
+    ETH_SoftwareReset();
+    while ((ETH->DMABMR & ETH_DMABMR_SR) != 0U)
+    {
+    }
+
+    /* MDC = HCLK / 42，复位 PHY 后打开自协商 */
+    ETH->MACMIIAR = ETH_MACMIIAR_CR_Div42;
+    ETH_WritePHYRegister(ETH_PHY_ADDRESS, PHY_BCR, PHY_Reset);
+    Delay_Ms(10);
+    ETH_WritePHYRegister(ETH_PHY_ADDRESS, PHY_BCR, PHY_AutoNegotiation);
+
+    /* 只收发往本机 MAC 与广播的帧（ARP 请求是广播），先存后转发 */
+    ETH->MACFFR = 0U;
+    myeth_get_mac(mac);
+    ETH_MACAddressConfig(ETH_MAC_Address0, mac);
+    ETH->DMAOMR = ETH_DMAOMR_RSF | ETH_DMAOMR_TSF;
+
+    for (i = 0; i < ETH_RX_DESC_NUM; i++)
+    {
+        eth_rx_desc[i].Status = ETH_DMARxDesc_OWN;
+        eth_rx_desc[i].ControlBufferSize = ETH_DMARxDesc_RCH | ETH_MAX_PACKET_SIZE;
+        eth_rx_desc[i].Buffer1Addr = (uint32_t)eth_rx_buf[i];
+        eth_rx_desc[i].Buffer2NextDescAddr = (uint32_t)&eth_rx_desc[(i + 1U) % ETH_RX_DESC_NUM];
+    }
+    for (i = 0; i < ETH_TX_DESC_NUM; i++)
+    {
+        eth_tx_desc[i].Status = ETH_DMATxDesc_TCH;
+        eth_tx_desc[i].ControlBufferSize = 0U;
+        eth_tx_desc[i].Buffer1Addr = (uint32_t)eth_tx_buf[i];
+        eth_tx_desc[i].Buffer2NextDescAddr = (uint32_t)&eth_tx_desc[(i + 1U) % ETH_TX_DESC_NUM];
+    }
+    ETH->DMARDLAR = (uint32_t)eth_rx_desc;
+    ETH->DMATDLAR = (uint32_t)eth_tx_desc;
+    eth_rx_index = 0U;
+    eth_tx_index = 0U;
+    eth_link_up = 0U;
+    eth_link_tick = get_uwtick() - 100U;
+
+    /* 收到帧时中断投递 bootloader 任务，帧仍由主循环从描述符中取 */
+    ETH_DMAITConfig(ETH_DMA_IT_NIS | ETH_DMA_IT_R, ENABLE);
+    NVIC_InitStructure.NVIC_IRQChannel = ETH_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    ETH_Start();
+}
+
+void ETH_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void ETH_IRQHandler(void)
+{
+    ETH_DMAClearITPendingBit(ETH_DMA_IT_NIS | ETH_DMA_IT_R);
+    scheduler_post(TASK_BOOTLOADER);
+}
+
+void myeth_deinit(void)
+{
+    NVIC_DisableIRQ(ETH_IRQn);
+    ETH_DeInit();
+    EXTEN->EXTEN_CTR &= ~EXTEN_ETH_10M_EN;
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_ETH_MAC | RCC_AHBPeriph_ETH_MAC_Tx | RCC_AHBPeriph_ETH_MAC_Rx, DISABLE);
+}
+
+//芯片唯一 ID 派生 MAC（与 WCH 例程一致，按字节逆序）
+void myeth_get_mac(uint8_t *mac)
+{
+    const uint8_t *uid = (const uint8_t *)0x1FFFF7E8U;
+    uint8_t i;
+
+    for (i = 0; i < 6U; i++)
+    {
+        mac[i] = uid[5U - i];
+    }
+}
+
+//取最早一帧完整接收的帧，出错或跨描述符的帧直接归还，无帧返回 0
+uint32_t myeth_rx_peek(const uint8_t **frame)
+{
+    myeth_link_poll();
+
+    for (;;)
+    {
+        ETH_DMADESCTypeDef *desc = &eth_rx_desc[eth_rx_index];
+        uint32_t status = desc->Status;
+
+        if ((status & ETH_DMARxDesc_OWN) != 0U) {
+            return 0U;
+        }
+        if ((status & (ETH_DMARxDesc_ES | ETH_DMARxDesc_FS | ETH_DMARxDesc_LS)) ==
+            (ETH_DMARxDesc_FS | ETH_DMARxDesc_LS))
+        {
+            uint32_t len = (status & ETH_DMARxDesc_FL) >> 16;
+            if (len > 4U) {
+                *frame = eth_rx_buf[eth_rx_index];
+                return len - 4U;            // 去掉 FCS
+            }
+        }
+        myeth_rx_release();
+    }
+}
+
+void myeth_rx_release(void)
+{
+    eth_rx_desc[eth_rx_index].Status = ETH_DMARxDesc_OWN;
+    eth_rx_index = (eth_rx_index + 1U) % ETH_RX_DESC_NUM;
+
+    /* 描述符曾全部用完时 DMA 已挂起，归还后唤醒 */
+    if ((ETH->DMASR & ETH_DMASR_RBUS) != 0U)
+    {
+        ETH->DMASR = ETH_DMASR_RBUS;
+        ETH->DMARPDR = 0U;
+    }
+}
+
+uint8_t *myeth_tx_acquire(void)
+{
+    if ((eth_tx_desc[eth_tx_index].Status & ETH_DMATxDesc_OWN) != 0U) {
+        return NULL;
+    }
+    return eth_tx_buf[eth_tx_index];
+}
+
+void myeth_tx_submit(uint32_t len)
+{
+    ETH_DMADESCTypeDef *desc = &eth_tx_desc[eth_tx_index];
+
+    desc->ControlBufferSize = len & ETH_DMATxDesc_TBS1;
+    desc->Status = ETH_DMATxDesc_TCH | ETH_DMATxDesc_FS | ETH_DMATxDesc_LS | ETH_DMATxDesc_OWN;
+    eth_tx_index = (eth_tx_index + 1U) % ETH_TX_DESC_NUM;
+
+    if ((ETH->DMASR & ETH_DMASR_TBUS) != 0U)
+    {
+        ETH->DMASR = ETH_DMASR_TBUS;
+    }
+    ETH->DMATPDR = 0U;
+}
@@ -0,0 +1,21 @@
+#ifndef MYETH_H_
+#define MYETH_H_
+
+#include "bsp_sys.h"
+#include "ch32v30x_eth.h"
+
+#define ETH_RX_DESC_NUM        6U      // 接收描述符个数，须大于升级窗口帧数
+#define ETH_TX_DESC_NUM        2U
+#define ETH_PHY_ADDRESS        1U      // 内置 10M PHY 地址
+
+
+void myeth_init(void);
+void myeth_deinit(void);
+void myeth_get_mac(uint8_t *mac);
+uint32_t myeth_rx_peek(const uint8_t **frame);
+void myeth_rx_release(void);
+uint8_t *myeth_tx_acquire(void);
+void myeth_tx_submit(uint32_t len);
+
+
+#endif /* MYETH_H_ */
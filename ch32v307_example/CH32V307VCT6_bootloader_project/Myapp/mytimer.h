@@ -2,9 +2,10 @@
 #define MYAPP_MYTIMER_H_
 
 #include "bsp_sys.h"
-extern uint32_t uwtick;
+extern volatile uint32_t uwtick;
 
 uint32_t get_uwtick(void);
+uint32_t get_ustick(void);
 void mytim6_init(void);
 
 #endif /* MYAPP_MYTIMER_H_ */
@@ -1,23 +1,70 @@
 #include "myuart.h"
-#include "ringbuffer.h"
 #define UART2_BAUDRATE        115200U
 
-uint8_t uart2_buffer[UART2_RX_BUFFER_SIZE];
+/* DMA 缓冲区本身就是环形缓存区：DMA1 通道 6 以循环模式一直运行，中断次数按帧计而不是按字节计 */
+static uint8_t uart2_buffer[UART2_RX_BUFFER_SIZE];
 uint32_t uart2_tick;
-struct rt_ringbuffer uart2_ringbuffer;
+uart_dma_ring_t uart2_rx_ring = {DMA1_Channel6, uart2_buffer, UART2_RX_BUFFER_SIZE};
 
+/* USART1 为日志口（USART_Printf_Init 已配置），USART2 为升级链路 */
+uart_dma_tx_t uart1_tx = {USART1, DMA1_Channel4, DMA1_Channel4_IRQn, DMA1_IT_TC4};
+uart_dma_tx_t uart2_tx = {USART2, DMA1_Channel7, DMA1_Channel7_IRQn, DMA1_IT_TC7};
 
 
+static void uart_dma_nvic_init(IRQn_Type irqn)
+{
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    NVIC_InitStructure.NVIC_IRQChannel = irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+static void uart_dma_tx_init(uart_dma_tx_t *tx)
+{
+    DMA_InitTypeDef DMA_InitStructure = {0};
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    DMA_DeInit(tx->channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&tx->usart->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tx->buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(tx->channel, &DMA_InitStructure);
+    DMA_ITConfig(tx->channel, DMA_IT_TC, ENABLE);
+
+    USART_DMACmd(tx->usart, USART_DMAReq_Tx, ENABLE);
+    uart_dma_nvic_init(tx->irqn);
+    tx->busy = 0U;
+    tx->enabled = 1U;
+}
+
+//日志口只发送，USART1 本身由 USART_Printf_Init 初始化，这里只接上 DMA 发送
+void myuart1_init(void)
+{
+    uart_dma_tx_init(&uart1_tx);
+}
 
 void myuart2_init(void)
 {
     GPIO_InitTypeDef GPIO_InitStructure = {0};
     USART_InitTypeDef USART_InitStructure = {0};
-    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    DMA_InitTypeDef DMA_InitStructure = {0};
 
 
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
 
     /* PA2 -> TX */
     GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;
@@ -40,44 +87,187 @@ void myuart2_init(void)
     USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
     USART_Init(USART2, &USART_InitStructure);
 
-    USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+    /* 接收：循环模式，半满/全满中断保证 DMA 每跑半圈至少推进一次写位置，用于判断覆盖 */
+    DMA_DeInit(DMA1_Channel6);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)uart2_buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = UART2_RX_BUFFER_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel6, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel6, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    boot_ring_init(&uart2_rx_ring.ring, uart2_rx_ring.buf, uart2_rx_ring.size);
+    DMA_Cmd(DMA1_Channel6, ENABLE);
+    uart_dma_nvic_init(DMA1_Channel6_IRQn);
+
+    uart_dma_tx_init(&uart2_tx);
+
+    /* 空闲中断标记一帧结束，错误中断处理溢出；不再开 RXNE，每个字节都由 DMA 搬运 */
+    USART_DMACmd(USART2, USART_DMAReq_Rx, ENABLE);
+    USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
+    USART_ITConfig(USART2, USART_IT_ERR, ENABLE);
     USART_Cmd(USART2, ENABLE);
+    uart_dma_nvic_init(USART2_IRQn);
+}
 
-    NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
-    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
-    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-    NVIC_Init(&NVIC_InitStructure);
+//跳转 APP 前调用：等待发送完成后关闭 DMA 与串口中断
+void myuart_deinit(void)
+{
+    uart_dma_flush(&uart1_tx);
+    uart_dma_flush(&uart2_tx);
 
-    //环形缓存区初始化
-    rt_ringbuffer_init(&uart2_ringbuffer, uart2_buffer, UART2_RX_BUFFER_SIZE);
+    USART_ITConfig(USART2, USART_IT_IDLE, DISABLE);
+    USART_ITConfig(USART2, USART_IT_ERR, DISABLE);
+    USART_DMACmd(USART2, USART_DMAReq_Rx | USART_DMAReq_Tx, DISABLE);
+    USART_DMACmd(USART1, USART_DMAReq_Tx, DISABLE);
+    DMA_DeInit(DMA1_Channel4);
+    DMA_DeInit(DMA1_Channel6);
+    DMA_DeInit(DMA1_Channel7);
+    uart1_tx.enabled = 0U;
+    uart2_tx.enabled = 0U;
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, DISABLE);
+}
+
+//推进写位置：pos 由 DMA 剩余计数得到，半满/全满中断保证两次推进之间 DMA 不会跑满一圈
+static void uart_dma_ring_advance(uart_dma_ring_t *ring)
+{
+    uint16_t pos = (uint16_t)(ring->size - DMA_GetCurrDataCounter(ring->channel));
+    uint32_t add = (pos - ring->ring.head) & ring->ring.mask;  // 计数器重装时 pos == size，与 0 等价
+    if (add == 0U)
+        return;
+
+    if (boot_ring_data_len(&ring->ring) + add >= ring->size)   //DMA 追上读位置，未读数据已被覆盖
+    {
+        ring->overrun = 1U;
+        ring->lost++;
+    }
+    boot_ring_commit_write(&ring->ring, add);
+}
+
+uint16_t uart_dma_ring_data_len(const uart_dma_ring_t *ring)
+{
+    uint32_t len = boot_ring_data_len(&ring->ring);
+    return (uint16_t)((len > ring->size) ? ring->size : len);
+}
+
+uint16_t uart_dma_ring_read(uart_dma_ring_t *ring, uint8_t *buf, uint16_t max_len)
+{
+    if (ring->overrun)
+    {
+        ring->overrun = 0U;
+        boot_ring_commit_read(&ring->ring, boot_ring_data_len(&ring->ring));
+        return 0U;
+    }
+
+    uint16_t len = (uint16_t)boot_ring_read(&ring->ring, buf, max_len);
+    if (ring->overrun)  //拷贝期间被覆盖，本次读到的数据不可信，下次读取时重新同步
+        return 0U;
+    return len;
 }
 
 void USART2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void USART2_IRQHandler(void)
 {
-    if (USART_GetITStatus(USART2, USART_IT_RXNE) != RESET)
+    uint16_t status = USART2->STATR;
+
+    if (status & (USART_FLAG_IDLE | USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE))
     {
-        uint8_t data = (uint8_t)USART_ReceiveData(USART2);
-        uart2_tick=get_uwtick();
-        rt_ringbuffer_put(&uart2_ringbuffer, &data, 1);
+        (void)USART2->DATAR;    //先读 STATR 再读 DATAR 清除空闲与错误标志
+        if (status & USART_FLAG_ORE)
+        {
+            uart2_rx_ring.overrun = 1U;
+            uart2_rx_ring.lost++;
+        }
+        uart2_tick = get_uwtick();
+        uart_dma_ring_advance(&uart2_rx_ring);
+        scheduler_post(TASK_BOOTLOADER);
     }
 }
 
+void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void DMA1_Channel6_IRQHandler(void)
+{
+    DMA_ClearITPendingBit(DMA1_IT_GL6);
+    uart_dma_ring_advance(&uart2_rx_ring);
+    scheduler_post(TASK_BOOTLOADER);
+}
+
+static void uart_dma_tx_irq(uart_dma_tx_t *tx)
+{
+    if (DMA_GetITStatus(tx->tc_it) != RESET)
+    {
+        DMA_ClearITPendingBit(tx->tc_it);
+        DMA_Cmd(tx->channel, DISABLE);
+        tx->busy = 0U;
+        if (tx->done != NULL)
+            tx->done();
+    }
+}
+
+void DMA1_Channel4_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void DMA1_Channel4_IRQHandler(void)
+{
+    uart_dma_tx_irq(&uart1_tx);
+}
+
+void DMA1_Channel7_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void DMA1_Channel7_IRQHandler(void)
+{
+    uart_dma_tx_irq(&uart2_tx);
+}
+
+//拷入发送缓冲后启动 DMA 立即返回，上一段还没发完时先等它完成；超过缓冲的数据分段发送
+void uart_dma_send(uart_dma_tx_t *tx, const uint8_t *data, uint32_t len)
+{
+    if (!tx->enabled)
+    {
+        for (uint32_t i = 0; i < len; i++)
+        {
+            while (USART_GetFlagStatus(tx->usart, USART_FLAG_TXE) == RESET);
+            USART_SendData(tx->usart, data[i]);
+        }
+        return;
+    }
+
+    while (len > 0U)
+    {
+        uint32_t chunk = (len > UART_TX_BUFFER_SIZE) ? UART_TX_BUFFER_SIZE : len;
+        while (tx->busy);
+        memcpy(tx->buf, data, chunk);
+        tx->busy = 1U;
+        tx->channel->CNTR = chunk;
+        DMA_Cmd(tx->channel, ENABLE);
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+//等待 DMA 与移位寄存器都发送完毕，复位或跳转前调用，保证最后的应答完整发出
+void uart_dma_flush(uart_dma_tx_t *tx)
+{
+    if (!tx->enabled)
+        return;
+    while (tx->busy);
+    while (USART_GetFlagStatus(tx->usart, USART_FLAG_TC) == RESET);
+}
+
 
 void uart2_task(void)
 {
     if(uwtick-uart2_tick>=10)
     {
-        rt_uint16_t data_len = rt_ringbuffer_data_len(&uart2_ringbuffer);
-        if(data_len > 0U)
+        uint8_t uart2_read[128];
+        uint16_t read_len = uart_dma_ring_read(&uart2_rx_ring, uart2_read, sizeof(uart2_read) - 1U);
+        if(read_len > 0U)
         {
-            uint8_t uart2_read[UART2_RX_BUFFER_SIZE];
-            rt_uint16_t read_len = rt_ringbuffer_get(&uart2_ringbuffer,
-                                                     uart2_read,
-                                                     (data_len > UART2_RX_BUFFER_SIZE) ? UART2_RX_BUFFER_SIZE : data_len);
+            uart2_read[read_len] = 0;
             uart_printf(USART2, "%s\r\n",uart2_read);
-            memset(uart2_read,0,read_len);
         }
 
 
@@ -97,12 +287,11 @@ int uart_printf(USART_TypeDef *USARTx, const char* format, ...) {
     if (len < 0) {
         return -1;  // 格式化失败
     }
-
-    // 通过UART发送格式化后的字符串
-    for(int i=0;i<len;i++)
-    {
-       while (!(USARTx->STATR & USART_FLAG_TXE)); // 等待发送缓冲区为空,避免堵塞
-       USART_SendData(USARTx, buffer[i]);
+    if (len >= (int)sizeof(buffer)) {
+        len = sizeof(buffer) - 1;
     }
+
+    // 通过 DMA 发送格式化后的字符串
+    uart_dma_send((USARTx == USART1) ? &uart1_tx : &uart2_tx, (const uint8_t *)buffer, (uint32_t)len);
     return len;
 }
@@ -3,8 +3,28 @@
 
 #include "bsp_sys.h"
 
+#define SCHEDULER_IDLE_SLEEP    1U      // 没有任务就绪时 WFI 休眠；调试时需要一直保持内核运行的话改为 0
+
+/* 任务编号，即 scheduler_task[] 的下标，中断里按编号投递事件 */
+typedef enum {
+    TASK_BOOTLOADER = 0,
+    TASK_NUM,
+} task_id_t;
+
+/* 任务统计，时间单位为微秒；到期触发的延迟按毫秒节拍计 */
+typedef struct {
+    uint32_t runs;                  // 执行次数
+    uint32_t event_runs;            // 其中由事件触发的次数
+    uint32_t max_latency_us;        // 事件投递（或到期）到开始执行的最长延迟
+    uint32_t max_run_us;            // 单次执行最长耗时
+    uint32_t total_run_us;          // 累计执行耗时
+} task_stats_t;
+
 void scheduler_init(void);
 void scheduler_run(void);
+void scheduler_post(task_id_t id);
+const task_stats_t *scheduler_get_stats(task_id_t id);
+uint32_t scheduler_idle_us(void);
 
 
 #endif
@@ -2,8 +2,11 @@
 #include "bsp_sys.h"
 
 
+extern void bootloader_fast_boot(void);
+
 int main(void)
 {
+	bootloader_fast_boot();
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
 	SystemCoreClockUpdate();
 	Delay_Init();
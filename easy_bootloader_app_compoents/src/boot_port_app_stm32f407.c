@@ -1,7 +1,7 @@
 #include "boot_config_app.h"
 #include "easy_bootloader_app.h"
 #include "main.h"
-#include "ringbuffer.h"
+#include "myusart.h"
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -9,46 +9,40 @@
 /* 外部变量声明 */
 extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart2;
-extern struct rt_ringbuffer uart2_ringbuffer_struct;
-
-/* STM32F407 Flash 扇区信息 */
-typedef struct {
-    uint32_t start_addr;
-    uint32_t size;
-    uint32_t sector_id;
-} flash_sector_t;
-
-static const flash_sector_t flash_sectors[] = {
-    {0x08000000, 0x4000,  FLASH_SECTOR_0},   // 16KB
-    {0x08004000, 0x4000,  FLASH_SECTOR_1},   // 16KB
-    {0x08008000, 0x4000,  FLASH_SECTOR_2},   // 16KB
-    {0x0800C000, 0x4000,  FLASH_SECTOR_3},   // 16KB
-    {0x08010000, 0x10000, FLASH_SECTOR_4},   // 64KB  - APP 起始
-    {0x08020000, 0x20000, FLASH_SECTOR_5},   // 128KB
-    {0x08040000, 0x20000, FLASH_SECTOR_6},   // 128KB
-    {0x08060000, 0x20000, FLASH_SECTOR_7},   // 128KB
-    {0x08080000, 0x20000, FLASH_SECTOR_8},   // 128KB
-    {0x080A0000, 0x20000, FLASH_SECTOR_9},   // 128KB
-    {0x080C0000, 0x20000, FLASH_SECTOR_10},  // 128KB
-    {0x080E0000, 0x20000, FLASH_SECTOR_11},  // 128KB - 标志区
-};
-#define FLASH_SECTOR_COUNT (sizeof(flash_sectors) / sizeof(flash_sectors[0]))
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+/* 网关下游链路：USART3、USART6 各接一个子节点，接收方式同 USART2（循环 DMA 接收环，见 Myapp/myusart.c） */
+extern UART_HandleTypeDef huart3;
+extern UART_HandleTypeDef huart6;
+extern uart_dma_ring_t uart3_rx_ring;
+extern uart_dma_ring_t uart6_rx_ring;
+#endif
+
+/* STM32F407 Flash 扇区起始地址（boot_memmap_app.h 生成），扇区号即下标，末项为 Flash 结束地址 */
+static const uint32_t flash_sector_start[BOOT_APP_FLASH_SECTOR_COUNT + 1U] = BOOT_APP_FLASH_SECTOR_STARTS;
 
 uint32_t boot_port_app_get_tick(void)
 {
     return HAL_GetTick();
 }
 
-/* 根据地址获取扇区索引 */
+/* 根据地址获取扇区索引：在扇区起始地址表中二分查找 */
 static int get_sector_index(uint32_t addr)
 {
-    for (int i = 0; i < FLASH_SECTOR_COUNT; i++) {
-        if (addr >= flash_sectors[i].start_addr &&
-            addr < flash_sectors[i].start_addr + flash_sectors[i].size) {
-            return i;
+    uint32_t lo = 0U;
+    uint32_t hi = BOOT_APP_FLASH_SECTOR_COUNT;
+
+    if (addr < flash_sector_start[0] || addr >= flash_sector_start[BOOT_APP_FLASH_SECTOR_COUNT]) {
+        return -1;
+    }
+    while (hi - lo > 1U) {      // flash_sector_start[lo] <= addr < flash_sector_start[hi]
+        uint32_t mid = (lo + hi) / 2U;
+        if (addr >= flash_sector_start[mid]) {
+            lo = mid;
+        } else {
+            hi = mid;
         }
     }
-    return -1;
+    return (int)lo;
 }
 
 boot_port_app_status_t boot_port_app_flash_erase(uint32_t addr, uint32_t size)
@@ -73,7 +67,7 @@ boot_port_app_status_t boot_port_app_flash_erase(uint32_t addr, uint32_t size)
     for (int i = start_sector; i <= end_sector; i++) {
         erase_init.TypeErase = FLASH_TYPEERASE_SECTORS;
         erase_init.VoltageRange = FLASH_VOLTAGE_RANGE_3;  // 2.7V - 3.6V
-        erase_init.Sector = flash_sectors[i].sector_id;
+        erase_init.Sector = (uint32_t)i;   // FLASH_SECTOR_n 即 n
         erase_init.NbSectors = 1;
 
         status = HAL_FLASHEx_Erase(&erase_init, &sector_error);
@@ -123,8 +117,30 @@ boot_port_app_status_t boot_port_app_uart_write(const uint8_t *data, uint32_t le
 
 uint32_t boot_port_app_uart_read(uint8_t *buf, uint32_t max_len)
 {
-    return rt_ringbuffer_get(&uart2_ringbuffer_struct, buf, max_len);
+    return uart_dma_ring_read(&uart2_rx_ring, buf, (max_len > 0xFFFFU) ? 0xFFFFU : (uint16_t)max_len);
+}
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+static UART_HandleTypeDef *const child_uarts[BOOT_APP_GATEWAY_CHILDREN] = {&huart3, &huart6};
+static uart_dma_ring_t *const child_rx[BOOT_APP_GATEWAY_CHILDREN] = {&uart3_rx_ring, &uart6_rx_ring};
+
+boot_port_app_status_t boot_port_app_child_write(uint8_t child, const uint8_t *data, uint32_t len)
+{
+    if (child >= BOOT_APP_GATEWAY_CHILDREN) {
+        return BOOT_PORT_APP_ERROR;
+    }
+    HAL_StatusTypeDef status = HAL_UART_Transmit(child_uarts[child], (uint8_t *)data, len, 1000);
+    return (status == HAL_OK) ? BOOT_PORT_APP_OK : BOOT_PORT_APP_ERROR;
+}
+
+uint32_t boot_port_app_child_read(uint8_t child, uint8_t *buf, uint32_t max_len)
+{
+    if (child >= BOOT_APP_GATEWAY_CHILDREN) {
+        return 0U;
+    }
+    return uart_dma_ring_read(child_rx[child], buf, (max_len > 0xFFFFU) ? 0xFFFFU : (uint16_t)max_len);
 }
+#endif
 
 void boot_port_app_log(const char *fmt, ...)
 {
@@ -157,6 +173,10 @@ boot_app_ops_t boot_port_app_ops = {
     .boot_port_app_data_read = boot_port_app_uart_read,
     .boot_port_app_log = boot_port_app_log,
     .boot_port_app_system_reset = boot_port_app_system_reset,
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+    .boot_port_app_child_write = boot_port_app_child_write,
+    .boot_port_app_child_read = boot_port_app_child_read,
+#endif
 };
 
 void bootloader_app_init(void)
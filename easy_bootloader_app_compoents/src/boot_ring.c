@@ -0,0 +1,136 @@
+// 单生产者 / 单消费者无锁环形缓冲区
+#include "boot_ring.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * 读对方的计数用获取语义：之后对缓冲区的访问不会被提前到读计数之前；
+ * 写自己的计数用释放语义：之前对缓冲区的访问都在计数更新之前完成。
+ * 单核 MCU 上主要是阻止编译器重排，多核或带写缓冲的内核上同时产生内存屏障
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define RING_LOAD_ACQUIRE(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(__CC_ARM)
+static __inline uint32_t ring_load_acquire(const volatile uint32_t *p)
+{
+    uint32_t v = *p;
+    __dmb(0xF);
+    return v;
+}
+static __inline void ring_store_release(volatile uint32_t *p, uint32_t v)
+{
+    __dmb(0xF);
+    *p = v;
+}
+#define RING_LOAD_ACQUIRE(p)        ring_load_acquire(p)
+#define RING_STORE_RELEASE(p, v)    ring_store_release((p), (v))
+#else
+#error "boot_ring: no acquire/release primitives for this compiler"
+#endif
+
+boot_ring_status_t boot_ring_init(boot_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+    if (ring == NULL || buf == NULL || size == 0U || (size & (size - 1U)) != 0U || size > 0x80000000UL) {
+        return BOOT_RING_ERROR;
+    }
+
+    ring->buf = buf;
+    ring->mask = size - 1U;
+    ring->head = 0U;
+    ring->tail = 0U;
+    return BOOT_RING_OK;
+}
+
+uint32_t boot_ring_data_len(const boot_ring_t *ring)
+{
+    uint32_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+    return RING_LOAD_ACQUIRE(&ring->head) - tail;
+}
+
+uint32_t boot_ring_space_len(const boot_ring_t *ring)
+{
+    return ring->mask + 1U - boot_ring_data_len(ring);
+}
+
+uint32_t boot_ring_acquire_read(boot_ring_t *ring, const uint8_t **data)
+{
+    return boot_ring_peek(ring, 0U, data);
+}
+
+uint32_t boot_ring_peek(boot_ring_t *ring, uint32_t offset, const uint8_t **data)
+{
+    uint32_t tail = ring->tail + offset;
+    uint32_t avail = RING_LOAD_ACQUIRE(&ring->head) - tail;
+    uint32_t pos = tail & ring->mask;
+    uint32_t contiguous = ring->mask + 1U - pos;
+
+    *data = &ring->buf[pos];
+    if (avail > ring->mask + 1U) {
+        return 0U;      // offset 超出未读数据
+    }
+    return (avail < contiguous) ? avail : contiguous;
+}
+
+void boot_ring_commit_read(boot_ring_t *ring, uint32_t len)
+{
+    RING_STORE_RELEASE(&ring->tail, ring->tail + len);
+}
+
+uint32_t boot_ring_acquire_write(boot_ring_t *ring, uint8_t **data)
+{
+    uint32_t head = ring->head;
+    uint32_t space = ring->mask + 1U - (head - RING_LOAD_ACQUIRE(&ring->tail));
+    uint32_t pos = head & ring->mask;
+    uint32_t contiguous = ring->mask + 1U - pos;
+
+    *data = &ring->buf[pos];
+    return (space < contiguous) ? space : contiguous;
+}
+
+void boot_ring_commit_write(boot_ring_t *ring, uint32_t len)
+{
+    RING_STORE_RELEASE(&ring->head, ring->head + len);
+}
+
+uint32_t boot_ring_read(boot_ring_t *ring, uint8_t *buf, uint32_t max_len)
+{
+    uint32_t done = 0U;
+
+    /* 最多两段：到缓冲区末尾一段，回绕后一段 */
+    while (done < max_len) {
+        const uint8_t *data;
+        uint32_t len = boot_ring_acquire_read(ring, &data);
+        if (len == 0U) {
+            break;
+        }
+        if (len > max_len - done) {
+            len = max_len - done;
+        }
+        memcpy(&buf[done], data, len);
+        boot_ring_commit_read(ring, len);
+        done += len;
+    }
+    return done;
+}
+
+uint32_t boot_ring_write(boot_ring_t *ring, const uint8_t *data, uint32_t len)
+{
+    uint32_t done = 0U;
+
+    while (done < len) {
+        uint8_t *dst;
+        uint32_t space = boot_ring_acquire_write(ring, &dst);
+        if (space == 0U) {
+            break;
+        }
+        if (space > len - done) {
+            space = len - done;
+        }
+        memcpy(dst, &data[done], space);
+        boot_ring_commit_write(ring, space);
+        done += space;
+    }
+    return done;
+}
@@ -0,0 +1,164 @@
+// SHA-256 流式摘要源文件
+#include "boot_sha256.h"
+
+#include <string.h>
+
+/*
+ * 实现要点（面向 Cortex-M4 / RV32IMAC）：
+ * 1. 消息扩展只保留 16 字滑动窗口，W[] 常驻寄存器/栈顶，不额外占 256B RAM
+ * 2. 64 轮按 8 轮一组展开，a~h 通过宏参数轮换，省掉每轮 8 次寄存器搬移
+ * 3. 输入已满一块时直接从源缓冲区按字读取，不再拷贝到 block[]
+ * Cortex-M4 上 ROTR 编译为单条 ROR，RV32IMAC 无 Zbb 时为两次移位加一次或
+ */
+
+#define SHA_ROTR(x, n)    (((x) >> (n)) | ((x) << (32U - (n))))
+#define SHA_CH(x, y, z)   ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA_MAJ(x, y, z)  (((x) & (y)) | ((z) & ((x) | (y))))
+#define SHA_EP0(x)        (SHA_ROTR(x, 2U) ^ SHA_ROTR(x, 13U) ^ SHA_ROTR(x, 22U))
+#define SHA_EP1(x)        (SHA_ROTR(x, 6U) ^ SHA_ROTR(x, 11U) ^ SHA_ROTR(x, 25U))
+#define SHA_SIG0(x)       (SHA_ROTR(x, 7U) ^ SHA_ROTR(x, 18U) ^ ((x) >> 3U))
+#define SHA_SIG1(x)       (SHA_ROTR(x, 17U) ^ SHA_ROTR(x, 19U) ^ ((x) >> 10U))
+
+#define SHA_LOAD_BE32(p)  (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                           ((uint32_t)(p)[2] << 8)  | (uint32_t)(p)[3])
+
+/* 第 i 轮（i >= 16）时原地更新窗口 W[i & 15] */
+#define SHA_EXPAND(w, i)  ((w)[(i) & 15U] += SHA_SIG1((w)[((i) - 2U) & 15U]) + \
+                           (w)[((i) - 7U) & 15U] + SHA_SIG0((w)[((i) - 15U) & 15U]))
+
+#define SHA_ROUND(a, b, c, d, e, f, g, h, k, wv)                    \
+    do {                                                            \
+        uint32_t t1 = (h) + SHA_EP1(e) + SHA_CH(e, f, g) + (k) + (wv); \
+        uint32_t t2 = SHA_EP0(a) + SHA_MAJ(a, b, c);                \
+        (d) += t1;                                                  \
+        (h) = t1 + t2;                                              \
+    } while (0)
+
+static const uint32_t g_sha256_k[64] = {
+    0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U, 0x923F82A4U, 0xAB1C5ED5U,
+    0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U, 0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U,
+    0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+    0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U, 0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U,
+    0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U, 0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U,
+    0xA2BFE8A1U, 0xA81A664BU, 0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+    0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+    0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U, 0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U,
+};
+
+static void sha256_transform(uint32_t state[8], const uint8_t *block)
+{
+    uint32_t w[16];
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (uint32_t i = 0U; i < 16U; i++) {
+        w[i] = SHA_LOAD_BE32(&block[i * 4U]);
+    }
+
+    /* 前 16 轮直接使用输入字 */
+    for (uint32_t i = 0U; i < 16U; i += 8U) {
+        SHA_ROUND(a, b, c, d, e, f, g, h, g_sha256_k[i + 0U], w[i + 0U]);
+        SHA_ROUND(h, a, b, c, d, e, f, g, g_sha256_k[i + 1U], w[i + 1U]);
+        SHA_ROUND(g, h, a, b, c, d, e, f, g_sha256_k[i + 2U], w[i + 2U]);
+        SHA_ROUND(f, g, h, a, b, c, d, e, g_sha256_k[i + 3U], w[i + 3U]);
+        SHA_ROUND(e, f, g, h, a, b, c, d, g_sha256_k[i + 4U], w[i + 4U]);
+        SHA_ROUND(d, e, f, g, h, a, b, c, g_sha256_k[i + 5U], w[i + 5U]);
+        SHA_ROUND(c, d, e, f, g, h, a, b, g_sha256_k[i + 6U], w[i + 6U]);
+        SHA_ROUND(b, c, d, e, f, g, h, a, g_sha256_k[i + 7U], w[i + 7U]);
+    }
+
+    /* 后 48 轮边扩展边计算 */
+    for (uint32_t i = 16U; i < 64U; i += 8U) {
+        SHA_ROUND(a, b, c, d, e, f, g, h, g_sha256_k[i + 0U], SHA_EXPAND(w, i + 0U));
+        SHA_ROUND(h, a, b, c, d, e, f, g, g_sha256_k[i + 1U], SHA_EXPAND(w, i + 1U));
+        SHA_ROUND(g, h, a, b, c, d, e, f, g_sha256_k[i + 2U], SHA_EXPAND(w, i + 2U));
+        SHA_ROUND(f, g, h, a, b, c, d, e, g_sha256_k[i + 3U], SHA_EXPAND(w, i + 3U));
+        SHA_ROUND(e, f, g, h, a, b, c, d, g_sha256_k[i + 4U], SHA_EXPAND(w, i + 4U));
+        SHA_ROUND(d, e, f, g, h, a, b, c, g_sha256_k[i + 5U], SHA_EXPAND(w, i + 5U));
+        SHA_ROUND(c, d, e, f, g, h, a, b, g_sha256_k[i + 6U], SHA_EXPAND(w, i + 6U));
+        SHA_ROUND(b, c, d, e, f, g, h, a, g_sha256_k[i + 7U], SHA_EXPAND(w, i + 7U));
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void boot_sha256_init(boot_sha256_ctx_t *ctx)
+{
+    ctx->state[0] = 0x6A09E667U;
+    ctx->state[1] = 0xBB67AE85U;
+    ctx->state[2] = 0x3C6EF372U;
+    ctx->state[3] = 0xA54FF53AU;
+    ctx->state[4] = 0x510E527FU;
+    ctx->state[5] = 0x9B05688CU;
+    ctx->state[6] = 0x1F83D9ABU;
+    ctx->state[7] = 0x5BE0CD19U;
+    ctx->total_len = 0U;
+    ctx->block_len = 0U;
+}
+
+void boot_sha256_update(boot_sha256_ctx_t *ctx, const uint8_t *data, uint32_t len)
+{
+    ctx->total_len += len;
+
+    /* 先补齐上次残留的不完整块 */
+    if (ctx->block_len > 0U) {
+        uint32_t fill = BOOT_SHA256_BLOCK_SIZE - ctx->block_len;
+        if (fill > len) {
+            fill = len;
+        }
+        memcpy(&ctx->block[ctx->block_len], data, fill);
+        ctx->block_len += (uint8_t)fill;
+        data += fill;
+        len -= fill;
+        if (ctx->block_len < BOOT_SHA256_BLOCK_SIZE) {
+            return;
+        }
+        sha256_transform(ctx->state, ctx->block);
+        ctx->block_len = 0U;
+    }
+
+    /* 整块直接从源数据计算 */
+    while (len >= BOOT_SHA256_BLOCK_SIZE) {
+        sha256_transform(ctx->state, data);
+        data += BOOT_SHA256_BLOCK_SIZE;
+        len -= BOOT_SHA256_BLOCK_SIZE;
+    }
+
+    if (len > 0U) {
+        memcpy(ctx->block, data, len);
+        ctx->block_len = (uint8_t)len;
+    }
+}
+
+void boot_sha256_final(boot_sha256_ctx_t *ctx, uint8_t digest[BOOT_SHA256_DIGEST_SIZE])
+{
+    uint32_t bit_len_hi = ctx->total_len >> 29;
+    uint32_t bit_len_lo = ctx->total_len << 3;
+
+    ctx->block[ctx->block_len++] = 0x80U;
+    if (ctx->block_len > (BOOT_SHA256_BLOCK_SIZE - 8U)) {
+        memset(&ctx->block[ctx->block_len], 0, BOOT_SHA256_BLOCK_SIZE - ctx->block_len);
+        sha256_transform(ctx->state, ctx->block);
+        ctx->block_len = 0U;
+    }
+    memset(&ctx->block[ctx->block_len], 0, (BOOT_SHA256_BLOCK_SIZE - 8U) - ctx->block_len);
+
+    /* 消息比特长度，大端 64 位 */
+    ctx->block[56] = (uint8_t)(bit_len_hi >> 24);
+    ctx->block[57] = (uint8_t)(bit_len_hi >> 16);
+    ctx->block[58] = (uint8_t)(bit_len_hi >> 8);
+    ctx->block[59] = (uint8_t)bit_len_hi;
+    ctx->block[60] = (uint8_t)(bit_len_lo >> 24);
+    ctx->block[61] = (uint8_t)(bit_len_lo >> 16);
+    ctx->block[62] = (uint8_t)(bit_len_lo >> 8);
+    ctx->block[63] = (uint8_t)bit_len_lo;
+    sha256_transform(ctx->state, ctx->block);
+
+    for (uint32_t i = 0U; i < 8U; i++) {
+        digest[i * 4U + 0U] = (uint8_t)(ctx->state[i] >> 24);
+        digest[i * 4U + 1U] = (uint8_t)(ctx->state[i] >> 16);
+        digest[i * 4U + 2U] = (uint8_t)(ctx->state[i] >> 8);
+        digest[i * 4U + 3U] = (uint8_t)ctx->state[i];
+    }
+}
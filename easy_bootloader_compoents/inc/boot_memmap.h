@@ -0,0 +1,37 @@
+// STM32F407VGT6 Flash / RAM 布局，由 PC tool/source/memmap_gen.py 根据 memmap.json 生成，不要手工修改
+#ifndef BOOT_MEMMAP_H
+#define BOOT_MEMMAP_H
+
+#define BOOT_MEMMAP_STAGING           0U            // 生成时的暂存区开关，须与配置头文件中的开关一致
+
+#define BOOT_BOOTLOADER_START_ADDR    0x08000000U
+#define BOOT_BOOTLOADER_SIZE          0x00010000U
+#define BOOT_APP_START_ADDR           0x08010000U
+#define BOOT_APP_MAX_SIZE             0x000D0000U   // APP 链接区域同此大小
+#define BOOT_APP_END_ADDR             (BOOT_APP_START_ADDR + BOOT_APP_MAX_SIZE - 1U)
+#define BOOT_STAGING_ADDR             0x08080000U
+#define BOOT_STAGING_SIZE             0x00060000U
+#define BOOT_FLAG_REGION_ADDR         0x080E0000U
+#define BOOT_FLAG_REGION_SIZE         0x00020000U
+
+/* RAM 范围（校验 APP 栈指针，结束地址即初始栈顶的上限） */
+#define BOOT_SRAM_START_ADDR          0x20000000U
+#define BOOT_SRAM_END_ADDR            0x20020000U
+#define BOOT_HAS_CCM                  1U
+#define BOOT_CCM_START_ADDR           0x10000000U
+#define BOOT_CCM_END_ADDR             0x10010000U
+
+/* Bootloader -> APP 交接区：RAM 末尾，两侧链接区域均已扣除 */
+#define BOOT_HANDOFF_ADDR             0x2001FF00U
+#define BOOT_HANDOFF_SIZE             0x00000100U
+
+#define BOOT_FLASH_START_ADDR         0x08000000U
+#define BOOT_FLASH_END_ADDR           0x08100000U
+#define BOOT_FLASH_SECTOR_COUNT       12U
+/* 各扇区起始地址，扇区号即下标，末项为 Flash 结束地址（BOOT_FLASH_SECTOR_COUNT + 1 项） */
+#define BOOT_FLASH_SECTOR_STARTS      {0x08000000U, 0x08004000U, 0x08008000U, 0x0800C000U, \
+                                       0x08010000U, 0x08020000U, 0x08040000U, 0x08060000U, \
+                                       0x08080000U, 0x080A0000U, 0x080C0000U, 0x080E0000U, \
+                                       0x08100000U}
+
+#endif // BOOT_MEMMAP_H
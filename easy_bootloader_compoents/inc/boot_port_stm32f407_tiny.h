@@ -0,0 +1,124 @@
+// STM32F407 寄存器级移植层的热路径函数：BOOT_CONFIG_STATIC_PORT 时由核心直接包含并内联，否则只由 boot_port_stm32f407_tiny.c 放入 ops
+#ifndef BOOT_PORT_STM32F407_TINY_H
+#define BOOT_PORT_STM32F407_TINY_H
+
+#include "boot_config.h"
+
+#if BOOT_CONFIG_PROFILE_TINY
+#include "easy_bootloader.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+#define TINY_FLASH_KEY1               0x45670123U
+#define TINY_FLASH_KEY2               0xCDEF89ABU
+#define TINY_FLASH_SR_ERRORS          (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR)
+#define TINY_RX_MASK                  (BOOT_TINY_RX_RING_SIZE - 1U)
+
+/* 定义在 boot_port_stm32f407_tiny.c */
+extern volatile uint32_t tiny_tick;
+extern uint8_t tiny_rx_ring[BOOT_TINY_RX_RING_SIZE];    // USART2 循环 DMA 接收环
+extern uint32_t tiny_rx_tail;                           // 已消费的总字节数，只取低位定位
+
+static inline uint32_t boot_port_get_tick(void)
+{
+    return tiny_tick;
+}
+
+static inline void tiny_flash_unlock(void)
+{
+    if ((FLASH->CR & FLASH_CR_LOCK) != 0U) {
+        FLASH->KEYR = TINY_FLASH_KEY1;
+        FLASH->KEYR = TINY_FLASH_KEY2;
+    }
+    FLASH->SR = TINY_FLASH_SR_ERRORS;   // 清除上次残留的错误标志（写 1 清零）
+}
+
+static inline boot_port_status_t tiny_flash_wait(void)
+{
+    uint32_t errors;
+
+    while ((FLASH->SR & FLASH_SR_BSY) != 0U) {
+    }
+    errors = FLASH->SR & TINY_FLASH_SR_ERRORS;
+    FLASH->SR = errors;
+    return (errors == 0U) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+}
+
+static inline boot_port_status_t boot_port_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    boot_port_status_t status = BOOT_PORT_OK;
+    uint32_t i;
+
+    tiny_flash_unlock();
+    FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+    /* 以 WORD (32位) 为单位写入，源数据可能不对齐（直接来自接收环），Cortex-M4 允许非对齐读 */
+    for (i = 0U; i < len; i += 4U) {
+        *(volatile uint32_t *)(addr + i) = *(const uint32_t *)(data + i);
+        status = tiny_flash_wait();
+        if (status != BOOT_PORT_OK) {
+            break;
+        }
+    }
+    FLASH->CR = FLASH_CR_LOCK;
+    return status;
+}
+
+static inline boot_port_status_t boot_port_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    memcpy(data, (const void *)addr, len);
+    return BOOT_PORT_OK;
+}
+
+static inline boot_port_status_t boot_port_data_write(const uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0U; i < len; i++) {
+        while ((USART2->SR & USART_SR_TXE) == 0U) {
+        }
+        USART2->DR = data[i];
+    }
+    return BOOT_PORT_OK;
+}
+
+/* 接收环直通：核心直接在 tiny_rx_ring 中校验数据帧并写 Flash */
+static inline uint32_t boot_port_rx_peek(uint32_t offset, const uint8_t **data)
+{
+    uint32_t head = BOOT_TINY_RX_RING_SIZE - DMA1_Stream5->NDTR;       // NDTR 为本轮剩余传输次数
+    uint32_t avail = (head - tiny_rx_tail) & TINY_RX_MASK;
+    uint32_t pos = (tiny_rx_tail + offset) & TINY_RX_MASK;
+    uint32_t contiguous = BOOT_TINY_RX_RING_SIZE - pos;
+
+    if (offset >= avail) {
+        return 0U;
+    }
+    *data = &tiny_rx_ring[pos];
+    return (avail - offset < contiguous) ? (avail - offset) : contiguous;
+}
+
+static inline boot_port_status_t boot_port_rx_consume(uint32_t len)
+{
+    tiny_rx_tail += len;
+    return BOOT_PORT_OK;
+}
+
+/* 等待完成帧时核心把数据拷入 rx_cache 解析 */
+static inline uint32_t boot_port_data_read(uint8_t *buf, uint32_t max_len)
+{
+    const uint8_t *data;
+    uint32_t done = 0U;
+    uint32_t len;
+
+    while (done < max_len && (len = boot_port_rx_peek(0U, &data)) != 0U) {
+        if (len > max_len - done) {
+            len = max_len - done;
+        }
+        memcpy(&buf[done], data, len);
+        tiny_rx_tail += len;
+        done += len;
+    }
+    return done;
+}
+
+#endif // BOOT_CONFIG_PROFILE_TINY
+#endif // BOOT_PORT_STM32F407_TINY_H
@@ -0,0 +1,78 @@
+// 最小 UDP/IPv4 协议栈头文件：ARP 应答、ICMP 回显、单端口 UDP 收发，以太网帧直接在 DMA 缓冲区中解析
+#ifndef BOOT_UDP_H
+#define BOOT_UDP_H
+
+#include <stdint.h>
+
+#define BOOT_UDP_MAC_SIZE             6U
+#define BOOT_UDP_IP_SIZE              4U
+#define BOOT_UDP_HEADER_SIZE          42U     // 以太网 14B + IPv4 20B + UDP 8B
+#define BOOT_UDP_PAYLOAD_MAX          1472U   // 1500B MTU 下单个 UDP 报文的最大载荷
+#define BOOT_UDP_FRAME_MAX            (BOOT_UDP_HEADER_SIZE + BOOT_UDP_PAYLOAD_MAX)
+
+#ifndef BOOT_UDP_TX_TIMEOUT_MS
+#define BOOT_UDP_TX_TIMEOUT_MS        100U    // 等待空闲发送描述符的超时
+#endif
+
+typedef enum {
+    BOOT_UDP_OK = 0,
+    BOOT_UDP_ERROR,             // 参数错误或尚未收到过上位机报文（不知道回给谁）
+    BOOT_UDP_TIMEOUT,           // 发送描述符一直被 DMA 占用
+} boot_udp_status_t;
+
+/* 以太网 MAC 接口，由移植层基于 DMA 描述符实现，收发均不经过中间缓冲 */
+typedef struct {
+    /* 取最早一帧已接收的以太网帧（指向接收 DMA 缓冲区，不含 FCS），无帧返回 0 */
+    uint32_t (*eth_rx_peek)(const uint8_t **frame);
+    /* 把 eth_rx_peek 取到的帧归还给 DMA */
+    void (*eth_rx_release)(void);
+    /* 取一个空闲发送 DMA 缓冲区（不小于 BOOT_UDP_FRAME_MAX），暂无空闲返回 NULL */
+    uint8_t *(*eth_tx_acquire)(void);
+    /* 提交 eth_tx_acquire 取到的缓冲区，len 为以太网帧长（不含 FCS） */
+    void (*eth_tx_submit)(uint32_t len);
+    uint32_t (*get_tick)(void);
+} boot_udp_ops_t;
+
+typedef struct {
+    uint8_t  mac[BOOT_UDP_MAC_SIZE];
+    uint8_t  ip[BOOT_UDP_IP_SIZE];      // 全 0 时使用由 MAC 派生的链路本地地址 169.254.x.y
+    uint16_t port;                      // 本端 UDP 端口
+} boot_udp_config_t;
+
+typedef struct {
+    const boot_udp_ops_t *ops;
+    boot_udp_config_t cfg;
+
+    /* 当前未读完的 UDP 载荷，仍位于接收 DMA 缓冲区 */
+    const uint8_t *rx_payload;
+    uint32_t rx_len;
+    uint32_t rx_offset;
+
+    /* 最近一次发来有效报文的上位机，应答发往该地址 */
+    uint8_t  peer_mac[BOOT_UDP_MAC_SIZE];
+    uint8_t  peer_ip[BOOT_UDP_IP_SIZE];
+    uint16_t peer_port;
+    uint8_t  peer_valid;
+
+    uint16_t ip_id;
+} boot_udp_t;
+
+boot_udp_status_t boot_udp_init(boot_udp_t *ctx, const boot_udp_ops_t *ops, const boot_udp_config_t *cfg);
+
+/* 广播一次免费 ARP，通告本端 IP/MAC（上电及链路建立后调用） */
+void boot_udp_announce(boot_udp_t *ctx);
+
+/*
+ * 零拷贝读取：处理排在前面的 ARP / ICMP，返回下一个发往本端口的 UDP 载荷在 DMA 缓冲区中的地址与剩余长度，
+ * 无数据返回 0；处理完必须调用 boot_udp_release 归还缓冲区
+ */
+uint32_t boot_udp_peek(boot_udp_t *ctx, const uint8_t **payload);
+void boot_udp_release(boot_udp_t *ctx);
+
+/* 拷贝读取：从当前 UDP 载荷中读出最多 max_len 字节，读完自动归还缓冲区 */
+uint32_t boot_udp_read(boot_udp_t *ctx, uint8_t *buf, uint32_t max_len);
+
+/* 以一个 UDP 报文发给最近的上位机，len 不超过 BOOT_UDP_PAYLOAD_MAX */
+boot_udp_status_t boot_udp_write(boot_udp_t *ctx, const uint8_t *data, uint32_t len);
+
+#endif // BOOT_UDP_H
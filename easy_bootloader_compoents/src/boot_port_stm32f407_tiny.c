@@ -0,0 +1,194 @@
+// STM32F407 寄存器级移植层：BOOT_CONFIG_PROFILE_TINY 时替代 boot_port_stm32f407.c，只依赖 CMSIS 设备头文件，不链接 HAL
+#include "boot_config.h"
+
+#if BOOT_CONFIG_PROFILE_TINY
+#include "easy_bootloader.h"
+#include "boot_port_stm32f407_tiny.h"
+#include "stm32f4xx.h"
+
+#if (BOOT_TINY_RX_RING_SIZE & (BOOT_TINY_RX_RING_SIZE - 1U)) != 0U || BOOT_TINY_RX_RING_SIZE > 32768U
+#error "BOOT_TINY_RX_RING_SIZE must be a power of two not larger than 32768"
+#endif
+#if BOOT_PACKET_MAX_SIZE > BOOT_TINY_RX_RING_SIZE
+#error "BOOT_PACKET_MAX_SIZE exceeds the USART2 DMA ring (BOOT_TINY_RX_RING_SIZE)"
+#endif
+
+#if BOOT_FLASH_SECTOR_COUNT != 12U
+#error "tiny_flash_sector() assumes the 1MB STM32F407 sector map in boot_memmap.h"
+#endif
+
+#define TINY_FLASH_SIZE               (BOOT_FLASH_END_ADDR - BOOT_FLASH_START_ADDR)
+
+volatile uint32_t tiny_tick;
+uint8_t tiny_rx_ring[BOOT_TINY_RX_RING_SIZE];
+uint32_t tiny_rx_tail;
+
+
+/* 精简构建不链接 HAL，毫秒节拍由移植层自己维护 */
+void SysTick_Handler(void)
+{
+    tiny_tick++;
+}
+
+/* F407 扇区：0~3 各 16KB，4 为 64KB，5~11 各 128KB，按偏移直接换算扇区号，不用查表 */
+static uint32_t tiny_flash_sector(uint32_t addr)
+{
+    uint32_t offset = addr - FLASH_BASE;
+
+    if (offset < 0x10000U) {
+        return offset >> 14;
+    }
+    if (offset < 0x20000U) {
+        return 4U;
+    }
+    return 4U + (offset >> 17);
+}
+
+/*
+ * 按 32 位并行度（2.7V~3.6V）擦除与编程；精简构建不开启 Flash 指令/数据缓存，擦除后不需要刷新缓存
+ * 提高主频时须先按手册设置 FLASH->ACR 等待周期
+ */
+boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
+{
+    boot_port_status_t status = BOOT_PORT_OK;
+    uint32_t sector;
+
+    if (size == 0U || addr < FLASH_BASE || addr - FLASH_BASE + size > TINY_FLASH_SIZE) {
+        return BOOT_PORT_ERROR;
+    }
+
+    tiny_flash_unlock();
+    for (sector = tiny_flash_sector(addr); sector <= tiny_flash_sector(addr + size - 1U); sector++) {
+        FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+        FLASH->CR |= FLASH_CR_STRT;
+        status = tiny_flash_wait();
+        if (status != BOOT_PORT_OK) {
+            break;
+        }
+    }
+    FLASH->CR = FLASH_CR_LOCK;
+    return status;
+}
+
+/*
+ * USART2（PA2 TX / PA3 RX，AF7）接收由 DMA1 Stream5 Channel4 循环写入 tiny_rx_ring，不开任何中断；
+ * 写位置由 NDTR 换算。没有溢出检测，接收环须容纳上位机窗口内的全部在途帧。
+ * 波特率按 APB1 不分频计算（CMSIS SystemInit 之后即是如此）
+ */
+static void tiny_uart_init(void)
+{
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_DMA1EN;
+    RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+    (void)RCC->APB1ENR;                 // 等外设时钟生效
+
+    GPIOA->MODER = (GPIOA->MODER & ~(0xFU << 4)) | (0xAU << 4);         // PA2/PA3 复用功能
+    GPIOA->PUPDR = (GPIOA->PUPDR & ~(0x3U << 6)) | (0x1U << 6);         // PA3 上拉
+    GPIOA->AFR[0] = (GPIOA->AFR[0] & ~(0xFFU << 8)) | (0x77U << 8);     // AF7 = USART2
+
+    DMA1_Stream5->CR = 0U;
+    while ((DMA1_Stream5->CR & DMA_SxCR_EN) != 0U) {
+    }
+    DMA1->HIFCR = DMA_HIFCR_CFEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTCIF5;
+    DMA1_Stream5->PAR = (uint32_t)&USART2->DR;
+    DMA1_Stream5->M0AR = (uint32_t)tiny_rx_ring;
+    DMA1_Stream5->NDTR = BOOT_TINY_RX_RING_SIZE;
+    DMA1_Stream5->CR = (4U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_EN;
+
+    USART2->BRR = (SystemCoreClock + BOOT_TINY_BAUDRATE / 2U) / BOOT_TINY_BAUDRATE;
+    USART2->CR3 = USART_CR3_DMAR;
+    USART2->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+}
+
+/* 复位与跳转前等最后一个应答发完 */
+static void tiny_uart_wait(void)
+{
+    while ((USART2->SR & USART_SR_TC) == 0U) {
+    }
+}
+
+void boot_port_jump_to_app(uint32_t app_addr)
+{
+    typedef void (*pFunction)(void);
+    pFunction jump_to_app;
+
+    uint32_t app_stack = *(volatile uint32_t *)app_addr;
+    uint32_t app_reset = *(volatile uint32_t *)(app_addr + 4U);
+    uint32_t i;
+
+    tiny_uart_wait();
+
+    /* 1. 关闭全局中断与 SysTick */
+    __disable_irq();
+    SysTick->CTRL = 0U;
+    SysTick->LOAD = 0U;
+    SysTick->VAL = 0U;
+
+    /* 2. 复位 USART2 与 DMA1，APP 按自己的配置重新初始化 */
+    DMA1_Stream5->CR = 0U;
+    RCC->AHB1RSTR |= RCC_AHB1RSTR_DMA1RST;
+    RCC->APB1RSTR |= RCC_APB1RSTR_USART2RST;
+    RCC->AHB1RSTR &= ~RCC_AHB1RSTR_DMA1RST;
+    RCC->APB1RSTR &= ~RCC_APB1RSTR_USART2RST;
+
+    /* 3. 禁用并清除所有中断 */
+    for (i = 0U; i < 8U; i++) {
+        NVIC->ICER[i] = 0xFFFFFFFFU;
+        NVIC->ICPR[i] = 0xFFFFFFFFU;
+    }
+
+    /* 4. 设置向量表偏移与主栈指针 */
+    SCB->VTOR = app_addr;
+    __set_MSP(app_stack);
+
+    /* 5. 内存屏障后重新允许中断并跳转 */
+    __DSB();
+    __ISB();
+    __enable_irq();
+    jump_to_app = (pFunction)app_reset;
+    jump_to_app();
+
+    /* 不应该执行到这里 */
+    while (1);
+}
+
+void boot_port_system_reset(void)
+{
+    tiny_uart_wait();
+    NVIC_SystemReset();
+}
+
+/* 静态绑定时热路径函数由核心直接内联，ops 中只留冷路径 */
+static const boot_ops_t boot_port_ops = {
+    .boot_port_flash_erase = boot_port_flash_erase,
+    .boot_port_jump_to_app = boot_port_jump_to_app,
+    .boot_port_system_reset = boot_port_system_reset,
+#if !BOOT_CONFIG_STATIC_PORT
+    .get_tick = boot_port_get_tick,
+    .boot_port_flash_write = boot_port_flash_write,
+    .boot_port_flash_read = boot_port_flash_read,
+    .boot_port_data_write = boot_port_data_write,
+    .boot_port_data_read = boot_port_data_read,
+    .boot_port_rx_peek = boot_port_rx_peek,
+    .boot_port_rx_consume = boot_port_rx_consume,
+#endif
+};
+
+/*
+ * 精简构建的 main 只需：
+ *   int main(void) { bootloader_app_init(); for (;;) { bootloader_app_loop(); } }
+ * 时钟沿用启动文件中 SystemInit 之后的配置
+ */
+void bootloader_app_init(void)
+{
+    (void)SysTick_Config(SystemCoreClock / 1000U);
+    tiny_uart_init();
+    easy_bootloader_init(&boot_port_ops);   //启动bootloader，传入ops操作集
+}
+
+//轮询使用easy_bootloader_run函数
+void bootloader_app_loop(void)
+{
+    easy_bootloader_run();
+}
+
+#endif // BOOT_CONFIG_PROFILE_TINY
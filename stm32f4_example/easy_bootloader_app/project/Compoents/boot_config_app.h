@@ -4,12 +4,40 @@
 #include <stdint.h>
 
 #define BOOT_APP_CONFIG_ENABLE_LOG        1U      // 1启用日志输出 0禁用日志输出
+#define BOOT_APP_CONFIG_ENABLE_STAGING    0U      // 1运行中后台接收新固件到暂存区，校验通过后复位由 Bootloader 安装 0禁用
+#define BOOT_APP_CONFIG_ENABLE_ADDRESS    0U      // 1多点总线（RS-485）模式，须与 Bootloader 侧 BOOT_CONFIG_ENABLE_ADDRESS 一致 0禁用
+#define BOOT_APP_CONFIG_ENABLE_GATEWAY    0U      // 1存储转发网关：带下游目标的固件收到暂存区后不安装，而是经下游串口并行刷写子节点（依赖暂存区） 0禁用
 
 /*
- * Flash 布局
+ * 多点总线节点地址（0x01~0xFE，与 Bootloader 侧 BOOT_NODE_ADDR 一致）
+ * ops.node_addr 非 0 时覆盖本值
  */
-#define BOOT_APP_FLAG_REGION_ADDR         0x080E0000U
-#define BOOT_APP_FLAG_REGION_SIZE         0x00020000U
+#define BOOT_APP_NODE_ADDR                1U
+
+/*
+ * Flash / RAM 布局（标志位区、暂存区及其擦除粒度、交接区与扇区表，与 Bootloader 侧共用一份清单）
+ * 由 stm32f4_example/memmap.json 经 PC tool/source/memmap_gen.py 生成，同时更新 Keil 工程 IROM1/IRAM1，不要手工修改 boot_memmap_app.h
+ */
+#include "boot_memmap_app.h"
+
+#if BOOT_APP_CONFIG_ENABLE_STAGING != BOOT_APP_MEMMAP_STAGING
+#error "BOOT_APP_CONFIG_ENABLE_STAGING differs from enable_staging in memmap.json, regenerate boot_memmap_app.h"
+#endif
+
+#define BOOT_APP_STAGING_WRITE_BUDGET     256U          // 每次 easy_bootloader_app_run 最多写入的字节数
+
+/*
+ * 存储转发网关（BOOT_APP_CONFIG_ENABLE_GATEWAY = 1 时生效）
+ * 本机作为上位机，把暂存区中已校验的固件按串口升级协议（数据帧逐帧应答 + 完成帧）刷写到各子节点，子节点之间并行；
+ * 子节点 Bootloader 使用非地址模式，BOOT_PACKET_MAX_SIZE 不小于 BOOT_APP_GATEWAY_CHUNK + 11
+ */
+#define BOOT_APP_GATEWAY_CHILDREN         2U        // 下游链路数（ops.boot_port_app_child_write/read 的 child 为 0 ~ N-1），最多 8 个
+#define BOOT_APP_GATEWAY_CHUNK            256U      // 下发数据帧的数据长度
+#define BOOT_APP_GATEWAY_ENTER_MS         1000U     // 发送升级命令后等待子节点 APP 复位进入 Bootloader 的时间
+#define BOOT_APP_GATEWAY_ACK_MS           1000U     // 等待数据帧 ACK 的超时
+#define BOOT_APP_GATEWAY_LONG_ACK_MS      10000U    // 首帧（子节点擦除 APP 区）与完成帧（校验摘要/签名）的 ACK 超时
+#define BOOT_APP_GATEWAY_RETRY_MS         6000U     // 失败后重新刷写前的等待，须大于子节点 BOOT_UART_TIMEOUT_MS
+#define BOOT_APP_GATEWAY_RETRIES          2U        // 每个子节点失败后的重试次数
 
 /*
  * 标志位区布局 (基于 BOOT_FLAG_REGION_ADDR)
@@ -25,6 +53,17 @@
 #define BOOT_APP_VERSION_ADDR             (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_VERSION_OFFSET)
 #define BOOT_APP_DATE_ADDR                (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_DATE_OFFSET)
 
+#define BOOT_APP_FLAG_ERASED              0xFFFFFFFFU   // Flash 擦除后的值
+
+/*
+ * 暂存记录（与 Bootloader 侧布局一致，魔数最后写入作为提交点）
+ * Word 0: magic / Word 1: size / Word 2: version / Word 3: date
+ * 0x10: SHA-256 摘要 (32B) / 0x30: Ed25519 签名 (64B，可选)
+ */
+#define BOOT_APP_STAGING_RECORD_OFFSET    0x100U
+#define BOOT_APP_STAGING_RECORD_ADDR      (BOOT_APP_FLAG_REGION_ADDR + BOOT_APP_STAGING_RECORD_OFFSET)
+#define BOOT_APP_STAGING_MAGIC            0x53544744U   // "STGD"
+
 /*
  * 协议缓冲配置
  */
@@ -32,6 +71,5 @@
 #define BOOT_APP_RINGBUFFER_SIZE    1013U
 #define BOOT_APP_UART_TIMEOUT_MS          5000U
 
-
 #endif // !BOOT_CONFIG_APP_H
 
@@ -0,0 +1,294 @@
+// 存储转发网关：每个下游链路一个升级协议客户端状态机，轮询推进，子节点之间互不等待
+#include "boot_gateway.h"
+#include "boot_config_app.h"
+
+#if BOOT_APP_CONFIG_ENABLE_GATEWAY
+
+#include <string.h>
+
+#if BOOT_APP_GATEWAY_CHILDREN == 0U || BOOT_APP_GATEWAY_CHILDREN > 8U
+    #error "BOOT_APP_GATEWAY_CHILDREN must be in 1..8"
+#endif
+
+#if BOOT_APP_CONFIG_ENABLE_LOG
+    #define GATEWAY_LOG(fmt, ...)                                                      \
+        do {                                                                           \
+            if (g_gateway.ops != NULL && g_gateway.ops->boot_port_app_log != NULL) {   \
+                g_gateway.ops->boot_port_app_log(fmt, ##__VA_ARGS__);                  \
+            }                                                                          \
+        } while (0)
+#else
+    #define GATEWAY_LOG(fmt, ...)  ((void)0)
+#endif
+
+#define GATEWAY_FRAME_OVERHEAD    11U     // 55 AA [剩余 3B] [长度 2B] [数据] [校验 2B] 55 55
+#define GATEWAY_RX_SIZE           16U     // 下游只会回 6 字节 ACK
+
+static const uint8_t g_gateway_enter[] = {0x55U, 0xAAU, 0xFFU, 0xEEU, 0x55U, 0x55U};
+static const uint8_t g_gateway_ack[] = {0x55U, 0xAAU, 0xFFU, 0xFEU, 0x55U, 0x55U};
+
+typedef struct {
+    boot_gateway_child_state_t state;
+    uint8_t  retries;
+    uint32_t acked;             // 已确认的字节数
+    uint32_t sent;              // 在途数据帧的结束位置
+    uint32_t wait_tick;         // 进入当前等待的时间
+    uint32_t wait_ms;           // 当前等待的超时
+    uint8_t  rx[GATEWAY_RX_SIZE];
+    uint8_t  rx_len;
+} gateway_child_t;
+
+typedef struct {
+    const boot_app_ops_t *ops;
+    uint32_t image_addr;
+    uint32_t image_size;
+    uint8_t  finish[BOOT_GATEWAY_FINISH_MAX];
+    uint16_t finish_len;
+    gateway_child_t child[BOOT_APP_GATEWAY_CHILDREN];
+    uint8_t  frame[BOOT_APP_GATEWAY_CHUNK + GATEWAY_FRAME_OVERHEAD];   // 各子节点轮流使用的发送缓冲
+} gateway_context_t;
+
+static gateway_context_t g_gateway;
+
+static void gateway_wait(gateway_child_t *c, uint32_t ms)
+{
+    c->wait_tick = g_gateway.ops->get_tick();
+    c->wait_ms = ms;
+}
+
+static bool gateway_expired(const gateway_child_t *c)
+{
+    return (uint32_t)(g_gateway.ops->get_tick() - c->wait_tick) >= c->wait_ms;
+}
+
+/**
+ * @brief 读取下游数据并查找 ACK，找到时消费到 ACK 末尾
+ * @note  未匹配的数据只保留可能是 ACK 前缀的尾部，子节点 APP 的其他输出不会堵塞接收缓存
+ */
+static bool gateway_take_ack(uint8_t index, gateway_child_t *c)
+{
+    for (;;) {
+        uint32_t received = g_gateway.ops->boot_port_app_child_read(index, &c->rx[c->rx_len],
+                                                                    GATEWAY_RX_SIZE - c->rx_len);
+        c->rx_len += (uint8_t)received;
+
+        for (uint32_t i = 0U; i + sizeof(g_gateway_ack) <= c->rx_len; i++) {
+            if (memcmp(&c->rx[i], g_gateway_ack, sizeof(g_gateway_ack)) == 0) {
+                uint32_t end = i + sizeof(g_gateway_ack);
+                memmove(c->rx, &c->rx[end], c->rx_len - end);
+                c->rx_len -= (uint8_t)end;
+                return true;
+            }
+        }
+
+        uint8_t keep = (c->rx_len < sizeof(g_gateway_ack)) ? c->rx_len : (uint8_t)(sizeof(g_gateway_ack) - 1U);
+        memmove(c->rx, &c->rx[c->rx_len - keep], keep);
+        c->rx_len = keep;
+        if (received == 0U) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief 从头开始刷写一个子节点：先发升级命令让 APP 复位进入 Bootloader（已在 Bootloader 中时该命令被忽略）
+ */
+static void gateway_begin(uint8_t index, gateway_child_t *c)
+{
+    c->state = BOOT_GATEWAY_CHILD_ENTER;
+    c->acked = 0U;
+    c->sent = 0U;
+    c->rx_len = 0U;
+    g_gateway.ops->boot_port_app_child_write(index, g_gateway_enter, sizeof(g_gateway_enter));
+    gateway_wait(c, BOOT_APP_GATEWAY_ENTER_MS);
+}
+
+/**
+ * @brief 从暂存区读出下一段数据，组成数据帧发给子节点
+ */
+static bool gateway_send_data(uint8_t index, gateway_child_t *c)
+{
+    uint8_t *frame = g_gateway.frame;
+    uint32_t len = g_gateway.image_size - c->acked;
+    if (len > BOOT_APP_GATEWAY_CHUNK) {
+        len = BOOT_APP_GATEWAY_CHUNK;
+    }
+    if (g_gateway.ops->boot_port_app_flash_read(g_gateway.image_addr + c->acked, &frame[7], len) != BOOT_PORT_APP_OK) {
+        return false;
+    }
+
+    uint32_t remain = g_gateway.image_size - c->acked - len;
+    uint16_t checksum = (uint16_t)((len >> 8) + (len & 0xFFU));
+    for (uint32_t i = 0U; i < len; i++) {
+        checksum += frame[7U + i];
+    }
+    frame[0] = 0x55U;
+    frame[1] = 0xAAU;
+    frame[2] = (uint8_t)(remain >> 16);
+    frame[3] = (uint8_t)(remain >> 8);
+    frame[4] = (uint8_t)remain;
+    frame[5] = (uint8_t)(len >> 8);
+    frame[6] = (uint8_t)len;
+    frame[7U + len] = (uint8_t)(checksum >> 8);
+    frame[8U + len] = (uint8_t)checksum;
+    frame[9U + len] = 0x55U;
+    frame[10U + len] = 0x55U;
+
+    if (g_gateway.ops->boot_port_app_child_write(index, frame, len + GATEWAY_FRAME_OVERHEAD) != BOOT_PORT_APP_OK) {
+        return false;
+    }
+    c->sent = c->acked + len;
+    gateway_wait(c, (c->acked == 0U) ? BOOT_APP_GATEWAY_LONG_ACK_MS : BOOT_APP_GATEWAY_ACK_MS);
+    return true;
+}
+
+static bool gateway_send_finish(uint8_t index, gateway_child_t *c)
+{
+    uint8_t *frame = g_gateway.frame;
+    frame[0] = 0x55U;
+    frame[1] = 0xAAU;
+    memcpy(&frame[2], g_gateway.finish, g_gateway.finish_len);
+    frame[2U + g_gateway.finish_len] = 0x55U;
+    frame[3U + g_gateway.finish_len] = 0x55U;
+
+    if (g_gateway.ops->boot_port_app_child_write(index, frame, g_gateway.finish_len + 4U) != BOOT_PORT_APP_OK) {
+        return false;
+    }
+    c->state = BOOT_GATEWAY_CHILD_FINISH;
+    gateway_wait(c, BOOT_APP_GATEWAY_LONG_ACK_MS);
+    return true;
+}
+
+/**
+ * @brief 子节点失败：等待其接收超时复位后从头重发，重试次数用尽时放弃
+ */
+static void gateway_fail(uint8_t index, gateway_child_t *c)
+{
+    if (c->retries < BOOT_APP_GATEWAY_RETRIES) {
+        c->retries++;
+        c->state = BOOT_GATEWAY_CHILD_RETRY;
+        gateway_wait(c, BOOT_APP_GATEWAY_RETRY_MS);
+        GATEWAY_LOG("Child %u failed at %lu bytes, retry %u\r\n",
+                    index, (unsigned long)c->acked, c->retries);
+        return;
+    }
+    c->state = BOOT_GATEWAY_CHILD_FAILED;
+    GATEWAY_LOG("Child %u failed, giving up\r\n", index);
+}
+
+static void gateway_poll_child(uint8_t index, gateway_child_t *c)
+{
+    switch (c->state) {
+        case BOOT_GATEWAY_CHILD_ENTER:
+            if (!gateway_expired(c)) {
+                break;
+            }
+            (void)gateway_take_ack(index, c);   // 丢弃 APP 对升级命令的应答
+            c->rx_len = 0U;
+            c->state = BOOT_GATEWAY_CHILD_DATA;
+            if (!gateway_send_data(index, c)) {
+                gateway_fail(index, c);
+            }
+            break;
+
+        case BOOT_GATEWAY_CHILD_DATA:
+            if (gateway_take_ack(index, c)) {
+                c->acked = c->sent;
+                bool ok = (c->acked < g_gateway.image_size) ? gateway_send_data(index, c)
+                                                            : gateway_send_finish(index, c);
+                if (!ok) {
+                    gateway_fail(index, c);
+                }
+            } else if (gateway_expired(c)) {
+                gateway_fail(index, c);
+            }
+            break;
+
+        case BOOT_GATEWAY_CHILD_FINISH:
+            if (gateway_take_ack(index, c)) {
+                c->state = BOOT_GATEWAY_CHILD_DONE;
+                GATEWAY_LOG("Child %u updated\r\n", index);
+            } else if (gateway_expired(c)) {
+                gateway_fail(index, c);
+            }
+            break;
+
+        case BOOT_GATEWAY_CHILD_RETRY:
+            if (gateway_expired(c)) {
+                gateway_begin(index, c);
+            }
+            break;
+
+        case BOOT_GATEWAY_CHILD_IDLE:
+        case BOOT_GATEWAY_CHILD_DONE:
+        case BOOT_GATEWAY_CHILD_FAILED:
+        default:
+            break;
+    }
+}
+
+void boot_gateway_init(const boot_app_ops_t *ops)
+{
+    memset(&g_gateway, 0, sizeof(g_gateway));
+    g_gateway.ops = ops;
+}
+
+bool boot_gateway_start(uint8_t mask, uint32_t image_addr, uint32_t image_size,
+                        const uint8_t *finish, uint16_t finish_len)
+{
+    if (g_gateway.ops == NULL || g_gateway.ops->get_tick == NULL ||
+        g_gateway.ops->boot_port_app_child_write == NULL || g_gateway.ops->boot_port_app_child_read == NULL ||
+        boot_gateway_busy() || image_size == 0U || finish_len > BOOT_GATEWAY_FINISH_MAX ||
+        (mask >> BOOT_APP_GATEWAY_CHILDREN) != 0U || mask == 0U) {
+        return false;
+    }
+
+    g_gateway.image_addr = image_addr;
+    g_gateway.image_size = image_size;
+    memcpy(g_gateway.finish, finish, finish_len);
+    g_gateway.finish_len = finish_len;
+
+    for (uint8_t i = 0U; i < BOOT_APP_GATEWAY_CHILDREN; i++) {
+        gateway_child_t *c = &g_gateway.child[i];
+        memset(c, 0, sizeof(*c));
+        c->state = BOOT_GATEWAY_CHILD_IDLE;
+        if ((mask & (1U << i)) != 0U) {
+            gateway_begin(i, c);
+        }
+    }
+    GATEWAY_LOG("Gateway forwarding %lu bytes to mask 0x%02X\r\n", (unsigned long)image_size, mask);
+    return true;
+}
+
+void boot_gateway_poll(void)
+{
+    for (uint8_t i = 0U; i < BOOT_APP_GATEWAY_CHILDREN; i++) {
+        gateway_poll_child(i, &g_gateway.child[i]);
+    }
+}
+
+bool boot_gateway_busy(void)
+{
+    for (uint8_t i = 0U; i < BOOT_APP_GATEWAY_CHILDREN; i++) {
+        boot_gateway_child_state_t state = g_gateway.child[i].state;
+        if (state != BOOT_GATEWAY_CHILD_IDLE && state != BOOT_GATEWAY_CHILD_DONE &&
+            state != BOOT_GATEWAY_CHILD_FAILED) {
+            return true;
+        }
+    }
+    return false;
+}
+
+boot_gateway_child_state_t boot_gateway_child_state(uint8_t child, uint8_t *percent)
+{
+    if (child >= BOOT_APP_GATEWAY_CHILDREN) {
+        *percent = 0U;
+        return BOOT_GATEWAY_CHILD_IDLE;
+    }
+    const gateway_child_t *c = &g_gateway.child[child];
+    *percent = (g_gateway.image_size == 0U) ? 0U
+             : (uint8_t)((uint64_t)c->acked * 100U / g_gateway.image_size);
+    return c->state;
+}
+
+#endif // BOOT_APP_CONFIG_ENABLE_GATEWAY
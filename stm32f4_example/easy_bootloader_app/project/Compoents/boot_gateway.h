@@ -0,0 +1,42 @@
+// 存储转发网关头文件：本机作为上位机，把暂存区中已校验的固件按串口升级协议并行刷写到各下游子节点
+#ifndef BOOT_GATEWAY_H
+#define BOOT_GATEWAY_H
+
+#include "easy_bootloader_app.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_GATEWAY_FINISH_MAX       106U    // 完成帧去掉帧头帧尾后的最大长度（签名完成帧：ver/date/sha256/sig/FF FA）
+
+/* 子节点刷写状态，经进度查询原样上报 */
+typedef enum {
+    BOOT_GATEWAY_CHILD_IDLE = 0,    // 不在本次目标中
+    BOOT_GATEWAY_CHILD_ENTER,       // 已发送升级命令，等待子节点 APP 复位进入 Bootloader
+    BOOT_GATEWAY_CHILD_DATA,        // 逐帧发送数据并等待 ACK
+    BOOT_GATEWAY_CHILD_FINISH,      // 已发送完成帧，等待子节点校验
+    BOOT_GATEWAY_CHILD_RETRY,       // 失败后等待子节点接收超时，随后从头重发
+    BOOT_GATEWAY_CHILD_DONE,
+    BOOT_GATEWAY_CHILD_FAILED,      // 重试次数用尽
+} boot_gateway_child_state_t;
+
+void boot_gateway_init(const boot_app_ops_t *ops);
+
+/*
+ * 开始向 mask 中的子节点（bit i 对应下游链路 i）转发 image_addr 起 image_size 字节的固件
+ * finish 为上位机完成帧去掉帧头（及地址）与帧尾后的内容，原样转发给子节点
+ * 正在转发或参数不合法时返回 false
+ */
+bool boot_gateway_start(uint8_t mask, uint32_t image_addr, uint32_t image_size,
+                        const uint8_t *finish, uint16_t finish_len);
+
+/* 推进各子节点的刷写，每次调用每个子节点最多发送一帧 */
+void boot_gateway_poll(void);
+
+/* 仍有子节点未完成（成功或失败）时返回 true，此时暂存区中的固件不能被覆盖 */
+bool boot_gateway_busy(void);
+
+/* 查询子节点状态，percent 为已确认的数据百分比 */
+boot_gateway_child_state_t boot_gateway_child_state(uint8_t child, uint8_t *percent);
+
+#endif // BOOT_GATEWAY_H
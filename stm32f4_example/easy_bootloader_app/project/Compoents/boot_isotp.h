@@ -0,0 +1,79 @@
+// ISO-TP (ISO 15765-2) 传输层头文件：在 CAN / CAN-FD 上承载升级协议字节流
+#ifndef BOOT_ISOTP_H
+#define BOOT_ISOTP_H
+
+#include <stdint.h>
+
+#ifndef BOOT_ISOTP_RX_BUF_SIZE
+#define BOOT_ISOTP_RX_BUF_SIZE        1024U   // 接收重组缓存，须为 2 的幂
+#endif
+#ifndef BOOT_ISOTP_TIMEOUT_MS
+#define BOOT_ISOTP_TIMEOUT_MS         1000U   // N_Bs / N_Cr：等待流控帧、连续帧的超时
+#endif
+#define BOOT_ISOTP_PADDING            0xCCU   // 帧尾填充字节
+
+#define BOOT_ISOTP_CAN_DLEN           8U      // 经典 CAN 帧长
+#define BOOT_ISOTP_CANFD_DLEN         64U     // CAN-FD 最大帧长
+
+typedef enum {
+    BOOT_ISOTP_OK = 0,
+    BOOT_ISOTP_ERROR,           // 参数错误或对端回复溢出
+    BOOT_ISOTP_TIMEOUT,         // 发送邮箱一直满或等不到流控帧
+} boot_isotp_status_t;
+
+/* CAN 控制器接口，由移植层实现 */
+typedef struct {
+    /* 发送一帧，len 为 8 或 CAN-FD 合法长度；邮箱满时返回非 0，由本模块重试 */
+    int (*can_send)(uint32_t id, const uint8_t *data, uint8_t len);
+    /* 取出一帧已接收报文，无报文时返回 0 */
+    int (*can_recv)(uint32_t *id, uint8_t *data, uint8_t *len);
+    uint32_t (*get_tick)(void);
+} boot_isotp_ops_t;
+
+typedef struct {
+    uint32_t tx_id;             // 本端发送 ID（经典 CAN 常用 0x7E8）
+    uint32_t rx_id;             // 本端接收 ID（经典 CAN 常用 0x7E0）
+    uint8_t  frame_len;         // 8：经典 CAN；12~64：CAN-FD
+    uint8_t  block_size;        // 流控帧 BS：每收多少个连续帧回一次流控，0 表示尽量大
+    uint8_t  st_min;            // 流控帧 STmin：要求对端连续帧间隔（ms，0xF1~0xF9 为 100~900us）
+} boot_isotp_config_t;
+
+typedef struct {
+    const boot_isotp_ops_t *ops;
+    boot_isotp_config_t cfg;
+
+    /* 接收：SF / FF / CF 直接重组进字节 FIFO，上层按字节流读取 */
+    uint8_t  rx_fifo[BOOT_ISOTP_RX_BUF_SIZE];
+    uint32_t rx_head;           // 自由递增读指针
+    uint32_t rx_tail;           // 自由递增写指针
+    uint32_t rx_remain;         // 当前多帧报文剩余字节，0 表示空闲
+    uint32_t rx_tick;           // 最近一次收到连续帧 / 发出流控的时间
+    uint8_t  rx_sn;             // 期望的连续帧序号
+    uint8_t  rx_block_left;     // 本块剩余连续帧数
+    uint8_t  rx_fc_pending;     // 1 表示待 FIFO 腾出空间后回 CTS
+    uint8_t  rx_overflow;       // 因空间不足丢弃的报文计数（饱和）
+
+    /* 发送：最近一次收到的流控帧 */
+    uint8_t  tx_fc_valid;
+    uint8_t  tx_fc_status;
+    uint8_t  tx_fc_bs;
+    uint8_t  tx_fc_st_min;
+} boot_isotp_t;
+
+/*
+ * 初始化上下文，block_size 会被收敛到一块不超过半个接收缓存
+ * 返回 BOOT_ISOTP_ERROR 表示参数不合法
+ */
+boot_isotp_status_t boot_isotp_init(boot_isotp_t *ctx, const boot_isotp_ops_t *ops,
+                                    const boot_isotp_config_t *cfg);
+
+/* 取走 CAN 控制器中的报文并重组；接收缓存有空间时补发挂起的流控帧 */
+void boot_isotp_poll(boot_isotp_t *ctx);
+
+/* 从重组缓存中读取最多 max_len 字节，返回实际字节数（会先调用 boot_isotp_poll） */
+uint32_t boot_isotp_read(boot_isotp_t *ctx, uint8_t *buf, uint32_t max_len);
+
+/* 阻塞发送一条报文：不超过单帧容量时发 SF，否则 FF + 按对端流控发 CF */
+boot_isotp_status_t boot_isotp_write(boot_isotp_t *ctx, const uint8_t *data, uint32_t len);
+
+#endif // BOOT_ISOTP_H
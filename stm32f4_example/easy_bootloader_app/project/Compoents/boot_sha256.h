@@ -0,0 +1,21 @@
+// SHA-256 流式摘要头文件
+#ifndef BOOT_SHA256_H
+#define BOOT_SHA256_H
+
+#include <stdint.h>
+
+#define BOOT_SHA256_DIGEST_SIZE       32U
+#define BOOT_SHA256_BLOCK_SIZE        64U
+
+typedef struct {
+    uint32_t state[8];
+    uint32_t total_len;                         // 已输入字节数（固件不超过 4GB）
+    uint8_t  block[BOOT_SHA256_BLOCK_SIZE];     // 不足一块的残留数据
+    uint8_t  block_len;
+} boot_sha256_ctx_t;
+
+void boot_sha256_init(boot_sha256_ctx_t *ctx);
+void boot_sha256_update(boot_sha256_ctx_t *ctx, const uint8_t *data, uint32_t len);
+void boot_sha256_final(boot_sha256_ctx_t *ctx, uint8_t digest[BOOT_SHA256_DIGEST_SIZE]);
+
+#endif // BOOT_SHA256_H
@@ -19,9 +19,32 @@ typedef struct {
     uint32_t (*boot_port_app_data_read)(uint8_t *buf, uint32_t max_len);
     void (*boot_port_app_log)(const char *fmt, ...);
     void (*boot_port_app_system_reset)(void);
+    uint8_t node_addr;      // 多点总线节点地址（BOOT_APP_CONFIG_ENABLE_ADDRESS），0 表示使用 BOOT_APP_NODE_ADDR
+    /* 网关下游链路（BOOT_APP_CONFIG_ENABLE_GATEWAY），child 为下游链路编号；发送须在返回前完成或拷贝走数据 */
+    boot_port_app_status_t (*boot_port_app_child_write)(uint8_t child, const uint8_t *data, uint32_t len);
+    uint32_t (*boot_port_app_child_read)(uint8_t child, uint8_t *buf, uint32_t max_len);
 } boot_app_ops_t;
 
+/* Bootloader 启动打点下标，与 Bootloader 侧 boot_stage_t 一致 */
+#define BOOT_APP_STAGE_RESET              0U
+#define BOOT_APP_STAGE_INIT               1U
+#define BOOT_APP_STAGE_FLAG_READ          2U
+#define BOOT_APP_STAGE_APP_CHECK          3U
+#define BOOT_APP_STAGE_JUMP               4U
+#define BOOT_APP_STAGE_COUNT              5U
+
+#define BOOT_APP_HANDOFF_MAGIC            0x424F4F54U  // "BOOT"
+#define BOOT_APP_HANDOFF_FLAG_FAST        0x00000001U  // 经快速跳转路径进入
+
+/* 交接区布局（单位：CPU 周期），与 Bootloader 侧 boot_handoff_t 一致 */
+typedef struct {
+    uint32_t magic;
+    uint32_t boot_flags;
+    uint32_t stamp[BOOT_APP_STAGE_COUNT];
+} boot_app_handoff_t;
+
 boot_port_app_status_t easy_bootloader_app_init(const boot_app_ops_t *ops);
 void easy_bootloader_app_run(void);
+const boot_app_handoff_t *easy_bootloader_app_get_handoff(void);
 
 #endif // !EASY_BOOTLOADER_APP_H
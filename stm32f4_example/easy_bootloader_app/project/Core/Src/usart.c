@@ -21,8 +21,7 @@
 #include "usart.h"
 
 /* USER CODE BEGIN 0 */
-extern uint8_t uart1_rx_dmabuffer[128];	//жݻ
-extern uint8_t uart2_rx_dmabuffer[128];	//жݻ
+#include "myusart.h"
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart1;
@@ -55,8 +54,7 @@ void MX_USART1_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART1_Init 2 */
-		HAL_UARTEx_ReceiveToIdle_DMA(&huart1,uart1_rx_dmabuffer,sizeof(uart1_rx_dmabuffer));	//DMA
-		__HAL_DMA_DISABLE_IT(&hdma_usart1_rx,DMA_IT_HT);	//رDMAж
+		uart_dma_ring_start(&uart1_rx_ring);	//ѭ DMA գֹ֮ͣ
   /* USER CODE END USART1_Init 2 */
 
 }
@@ -85,8 +83,7 @@ void MX_USART2_UART_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USART2_Init 2 */
-		HAL_UARTEx_ReceiveToIdle_DMA(&huart2,uart2_rx_dmabuffer,sizeof(uart2_rx_dmabuffer));	//DMA
-		__HAL_DMA_DISABLE_IT(&hdma_usart2_rx,DMA_IT_HT);	//رDMAж
+		uart_dma_ring_start(&uart2_rx_ring);	//ѭ DMA գֹ֮ͣ
   /* USER CODE END USART2_Init 2 */
 
 }
@@ -124,7 +121,7 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart1_rx.Init.Mode = DMA_NORMAL;
+    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
     hdma_usart1_rx.Init.Priority = DMA_PRIORITY_LOW;
     hdma_usart1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK)
@@ -170,8 +167,8 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_usart2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_usart2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart2_rx.Init.Mode = DMA_NORMAL;
-    hdma_usart2_rx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart2_rx.Init.Priority = DMA_PRIORITY_HIGH;
     hdma_usart2_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     if (HAL_DMA_Init(&hdma_usart2_rx) != HAL_OK)
     {
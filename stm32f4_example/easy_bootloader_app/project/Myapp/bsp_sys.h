@@ -6,7 +6,7 @@
 #include "stdarg.h"
 #include "string.h"
 
-#include "ringbuffer.h"
+#include "boot_ring.h"
 #include "myusart.h"
 #include "scheduler.h"
 #include "easy_bootloader_app.h"
@@ -2,59 +2,146 @@
 
 extern void bootloader_app_init(void);
 
-
-// ȫֱڴ洢
-uint8_t task_num;
-
+/*
+ * 事件驱动调度：中断里 scheduler_post 投递事件，任务在下一轮立即执行；
+ * rate_ms 不为 0 的任务同时按截止时间执行（超时、ACK 合并等与收数据无关的工作），每次执行后截止时间顺延。
+ * 一轮下来没有任务执行时 WFI 休眠，由任意中断唤醒
+ */
 typedef struct {
     void (*task_func)(void);
-    uint32_t rate_ms;
-    uint32_t last_run;
+    uint32_t rate_ms;                   // 截止周期(毫秒)，0 表示只由事件触发
+    uint32_t next_run;                  // 下次到期时间(毫秒)
+    volatile uint8_t pending;           // 事件已投递尚未执行
+    volatile uint32_t post_stamp;       // 第一次投递的时间戳
+    task_stats_t stats;
 } task_t;
 
+// 静态任务数组，下标为 task_id_t
+static task_t scheduler_task[TASK_NUM] =
+{
+    [TASK_UART1]      = {uart1_task, 0},
+    [TASK_BOOTLOADER] = {easy_bootloader_app_run, 10},   // 接收事件立即执行，10ms 截止用于网关等超时检查
+};
 
+static uint32_t scheduler_idle;
 
-// ̬飬ÿִڣ룩ϴʱ䣨룩
-static task_t scheduler_task[] =
+/* 时间戳取 DWT 周期计数，差值换算为微秒（168MHz 下约 25s 回绕，只用于短间隔） */
+static uint32_t scheduler_stamp(void)
 {
-	{uart1_task,100,0},
-	{easy_bootloader_app_run,10,0},
-};
+    return DWT->CYCCNT;
+}
+
+static uint32_t scheduler_stamp_us(uint32_t delta)
+{
+    return delta / (SystemCoreClock / 1000000U);
+}
+
+static void scheduler_account(task_stats_t *stats, uint32_t latency_us, uint32_t run_us)
+{
+    stats->runs++;
+    stats->total_run_us += run_us;
+    if (latency_us > stats->max_latency_us)
+        stats->max_latency_us = latency_us;
+    if (run_us > stats->max_run_us)
+        stats->max_run_us = run_us;
+}
+
+/* 关中断后再确认没有事件才休眠：WFI 在 PRIMASK 置位时仍会被挂起的中断唤醒，开中断后中断立即执行，不会漏掉事件 */
+static void scheduler_sleep(void)
+{
+#if SCHEDULER_IDLE_SLEEP
+    __disable_irq();
+    for (uint8_t i = 0; i < TASK_NUM; i++)
+    {
+        if (scheduler_task[i].pending)
+        {
+            __enable_irq();
+            return;
+        }
+    }
+    uint32_t start = scheduler_stamp();
+    __WFI();
+    scheduler_idle += scheduler_stamp_us(scheduler_stamp() - start);
+    __enable_irq();
+#endif
+}
 
 /**
- * @brief ʼ
- * Ԫظ洢 task_num 
+ * @brief 调度器初始化函数
+ * 打开 DWT 周期计数器用于统计，再初始化串口与升级组件
  */
 void scheduler_init(void)
 {
-    // Ԫظ洢 task_num 
-    task_num = sizeof(scheduler_task) / sizeof(task_t);
-		myusart_init();
-		bootloader_app_init();
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    myusart_init();
+    bootloader_app_init();
 }
 
 /**
- * @brief к
- * 飬ǷҪִСǰʱѾִڣִи񲢸ϴʱ
+ * @brief 投递事件，可在中断中调用
+ * 同一任务执行前多次投递只执行一次，延迟从第一次投递算起
+ */
+void scheduler_post(task_id_t id)
+{
+    task_t *task = &scheduler_task[id];
+
+    if (!task->pending)
+    {
+        task->post_stamp = scheduler_stamp();
+        task->pending = 1;
+    }
+}
+
+/**
+ * @brief 调度器运行函数
+ * 执行已投递事件或已到期的任务，都没有时休眠到下一个中断
  */
 void scheduler_run(void)
 {
-    // е
-    for (uint8_t i = 0; i < task_num; i++)
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < TASK_NUM; i++)
     {
-        // ȡǰϵͳʱ䣨룩
+        task_t *task = &scheduler_task[i];
         uint32_t now_time = HAL_GetTick();
+        uint32_t start = scheduler_stamp();
+        uint32_t latency_us;
 
-        // 鵱ǰʱǷﵽִʱ
-        if (now_time >= scheduler_task[i].rate_ms + scheduler_task[i].last_run)
+        if (task->pending)
         {
-            // ϴʱΪǰʱ
-            scheduler_task[i].last_run = now_time;
-
-            // ִ
-            scheduler_task[i].task_func();
+            latency_us = scheduler_stamp_us(start - task->post_stamp);
+            task->pending = 0;          // 先清标志再执行，执行期间到达的事件留到下一轮
+            task->stats.event_runs++;
         }
+        else if (task->rate_ms != 0U && (int32_t)(now_time - task->next_run) >= 0)    // 按差值比较，tick 回绕后仍正确
+        {
+            latency_us = (now_time - task->next_run) * 1000U;
+        }
+        else
+        {
+            continue;
+        }
+
+        task->next_run = now_time + task->rate_ms;
+        task->task_func();
+        scheduler_account(&task->stats, latency_us, scheduler_stamp_us(scheduler_stamp() - start));
+        ran = 1;
     }
+
+    if (!ran)
+        scheduler_sleep();
 }
 
+const task_stats_t *scheduler_get_stats(task_id_t id)
+{
+    return &scheduler_task[id].stats;
+}
 
+/* 累计休眠时间，运行时间减去它即为 CPU 忙碌时间 */
+uint32_t scheduler_idle_us(void)
+{
+    return scheduler_idle;
+}
@@ -0,0 +1,697 @@
+// Ed25519 签名校验源文件
+#include "boot_ed25519.h"
+
+#include <string.h>
+
+/*
+ * 实现要点（面向 Cortex-M4 / RV32IMAC，只做校验）：
+ * 1. 域元素用 8 个 32 位字表示，运算结果只约减到 mod 2^256-38 范围内，
+ *    仅在比较/编码时才完全约减到 [0, p)，乘法为 8x8 字乘加后按 2^256 = 38 折叠
+ * 2. 点运算使用扭曲爱德华兹扩展坐标 (X:Y:Z:T)，a = -1，全程无求逆，只在最后编码时求逆一次
+ * 3. [S]B + [k](-A) 用有符号 4 位窗口同时计算（Straus/Shamir 双标量乘），
+ *    B 的 1~8 倍点预先算好放在 Flash，A 的 1~8 倍点运行时计算，
+ *    共约 252 次倍点 + 128 次加点，Cortex-M4 168MHz 下为毫秒级
+ * 4. 校验过程只涉及公开数据，允许与数据相关的分支
+ * 5. SHA-512 仅用于计算 k = H(R || A || M)，这里只保留最小的流式实现
+ */
+
+typedef uint32_t fe_t[8];
+
+typedef struct {
+    fe_t x, y, z, t;
+} ge_p3_t;
+
+/* 加法用缓存点：(Y+X, Y-X, Z, 2dT) */
+typedef struct {
+    fe_t yplusx, yminusx, z, t2d;
+} ge_cached_t;
+
+/* Z = 1 的仿射预计算点：(y+x, y-x, 2dxy) */
+typedef struct {
+    fe_t yplusx, yminusx, xy2d;
+} ge_niels_t;
+
+typedef struct {
+    uint64_t state[8];
+    uint8_t  block[128];
+    uint32_t block_len;
+    uint32_t total_len;
+} sha512_ctx_t;
+
+static const fe_t g_fe_p = {
+    0xFFFFFFEDU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU,
+    0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0x7FFFFFFFU,
+};
+
+static const fe_t g_fe_d = {
+    0x135978A3U, 0x75EB4DCAU, 0x4141D8ABU, 0x00700A4DU,
+    0x7779E898U, 0x8CC74079U, 0x2B6FFE73U, 0x52036CEEU,
+};
+
+static const fe_t g_fe_d2 = {
+    0x26B2F159U, 0xEBD69B94U, 0x8283B156U, 0x00E0149AU,
+    0xEEF3D130U, 0x198E80F2U, 0x56DFFCE7U, 0x2406D9DCU,
+};
+
+static const fe_t g_fe_sqrtm1 = {
+    0x4A0EA0B0U, 0xC4EE1B27U, 0xAD2FE478U, 0x2F431806U,
+    0x3DFBD7A7U, 0x2B4D0099U, 0x4FC1DF0BU, 0x2B832480U,
+};
+
+/* 基点 B 的 1~8 倍 */
+static const ge_niels_t g_base_table[8] = {
+    {{0xF58C3B85U, 0x2FBC93C6U, 0xFB8C0E19U, 0xCF932DC6U, 0x643D42C2U, 0x270B4898U, 0x33D4BA65U, 0x07CF9D3AU},
+     {0xD740913EU, 0x9D103905U, 0xD140BEB3U, 0xFD399F05U, 0x688F8A09U, 0xA5C18434U, 0x98F81267U, 0x44FD2F92U},
+     {0x877AAA68U, 0xABC91205U, 0xCCAAC49EU, 0x26D9E823U, 0xDD43598CU, 0x5A1B7DCBU, 0x9F0C65A8U, 0x6F117B68U}},
+    {{0x933C71D7U, 0x9224E7FCU, 0x7A0FF5B5U, 0x9F469D96U, 0xE1D60702U, 0x5AA69A65U, 0xA87D2E2EU, 0x590C063FU},
+     {0x42B4D5A8U, 0x8A99A560U, 0x4E60ACF6U, 0x8F2B810CU, 0xB16E37AAU, 0xE09E236BU, 0x69C92555U, 0x6BB595A6U},
+     {0xA59B7A5FU, 0x43FAA8B3U, 0x5D9ACF78U, 0x36C16BDDU, 0x0B3D6A31U, 0x500FA084U, 0x3EA50B73U, 0x701AF5B1U}},
+    {{0x4CEE9730U, 0xAF25B0A8U, 0xE8864B8AU, 0x025A8430U, 0x9F016732U, 0xC11B5002U, 0x9A80F8F4U, 0x7A164E1BU},
+     {0xA4FCD265U, 0x56611FE8U, 0xE5C1BA7DU, 0x3BD353FDU, 0x214BD6BDU, 0x8131F31AU, 0x555BDA62U, 0x2AB91587U},
+     {0x0DD0D889U, 0x14AE933FU, 0x1C35DA62U, 0x58942322U, 0x8CF2DB4CU, 0xD170E545U, 0x12B9B4C6U, 0x5A2826AFU}},
+    {{0x8EFC099FU, 0x287351B9U, 0x7DFD2538U, 0x6765C6F4U, 0xFB0A9265U, 0xCA348D3DU, 0x21E58727U, 0x680E9103U},
+     {0x056818BFU, 0x95FE050AU, 0x5660FAA9U, 0x327E8971U, 0x06A05073U, 0xC3E8E3CDU, 0x7445A49AU, 0x27933F4CU},
+     {0xC476FF09U, 0x5A13FBE9U, 0x7B5CC172U, 0x6E9E3945U, 0x102B4494U, 0x5DDBDCF9U, 0x63553E2BU, 0x7F9D0CBFU}},
+    {{0x08A5BB33U, 0xA212BC44U, 0xC75EED02U, 0x8D5048C3U, 0x5ABFEC44U, 0xDD1BEB0CU, 0x46E206EBU, 0x2945CCF1U},
+     {0xA447D6BAU, 0x7F9182C3U, 0x4B2729B7U, 0xD50014D1U, 0xB864A087U, 0xE33CF11CU, 0xEB1B55F3U, 0x154A7E73U},
+     {0x812A8285U, 0xBCBBDBF1U, 0xD0BDD1FCU, 0x270E0807U, 0x1BBDA72DU, 0xB41B670BU, 0x6B3BB69AU, 0x43AABE69U}},
+    {{0x77157131U, 0x3A0CEEEBU, 0x00C8AF88U, 0x9B271589U, 0xDA59A736U, 0x8065B668U, 0xA2CC38BDU, 0x51E57BB6U},
+     {0x7B7D8CA4U, 0x499806B6U, 0x27D22739U, 0x575BE284U, 0x204553B9U, 0xBB085CE7U, 0xAE417884U, 0x38B64C41U},
+     {0x02EA4B71U, 0x85AC3267U, 0x41A1BB01U, 0xBE70E003U, 0x083BC144U, 0x53E4A24BU, 0x9F0D61E3U, 0x10B8E91AU}},
+    {{0x944EA3BFU, 0x6B1A5CD0U, 0xB39DC0D2U, 0x7470353AU, 0x28542E49U, 0x71B25282U, 0x283C927EU, 0x461BEA69U},
+     {0xAA3221B1U, 0xBA6F2C9AU, 0x3BBA23A7U, 0x6CA02153U, 0x92192C3AU, 0x9DEA764FU, 0x2E5317E0U, 0x1D6EDD5DU},
+     {0x01B8B3A2U, 0xF1836DC8U, 0x053EA49AU, 0xB3035F47U, 0x5877ADF3U, 0x529C41BAU, 0x6A0F90A7U, 0x7A9FBB1CU}},
+    {{0x04DD3E8FU, 0x59B75966U, 0xE288702CU, 0x6CB30377U, 0x5ED9C323U, 0xB1339C66U, 0x61BCE52FU, 0x0915E760U},
+     {0xF39234D9U, 0xE2A75DEDU, 0xE1B558F9U, 0x963D7680U, 0x6E3C23FBU, 0x2C2741ACU, 0x320E01C3U, 0x3A9024A1U},
+     {0xC9A2911AU, 0xE7C1F5D9U, 0x8BCCA7D7U, 0xB8A37178U, 0x0EB62A32U, 0x63641219U, 0x2ECC4E95U, 0x26907C5CU}},
+};
+
+/* 群阶 L = 2^252 + 27742317777372353535851937790883648493，小端 */
+static const uint8_t g_order_l[32] = {
+    0xEDU, 0xD3U, 0xF5U, 0x5CU, 0x1AU, 0x63U, 0x12U, 0x58U,
+    0xD6U, 0x9CU, 0xF7U, 0xA2U, 0xDEU, 0xF9U, 0xDEU, 0x14U,
+    0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U,
+    0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x10U,
+};
+
+static const uint64_t g_sha512_k[80] = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+    0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL, 0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+    0xD807AA98A3030242ULL, 0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+    0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL, 0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+    0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+    0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL, 0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+    0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+    0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL, 0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+    0xD192E819D6EF5218ULL, 0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+    0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL, 0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+    0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+    0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL, 0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+    0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+    0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL, 0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL,
+};
+
+/* 校验工作区：计算 k 与构建 A 的倍点表两个阶段不会同时使用 */
+static union {
+    struct {
+        sha512_ctx_t sha;
+        int64_t      wide[64];
+    } hram;
+    ge_cached_t a_table[8];
+} g_ed25519_work;
+
+/* ========================= SHA-512 ========================= */
+
+#define SHA512_ROTR(x, n)  (((x) >> (n)) | ((x) << (64U - (n))))
+
+static void sha512_transform(uint64_t state[8], const uint8_t *block)
+{
+    uint64_t w[16];
+    uint64_t v[8];
+
+    for (uint32_t i = 0U; i < 16U; i++) {
+        uint64_t x = 0U;
+        for (uint32_t j = 0U; j < 8U; j++) {
+            x = (x << 8) | block[i * 8U + j];
+        }
+        w[i] = x;
+    }
+    memcpy(v, state, sizeof(v));
+
+    for (uint32_t i = 0U; i < 80U; i++) {
+        if (i >= 16U) {
+            uint64_t s0 = w[(i - 15U) & 15U];
+            uint64_t s1 = w[(i - 2U) & 15U];
+            s0 = SHA512_ROTR(s0, 1U) ^ SHA512_ROTR(s0, 8U) ^ (s0 >> 7);
+            s1 = SHA512_ROTR(s1, 19U) ^ SHA512_ROTR(s1, 61U) ^ (s1 >> 6);
+            w[i & 15U] += s0 + s1 + w[(i - 7U) & 15U];
+        }
+        uint64_t t1 = v[7] + (SHA512_ROTR(v[4], 14U) ^ SHA512_ROTR(v[4], 18U) ^ SHA512_ROTR(v[4], 41U)) +
+                      (v[6] ^ (v[4] & (v[5] ^ v[6]))) + g_sha512_k[i] + w[i & 15U];
+        uint64_t t2 = (SHA512_ROTR(v[0], 28U) ^ SHA512_ROTR(v[0], 34U) ^ SHA512_ROTR(v[0], 39U)) +
+                      ((v[0] & v[1]) | (v[2] & (v[0] | v[1])));
+        memmove(&v[1], &v[0], 7U * sizeof(uint64_t));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+
+    for (uint32_t i = 0U; i < 8U; i++) {
+        state[i] += v[i];
+    }
+}
+
+static void sha512_init(sha512_ctx_t *ctx)
+{
+    ctx->state[0] = 0x6A09E667F3BCC908ULL;
+    ctx->state[1] = 0xBB67AE8584CAA73BULL;
+    ctx->state[2] = 0x3C6EF372FE94F82BULL;
+    ctx->state[3] = 0xA54FF53A5F1D36F1ULL;
+    ctx->state[4] = 0x510E527FADE682D1ULL;
+    ctx->state[5] = 0x9B05688C2B3E6C1FULL;
+    ctx->state[6] = 0x1F83D9ABFB41BD6BULL;
+    ctx->state[7] = 0x5BE0CD19137E2179ULL;
+    ctx->block_len = 0U;
+    ctx->total_len = 0U;
+}
+
+static void sha512_update(sha512_ctx_t *ctx, const uint8_t *data, uint32_t len)
+{
+    ctx->total_len += len;
+    while (len > 0U) {
+        uint32_t fill = 128U - ctx->block_len;
+        if (fill > len) {
+            fill = len;
+        }
+        memcpy(&ctx->block[ctx->block_len], data, fill);
+        ctx->block_len += fill;
+        data += fill;
+        len -= fill;
+        if (ctx->block_len == 128U) {
+            sha512_transform(ctx->state, ctx->block);
+            ctx->block_len = 0U;
+        }
+    }
+}
+
+static void sha512_final(sha512_ctx_t *ctx, uint8_t digest[64])
+{
+    uint32_t bit_len_hi = ctx->total_len >> 29;
+    uint32_t bit_len_lo = ctx->total_len << 3;
+
+    ctx->block[ctx->block_len++] = 0x80U;
+    if (ctx->block_len > 112U) {
+        memset(&ctx->block[ctx->block_len], 0, 128U - ctx->block_len);
+        sha512_transform(ctx->state, ctx->block);
+        ctx->block_len = 0U;
+    }
+    memset(&ctx->block[ctx->block_len], 0, 120U - ctx->block_len);
+
+    /* 消息比特长度，大端 128 位（高 64 位恒为 0） */
+    ctx->block[120] = (uint8_t)(bit_len_hi >> 24);
+    ctx->block[121] = (uint8_t)(bit_len_hi >> 16);
+    ctx->block[122] = (uint8_t)(bit_len_hi >> 8);
+    ctx->block[123] = (uint8_t)bit_len_hi;
+    ctx->block[124] = (uint8_t)(bit_len_lo >> 24);
+    ctx->block[125] = (uint8_t)(bit_len_lo >> 16);
+    ctx->block[126] = (uint8_t)(bit_len_lo >> 8);
+    ctx->block[127] = (uint8_t)bit_len_lo;
+    sha512_transform(ctx->state, ctx->block);
+
+    for (uint32_t i = 0U; i < 64U; i++) {
+        digest[i] = (uint8_t)(ctx->state[i >> 3] >> (56U - 8U * (i & 7U)));
+    }
+}
+
+/* ========================= 域运算 mod 2^255-19 ========================= */
+
+static void fe_copy(fe_t r, const fe_t a)
+{
+    memcpy(r, a, sizeof(fe_t));
+}
+
+static void fe_set(fe_t r, uint32_t v)
+{
+    memset(r, 0, sizeof(fe_t));
+    r[0] = v;
+}
+
+static void fe_add(fe_t r, const fe_t a, const fe_t b)
+{
+    uint64_t c = 0U;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += (uint64_t)a[i] + b[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    /* 2^256 = 38 (mod p)，第二次折叠后进位至多为 1，此时 r 很小，直接加到最低字 */
+    c *= 38U;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += r[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    r[0] += (uint32_t)c * 38U;
+}
+
+static void fe_sub(fe_t r, const fe_t a, const fe_t b)
+{
+    int64_t c = 0;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += (int64_t)a[i] - b[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    /* 借位相当于多加了 2^256，需要再减 38 */
+    c *= 38;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += r[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    r[0] += (uint32_t)c * 38U;
+}
+
+static void fe_mul(fe_t r, const fe_t a, const fe_t b)
+{
+    uint32_t t[16] = {0};
+
+    for (uint32_t i = 0U; i < 8U; i++) {
+        uint64_t c = 0U;
+        for (uint32_t j = 0U; j < 8U; j++) {
+            c += (uint64_t)a[i] * b[j] + t[i + j];
+            t[i + j] = (uint32_t)c;
+            c >>= 32;
+        }
+        t[i + 8U] = (uint32_t)c;
+    }
+
+    uint64_t c = 0U;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += (uint64_t)t[i + 8U] * 38U + t[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    c *= 38U;
+    for (uint32_t i = 0U; i < 8U; i++) {
+        c += r[i];
+        r[i] = (uint32_t)c;
+        c >>= 32;
+    }
+    r[0] += (uint32_t)c * 38U;
+}
+
+static void fe_sqr(fe_t r, const fe_t a)
+{
+    fe_mul(r, a, a);
+}
+
+static void fe_sqr_n(fe_t r, const fe_t a, uint32_t n)
+{
+    fe_sqr(r, a);
+    while (--n > 0U) {
+        fe_sqr(r, r);
+    }
+}
+
+/* 完全约减到 [0, p)：输入 < 2^256 = 2p + 38，最多减两次 p */
+static void fe_reduce(fe_t r)
+{
+    for (uint32_t k = 0U; k < 2U; k++) {
+        fe_t t;
+        int64_t c = 0;
+        for (uint32_t i = 0U; i < 8U; i++) {
+            c += (int64_t)r[i] - g_fe_p[i];
+            t[i] = (uint32_t)c;
+            c >>= 32;
+        }
+        /* 无借位（r >= p）时取 t，按掩码选择，不引入分支 */
+        uint32_t keep = (uint32_t)c;
+        for (uint32_t i = 0U; i < 8U; i++) {
+            r[i] = (r[i] & keep) | (t[i] & ~keep);
+        }
+    }
+}
+
+static void fe_frombytes(fe_t r, const uint8_t s[32])
+{
+    for (uint32_t i = 0U; i < 8U; i++) {
+        r[i] = (uint32_t)s[i * 4U] | ((uint32_t)s[i * 4U + 1U] << 8) |
+               ((uint32_t)s[i * 4U + 2U] << 16) | ((uint32_t)s[i * 4U + 3U] << 24);
+    }
+    r[7] &= 0x7FFFFFFFU;
+}
+
+static void fe_tobytes(uint8_t s[32], const fe_t a)
+{
+    fe_t t;
+    fe_copy(t, a);
+    fe_reduce(t);
+    for (uint32_t i = 0U; i < 8U; i++) {
+        s[i * 4U + 0U] = (uint8_t)t[i];
+        s[i * 4U + 1U] = (uint8_t)(t[i] >> 8);
+        s[i * 4U + 2U] = (uint8_t)(t[i] >> 16);
+        s[i * 4U + 3U] = (uint8_t)(t[i] >> 24);
+    }
+}
+
+static bool fe_is_zero(const fe_t a)
+{
+    uint8_t s[32];
+    uint8_t acc = 0U;
+    fe_tobytes(s, a);
+    for (uint32_t i = 0U; i < 32U; i++) {
+        acc |= s[i];
+    }
+    return acc == 0U;
+}
+
+static uint32_t fe_is_negative(const fe_t a)
+{
+    uint8_t s[32];
+    fe_tobytes(s, a);
+    return s[0] & 1U;
+}
+
+/* z^(2^250 - 1)，同时输出 z^11 供求逆使用 */
+static void fe_pow_2_250_1(fe_t r, fe_t z11, const fe_t z)
+{
+    fe_t t0, t1, t2;
+
+    fe_sqr(t0, z);                  // z^2
+    fe_sqr_n(t1, t0, 2U);           // z^8
+    fe_mul(t1, z, t1);              // z^9
+    fe_mul(z11, t0, t1);            // z^11
+    fe_sqr(t0, z11);                // z^22
+    fe_mul(t0, t1, t0);             // z^(2^5 - 1)
+    fe_sqr_n(t1, t0, 5U);
+    fe_mul(t0, t1, t0);             // z^(2^10 - 1)
+    fe_sqr_n(t1, t0, 10U);
+    fe_mul(t1, t1, t0);             // z^(2^20 - 1)
+    fe_sqr_n(t2, t1, 20U);
+    fe_mul(t1, t2, t1);             // z^(2^40 - 1)
+    fe_sqr_n(t1, t1, 10U);
+    fe_mul(t0, t1, t0);             // z^(2^50 - 1)
+    fe_sqr_n(t1, t0, 50U);
+    fe_mul(t1, t1, t0);             // z^(2^100 - 1)
+    fe_sqr_n(t2, t1, 100U);
+    fe_mul(t1, t2, t1);             // z^(2^200 - 1)
+    fe_sqr_n(t1, t1, 50U);
+    fe_mul(r, t1, t0);              // z^(2^250 - 1)
+}
+
+/* z^(p - 2) = z^(2^255 - 21) */
+static void fe_invert(fe_t r, const fe_t z)
+{
+    fe_t t, z11;
+    fe_pow_2_250_1(t, z11, z);
+    fe_sqr_n(t, t, 5U);
+    fe_mul(r, t, z11);
+}
+
+/* z^((p - 5) / 8) = z^(2^252 - 3) */
+static void fe_pow22523(fe_t r, const fe_t z)
+{
+    fe_t t, z11;
+    fe_pow_2_250_1(t, z11, z);
+    fe_sqr_n(t, t, 2U);
+    fe_mul(r, t, z);
+}
+
+/* ========================= 点运算 ========================= */
+
+static void ge_set_identity(ge_p3_t *p)
+{
+    fe_set(p->x, 0U);
+    fe_set(p->y, 1U);
+    fe_set(p->z, 1U);
+    fe_set(p->t, 0U);
+}
+
+static void ge_to_cached(ge_cached_t *r, const ge_p3_t *p)
+{
+    fe_add(r->yplusx, p->y, p->x);
+    fe_sub(r->yminusx, p->y, p->x);
+    fe_copy(r->z, p->z);
+    fe_mul(r->t2d, p->t, g_fe_d2);
+}
+
+/*
+ * r = p + q 或 p - q（neg 非 0 时），q 以 (Y+X, Y-X, 2dT, Z) 形式给出
+ * z 为 NULL 表示 q 为 Z = 1 的仿射点，省一次乘法
+ * 取负点即交换 Y+X / Y-X 并对 2dT 取负，后者体现在 F / G 的加减互换上
+ */
+static void ge_add(ge_p3_t *r, const ge_p3_t *p, const fe_t yplusx, const fe_t yminusx,
+                   const fe_t t2d, const fe_t z, bool neg)
+{
+    fe_t a, b, c, d, e, f, g, h;
+
+    fe_sub(a, p->y, p->x);
+    fe_add(b, p->y, p->x);
+    fe_mul(a, a, neg ? yplusx : yminusx);
+    fe_mul(b, b, neg ? yminusx : yplusx);
+    fe_mul(c, p->t, t2d);
+    if (z != NULL) {
+        fe_mul(d, p->z, z);
+        fe_add(d, d, d);
+    } else {
+        fe_add(d, p->z, p->z);
+    }
+    fe_sub(e, b, a);
+    fe_add(h, b, a);
+    if (neg) {
+        fe_add(f, d, c);
+        fe_sub(g, d, c);
+    } else {
+        fe_sub(f, d, c);
+        fe_add(g, d, c);
+    }
+    fe_mul(r->x, e, f);
+    fe_mul(r->y, g, h);
+    fe_mul(r->z, f, g);
+    fe_mul(r->t, e, h);
+}
+
+/* r = 2p（dbl-2008-hwcd，a = -1，各中间量整体取负后结果不变） */
+static void ge_dbl(ge_p3_t *r, const ge_p3_t *p)
+{
+    fe_t a, b, c, e, f, g, h;
+
+    fe_sqr(a, p->x);
+    fe_sqr(b, p->y);
+    fe_sqr(c, p->z);
+    fe_add(c, c, c);
+    fe_add(h, a, b);
+    fe_add(e, p->x, p->y);
+    fe_sqr(e, e);
+    fe_sub(e, h, e);
+    fe_sub(g, a, b);
+    fe_add(f, c, g);
+    fe_mul(r->x, e, f);
+    fe_mul(r->y, g, h);
+    fe_mul(r->z, f, g);
+    fe_mul(r->t, e, h);
+}
+
+/* 解码公钥并取负，得到 -A；点不在曲线上时返回 false */
+static bool ge_frombytes_negate(ge_p3_t *r, const uint8_t s[32])
+{
+    fe_t u, v, v3, vxx, check;
+
+    fe_frombytes(r->y, s);
+    fe_set(r->z, 1U);
+    fe_sqr(u, r->y);
+    fe_mul(v, u, g_fe_d);
+    fe_sub(u, u, r->z);             // u = y^2 - 1
+    fe_add(v, v, r->z);             // v = d*y^2 + 1
+
+    /* x = u * v^3 * (u * v^7)^((p-5)/8) */
+    fe_sqr(v3, v);
+    fe_mul(v3, v3, v);
+    fe_sqr(r->x, v3);
+    fe_mul(r->x, r->x, v);
+    fe_mul(r->x, r->x, u);
+    fe_pow22523(r->x, r->x);
+    fe_mul(r->x, r->x, v3);
+    fe_mul(r->x, r->x, u);
+
+    fe_sqr(vxx, r->x);
+    fe_mul(vxx, vxx, v);
+    fe_sub(check, vxx, u);
+    if (!fe_is_zero(check)) {
+        fe_add(check, vxx, u);
+        if (!fe_is_zero(check)) {
+            return false;
+        }
+        fe_mul(r->x, r->x, g_fe_sqrtm1);
+    }
+
+    /* 编码符号位对应 A 的 x，这里取相反符号得到 -A */
+    if (fe_is_negative(r->x) == (uint32_t)(s[31] >> 7)) {
+        fe_t zero;
+        fe_set(zero, 0U);
+        fe_sub(r->x, zero, r->x);
+    }
+    fe_mul(r->t, r->x, r->y);
+    return true;
+}
+
+static void ge_tobytes(uint8_t s[32], const ge_p3_t *p)
+{
+    fe_t zi, x, y;
+
+    fe_invert(zi, p->z);
+    fe_mul(x, p->x, zi);
+    fe_mul(y, p->y, zi);
+    fe_tobytes(s, y);
+    s[31] ^= (uint8_t)(fe_is_negative(x) << 7);
+}
+
+/* ========================= 标量运算 mod L ========================= */
+
+/* S 必须小于 L，拒绝可延展签名 */
+static bool sc_is_canonical(const uint8_t s[32])
+{
+    for (int32_t i = 31; i >= 0; i--) {
+        if (s[i] < g_order_l[i]) {
+            return true;
+        }
+        if (s[i] > g_order_l[i]) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/* 64 字节小端整数 mod L，结果 32 字节 */
+static void sc_reduce(uint8_t r[32], const uint8_t s[64])
+{
+    int64_t *x = g_ed25519_work.hram.wide;
+    int64_t carry;
+    int32_t i, j;
+
+    for (i = 0; i < 64; i++) {
+        x[i] = s[i];
+    }
+    for (i = 63; i >= 32; i--) {
+        carry = 0;
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * g_order_l[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    carry = 0;
+    for (j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * g_order_l[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (j = 0; j < 32; j++) {
+        x[j] -= carry * g_order_l[j];
+    }
+    for (i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+/* 标量转为 64 个有符号 4 位窗口，每位取值 [-8, 8]；要求标量 < 2^255 */
+static void sc_recode(int8_t e[64], const uint8_t a[32])
+{
+    int8_t carry = 0;
+
+    for (uint32_t i = 0U; i < 32U; i++) {
+        e[2U * i] = (int8_t)(a[i] & 15U);
+        e[2U * i + 1U] = (int8_t)(a[i] >> 4);
+    }
+    for (uint32_t i = 0U; i < 63U; i++) {
+        e[i] = (int8_t)(e[i] + carry);
+        carry = (int8_t)((e[i] + 8) >> 4);
+        e[i] = (int8_t)(e[i] - carry * 16);
+    }
+    e[63] = (int8_t)(e[63] + carry);
+}
+
+/* r = [a]A + [b]B */
+static void ge_double_scalarmult(ge_p3_t *r, const uint8_t a[32], const ge_p3_t *pa, const uint8_t b[32])
+{
+    ge_cached_t *table = g_ed25519_work.a_table;
+    int8_t ea[64];
+    int8_t eb[64];
+    ge_p3_t t;
+    bool started = false;
+
+    sc_recode(ea, a);
+    sc_recode(eb, b);
+
+    /* A, 2A, ... 8A */
+    ge_to_cached(&table[0], pa);
+    ge_dbl(&t, pa);
+    ge_to_cached(&table[1], &t);
+    for (uint32_t i = 2U; i < 8U; i++) {
+        ge_add(&t, &t, table[0].yplusx, table[0].yminusx, table[0].t2d, table[0].z, false);
+        ge_to_cached(&table[i], &t);
+    }
+
+    ge_set_identity(r);
+    for (int32_t i = 63; i >= 0; i--) {
+        if (started) {
+            ge_dbl(r, r);
+            ge_dbl(r, r);
+            ge_dbl(r, r);
+            ge_dbl(r, r);
+        }
+        if (ea[i] != 0) {
+            const ge_cached_t *q = &table[(ea[i] > 0 ? ea[i] : -ea[i]) - 1];
+            ge_add(r, r, q->yplusx, q->yminusx, q->t2d, q->z, ea[i] < 0);
+            started = true;
+        }
+        if (eb[i] != 0) {
+            const ge_niels_t *q = &g_base_table[(eb[i] > 0 ? eb[i] : -eb[i]) - 1];
+            ge_add(r, r, q->yplusx, q->yminusx, q->xy2d, NULL, eb[i] < 0);
+            started = true;
+        }
+    }
+}
+
+/* ========================= 签名校验 ========================= */
+
+bool boot_ed25519_verify(const uint8_t sig[BOOT_ED25519_SIGNATURE_SIZE],
+                         const uint8_t *msg, uint32_t msg_len,
+                         const uint8_t pub[BOOT_ED25519_PUBLIC_KEY_SIZE])
+{
+    sha512_ctx_t *sha = &g_ed25519_work.hram.sha;
+    uint8_t hram[64];
+    uint8_t k[32];
+    uint8_t check[32];
+    ge_p3_t neg_a;
+    ge_p3_t r;
+
+    if (!sc_is_canonical(&sig[32])) {
+        return false;
+    }
+    if (!ge_frombytes_negate(&neg_a, pub)) {
+        return false;
+    }
+
+    /* k = H(R || A || M) mod L */
+    sha512_init(sha);
+    sha512_update(sha, sig, 32U);
+    sha512_update(sha, pub, BOOT_ED25519_PUBLIC_KEY_SIZE);
+    sha512_update(sha, msg, msg_len);
+    sha512_final(sha, hram);
+    sc_reduce(k, hram);
+
+    /* [S]B - [k]A 应等于 R */
+    ge_double_scalarmult(&r, k, &neg_a, &sig[32]);
+    ge_tobytes(check, &r);
+    return memcmp(check, sig, 32U) == 0;
+}
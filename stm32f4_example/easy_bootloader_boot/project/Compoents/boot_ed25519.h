@@ -0,0 +1,23 @@
+// Ed25519 签名校验头文件
+#ifndef BOOT_ED25519_H
+#define BOOT_ED25519_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOOT_ED25519_PUBLIC_KEY_SIZE  32U
+#define BOOT_ED25519_SIGNATURE_SIZE   64U
+
+/*
+ * 校验 RFC 8032 Ed25519 签名（仅校验，不含签名/密钥生成）
+ * sig:     R(32) || S(32)
+ * msg:     被签名的消息，Bootloader 中为固件 SHA-256 摘要
+ * pub:     32 字节压缩公钥
+ * 返回 true 表示签名有效；S >= L、公钥无法解码等情况一律返回 false
+ * 运行期工作区为静态变量（约 1KB RAM），不可重入，栈占用约 800B
+ */
+bool boot_ed25519_verify(const uint8_t sig[BOOT_ED25519_SIGNATURE_SIZE],
+                         const uint8_t *msg, uint32_t msg_len,
+                         const uint8_t pub[BOOT_ED25519_PUBLIC_KEY_SIZE]);
+
+#endif // BOOT_ED25519_H
@@ -0,0 +1,396 @@
+// ISO-TP (ISO 15765-2) 传输层：单帧 / 首帧 / 连续帧 / 流控帧，支持 CAN-FD 转义单帧与 32 位长度首帧
+#include "boot_isotp.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define ISOTP_PCI_MASK                0xF0U
+#define ISOTP_PCI_SF                  0x00U
+#define ISOTP_PCI_FF                  0x10U
+#define ISOTP_PCI_CF                  0x20U
+#define ISOTP_PCI_FC                  0x30U
+
+#define ISOTP_FC_CTS                  0x00U
+#define ISOTP_FC_WAIT                 0x01U
+#define ISOTP_FC_OVERFLOW             0x02U
+
+#define ISOTP_SF_MAX_LEN              7U        // 经典单帧（及 CAN-FD 非转义单帧）最大载荷
+#define ISOTP_FF_MAX_LEN12            0x0FFFU   // 12 位长度首帧上限，更长时使用 32 位转义长度
+#define ISOTP_ST_MIN_MAX_MS           0x7FU
+
+#if (BOOT_ISOTP_RX_BUF_SIZE & (BOOT_ISOTP_RX_BUF_SIZE - 1U)) != 0U
+#error "BOOT_ISOTP_RX_BUF_SIZE must be a power of 2"
+#endif
+
+static uint32_t isotp_fifo_free(const boot_isotp_t *ctx)
+{
+    return BOOT_ISOTP_RX_BUF_SIZE - (ctx->rx_tail - ctx->rx_head);
+}
+
+static void isotp_fifo_put(boot_isotp_t *ctx, const uint8_t *data, uint32_t len)
+{
+    uint32_t pos = ctx->rx_tail & (BOOT_ISOTP_RX_BUF_SIZE - 1U);
+    uint32_t first = BOOT_ISOTP_RX_BUF_SIZE - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ctx->rx_fifo[pos], data, first);
+    memcpy(ctx->rx_fifo, &data[first], len - first);
+    ctx->rx_tail += len;
+}
+
+/* CAN-FD 帧长只能取 8/12/16/20/24/32/48/64，不足时向上补齐；经典 CAN 一律补齐到 8 */
+static uint8_t isotp_frame_dlen(uint32_t len)
+{
+    static const uint8_t dlen_table[] = {8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U};
+
+    for (uint32_t i = 0U; i < sizeof(dlen_table); i++) {
+        if (len <= dlen_table[i]) {
+            return dlen_table[i];
+        }
+    }
+    return BOOT_ISOTP_CANFD_DLEN;
+}
+
+static boot_isotp_status_t isotp_send_frame(boot_isotp_t *ctx, uint8_t *frame, uint32_t len)
+{
+    uint8_t dlen = isotp_frame_dlen(len);
+    memset(&frame[len], BOOT_ISOTP_PADDING, dlen - len);
+
+    uint32_t start = ctx->ops->get_tick();
+    while (ctx->ops->can_send(ctx->cfg.tx_id, frame, dlen) != 0) {
+        if ((uint32_t)(ctx->ops->get_tick() - start) >= BOOT_ISOTP_TIMEOUT_MS) {
+            return BOOT_ISOTP_TIMEOUT;
+        }
+    }
+    return BOOT_ISOTP_OK;
+}
+
+static void isotp_send_fc(boot_isotp_t *ctx, uint8_t status)
+{
+    uint8_t frame[BOOT_ISOTP_CANFD_DLEN];
+    frame[0] = (uint8_t)(ISOTP_PCI_FC | status);
+    frame[1] = ctx->cfg.block_size;
+    frame[2] = ctx->cfg.st_min;
+    (void)isotp_send_frame(ctx, frame, 3U);
+}
+
+/*
+ * 接收缓存能容纳下一整块连续帧时才回 CTS，缓存不足就让对端停在等流控，
+ * 由上层读走数据后在 poll / read 中补发，实现端到端背压
+ */
+static void isotp_try_send_cts(boot_isotp_t *ctx)
+{
+    uint32_t need = (uint32_t)ctx->cfg.block_size * (ctx->cfg.frame_len - 1U);
+    if (need > ctx->rx_remain) {
+        need = ctx->rx_remain;
+    }
+    if (isotp_fifo_free(ctx) < need) {
+        return;
+    }
+
+    isotp_send_fc(ctx, ISOTP_FC_CTS);
+    ctx->rx_fc_pending = 0U;
+    ctx->rx_block_left = ctx->cfg.block_size;
+    ctx->rx_tick = ctx->ops->get_tick();
+}
+
+static void isotp_drop_message(boot_isotp_t *ctx)
+{
+    if (ctx->rx_overflow < 0xFFU) {
+        ctx->rx_overflow++;
+    }
+}
+
+static void isotp_handle_frame(boot_isotp_t *ctx, const uint8_t *data, uint8_t len)
+{
+    if (len == 0U) {
+        return;
+    }
+
+    switch (data[0] & ISOTP_PCI_MASK) {
+    case ISOTP_PCI_SF: {
+        uint32_t offset = 1U;
+        uint32_t size = data[0] & 0x0FU;
+        if (size == 0U && len > BOOT_ISOTP_CAN_DLEN) {
+            size = data[1];         // CAN-FD 转义单帧：长度放在第 2 字节
+            offset = 2U;
+        }
+        if (size == 0U || size + offset > len) {
+            return;
+        }
+
+        /* 新报文打断未完成的多帧接收 */
+        ctx->rx_remain = 0U;
+        ctx->rx_fc_pending = 0U;
+        if (isotp_fifo_free(ctx) < size) {
+            isotp_drop_message(ctx);
+            return;
+        }
+        isotp_fifo_put(ctx, &data[offset], size);
+        break;
+    }
+
+    case ISOTP_PCI_FF: {
+        if (len < BOOT_ISOTP_CAN_DLEN) {
+            return;
+        }
+        uint32_t offset = 2U;
+        uint32_t size = ((uint32_t)(data[0] & 0x0FU) << 8) | data[1];
+        if (size == 0U) {
+            size = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) |
+                   ((uint32_t)data[4] << 8) | data[5];
+            offset = 6U;
+        }
+        uint32_t chunk = len - offset;
+        if (size <= chunk) {
+            return;
+        }
+
+        ctx->rx_remain = 0U;
+        ctx->rx_fc_pending = 0U;
+        if (isotp_fifo_free(ctx) < chunk) {
+            isotp_drop_message(ctx);
+            isotp_send_fc(ctx, ISOTP_FC_OVERFLOW);
+            return;
+        }
+        isotp_fifo_put(ctx, &data[offset], chunk);
+        ctx->rx_remain = size - chunk;
+        ctx->rx_sn = 1U;
+        ctx->rx_fc_pending = 1U;
+        isotp_try_send_cts(ctx);
+        break;
+    }
+
+    case ISOTP_PCI_CF: {
+        if (ctx->rx_remain == 0U || ctx->rx_fc_pending != 0U) {
+            return;
+        }
+        if ((data[0] & 0x0FU) != ctx->rx_sn) {
+            ctx->rx_remain = 0U;    // 序号错误说明丢帧，放弃本报文，由上层协议超时重传
+            isotp_drop_message(ctx);
+            return;
+        }
+
+        uint32_t chunk = (uint32_t)len - 1U;
+        if (chunk > ctx->rx_remain) {
+            chunk = ctx->rx_remain;
+        }
+        isotp_fifo_put(ctx, &data[1], chunk);   // CTS 前已预留整块空间
+        ctx->rx_remain -= chunk;
+        ctx->rx_sn = (uint8_t)((ctx->rx_sn + 1U) & 0x0FU);
+        ctx->rx_tick = ctx->ops->get_tick();
+
+        if (ctx->rx_remain > 0U && --ctx->rx_block_left == 0U) {
+            ctx->rx_fc_pending = 1U;
+            isotp_try_send_cts(ctx);
+        }
+        break;
+    }
+
+    case ISOTP_PCI_FC:
+        if (len < 3U) {
+            return;
+        }
+        ctx->tx_fc_status = data[0] & 0x0FU;
+        ctx->tx_fc_bs = data[1];
+        ctx->tx_fc_st_min = data[2];
+        ctx->tx_fc_valid = 1U;
+        break;
+
+    default:
+        break;
+    }
+}
+
+boot_isotp_status_t boot_isotp_init(boot_isotp_t *ctx, const boot_isotp_ops_t *ops,
+                                    const boot_isotp_config_t *cfg)
+{
+    if (ctx == NULL || ops == NULL || cfg == NULL ||
+        ops->can_send == NULL || ops->can_recv == NULL || ops->get_tick == NULL ||
+        isotp_frame_dlen(cfg->frame_len) != cfg->frame_len) {
+        return BOOT_ISOTP_ERROR;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->ops = ops;
+    ctx->cfg = *cfg;
+
+    /* 一块连续帧不超过半个接收缓存，上层读走一半即可放行下一块 */
+    uint32_t max_bs = (BOOT_ISOTP_RX_BUF_SIZE / 2U) / (cfg->frame_len - 1U);
+    if (max_bs > 0xFFU) {
+        max_bs = 0xFFU;
+    }
+    if (max_bs == 0U) {
+        return BOOT_ISOTP_ERROR;
+    }
+    if (ctx->cfg.block_size == 0U || ctx->cfg.block_size > max_bs) {
+        ctx->cfg.block_size = (uint8_t)max_bs;
+    }
+    return BOOT_ISOTP_OK;
+}
+
+void boot_isotp_poll(boot_isotp_t *ctx)
+{
+    uint32_t id;
+    uint8_t data[BOOT_ISOTP_CANFD_DLEN];
+    uint8_t len;
+
+    while (ctx->ops->can_recv(&id, data, &len) != 0) {
+        if (id == ctx->cfg.rx_id) {
+            isotp_handle_frame(ctx, data, len);
+        }
+    }
+
+    if (ctx->rx_fc_pending != 0U) {
+        isotp_try_send_cts(ctx);
+    } else if (ctx->rx_remain > 0U &&
+               (uint32_t)(ctx->ops->get_tick() - ctx->rx_tick) >= BOOT_ISOTP_TIMEOUT_MS) {
+        ctx->rx_remain = 0U;    // N_Cr 超时，放弃未完成的报文
+        isotp_drop_message(ctx);
+    }
+}
+
+uint32_t boot_isotp_read(boot_isotp_t *ctx, uint8_t *buf, uint32_t max_len)
+{
+    if (ctx == NULL || buf == NULL || max_len == 0U) {
+        return 0U;
+    }
+
+    boot_isotp_poll(ctx);
+
+    uint32_t len = ctx->rx_tail - ctx->rx_head;
+    if (len > max_len) {
+        len = max_len;
+    }
+    uint32_t pos = ctx->rx_head & (BOOT_ISOTP_RX_BUF_SIZE - 1U);
+    uint32_t first = BOOT_ISOTP_RX_BUF_SIZE - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(buf, &ctx->rx_fifo[pos], first);
+    memcpy(&buf[first], ctx->rx_fifo, len - first);
+    ctx->rx_head += len;
+
+    if (len > 0U && ctx->rx_fc_pending != 0U) {
+        isotp_try_send_cts(ctx);
+    }
+    return len;
+}
+
+/* 等待对端流控帧，期间收到的报文照常重组；WAIT 会重新计时 */
+static boot_isotp_status_t isotp_wait_fc(boot_isotp_t *ctx, uint8_t *bs, uint8_t *st_min)
+{
+    uint32_t start = ctx->ops->get_tick();
+
+    for (;;) {
+        boot_isotp_poll(ctx);
+        if (ctx->tx_fc_valid != 0U) {
+            ctx->tx_fc_valid = 0U;
+            if (ctx->tx_fc_status == ISOTP_FC_CTS) {
+                *bs = ctx->tx_fc_bs;
+                *st_min = ctx->tx_fc_st_min;
+                return BOOT_ISOTP_OK;
+            }
+            if (ctx->tx_fc_status != ISOTP_FC_WAIT) {
+                return BOOT_ISOTP_ERROR;
+            }
+            start = ctx->ops->get_tick();
+        }
+        if ((uint32_t)(ctx->ops->get_tick() - start) >= BOOT_ISOTP_TIMEOUT_MS) {
+            return BOOT_ISOTP_TIMEOUT;
+        }
+    }
+}
+
+/* STmin 转换为 tick（ms）：0xF1~0xF9 为百微秒级，tick 粒度下不再额外等待；保留值按 127ms 处理 */
+static uint32_t isotp_st_min_ms(uint8_t st_min)
+{
+    if (st_min <= ISOTP_ST_MIN_MAX_MS) {
+        return st_min;
+    }
+    if (st_min >= 0xF1U && st_min <= 0xF9U) {
+        return 0U;
+    }
+    return ISOTP_ST_MIN_MAX_MS;
+}
+
+boot_isotp_status_t boot_isotp_write(boot_isotp_t *ctx, const uint8_t *data, uint32_t len)
+{
+    uint8_t frame[BOOT_ISOTP_CANFD_DLEN];
+    uint32_t dlen;
+
+    if (ctx == NULL || data == NULL || len == 0U) {
+        return BOOT_ISOTP_ERROR;
+    }
+    dlen = ctx->cfg.frame_len;
+
+    if (len <= ISOTP_SF_MAX_LEN) {
+        frame[0] = (uint8_t)(ISOTP_PCI_SF | len);
+        memcpy(&frame[1], data, len);
+        return isotp_send_frame(ctx, frame, len + 1U);
+    }
+    if (dlen > BOOT_ISOTP_CAN_DLEN && len <= dlen - 2U) {
+        frame[0] = ISOTP_PCI_SF;
+        frame[1] = (uint8_t)len;
+        memcpy(&frame[2], data, len);
+        return isotp_send_frame(ctx, frame, len + 2U);
+    }
+
+    uint32_t offset;
+    if (len <= ISOTP_FF_MAX_LEN12) {
+        frame[0] = (uint8_t)(ISOTP_PCI_FF | (len >> 8));
+        frame[1] = (uint8_t)len;
+        offset = 2U;
+    } else {
+        frame[0] = ISOTP_PCI_FF;
+        frame[1] = 0U;
+        frame[2] = (uint8_t)(len >> 24);
+        frame[3] = (uint8_t)(len >> 16);
+        frame[4] = (uint8_t)(len >> 8);
+        frame[5] = (uint8_t)len;
+        offset = 6U;
+    }
+    uint32_t chunk = dlen - offset;
+    memcpy(&frame[offset], data, chunk);
+
+    ctx->tx_fc_valid = 0U;
+    boot_isotp_status_t status = isotp_send_frame(ctx, frame, dlen);
+    if (status != BOOT_ISOTP_OK) {
+        return status;
+    }
+    data += chunk;
+    len -= chunk;
+
+    uint8_t sn = 1U;
+    while (len > 0U) {
+        uint8_t bs;
+        uint8_t st_min;
+        status = isotp_wait_fc(ctx, &bs, &st_min);
+        if (status != BOOT_ISOTP_OK) {
+            return status;
+        }
+
+        uint32_t gap = isotp_st_min_ms(st_min);
+        uint32_t last_tick = 0U;
+        for (uint32_t sent = 0U; len > 0U && (bs == 0U || sent < bs); sent++) {
+            /* 按 tick 粒度向上取整，保证实际间隔不小于 STmin */
+            while (sent > 0U && gap > 0U &&
+                   (uint32_t)(ctx->ops->get_tick() - last_tick) <= gap) {
+            }
+
+            chunk = (len > dlen - 1U) ? (dlen - 1U) : len;
+            frame[0] = (uint8_t)(ISOTP_PCI_CF | sn);
+            memcpy(&frame[1], data, chunk);
+            status = isotp_send_frame(ctx, frame, chunk + 1U);
+            if (status != BOOT_ISOTP_OK) {
+                return status;
+            }
+            last_tick = ctx->ops->get_tick();
+            sn = (uint8_t)((sn + 1U) & 0x0FU);
+            data += chunk;
+            len -= chunk;
+        }
+    }
+    return BOOT_ISOTP_OK;
+}
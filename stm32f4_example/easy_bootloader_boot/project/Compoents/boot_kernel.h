@@ -0,0 +1,27 @@
+// 数据处理内核头文件：帧校验和、CRC32 与擦除值比较，按 BOOT_ARCH 与编译器特性选择快速实现，其余平台使用可移植的按字实现
+#ifndef BOOT_KERNEL_H
+#define BOOT_KERNEL_H
+
+#include "boot_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 协议帧的 16 位累加和：返回 sum 加上 data 各字节之和（模 65536）
+ * 可分段连续调用，首段 sum 传入 0 或参与校验的前导字节（如节点地址）
+ */
+uint16_t boot_sum16(uint16_t sum, const uint8_t *data, uint32_t len);
+
+/*
+ * CRC-32（IEEE 802.3，反射多项式 0xEDB88320，初值与结果异或 0xFFFFFFFF，与 zlib crc32 一致）
+ * 可分段连续调用：首段 crc 传入 0，之后传入上一段的返回值
+ */
+uint32_t boot_crc32(uint32_t crc, const uint8_t *data, uint32_t len);
+
+/*
+ * 判断 data 是否全部等于擦除值：第 i 字节与 erased 的第 (i % 4) 字节（小端）比较，
+ * 因此 data 须对应从字对齐 Flash 地址读出的内容，erased 传入 BOOT_FLAG_ERASED
+ */
+bool boot_is_erased(const uint8_t *data, uint32_t len, uint32_t erased);
+
+#endif // BOOT_KERNEL_H
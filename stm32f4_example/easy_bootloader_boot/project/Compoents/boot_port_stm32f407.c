@@ -1,39 +1,35 @@
 #include "boot_config.h"
 #include "easy_bootloader.h"
 #include "main.h"
-#include "ringbuffer.h"
+#include "myusart.h"
 #include <string.h>
+#if !BOOT_CONFIG_LOG_DEFERRED
 #include <stdarg.h>
 #include <stdio.h>
+#endif
+
+#if BOOT_CONFIG_LINK_SPI
+#include "boot_spi.h"
+
+#if BOOT_PACKET_MAX_SIZE > BOOT_SPI_PAYLOAD_MAX
+#error "BOOT_PACKET_MAX_SIZE exceeds BOOT_SPI_PAYLOAD_MAX"
+#endif
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+#error "BOOT_CONFIG_ENABLE_RX_DIRECT needs the USART2 DMA ring, disable it for the SPI link"
+#endif
+#endif
+
+#if BOOT_CONFIG_ENABLE_RX_DIRECT && BOOT_PACKET_MAX_SIZE > UART2_RX_BUFFER_SIZE
+#error "BOOT_PACKET_MAX_SIZE exceeds the USART2 DMA ring (UART2_RX_BUFFER_SIZE)"
+#endif
 
 /* 外部变量声明 */
 extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart2;
 extern DMA_HandleTypeDef hdma_usart2_rx;
-extern struct rt_ringbuffer uart2_ringbuffer_struct;
-
-/* STM32F407 Flash 扇区信息 */
-typedef struct {
-    uint32_t start_addr;
-    uint32_t size;
-    uint32_t sector_id;
-} flash_sector_t;
-
-static const flash_sector_t flash_sectors[] = {
-    {0x08000000, 0x4000,  FLASH_SECTOR_0},   // 16KB
-    {0x08004000, 0x4000,  FLASH_SECTOR_1},   // 16KB
-    {0x08008000, 0x4000,  FLASH_SECTOR_2},   // 16KB
-    {0x0800C000, 0x4000,  FLASH_SECTOR_3},   // 16KB
-    {0x08010000, 0x10000, FLASH_SECTOR_4},   // 64KB  - APP 起始
-    {0x08020000, 0x20000, FLASH_SECTOR_5},   // 128KB
-    {0x08040000, 0x20000, FLASH_SECTOR_6},   // 128KB
-    {0x08060000, 0x20000, FLASH_SECTOR_7},   // 128KB
-    {0x08080000, 0x20000, FLASH_SECTOR_8},   // 128KB
-    {0x080A0000, 0x20000, FLASH_SECTOR_9},   // 128KB
-    {0x080C0000, 0x20000, FLASH_SECTOR_10},  // 128KB
-    {0x080E0000, 0x20000, FLASH_SECTOR_11},  // 128KB - 标志区
-};
-#define FLASH_SECTOR_COUNT (sizeof(flash_sectors) / sizeof(flash_sectors[0]))
+
+/* STM32F407 Flash 扇区起始地址（boot_memmap.h 生成），扇区号即下标，末项为 Flash 结束地址 */
+static const uint32_t flash_sector_start[BOOT_FLASH_SECTOR_COUNT + 1U] = BOOT_FLASH_SECTOR_STARTS;
 
 
 uint32_t boot_port_get_tick(void)
@@ -41,16 +37,24 @@ uint32_t boot_port_get_tick(void)
     return HAL_GetTick();
 }
 
-/* 根据地址获取扇区索引 */
+/* 根据地址获取扇区索引：在扇区起始地址表中二分查找 */
 static int get_sector_index(uint32_t addr)
 {
-    for (int i = 0; i < FLASH_SECTOR_COUNT; i++) {
-        if (addr >= flash_sectors[i].start_addr &&
-            addr < flash_sectors[i].start_addr + flash_sectors[i].size) {
-            return i;
+    uint32_t lo = 0U;
+    uint32_t hi = BOOT_FLASH_SECTOR_COUNT;
+
+    if (addr < flash_sector_start[0] || addr >= flash_sector_start[BOOT_FLASH_SECTOR_COUNT]) {
+        return -1;
+    }
+    while (hi - lo > 1U) {      // flash_sector_start[lo] <= addr < flash_sector_start[hi]
+        uint32_t mid = (lo + hi) / 2U;
+        if (addr >= flash_sector_start[mid]) {
+            lo = mid;
+        } else {
+            hi = mid;
         }
     }
-    return -1;
+    return (int)lo;
 }
 
 boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
@@ -75,7 +79,7 @@ boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
     for (int i = start_sector; i <= end_sector; i++) {
         erase_init.TypeErase = FLASH_TYPEERASE_SECTORS;
         erase_init.VoltageRange = FLASH_VOLTAGE_RANGE_3;  // 2.7V - 3.6V
-        erase_init.Sector = flash_sectors[i].sector_id;
+        erase_init.Sector = (uint32_t)i;   // FLASH_SECTOR_n 即 n
         erase_init.NbSectors = 1;
 
         status = HAL_FLASHEx_Erase(&erase_init, &sector_error);
@@ -89,6 +93,16 @@ boot_port_status_t boot_port_flash_erase(uint32_t addr, uint32_t size)
     return BOOT_PORT_OK;
 }
 
+/* 返回 addr 所在扇区从 addr 到扇区末尾的长度，安装暂存固件时按扇区擦写 */
+uint32_t boot_port_flash_erase_unit(uint32_t addr)
+{
+    int i = get_sector_index(addr);
+    if (i < 0) {
+        return 0U;
+    }
+    return flash_sector_start[i + 1] - addr;
+}
+
 boot_port_status_t boot_port_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
 {
     HAL_StatusTypeDef status;
@@ -117,17 +131,222 @@ boot_port_status_t boot_port_flash_read(uint32_t addr, uint8_t *data, uint32_t l
     return BOOT_PORT_OK;
 }
 
+#if BOOT_CONFIG_DMA_READ
+/*
+ * Flash 异步读取：DMA2 Stream1 存储器到存储器传输（只有 DMA2 支持该模式），外设端口为源、存储器端口为目标，
+ * 地址与长度都按 4 字节对齐时按字传输，否则按字节；存储器到存储器模式下 FIFO 强制启用。
+ * 查询完成标志，不开中断；优先级最低，不影响串口接收 DMA。目标缓冲须在 SRAM 中：DMA 访问不到 CCM，
+ * 缓冲被链接到 CCM 时拒绝发起，核心改为同步读取。
+ * Stream0/3 留给 SPI 链路，Stream2 为 USART1 接收
+ */
+static bool flash_dma_pending;
+
+boot_port_status_t boot_port_flash_read_start(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t cr = DMA_SxCR_DIR_1 | DMA_SxCR_PINC | DMA_SxCR_MINC;
+    uint32_t count = len;
+
+    if (((addr | (uint32_t)data | len) & 3U) == 0U) {
+        cr |= DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1;
+        count = len / 4U;
+    }
+    if (flash_dma_pending || count == 0U || count > 0xFFFFU) {
+        return BOOT_PORT_ERROR;
+    }
+#if BOOT_HAS_CCM
+    if ((uint32_t)data < BOOT_CCM_END_ADDR && (uint32_t)data + len > BOOT_CCM_START_ADDR) {
+        return BOOT_PORT_ERROR;
+    }
+#endif
+
+    DMA2->LIFCR = DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1;
+    DMA2_Stream1->PAR = addr;
+    DMA2_Stream1->M0AR = (uint32_t)data;
+    DMA2_Stream1->NDTR = count;
+    DMA2_Stream1->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+    DMA2_Stream1->CR = cr;
+    DMA2_Stream1->CR = cr | DMA_SxCR_EN;
+    flash_dma_pending = true;
+    return BOOT_PORT_OK;
+}
+
+boot_port_status_t boot_port_flash_read_wait(void)
+{
+    uint32_t isr;
+
+    if (!flash_dma_pending) {
+        return BOOT_PORT_OK;
+    }
+    do {
+        isr = DMA2->LISR;
+    } while ((isr & (DMA_LISR_TCIF1 | DMA_LISR_TEIF1)) == 0U);
+    flash_dma_pending = false;
+    return ((isr & DMA_LISR_TEIF1) == 0U) ? BOOT_PORT_OK : BOOT_PORT_ERROR;    // 传输错误时硬件已关闭数据流
+}
+#endif
+
+#if BOOT_CONFIG_LINK_SPI
+/*
+ * SPI1 从机：PA4 NSS / PA5 SCK / PA6 MISO / PA7 MOSI（AF5），就绪线 PB0 推挽输出
+ * DMA2 Stream0 通道 3 接收、Stream3 通道 3 发送；NSS 双边沿触发 EXTI4，下降沿拉低就绪线，上升沿结束事务
+ * 示例工程未启用 HAL SPI 驱动，这里直接操作寄存器
+ */
+#define SPI_LINK_NSS_PIN      4U
+#define SPI_LINK_READY_PIN    0U
+
+static boot_spi_t boot_port_spi;
+
+static void spi_link_stop(void)
+{
+    DMA2_Stream0->CR &= ~DMA_SxCR_EN;
+    DMA2_Stream3->CR &= ~DMA_SxCR_EN;
+    while ((DMA2_Stream0->CR & DMA_SxCR_EN) != 0U || (DMA2_Stream3->CR & DMA_SxCR_EN) != 0U) {
+    }
+    /* 复位 SPI1，丢弃上一次事务留在发送数据寄存器中的字节 */
+    RCC->APB2RSTR |= RCC_APB2RSTR_SPI1RST;
+    RCC->APB2RSTR &= ~RCC_APB2RSTR_SPI1RST;
+}
+
+static void spi_link_arm(uint8_t *rx, uint32_t rx_len, const uint8_t *tx, uint32_t tx_len)
+{
+    spi_link_stop();
+    DMA2->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0 |
+                  DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+
+    DMA2_Stream0->PAR = (uint32_t)&SPI1->DR;
+    DMA2_Stream0->M0AR = (uint32_t)rx;
+    DMA2_Stream0->NDTR = rx_len;
+    DMA2_Stream0->CR = (3U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_MINC;                   // 外设到存储器
+    DMA2_Stream3->PAR = (uint32_t)&SPI1->DR;
+    DMA2_Stream3->M0AR = (uint32_t)tx;
+    DMA2_Stream3->NDTR = tx_len;
+    DMA2_Stream3->CR = (3U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0;  // 存储器到外设
+
+    /* 从机、模式 0、8 位、MSB 先发、硬件 NSS；按参考手册顺序：RXDMAEN -> 使能数据流 -> TXDMAEN -> SPE */
+    SPI1->CR1 = 0U;
+    SPI1->CR2 = SPI_CR2_RXDMAEN;
+    DMA2_Stream0->CR |= DMA_SxCR_EN;
+    DMA2_Stream3->CR |= DMA_SxCR_EN;
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+    SPI1->CR1 |= SPI_CR1_SPE;
+}
+
+static void spi_link_set_ready(uint8_t ready)
+{
+    GPIOB->BSRR = ready ? (1U << SPI_LINK_READY_PIN) : (1U << (SPI_LINK_READY_PIN + 16U));
+}
+
+static const boot_spi_ops_t boot_port_spi_ops = {
+    .arm = spi_link_arm,
+    .set_ready = spi_link_set_ready,
+};
+
+static void spi_link_init(void)
+{
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOBEN | RCC_AHB1ENR_DMA2EN;
+    RCC->APB2ENR |= RCC_APB2ENR_SPI1EN | RCC_APB2ENR_SYSCFGEN;
+    (void)RCC->APB2ENR;
+
+    GPIOA->MODER = (GPIOA->MODER & ~0x0000FF00U) | 0x0000AA00U;     // PA4~PA7 复用功能
+    GPIOA->OSPEEDR |= 0x0000FF00U;
+    GPIOA->PUPDR = (GPIOA->PUPDR & ~0x00000300U) | 0x00000100U;     // NSS 上拉，主机未接时不误触发
+    GPIOA->AFR[0] = (GPIOA->AFR[0] & 0x0000FFFFU) | 0x55550000U;     // AF5 = SPI1
+    GPIOB->BSRR = 1U << (SPI_LINK_READY_PIN + 16U);
+    GPIOB->MODER = (GPIOB->MODER & ~(3U << (SPI_LINK_READY_PIN * 2U))) | (1U << (SPI_LINK_READY_PIN * 2U));
+
+    SYSCFG->EXTICR[1] &= ~SYSCFG_EXTICR2_EXTI4;                     // EXTI4 连到 PA4
+    EXTI->RTSR |= 1U << SPI_LINK_NSS_PIN;
+    EXTI->FTSR |= 1U << SPI_LINK_NSS_PIN;
+    EXTI->PR = 1U << SPI_LINK_NSS_PIN;
+    EXTI->IMR |= 1U << SPI_LINK_NSS_PIN;
+    HAL_NVIC_SetPriority(EXTI4_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(EXTI4_IRQn);
+
+    (void)boot_spi_init(&boot_port_spi, &boot_port_spi_ops);
+}
+
+void EXTI4_IRQHandler(void)
+{
+    EXTI->PR = 1U << SPI_LINK_NSS_PIN;
+    if ((GPIOA->IDR & (1U << SPI_LINK_NSS_PIN)) == 0U) {
+        spi_link_set_ready(0U);     // 事务开始，主机看到就绪线变低后才会等待下一次就绪
+    } else {
+        boot_spi_xfer_done(&boot_port_spi, BOOT_SPI_RX_SIZE - DMA2_Stream0->NDTR);
+        scheduler_post(TASK_BOOTLOADER);
+    }
+}
+
+boot_port_status_t boot_port_data_write(const uint8_t *data, uint32_t len)
+{
+    return (boot_spi_write(&boot_port_spi, data, len) == BOOT_SPI_OK) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+}
+
+uint32_t boot_port_data_read(uint8_t *buf, uint32_t max_len)
+{
+    return boot_spi_read(&boot_port_spi, buf, max_len);
+}
+
+/* 零拷贝：协议帧直接在 SPI 接收缓冲中校验写入，归还后若两个缓冲曾经都满则重新启动 DMA */
+uint32_t boot_port_data_peek(const uint8_t **data)
+{
+    return boot_spi_peek(&boot_port_spi, data);
+}
+
+void boot_port_data_release(void)
+{
+    boot_spi_release(&boot_port_spi);
+}
+#else
 boot_port_status_t boot_port_data_write(const uint8_t *data, uint32_t len)
 {
     HAL_StatusTypeDef status = HAL_UART_Transmit(&huart2, (uint8_t *)data, len, 1000);
     return (status == HAL_OK) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
 }
 
+/* 直接从循环 DMA 接收环中取数据，接收不停 DMA，不经过中间环形缓存区 */
 uint32_t boot_port_data_read(uint8_t *buf, uint32_t max_len)
 {
-    return rt_ringbuffer_get(&uart2_ringbuffer_struct, buf, max_len);
+    return uart_dma_ring_read(&uart2_rx_ring, buf, (max_len > 0xFFFFU) ? 0xFFFFU : (uint16_t)max_len);
+}
+
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+/* 接收环直通：核心直接在 uart2_rx_dmabuffer 中校验数据帧并写 Flash */
+uint32_t boot_port_rx_peek(uint32_t offset, const uint8_t **data)
+{
+    return (offset >= UART2_RX_BUFFER_SIZE) ? 0U : uart_dma_ring_peek(&uart2_rx_ring, (uint16_t)offset, data);
+}
+
+boot_port_status_t boot_port_rx_consume(uint32_t len)
+{
+    return (uart_dma_ring_consume(&uart2_rx_ring, (uint16_t)len) == 0U) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+}
+#endif
+#endif
+
+#if BOOT_CONFIG_LOG_DEFERRED
+/* 延迟日志经 USART1 中断发送：拷入发送缓冲后立即返回，上一段还没发完时返回 0 */
+static uint8_t boot_port_log_tx[64];
+
+uint32_t boot_port_log_write(const uint8_t *data, uint32_t len)
+{
+    if (huart1.gState != HAL_UART_STATE_READY) {
+        return 0U;
+    }
+    if (len > sizeof(boot_port_log_tx)) {
+        len = sizeof(boot_port_log_tx);
+    }
+    memcpy(boot_port_log_tx, data, len);
+    return (HAL_UART_Transmit_IT(&huart1, boot_port_log_tx, (uint16_t)len) == HAL_OK) ? len : 0U;
 }
 
+/* 关中断前等最后一段日志发完 */
+static void boot_port_log_wait(void)
+{
+    uint32_t start = HAL_GetTick();
+    while (huart1.gState == HAL_UART_STATE_BUSY_TX && (HAL_GetTick() - start) < 10U) {
+    }
+}
+#else
 void boot_port_log(const char *fmt, ...)
 {
     char buffer[256];
@@ -144,6 +363,7 @@ void boot_port_log(const char *fmt, ...)
         HAL_UART_Transmit(&huart1, (uint8_t *)buffer, tx_len, 100);
     }
 }
+#endif
 
 void boot_port_jump_to_app(uint32_t app_addr)
 {
@@ -153,6 +373,10 @@ void boot_port_jump_to_app(uint32_t app_addr)
     uint32_t app_stack = *(volatile uint32_t *)app_addr;
     uint32_t app_reset = *(volatile uint32_t *)(app_addr + 4);
 
+#if BOOT_CONFIG_LOG_DEFERRED
+    boot_port_log_wait();
+#endif
+
     /* 1. 关闭全局中断 */
     __disable_irq();
 
@@ -161,11 +385,19 @@ void boot_port_jump_to_app(uint32_t app_addr)
     SysTick->LOAD = 0;
     SysTick->VAL = 0;
 
-    /* 3. 复位外设 - 停止 DMA 和 UART */
-    HAL_UART_DMAStop(&huart1);
-    HAL_UART_DMAStop(&huart2);
-    HAL_UART_DeInit(&huart1);
-    HAL_UART_DeInit(&huart2);
+    /* 3. 复位外设 - 停止 DMA 和 UART（快速跳转路径下串口尚未初始化） */
+    if (huart1.Instance != NULL) {
+        HAL_UART_DMAStop(&huart1);
+        HAL_UART_DeInit(&huart1);
+    }
+    if (huart2.Instance != NULL) {
+        HAL_UART_DMAStop(&huart2);
+        HAL_UART_DeInit(&huart2);
+    }
+#if BOOT_CONFIG_LINK_SPI
+    EXTI->IMR &= ~(1U << SPI_LINK_NSS_PIN);
+    spi_link_stop();                // DMA 仍在等待主机时钟，跳转前必须停下，否则会改写 APP 的 RAM
+#endif
 
     /* 4. 清除所有中断挂起标志 */
     for (int i = 0; i < 8; i++) {
@@ -196,6 +428,9 @@ void boot_port_jump_to_app(uint32_t app_addr)
 
 void boot_port_system_reset(void)
 {
+#if BOOT_CONFIG_LOG_DEFERRED
+    boot_port_log_wait();
+#endif
     NVIC_SystemReset(); // 调用系统复位函数
 }
 
@@ -206,13 +441,44 @@ boot_ops_t boot_port_ops = {
     .boot_port_flash_read = boot_port_flash_read,
     .boot_port_data_write = boot_port_data_write,
     .boot_port_data_read = boot_port_data_read,
+#if BOOT_CONFIG_LOG_DEFERRED
+    .boot_port_log_write = boot_port_log_write,
+#else
     .boot_port_log = boot_port_log,
+#endif
     .boot_port_jump_to_app = boot_port_jump_to_app,
     .boot_port_system_reset = boot_port_system_reset,
+    .boot_port_flash_erase_unit = boot_port_flash_erase_unit,
+#if BOOT_CONFIG_DMA_READ
+    .boot_port_flash_read_start = boot_port_flash_read_start,
+    .boot_port_flash_read_wait = boot_port_flash_read_wait,
+#endif
+#if BOOT_CONFIG_LINK_SPI
+    .link_mtu = BOOT_SPI_REPLY_MAX,
+    .link_window = BOOT_SPI_LINK_WINDOW,
+    .boot_port_data_peek = boot_port_data_peek,
+    .boot_port_data_release = boot_port_data_release,
+#elif BOOT_CONFIG_ENABLE_RX_DIRECT
+    .boot_port_rx_peek = boot_port_rx_peek,
+    .boot_port_rx_consume = boot_port_rx_consume,
+#endif
 };
 
+//在 main 最开始调用：启动打点并尝试快速跳转，未跳转时返回继续正常初始化
+void bootloader_fast_boot(void)
+{
+    easy_bootloader_profile_start();
+    (void)easy_bootloader_fast_boot(&boot_port_ops);
+}
+
 void bootloader_app_init(void)
 {
+#if BOOT_CONFIG_DMA_READ
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+#endif
+#if BOOT_CONFIG_LINK_SPI
+    spi_link_init();
+#endif
     easy_bootloader_init(&boot_port_ops);   //启动bootloader，传入ops操作集
 }
 
@@ -0,0 +1,49 @@
+// 单生产者 / 单消费者无锁环形缓冲区：中断（或 DMA）写、主循环读，连续区域直接读写，不经过中间拷贝
+#ifndef BOOT_RING_H
+#define BOOT_RING_H
+
+#include <stdint.h>
+
+/*
+ * head / tail 为自由递增的 32 位计数，只取低位定位（容量须为 2 的幂，最大 2^31 字节）；
+ * head 只由生产者修改，tail 只由消费者修改，两侧各自用获取/释放语义读对方的计数，不需要关中断
+ *
+ * 零拷贝用法：
+ *   生产者  n = boot_ring_acquire_write(r, &p); 向 p 写入 k <= n 字节; boot_ring_commit_write(r, k);
+ *   消费者  n = boot_ring_acquire_read(r, &p);  就地处理 p 中 k <= n 字节; boot_ring_commit_read(r, k);
+ * acquire 返回的是到缓冲区末尾为止的连续区域，回绕后的部分在下一次 acquire 中取得；
+ * 需要在提交前同时看到回绕两侧（如跨环末尾的整帧）时用 boot_ring_peek 按偏移取第二段
+ */
+typedef struct {
+    uint8_t *buf;
+    uint32_t mask;                  // 容量 - 1
+    volatile uint32_t head;         // 已写入的总字节数，只由生产者修改
+    volatile uint32_t tail;         // 已读出的总字节数，只由消费者修改
+} boot_ring_t;
+
+typedef enum {
+    BOOT_RING_OK = 0,
+    BOOT_RING_ERROR,                // 参数错误或容量不是 2 的幂
+} boot_ring_status_t;
+
+boot_ring_status_t boot_ring_init(boot_ring_t *ring, uint8_t *buf, uint32_t size);
+
+/* 两侧都可调用，结果是调用时刻的快照 */
+uint32_t boot_ring_data_len(const boot_ring_t *ring);
+uint32_t boot_ring_space_len(const boot_ring_t *ring);
+
+/* 消费者：取最早未读数据的连续区域，处理完提交实际消费的字节数 */
+uint32_t boot_ring_acquire_read(boot_ring_t *ring, const uint8_t **data);
+void boot_ring_commit_read(boot_ring_t *ring, uint32_t len);
+/* 消费者：取未读数据中 offset 处起的连续区域，不移动读位置；offset 为 0 时与 acquire_read 相同 */
+uint32_t boot_ring_peek(boot_ring_t *ring, uint32_t offset, const uint8_t **data);
+
+/* 生产者：取可写的连续区域，写完提交实际写入的字节数 */
+uint32_t boot_ring_acquire_write(boot_ring_t *ring, uint8_t **data);
+void boot_ring_commit_write(boot_ring_t *ring, uint32_t len);
+
+/* 拷贝接口：基于上面的连续区域接口，返回实际读出 / 写入的字节数 */
+uint32_t boot_ring_read(boot_ring_t *ring, uint8_t *buf, uint32_t max_len);
+uint32_t boot_ring_write(boot_ring_t *ring, const uint8_t *data, uint32_t len);
+
+#endif // BOOT_RING_H
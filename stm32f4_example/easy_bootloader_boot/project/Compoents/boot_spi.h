@@ -0,0 +1,87 @@
+// SPI 从机传输层头文件：主机按事务全双工收发，DMA 直接收发双缓冲，就绪线做流控
+#ifndef BOOT_SPI_H
+#define BOOT_SPI_H
+
+#include <stdint.h>
+
+/*
+ * 事务格式（主机每次拉低片选发起一次事务，拉高片选结束）：
+ *   MOSI: A5 00 [len 2B] [len 字节协议帧] [填充]      len = 0 为空事务，只用来取回应答
+ *   MISO: 5A [status] [len 2B] [len 字节应答] [填充]
+ * 从机在启动 DMA 时就确定了 MISO 内容，所以应答总是随后续事务返回；
+ * 主机每次事务至少时钟 BOOT_SPI_HEADER_SIZE + BOOT_SPI_REPLY_MAX 字节，且只在就绪线为高时发起
+ */
+#define BOOT_SPI_HEADER_SIZE          4U
+#define BOOT_SPI_MOSI_MAGIC           0xA5U
+#define BOOT_SPI_MISO_MAGIC           0x5AU
+
+#ifndef BOOT_SPI_PAYLOAD_MAX
+#define BOOT_SPI_PAYLOAD_MAX          1024U   // 单个事务承载的最大协议帧，不小于 BOOT_PACKET_MAX_SIZE
+#endif
+#ifndef BOOT_SPI_REPLY_MAX
+#define BOOT_SPI_REPLY_MAX            64U     // 单个事务携带的最大应答字节数，超出的应答留到下一次事务
+#endif
+#define BOOT_SPI_RX_SIZE              (BOOT_SPI_HEADER_SIZE + BOOT_SPI_PAYLOAD_MAX)
+#define BOOT_SPI_TX_SIZE              (BOOT_SPI_HEADER_SIZE + BOOT_SPI_REPLY_MAX)
+
+/* MISO status 位 */
+#define BOOT_SPI_STATUS_OVERRUN       0x01U   // 有事务在就绪线为低时发起，其中的协议帧已丢弃
+#define BOOT_SPI_STATUS_REPLY_LOST    0x02U   // 应答缓冲已满，有应答被丢弃
+
+typedef enum {
+    BOOT_SPI_OK = 0,
+    BOOT_SPI_ERROR,             // 参数错误
+    BOOT_SPI_FULL,              // 应答缓冲已满
+} boot_spi_status_t;
+
+/* SPI 从机接口，由移植层基于 DMA 实现 */
+typedef struct {
+    /* 启动一次从机 DMA 事务：接收到 rx（最多 rx_len 字节），同时发送 tx 的 tx_len 字节，之后的时钟发送任意填充 */
+    void (*arm)(uint8_t *rx, uint32_t rx_len, const uint8_t *tx, uint32_t tx_len);
+    /* 驱动就绪线：1 表示 DMA 已启动，主机可以发起下一次事务；
+     * 移植层还须在片选拉低（事务开始）时立即拉低就绪线，主机据此判断从机已接手本次事务 */
+    void (*set_ready)(uint8_t ready);
+} boot_spi_ops_t;
+
+typedef struct {
+    const boot_spi_ops_t *ops;
+
+    /* 接收双缓冲：一个由 DMA 接收时另一个可交给核心处理，Flash 写入与下一帧的传输重叠 */
+    uint8_t rx[2][BOOT_SPI_RX_SIZE];
+    volatile uint16_t rx_len[2];        // 已收到待处理的协议帧长度，0 表示空闲
+    uint8_t rx_head;                    // 最早收到、下一个交给核心的缓冲
+    uint32_t rx_offset;
+
+    /* 发送双缓冲：一个由 DMA 发送时另一个追加应答 */
+    uint8_t tx[2][BOOT_SPI_TX_SIZE];
+    volatile uint16_t tx_len[2];
+    volatile uint8_t tx_fill;           // 正在追加应答的缓冲
+    volatile uint8_t tx_writing;        // 正在追加时中断里不交换发送缓冲
+
+    volatile uint8_t armed;             // 当前启动 DMA 的接收缓冲，BOOT_SPI_IDLE 表示未启动
+    volatile uint8_t next;              // 下一次启动 DMA 使用的接收缓冲
+    volatile uint8_t status;            // 下一次事务上报的状态位
+} boot_spi_t;
+
+#define BOOT_SPI_IDLE                 0xFFU
+
+/* 初始化并启动第一次事务 */
+boot_spi_status_t boot_spi_init(boot_spi_t *ctx, const boot_spi_ops_t *ops);
+
+/*
+ * 一次事务结束（片选拉高）时由移植层在中断中调用，clocked 为本次事务实际收到的字节数；
+ * 有空闲接收缓冲时立即启动下一次事务，否则保持就绪线为低直到核心归还缓冲
+ */
+void boot_spi_xfer_done(boot_spi_t *ctx, uint32_t clocked);
+
+/* 零拷贝读取：返回最早收到的协议帧在接收缓冲中的地址与剩余长度，无数据返回 0；处理完调用 boot_spi_release */
+uint32_t boot_spi_peek(boot_spi_t *ctx, const uint8_t **data);
+void boot_spi_release(boot_spi_t *ctx);
+
+/* 拷贝读取：从当前协议帧中读出最多 max_len 字节，读完自动归还缓冲 */
+uint32_t boot_spi_read(boot_spi_t *ctx, uint8_t *buf, uint32_t max_len);
+
+/* 追加应答，随之后启动的事务发给主机 */
+boot_spi_status_t boot_spi_write(boot_spi_t *ctx, const uint8_t *data, uint32_t len);
+
+#endif // BOOT_SPI_H
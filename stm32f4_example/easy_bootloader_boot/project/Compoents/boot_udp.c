@@ -0,0 +1,343 @@
+// 最小 UDP/IPv4 协议栈：只应答 ARP 与 ICMP 回显，只收发一个 UDP 端口，不处理 IP 分片
+#include "boot_udp.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define ETH_HDR_SIZE                  14U
+#define ETH_MIN_FRAME                 60U
+#define ETH_TYPE_IPV4                 0x0800U
+#define ETH_TYPE_ARP                  0x0806U
+
+#define ARP_PACKET_SIZE               28U
+#define ARP_OP_REQUEST                1U
+#define ARP_OP_REPLY                  2U
+
+#define IP_HDR_SIZE                   20U
+#define IP_PROTO_ICMP                 1U
+#define IP_PROTO_UDP                  17U
+#define IP_DEFAULT_TTL                64U
+#define IP_MTU                        1500U
+
+#define UDP_HDR_SIZE                  8U
+#define ICMP_ECHO_REQUEST             8U
+#define ICMP_ECHO_REPLY               0U
+
+static uint16_t udp_get16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void udp_put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+/* 反码和累加（大端 16 位），最终由 udp_fold 折叠取反 */
+static uint32_t udp_sum(uint32_t sum, const uint8_t *data, uint32_t len)
+{
+    while (len > 1U) {
+        sum += ((uint32_t)data[0] << 8) | data[1];
+        data += 2;
+        len -= 2U;
+    }
+    if (len > 0U) {
+        sum += (uint32_t)data[0] << 8;
+    }
+    return sum;
+}
+
+static uint16_t udp_fold(uint32_t sum)
+{
+    while ((sum >> 16) != 0U) {
+        sum = (sum & 0xFFFFU) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+static uint8_t *udp_tx_acquire(boot_udp_t *ctx)
+{
+    uint32_t start = ctx->ops->get_tick();
+    uint8_t *frame;
+
+    while ((frame = ctx->ops->eth_tx_acquire()) == NULL) {
+        if ((uint32_t)(ctx->ops->get_tick() - start) >= BOOT_UDP_TX_TIMEOUT_MS) {
+            return NULL;
+        }
+    }
+    return frame;
+}
+
+static void udp_tx_submit(boot_udp_t *ctx, uint8_t *frame, uint32_t len)
+{
+    if (len < ETH_MIN_FRAME) {
+        memset(&frame[len], 0, ETH_MIN_FRAME - len);
+        len = ETH_MIN_FRAME;
+    }
+    ctx->ops->eth_tx_submit(len);
+}
+
+static void udp_build_eth(const boot_udp_t *ctx, uint8_t *frame, const uint8_t *dst_mac, uint16_t type)
+{
+    memcpy(&frame[0], dst_mac, BOOT_UDP_MAC_SIZE);
+    memcpy(&frame[6], ctx->cfg.mac, BOOT_UDP_MAC_SIZE);
+    udp_put16(&frame[12], type);
+}
+
+static void udp_build_ip(boot_udp_t *ctx, uint8_t *frame, const uint8_t *dst_ip, uint8_t proto, uint32_t payload_len)
+{
+    uint8_t *ip = &frame[ETH_HDR_SIZE];
+
+    ip[0] = 0x45U;
+    ip[1] = 0U;
+    udp_put16(&ip[2], (uint16_t)(IP_HDR_SIZE + payload_len));
+    udp_put16(&ip[4], ctx->ip_id++);
+    udp_put16(&ip[6], 0x4000U);         // DF
+    ip[8] = IP_DEFAULT_TTL;
+    ip[9] = proto;
+    udp_put16(&ip[10], 0U);
+    memcpy(&ip[12], ctx->cfg.ip, BOOT_UDP_IP_SIZE);
+    memcpy(&ip[16], dst_ip, BOOT_UDP_IP_SIZE);
+    udp_put16(&ip[10], udp_fold(udp_sum(0U, ip, IP_HDR_SIZE)));
+}
+
+static void udp_send_arp(boot_udp_t *ctx, uint16_t op, const uint8_t *dst_mac, const uint8_t *target_mac,
+                         const uint8_t *target_ip)
+{
+    uint8_t *frame = udp_tx_acquire(ctx);
+    if (frame == NULL) {
+        return;
+    }
+
+    udp_build_eth(ctx, frame, dst_mac, ETH_TYPE_ARP);
+    uint8_t *arp = &frame[ETH_HDR_SIZE];
+    udp_put16(&arp[0], 1U);             // 以太网
+    udp_put16(&arp[2], ETH_TYPE_IPV4);
+    arp[4] = BOOT_UDP_MAC_SIZE;
+    arp[5] = BOOT_UDP_IP_SIZE;
+    udp_put16(&arp[6], op);
+    memcpy(&arp[8], ctx->cfg.mac, BOOT_UDP_MAC_SIZE);
+    memcpy(&arp[14], ctx->cfg.ip, BOOT_UDP_IP_SIZE);
+    memcpy(&arp[18], target_mac, BOOT_UDP_MAC_SIZE);
+    memcpy(&arp[24], target_ip, BOOT_UDP_IP_SIZE);
+    udp_tx_submit(ctx, frame, ETH_HDR_SIZE + ARP_PACKET_SIZE);
+}
+
+static void udp_handle_arp(boot_udp_t *ctx, const uint8_t *frame, uint32_t len)
+{
+    const uint8_t *arp = &frame[ETH_HDR_SIZE];
+
+    if (len < ETH_HDR_SIZE + ARP_PACKET_SIZE ||
+        udp_get16(&arp[0]) != 1U || udp_get16(&arp[2]) != ETH_TYPE_IPV4 ||
+        arp[4] != BOOT_UDP_MAC_SIZE || arp[5] != BOOT_UDP_IP_SIZE ||
+        udp_get16(&arp[6]) != ARP_OP_REQUEST ||
+        memcmp(&arp[24], ctx->cfg.ip, BOOT_UDP_IP_SIZE) != 0) {
+        return;
+    }
+
+    /* 请求帧还在接收缓冲区中，先取出请求方地址再发应答 */
+    uint8_t sender_mac[BOOT_UDP_MAC_SIZE];
+    uint8_t sender_ip[BOOT_UDP_IP_SIZE];
+    memcpy(sender_mac, &arp[8], BOOT_UDP_MAC_SIZE);
+    memcpy(sender_ip, &arp[14], BOOT_UDP_IP_SIZE);
+    udp_send_arp(ctx, ARP_OP_REPLY, sender_mac, sender_mac, sender_ip);
+}
+
+static void udp_handle_icmp(boot_udp_t *ctx, const uint8_t *frame, uint32_t ihl, uint32_t total)
+{
+    const uint8_t *ip = &frame[ETH_HDR_SIZE];
+    const uint8_t *icmp = &ip[ihl];
+    uint32_t icmp_len = total - ihl;
+
+    if (icmp_len < 8U || icmp[0] != ICMP_ECHO_REQUEST || udp_fold(udp_sum(0U, icmp, icmp_len)) != 0U) {
+        return;
+    }
+
+    uint8_t *reply = udp_tx_acquire(ctx);
+    if (reply == NULL) {
+        return;
+    }
+    udp_build_eth(ctx, reply, &frame[6], ETH_TYPE_IPV4);
+    udp_build_ip(ctx, reply, &ip[12], IP_PROTO_ICMP, icmp_len);
+
+    uint8_t *out = &reply[ETH_HDR_SIZE + IP_HDR_SIZE];
+    memcpy(out, icmp, icmp_len);
+    out[0] = ICMP_ECHO_REPLY;
+    udp_put16(&out[2], 0U);
+    udp_put16(&out[2], udp_fold(udp_sum(0U, out, icmp_len)));
+    udp_tx_submit(ctx, reply, ETH_HDR_SIZE + IP_HDR_SIZE + icmp_len);
+}
+
+/* 是发往本端口的非空 UDP 报文时记录载荷位置并返回 1，其余返回 0 由调用方归还 */
+static int udp_handle_ipv4(boot_udp_t *ctx, const uint8_t *frame, uint32_t len)
+{
+    const uint8_t *ip = &frame[ETH_HDR_SIZE];
+
+    if (len < ETH_HDR_SIZE + IP_HDR_SIZE || (ip[0] >> 4) != 4U) {
+        return 0;
+    }
+    uint32_t ihl = (uint32_t)(ip[0] & 0x0FU) * 4U;
+    uint32_t total = udp_get16(&ip[2]);
+    if (ihl < IP_HDR_SIZE || total < ihl || ETH_HDR_SIZE + total > len ||
+        udp_fold(udp_sum(0U, ip, ihl)) != 0U ||
+        (udp_get16(&ip[6]) & 0x3FFFU) != 0U) {
+        return 0;
+    }
+
+    static const uint8_t broadcast_ip[BOOT_UDP_IP_SIZE] = {0xFFU, 0xFFU, 0xFFU, 0xFFU};
+    int to_us = (memcmp(&ip[16], ctx->cfg.ip, BOOT_UDP_IP_SIZE) == 0);
+    if (!to_us && memcmp(&ip[16], broadcast_ip, BOOT_UDP_IP_SIZE) != 0) {
+        return 0;
+    }
+    if (ip[9] == IP_PROTO_ICMP) {
+        if (to_us && total <= IP_MTU) {
+            udp_handle_icmp(ctx, frame, ihl, total);
+        }
+        return 0;
+    }
+    if (ip[9] != IP_PROTO_UDP) {
+        return 0;
+    }
+
+    const uint8_t *udp = &ip[ihl];
+    uint32_t udp_len = total - ihl;
+    if (udp_len < UDP_HDR_SIZE || udp_get16(&udp[4]) < UDP_HDR_SIZE || udp_get16(&udp[4]) > udp_len ||
+        udp_get16(&udp[2]) != ctx->cfg.port) {
+        return 0;
+    }
+    udp_len = udp_get16(&udp[4]);
+    if (udp_get16(&udp[6]) != 0U) {
+        uint32_t sum = udp_sum(0U, &ip[12], 2U * BOOT_UDP_IP_SIZE) + IP_PROTO_UDP + udp_len;
+        if (udp_fold(udp_sum(sum, udp, udp_len)) != 0U) {
+            return 0;
+        }
+    }
+    if (udp_len == UDP_HDR_SIZE) {
+        return 0;
+    }
+
+    memcpy(ctx->peer_mac, &frame[6], BOOT_UDP_MAC_SIZE);
+    memcpy(ctx->peer_ip, &ip[12], BOOT_UDP_IP_SIZE);
+    ctx->peer_port = udp_get16(&udp[0]);
+    ctx->peer_valid = 1U;
+
+    ctx->rx_payload = &udp[UDP_HDR_SIZE];
+    ctx->rx_len = udp_len - UDP_HDR_SIZE;
+    ctx->rx_offset = 0U;
+    return 1;
+}
+
+boot_udp_status_t boot_udp_init(boot_udp_t *ctx, const boot_udp_ops_t *ops, const boot_udp_config_t *cfg)
+{
+    static const uint8_t zero_ip[BOOT_UDP_IP_SIZE] = {0U, 0U, 0U, 0U};
+
+    if (ctx == NULL || ops == NULL || cfg == NULL ||
+        ops->eth_rx_peek == NULL || ops->eth_rx_release == NULL ||
+        ops->eth_tx_acquire == NULL || ops->eth_tx_submit == NULL || ops->get_tick == NULL) {
+        return BOOT_UDP_ERROR;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->ops = ops;
+    ctx->cfg = *cfg;
+
+    /* RFC 3927 链路本地地址 169.254.1.0 ~ 169.254.254.255，由 MAC 低两字节派生，不做冲突探测 */
+    if (memcmp(ctx->cfg.ip, zero_ip, BOOT_UDP_IP_SIZE) == 0) {
+        ctx->cfg.ip[0] = 169U;
+        ctx->cfg.ip[1] = 254U;
+        ctx->cfg.ip[2] = (uint8_t)(1U + cfg->mac[4] % 254U);
+        ctx->cfg.ip[3] = cfg->mac[5];
+    }
+    return BOOT_UDP_OK;
+}
+
+void boot_udp_announce(boot_udp_t *ctx)
+{
+    static const uint8_t broadcast_mac[BOOT_UDP_MAC_SIZE] = {0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU};
+    static const uint8_t zero_mac[BOOT_UDP_MAC_SIZE] = {0U, 0U, 0U, 0U, 0U, 0U};
+
+    udp_send_arp(ctx, ARP_OP_REQUEST, broadcast_mac, zero_mac, ctx->cfg.ip);
+}
+
+uint32_t boot_udp_peek(boot_udp_t *ctx, const uint8_t **payload)
+{
+    while (ctx->rx_payload == NULL) {
+        const uint8_t *frame;
+        uint32_t len = ctx->ops->eth_rx_peek(&frame);
+        if (len == 0U) {
+            return 0U;
+        }
+
+        if (len >= ETH_HDR_SIZE) {
+            uint16_t type = udp_get16(&frame[12]);
+            if (type == ETH_TYPE_ARP) {
+                udp_handle_arp(ctx, frame, len);
+            } else if (type == ETH_TYPE_IPV4 && udp_handle_ipv4(ctx, frame, len)) {
+                break;
+            }
+        }
+        ctx->ops->eth_rx_release();
+    }
+
+    *payload = &ctx->rx_payload[ctx->rx_offset];
+    return ctx->rx_len - ctx->rx_offset;
+}
+
+void boot_udp_release(boot_udp_t *ctx)
+{
+    if (ctx->rx_payload != NULL) {
+        ctx->rx_payload = NULL;
+        ctx->ops->eth_rx_release();
+    }
+}
+
+uint32_t boot_udp_read(boot_udp_t *ctx, uint8_t *buf, uint32_t max_len)
+{
+    const uint8_t *payload;
+
+    if (ctx == NULL || buf == NULL || max_len == 0U) {
+        return 0U;
+    }
+
+    uint32_t len = boot_udp_peek(ctx, &payload);
+    if (len > max_len) {
+        len = max_len;
+    }
+    memcpy(buf, payload, len);
+    ctx->rx_offset += len;
+    if (ctx->rx_payload != NULL && ctx->rx_offset >= ctx->rx_len) {
+        boot_udp_release(ctx);
+    }
+    return len;
+}
+
+boot_udp_status_t boot_udp_write(boot_udp_t *ctx, const uint8_t *data, uint32_t len)
+{
+    if (ctx == NULL || data == NULL || len == 0U || len > BOOT_UDP_PAYLOAD_MAX || !ctx->peer_valid) {
+        return BOOT_UDP_ERROR;
+    }
+
+    uint8_t *frame = udp_tx_acquire(ctx);
+    if (frame == NULL) {
+        return BOOT_UDP_TIMEOUT;
+    }
+
+    uint32_t udp_len = UDP_HDR_SIZE + len;
+    udp_build_eth(ctx, frame, ctx->peer_mac, ETH_TYPE_IPV4);
+    udp_build_ip(ctx, frame, ctx->peer_ip, IP_PROTO_UDP, udp_len);
+
+    uint8_t *udp = &frame[ETH_HDR_SIZE + IP_HDR_SIZE];
+    udp_put16(&udp[0], ctx->cfg.port);
+    udp_put16(&udp[2], ctx->peer_port);
+    udp_put16(&udp[4], (uint16_t)udp_len);
+    udp_put16(&udp[6], 0U);
+    memcpy(&udp[UDP_HDR_SIZE], data, len);
+
+    uint32_t sum = udp_sum(0U, &frame[ETH_HDR_SIZE + 12U], 2U * BOOT_UDP_IP_SIZE) + IP_PROTO_UDP + udp_len;
+    uint16_t checksum = udp_fold(udp_sum(sum, udp, udp_len));
+    udp_put16(&udp[6], (checksum == 0U) ? 0xFFFFU : checksum);
+
+    udp_tx_submit(ctx, frame, BOOT_UDP_HEADER_SIZE + len);
+    return BOOT_UDP_OK;
+}
@@ -1,129 +1,392 @@
 // 应用层源文件
 #include "easy_bootloader.h"
+#include "boot_kernel.h"
+#if BOOT_CONFIG_ENABLE_SHA256
+#include "boot_sha256.h"
+#endif
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+#include "boot_ed25519.h"
+#if !BOOT_CONFIG_ENABLE_SHA256
+    #error "BOOT_CONFIG_ENABLE_SIGNATURE requires BOOT_CONFIG_ENABLE_SHA256"
+#endif
+#ifndef BOOT_SIGN_PUBLIC_KEY
+    #error "BOOT_CONFIG_ENABLE_SIGNATURE requires BOOT_SIGN_PUBLIC_KEY in boot_config.h (generate it with PC tool/source/image_sign.py keygen)"
+#endif
+#endif
+#if BOOT_CONFIG_ENABLE_STAGING && !BOOT_CONFIG_ENABLE_SHA256
+    #error "BOOT_CONFIG_ENABLE_STAGING requires BOOT_CONFIG_ENABLE_SHA256"
+#endif
+#if BOOT_CONFIG_ENABLE_ADDRESS && (BOOT_NODE_ADDR == 0U || BOOT_NODE_ADDR >= 0xFFU)
+    #error "BOOT_NODE_ADDR must be in 0x01..0xFE"
+#endif
+#if BOOT_CONFIG_ENABLE_BROADCAST && (!BOOT_CONFIG_ENABLE_ADDRESS || !BOOT_CONFIG_ENABLE_SHA256)
+    #error "BOOT_CONFIG_ENABLE_BROADCAST requires BOOT_CONFIG_ENABLE_ADDRESS and BOOT_CONFIG_ENABLE_SHA256"
+#endif
+#if BOOT_CONFIG_ENABLE_FEC
+#include "boot_fec.h"
+#if !BOOT_CONFIG_ENABLE_SHA256
+    #error "BOOT_CONFIG_ENABLE_FEC requires BOOT_CONFIG_ENABLE_SHA256"
+#endif
+#if BOOT_FEC_MAX_PARITY > 8U || BOOT_FEC_MAX_PARITY > BOOT_FEC_MAX_SOLVE || (BOOT_FEC_CHUNK_MAX & 0x3U) != 0U
+    #error "BOOT_FEC_MAX_PARITY must be <= 8 and BOOT_FEC_CHUNK_MAX a multiple of 4"
+#endif
+#endif
+#if BOOT_CONFIG_ENABLE_RX_DIRECT && (BOOT_CONFIG_ENABLE_ADDRESS || BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC)
+    #error "BOOT_CONFIG_ENABLE_RX_DIRECT supports point-to-point links only (no ADDRESS, BROADCAST or FEC)"
+#endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+#include "boot_ring.h"
+#if (BOOT_LOG_RING_SIZE & (BOOT_LOG_RING_SIZE - 1U)) != 0U
+    #error "BOOT_LOG_RING_SIZE must be a power of two"
+#endif
+#endif
+
+/*
+ * 移植层调用：默认经 ops 函数指针；BOOT_CONFIG_STATIC_PORT 时下列热路径函数编译期绑定到
+ * BOOT_STATIC_PORT_HEADER 中的同名 static inline 实现（tick 为 boot_port_get_tick），可被内联，
+ * 视为都已提供；擦除、跳转、复位等冷路径仍经 ops
+ */
+#if BOOT_CONFIG_STATIC_PORT
+#include BOOT_STATIC_PORT_HEADER
+    #define BOOT_PORT(ctx, fn)                      BOOT_STATIC_##fn
+    #define BOOT_PORT_HAS(ctx, fn)                  (true)
+    #define BOOT_STATIC_get_tick                    boot_port_get_tick
+    #define BOOT_STATIC_boot_port_flash_write       boot_port_flash_write
+    #define BOOT_STATIC_boot_port_flash_read        boot_port_flash_read
+    #define BOOT_STATIC_boot_port_data_write        boot_port_data_write
+    #define BOOT_STATIC_boot_port_data_read         boot_port_data_read
+    #define BOOT_STATIC_boot_port_data_peek         boot_port_data_peek
+    #define BOOT_STATIC_boot_port_data_release      boot_port_data_release
+    #define BOOT_STATIC_boot_port_rx_peek           boot_port_rx_peek
+    #define BOOT_STATIC_boot_port_rx_consume        boot_port_rx_consume
+    #define BOOT_STATIC_boot_port_log_write         boot_port_log_write
+#else
+    #define BOOT_PORT(ctx, fn)                      ((ctx)->ops->fn)
+    #define BOOT_PORT_HAS(ctx, fn)                  ((ctx)->ops->fn != NULL)
+#endif
 
-/* 应用层日志封装，受 BOOT_CONFIG_ENABLE_LOG 宏控制 */
-#if BOOT_CONFIG_ENABLE_LOG
+/* 应用层日志封装，受 BOOT_CONFIG_ENABLE_LOG 宏控制，输出到调用处 ctx 实例的移植层 */
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+    /* 延迟日志：格式串放进带名字的静态数组（上位机按符号名从 ELF 中取出），记录只写它的地址与原始参数 */
+    #define BOOT_LOG(fmt, ...)                                                     \
+        do {                                                                       \
+            static const char boot_log_fmt[] = fmt;                                \
+            const uint32_t boot_log_args[] = {0U, ##__VA_ARGS__};                  \
+            bootloader_log_record(ctx, boot_log_fmt, &boot_log_args[1],            \
+                                  sizeof(boot_log_args) / sizeof(uint32_t) - 1U);  \
+        } while (0)
+#elif BOOT_CONFIG_ENABLE_LOG
     #define BOOT_LOG(fmt, ...)                                                     \
         do {                                                                       \
-            if (g_boot_ops != NULL && g_boot_ops->boot_port_log != NULL) {        \
-                g_boot_ops->boot_port_log(fmt, ##__VA_ARGS__);                     \
+            if (ctx->ops != NULL && ctx->ops->boot_port_log != NULL &&             \
+                !ctx->log_muted) {                                                 \
+                ctx->ops->boot_port_log(fmt, ##__VA_ARGS__);                       \
             }                                                                      \
         } while (0)
 #else
     #define BOOT_LOG(fmt, ...)  ((void)0)
 #endif
 
+/* 启动耗时打点，受 BOOT_CONFIG_ENABLE_PROFILE 宏控制 */
+#if BOOT_CONFIG_ENABLE_PROFILE
+    #define BOOT_PROFILE_STAMP(stage)   bootloader_profile_stamp(stage)
+    #define BOOT_HANDOFF                ((volatile boot_handoff_t *)(BOOT_HANDOFF_BASE))
+#if (BOOT_ARCH == BOOT_ARCH_ARM_CORTEX_M) && !defined(BOOT_CYCLE_GET)
+    #define BOOT_DEMCR                  (*(volatile uint32_t *)0xE000EDFCU)
+    #define BOOT_DEMCR_TRCENA           (1UL << 24)
+    #define BOOT_DWT_CTRL               (*(volatile uint32_t *)0xE0001000U)
+    #define BOOT_DWT_CTRL_CYCCNTENA     (1UL << 0)
+    #define BOOT_DWT_CYCCNT             (*(volatile uint32_t *)0xE0001004U)
+#endif
+#else
+    #define BOOT_PROFILE_STAMP(stage)   ((void)0)
+#endif
+
 #define BOOT_FRAME_HEADER0        0x55U
 #define BOOT_FRAME_HEADER1        0xAAU
 #define BOOT_FRAME_TAIL0          0x55U
 #define BOOT_FRAME_TAIL1          0x55U
-#define BOOT_FRAME_FIXED_SIZE     11U    // 2B 头 + 3B 剩余 + 2B 长度 + 2B 校验 + 2B 尾
+#if BOOT_CONFIG_ENABLE_ADDRESS
+#define BOOT_FRAME_ADDR_LEN       1U     // 帧头后的节点地址字节
+#else
+#define BOOT_FRAME_ADDR_LEN       0U
+#endif
+#define BOOT_FRAME_BODY           (2U + BOOT_FRAME_ADDR_LEN)    // 帧头（及地址）之后第一个字节的下标
+#define BOOT_FRAME_FIXED_SIZE     (11U + BOOT_FRAME_ADDR_LEN)   // 2B 头 + [地址] + 3B 剩余 + 2B 长度 + 2B 校验 + 2B 尾
 
 /* 完成帧命令码 */
 #define BOOT_FINISH_FRAME_BYTE0   0xFFU
 #define BOOT_FINISH_FRAME_BYTE1   0xFDU
-#define BOOT_FINISH_FRAME_LEN     14U    // 55 AA [ver 4B] [date 4B] FF FD 55 55
+#define BOOT_FINISH_FRAME_LEN     (14U + BOOT_FRAME_ADDR_LEN)    // 55 AA [ver 4B] [date 4B] FF FD 55 55
+
+/* 扩展完成帧（携带 SHA-256 摘要） */
+#define BOOT_FINISH_EXT_BYTE0     0xFFU
+#define BOOT_FINISH_EXT_BYTE1     0xFBU
+#define BOOT_FINISH_EXT_LEN       (46U + BOOT_FRAME_ADDR_LEN)    // 55 AA [ver 4B] [date 4B] [sha256 32B] FF FB 55 55
+
+/* 签名完成帧（携带 SHA-256 摘要与其 Ed25519 签名） */
+#define BOOT_FINISH_SIGNED_BYTE0  0xFFU
+#define BOOT_FINISH_SIGNED_BYTE1  0xFAU
+#define BOOT_FINISH_SIGNED_LEN    (110U + BOOT_FRAME_ADDR_LEN)   // 55 AA [ver 4B] [date 4B] [sha256 32B] [sig 64B] FF FA 55 55
 
 static const uint8_t g_boot_ack[] = {0x55U, 0xAAU, 0xFFU, 0xFEU, 0x55U, 0x55U}; //ACK帧
 
+/* 计数 ACK（在途窗口 > 1 时使用），一次确认 n 个数据帧 */
+#define BOOT_ACK_COUNT_BYTE0      0xFFU
+#define BOOT_ACK_COUNT_BYTE1      0xF9U
+#define BOOT_ACK_COUNT_LEN        7U     // 55 AA FF F9 [n] 55 55
+
+#if BOOT_CONFIG_ENABLE_ADDRESS
+/* 总线扫描：探测帧 55 AA [addr] FF F8 55 55，应答 55 AA FF F8 [addr] [state] [ver 4B] 55 55 */
+#define BOOT_SCAN_BYTE0           0xFFU
+#define BOOT_SCAN_BYTE1           0xF8U
+#define BOOT_SCAN_LEN             7U
+#define BOOT_SCAN_REPLY_LEN       12U
+#endif
+
+#if BOOT_CONFIG_ENABLE_BROADCAST
+/*
+ * 广播升级，地址 0x00 的帧所有节点都接收且不应答：
+ *   启动帧 55 AA 00 FF F7 [session] [size 3B] [chunk 2B] [sum 2B] 55 55
+ *   数据帧 55 AA 00 FF F6 [session] [index 2B] [len 2B] [data] [sum 2B] 55 55
+ * 状态查询（单播）55 AA [addr] FF F5 55 55，
+ *   应答 55 AA FF F5 [addr] [session] [frames 2B] [missing 2B] [bitmap] 55 55，bitmap 中 1 表示已收到
+ * 校验和为地址字节加 session 起至校验和之前各字节的累加和
+ */
+#define BOOT_BCAST_ADDR           0x00U
+#define BOOT_BCAST_BYTE0          0xFFU
+#define BOOT_BCAST_START_BYTE1    0xF7U
+#define BOOT_BCAST_DATA_BYTE1     0xF6U
+#define BOOT_BCAST_STATUS_BYTE1   0xF5U
+#define BOOT_BCAST_START_FIELDS   6U      // session + size + chunk
+#define BOOT_BCAST_DATA_FIELDS    5U      // session + index + len
+#define BOOT_BCAST_FRAME_FIXED    (BOOT_FRAME_BODY + 6U)    // 头 + 地址 + 命令码 + 校验 + 尾
+#define BOOT_BCAST_CHUNK_MAX      ((BOOT_PACKET_MAX_SIZE - BOOT_BCAST_FRAME_FIXED - BOOT_BCAST_DATA_FIELDS) & ~0x3U)
+#define BOOT_BCAST_STATUS_LEN     7U
+#define BOOT_BCAST_REPLY_MAX      (12U + BOOT_BCAST_BITMAP_SIZE)
+#endif
+
+#if BOOT_CONFIG_ENABLE_FEC
+/*
+ * 前向纠错传输，用于没有可靠回传通道的链路，节点不应答：
+ *   启动帧 55 AA [addr] FF F4 [session] [size 3B] [chunk 2B] [k] [m] [ver 4B] [date 4B] [sha256 32B] [sig 64B] [sum 2B] 55 55
+ *   数据帧 55 AA [addr] FF F3 [session] [group 2B] [row] [len 2B] [data] [sum 2B] 55 55
+ * row < k 为组内第 row 个数据帧（固件第 group*k+row 帧），row >= k 为该组第 row-k 个校验帧（长度固定为 chunk）
+ * 地址字节仅在多点总线模式下存在（0x00 或本节点地址）；校验和为地址字节加 session 起至校验和之前各字节的累加和
+ * 启动帧随数据周期性重发，其中的摘要与签名（未启用签名时填 0）在收齐后直接用于提交，不需要完成帧
+ */
+#define BOOT_FEC_BYTE0            0xFFU
+#define BOOT_FEC_START_BYTE1      0xF4U
+#define BOOT_FEC_DATA_BYTE1       0xF3U
+#define BOOT_FEC_BCAST_ADDR       0x00U
+#define BOOT_FEC_START_FIELDS     112U    // session + size + chunk + k + m + ver + date + sha256 + sig
+#define BOOT_FEC_DATA_FIELDS      6U      // session + group + row + len
+#define BOOT_FEC_FRAME_FIXED      (BOOT_FRAME_BODY + 6U)    // 头 + [地址] + 命令码 + 校验 + 尾
+#define BOOT_FEC_NO_GROUP         0xFFFFU
+#if (BOOT_FEC_FRAME_FIXED + BOOT_FEC_DATA_FIELDS + BOOT_FEC_CHUNK_MAX) > BOOT_PACKET_MAX_SIZE
+    #error "BOOT_FEC_CHUNK_MAX does not fit in BOOT_PACKET_MAX_SIZE"
+#endif
+#endif
+
 // 纯数据部分最大长度 = 整帧最大长度 - 固定部分长度
 #define BOOT_PAYLOAD_MAX_SIZE     (BOOT_PACKET_MAX_SIZE - BOOT_FRAME_FIXED_SIZE)
 
-/* Bootloader 状态枚举 */
-typedef enum {
-    BOOT_STATE_IDLE,          // 空闲，等待数据帧
-    BOOT_STATE_RECEIVING,     // 正在接收固件数据
-    BOOT_STATE_WAIT_FINISH,   // 数据接收完成，等待完成帧
-} boot_state_t;
+#if BOOT_CONFIG_ENABLE_RX_DIRECT && BOOT_RX_CACHE_SIZE < BOOT_FINISH_SIGNED_LEN
+    #error "BOOT_RX_CACHE_SIZE must hold the longest finish frame"
+#endif
 
+#if BOOT_CONFIG_ENABLE_STAGING
+/* 暂存记录，布局见 boot_config.h */
 typedef struct {
-    uint8_t  rx_cache[BOOT_PACKET_MAX_SIZE];   // 线性解析缓存（整帧最大长度）
-    uint16_t rx_cache_len;
-    uint8_t  payload_buf[BOOT_PAYLOAD_MAX_SIZE];  // 纯数据缓存
-
-    uint32_t current_addr;              //当前写入地址
-    uint8_t  stream_cache[4];           //写流缓存，保证4字节对齐写入
-    uint8_t  stream_cache_len;
-
-    uint32_t boot_flag;
-    uint32_t app_version;
-    uint32_t update_date;
-
-    boot_state_t state;                 // 当前状态
-    bool download_active;
-    bool initialized;
-} bootloader_context_t;
-
-static bootloader_context_t g_boot_ctx;
-static const boot_ops_t *g_boot_ops;
-
-
-static void bootloader_reset_context(void);
-static void bootloader_read_flag_region(void);
-static bool bootloader_check_app_valid(void);
-static void bootloader_poll_data(void);
-static void bootloader_consume_cache(uint16_t count);
-static bool bootloader_try_extract_frame(uint32_t *remaining, uint16_t *payload_len);
-static bool bootloader_try_extract_finish_frame(uint32_t *version, uint32_t *date);
-static boot_port_status_t bootloader_handle_payload(uint32_t remaining, uint16_t payload_len);
-static boot_port_status_t bootloader_handle_finish_frame(uint32_t version, uint32_t date);
-static boot_port_status_t bootloader_prepare_download(void);
-static boot_port_status_t bootloader_stream_write(const uint8_t *data, uint32_t len);
-static boot_port_status_t bootloader_stream_flush(void);
-static boot_port_status_t bootloader_write_flag_region(uint32_t flag, uint32_t version, uint32_t date);
+    uint32_t magic;
+    uint32_t size;
+    uint32_t version;
+    uint32_t date;
+    uint8_t  digest[BOOT_DIGEST_SIZE];
+    uint8_t  signature[BOOT_SIGNATURE_SIZE];
+} boot_staging_record_t;
+#endif
+
+#if BOOT_CONFIG_ENABLE_STAGING || BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+/* 分块处理 Flash 内容的回调，返回 false 时提前结束 */
+typedef bool (*boot_chunk_fn_t)(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len);
+#endif
+
+static easy_bootloader_t g_boot_ctx;         // easy_bootloader_init / easy_bootloader_run 使用的默认实例
+#if BOOT_CONFIG_ENABLE_PROFILE
+static bool g_boot_profile_started;
+#endif
+
+
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+static void bootloader_log_record(easy_bootloader_t *ctx, const char *fmt, const uint32_t *args, uint32_t nargs);
+static void bootloader_log_drain(easy_bootloader_t *ctx);
+static void bootloader_log_flush(easy_bootloader_t *ctx);
+#else
+#define bootloader_log_drain(ctx)      ((void)0)
+#define bootloader_log_flush(ctx)      ((void)0)
+#endif
+static void bootloader_reset_context(easy_bootloader_t *ctx);
+static void bootloader_read_flag_region(easy_bootloader_t *ctx);
+static bool bootloader_check_app_valid(easy_bootloader_t *ctx);
+static void bootloader_poll_data(easy_bootloader_t *ctx);
+static void bootloader_consume_cache(easy_bootloader_t *ctx, uint16_t count);
+static void bootloader_link_write(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len);
+static void bootloader_flush_ack(easy_bootloader_t *ctx);
+static void bootloader_ack_released(easy_bootloader_t *ctx);
+static int32_t bootloader_check_frame(const uint8_t *buf, uint32_t len, uint32_t *remaining, uint16_t *payload_len);
+static bool bootloader_seek_frame(easy_bootloader_t *ctx, uint16_t min_len);
+#if BOOT_CONFIG_ENABLE_BROADCAST
+static uint16_t bootloader_bcast_frame(easy_bootloader_t *ctx, const uint8_t *buf, uint16_t len);
+static void bootloader_bcast_start(easy_bootloader_t *ctx, const uint8_t *fields);
+static void bootloader_bcast_data(easy_bootloader_t *ctx, const uint8_t *fields, const uint8_t *data, uint16_t data_len);
+static void bootloader_bcast_send_status(easy_bootloader_t *ctx);
+#endif
+#if BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+static boot_port_status_t bootloader_write_chunk(easy_bootloader_t *ctx, uint32_t addr, const uint8_t *data, uint16_t len);
+static uint32_t bootloader_unordered_size(easy_bootloader_t *ctx);
+#endif
+#if BOOT_CONFIG_ENABLE_FEC
+static uint16_t bootloader_fec_frame(easy_bootloader_t *ctx, const uint8_t *buf, uint16_t len);
+static void bootloader_fec_start(easy_bootloader_t *ctx, const uint8_t *fields);
+static void bootloader_fec_data(easy_bootloader_t *ctx, const uint8_t *fields, const uint8_t *data, uint16_t data_len);
+static void bootloader_fec_decode(easy_bootloader_t *ctx);
+static void bootloader_fec_commit(easy_bootloader_t *ctx);
+#endif
+static uint16_t bootloader_try_extract_frame(easy_bootloader_t *ctx, uint32_t *remaining, uint16_t *payload_len);
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+static void bootloader_poll_ring(easy_bootloader_t *ctx);
+#else
+static void bootloader_poll_direct(easy_bootloader_t *ctx);
+#endif
+static bool bootloader_try_extract_finish_frame(easy_bootloader_t *ctx, boot_finish_frame_t *frame);
+static boot_port_status_t bootloader_handle_payload(easy_bootloader_t *ctx, uint32_t remaining, const uint8_t *payload, uint16_t payload_len,
+                                                    const uint8_t *more, uint16_t more_len);
+static boot_port_status_t bootloader_handle_finish_frame(easy_bootloader_t *ctx, const boot_finish_frame_t *frame);
+static boot_port_status_t bootloader_prepare_download(easy_bootloader_t *ctx);
+static boot_port_status_t bootloader_stream_write(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len);
+static boot_port_status_t bootloader_stream_flush(easy_bootloader_t *ctx);
+static boot_port_status_t bootloader_write_flag_region(easy_bootloader_t *ctx, uint32_t flag, uint32_t version, uint32_t date,
+                                                       const uint8_t *digest, const uint8_t *signature);
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+static boot_port_status_t bootloader_write_sign_trailer(easy_bootloader_t *ctx, const uint8_t *digest, const uint8_t *signature);
+static bool bootloader_verify_signature(easy_bootloader_t *ctx, const uint8_t *digest, const uint8_t *signature);
+#endif
+#if BOOT_CONFIG_ENABLE_STAGING || BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+static boot_port_status_t bootloader_scan_region(easy_bootloader_t *ctx, uint32_t addr, uint32_t len,
+                                                 boot_chunk_fn_t fn, bool *complete);
+static boot_port_status_t bootloader_hash_region(easy_bootloader_t *ctx, uint32_t addr, uint32_t size, uint8_t *digest);
+#endif
+#if BOOT_CONFIG_ENABLE_STAGING
+static void bootloader_install_staged(easy_bootloader_t *ctx);
+static void bootloader_discard_staged(easy_bootloader_t *ctx);
+static boot_port_status_t bootloader_install_copy(easy_bootloader_t *ctx, uint32_t image_size);
+static boot_port_status_t bootloader_compare_region(easy_bootloader_t *ctx, uint32_t addr_a, uint32_t addr_b, uint32_t len, bool *same);
+static boot_port_status_t bootloader_check_erased(easy_bootloader_t *ctx, uint32_t addr, uint32_t len, bool *erased);
+#endif
+static void bootloader_jump_to_app(easy_bootloader_t *ctx, uint32_t boot_flags);
+#if BOOT_CONFIG_ENABLE_PROFILE
+static uint32_t bootloader_cycle_get(void);
+static void bootloader_profile_stamp(boot_stage_t stage);
+#endif
 
 boot_port_status_t easy_bootloader_init(const boot_ops_t *ops)
 {
-    if (ops == NULL) {
+    return easy_bootloader_ctx_init(&g_boot_ctx, ops);
+}
+
+void easy_bootloader_run(void)
+{
+    easy_bootloader_ctx_run(&g_boot_ctx);
+}
+
+/**
+ * @brief 初始化一个 Bootloader 实例并完成启动判断（APP 有效时直接跳转，不返回）
+ * @param ctx 调用方分配的实例，之前的内容全部清除
+ * @param ops 移植层操作集，实例运行期间保持有效
+ */
+boot_port_status_t easy_bootloader_ctx_init(easy_bootloader_t *ctx, const boot_ops_t *ops)
+{
+    if (ctx == NULL || ops == NULL) {
         return BOOT_PORT_ERROR;
     }
 
     if (ops->boot_port_flash_erase == NULL ||
-        ops->boot_port_flash_write == NULL ||
-        ops->boot_port_flash_read == NULL ||
-        ops->boot_port_data_write == NULL ||
-        ops->boot_port_data_read == NULL ||
         ops->boot_port_jump_to_app == NULL ||
         ops->boot_port_system_reset == NULL) {
         return BOOT_PORT_ERROR;
     }
+#if !BOOT_CONFIG_STATIC_PORT
+    if (ops->boot_port_flash_write == NULL ||
+        ops->boot_port_flash_read == NULL ||
+        ops->boot_port_data_write == NULL ||
+        ops->boot_port_data_read == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+    if (ops->boot_port_rx_peek == NULL || ops->boot_port_rx_consume == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+#endif
+#endif
+
+#if BOOT_CONFIG_ENABLE_PROFILE
+    if (!g_boot_profile_started) {
+        easy_bootloader_profile_start();
+    }
+#endif
+    BOOT_PROFILE_STAMP(BOOT_STAGE_INIT);
 
-    g_boot_ops = ops;   //ops绑定
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->ops = ops;   //ops绑定
+    ctx->log_muted = false;
+#if BOOT_CONFIG_ENABLE_ADDRESS
+    ctx->node_addr = (ops->node_addr != 0U) ? ops->node_addr : (uint8_t)BOOT_NODE_ADDR;
+#endif
 
     BOOT_LOG("=== Easy Bootloader Start ===\r\n");
 
-    bootloader_reset_context();
-    bootloader_read_flag_region();
+    bootloader_reset_context(ctx);
+    bootloader_read_flag_region(ctx);
+    BOOT_PROFILE_STAMP(BOOT_STAGE_FLAG_READ);
+
+#if BOOT_CONFIG_ENABLE_STAGING
+    // 暂存区有 APP 后台接收好的固件时，先安装再走正常启动判断
+    bootloader_install_staged(ctx);
+#endif
 
     BOOT_LOG("Flag: 0x%08X, Version: 0x%08X, Date: 0x%08X\r\n",
-              g_boot_ctx.boot_flag, g_boot_ctx.app_version, g_boot_ctx.update_date);
+              ctx->boot_flag, ctx->app_version, ctx->update_date);
 
     // 判断是否需要跳转到 APP
     // 条件1: 标志位为 APP 模式
     // 条件2: APP 区域有效（非空且校验通过）
     bool should_jump = false;
 
-    if (g_boot_ctx.boot_flag == BOOT_FLAG_BOOTLOADER) {
+    if (ctx->boot_flag == BOOT_FLAG_BOOTLOADER) {
         // flag=1: 明确要求停留在 Bootloader，等待固件
         BOOT_LOG("Flag=BOOT, waiting for firmware...\r\n");
     } else {
         // flag=2 或 flag=BOOT_FLAG_ERASED 或其他值: 都尝试检查 APP 有效性
         BOOT_LOG("Checking APP validity...\r\n");
-        if (bootloader_check_app_valid()) {
-            if (g_boot_ctx.boot_flag == BOOT_FLAG_APP) {
+        bool app_valid = bootloader_check_app_valid(ctx);
+        BOOT_PROFILE_STAMP(BOOT_STAGE_APP_CHECK);
+        if (app_valid) {
+            if (ctx->boot_flag == BOOT_FLAG_APP) {
                 // flag=2 且 APP 有效: 正常跳转
                 should_jump = true;
-            } else if (g_boot_ctx.boot_flag == BOOT_FLAG_ERASED) {
+            } else if (ctx->boot_flag == BOOT_FLAG_ERASED) {
                 // flag=擦除值 且 APP 有效: 标志位未初始化，停留在 Bootloader 等待升级
                 BOOT_LOG("Flag erased, staying in bootloader...\r\n");
                 should_jump = false;
             } else {
                 // 其他未知 flag 值，APP 有效但不跳转，等待用户处理
                 BOOT_LOG("Flag=0x%08X (unknown), APP valid but not jumping\r\n",
-                         g_boot_ctx.boot_flag);
+                         ctx->boot_flag);
             }
         } else {
             // APP 无效，无论 flag 是什么都不跳转
@@ -133,33 +396,248 @@ boot_port_status_t easy_bootloader_init(const boot_ops_t *ops)
 
     if (should_jump) {
         BOOT_LOG("APP valid, jumping to APP...\r\n");
-        g_boot_ops->boot_port_jump_to_app(BOOT_APP_START_ADDR);
+        bootloader_jump_to_app(ctx, 0U);
         // 如果跳转失败会返回这里
         BOOT_LOG("Jump failed, staying in bootloader\r\n");
     }
 
-    g_boot_ctx.initialized = true;
+    ctx->initialized = true;
+    BOOT_LOG("Context RAM: %lu bytes (rx cache %lu)\r\n",
+             (unsigned long)sizeof(*ctx), (unsigned long)sizeof(ctx->rx_cache));
     BOOT_LOG("Bootloader ready, waiting for data...\r\n");
 
     return BOOT_PORT_OK;
 }
 
-static void bootloader_read_flag_region(void)
+/**
+ * @brief 启动打点起点，建议在 main 最开始（HAL/时钟初始化之前）调用
+ * @note  Cortex-M 下开启并清零 DWT 周期计数器，RISC-V 下 mcycle 自复位起计数，
+ *        同时清空交接区。未调用时由 easy_bootloader_init 补调
+ */
+void easy_bootloader_profile_start(void)
+{
+#if BOOT_CONFIG_ENABLE_PROFILE
+#if (BOOT_ARCH == BOOT_ARCH_ARM_CORTEX_M) && !defined(BOOT_CYCLE_GET)
+    BOOT_DEMCR |= BOOT_DEMCR_TRCENA;
+    BOOT_DWT_CYCCNT = 0U;
+    BOOT_DWT_CTRL |= BOOT_DWT_CTRL_CYCCNTENA;
+#endif
+    memset((void *)BOOT_HANDOFF, 0, sizeof(boot_handoff_t));
+    g_boot_profile_started = true;
+    bootloader_profile_stamp(BOOT_STAGE_RESET);
+#endif
+}
+
+/**
+ * @brief 快速跳转路径
+ * @param ops 移植层操作集（只用到 flash_read 与 jump_to_app）
+ * @return 仅在未跳转时返回 BOOT_PORT_ERROR，调用方继续走正常初始化
+ * @note  应在外设初始化之前调用：flag=APP 且 APP 有效时不输出日志、
+ *        不等待串口，直接跳转；其他情况交给 easy_bootloader_init 处理
+ */
+boot_port_status_t easy_bootloader_fast_boot(const boot_ops_t *ops)
+{
+#if BOOT_CONFIG_ENABLE_FAST_BOOT
+    easy_bootloader_t *ctx = &g_boot_ctx;
+
+    if (ops == NULL || ops->boot_port_jump_to_app == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+#if !BOOT_CONFIG_STATIC_PORT
+    if (ops->boot_port_flash_read == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+#endif
+
+#if BOOT_CONFIG_ENABLE_PROFILE
+    if (!g_boot_profile_started) {
+        easy_bootloader_profile_start();
+    }
+#endif
+    BOOT_PROFILE_STAMP(BOOT_STAGE_INIT);
+
+    ctx->ops = ops;
+    ctx->log_muted = true;
+
+    bootloader_read_flag_region(ctx);
+    BOOT_PROFILE_STAMP(BOOT_STAGE_FLAG_READ);
+
+#if BOOT_CONFIG_ENABLE_STAGING
+    // 有待安装的暂存固件时交给正常初始化处理
+    uint32_t staging_magic = 0U;
+    if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_STAGING_RECORD_ADDR, (uint8_t *)&staging_magic, 4U) != BOOT_PORT_OK ||
+        staging_magic == BOOT_STAGING_MAGIC) {
+        ctx->boot_flag = BOOT_FLAG_BOOTLOADER;
+    }
+#endif
+
+    if (ctx->boot_flag == BOOT_FLAG_APP) {
+        bool app_valid = bootloader_check_app_valid(ctx);
+        BOOT_PROFILE_STAMP(BOOT_STAGE_APP_CHECK);
+        if (app_valid) {
+            bootloader_jump_to_app(ctx, BOOT_HANDOFF_FLAG_FAST);
+        }
+    }
+
+    // 未跳转：恢复日志，ops 由 easy_bootloader_init 重新绑定
+    ctx->log_muted = false;
+    ctx->ops = NULL;
+#else
+    (void)ops;
+#endif
+    return BOOT_PORT_ERROR;
+}
+
+static void bootloader_jump_to_app(easy_bootloader_t *ctx, uint32_t boot_flags)
+{
+    bootloader_log_flush(ctx);
+#if BOOT_CONFIG_ENABLE_PROFILE
+    BOOT_PROFILE_STAMP(BOOT_STAGE_JUMP);
+    BOOT_HANDOFF->boot_flags = boot_flags;
+    BOOT_HANDOFF->magic = BOOT_HANDOFF_MAGIC;
+#else
+    (void)boot_flags;
+#endif
+    ctx->ops->boot_port_jump_to_app(BOOT_APP_START_ADDR);
+}
+
+#if BOOT_CONFIG_ENABLE_LOG && BOOT_CONFIG_LOG_DEFERRED
+#define BOOT_LOG_SYNC                 0xEBU
+#define BOOT_LOG_HEADER_SIZE          8U
+#define BOOT_LOG_MAX_ARGS             8U
+
+/**
+ * @brief 写入一条延迟日志记录
+ * @note  记录：EB [参数个数] [tick 低 16 位] [格式串地址 4B] [参数 4B * n]，多字节均为小端；
+ *        格式串地址为 0 表示丢弃计数记录。环空间不足时丢弃本条，不等待
+ */
+static void bootloader_log_record(easy_bootloader_t *ctx, const char *fmt, const uint32_t *args, uint32_t nargs)
+{
+    uint8_t record[BOOT_LOG_HEADER_SIZE + 4U * BOOT_LOG_MAX_ARGS];
+    uint32_t addr = (uint32_t)(uintptr_t)fmt;
+    uint32_t tick;
+    uint32_t len;
+    uint32_t i;
+
+    if (ctx->log_muted) {
+        return;
+    }
+    if (ctx->log_ring.buf == NULL) {
+        (void)boot_ring_init(&ctx->log_ring, ctx->log_buf, sizeof(ctx->log_buf));
+    }
+    if (nargs > BOOT_LOG_MAX_ARGS) {
+        nargs = BOOT_LOG_MAX_ARGS;
+    }
+    len = BOOT_LOG_HEADER_SIZE + 4U * nargs;
+    if (boot_ring_space_len(&ctx->log_ring) < len) {
+        ctx->log_dropped++;
+        return;
+    }
+
+    tick = (ctx->ops != NULL && BOOT_PORT_HAS(ctx, get_tick)) ? BOOT_PORT(ctx, get_tick)() : 0U;
+    record[0] = BOOT_LOG_SYNC;
+    record[1] = (uint8_t)nargs;
+    record[2] = (uint8_t)(tick & 0xFFU);
+    record[3] = (uint8_t)((tick >> 8) & 0xFFU);
+    for (i = 0U; i < 4U; i++) {
+        record[4U + i] = (uint8_t)((addr >> (8U * i)) & 0xFFU);
+    }
+    for (i = 0U; i < 4U * nargs; i++) {
+        record[BOOT_LOG_HEADER_SIZE + i] = (uint8_t)((args[i / 4U] >> (8U * (i % 4U))) & 0xFFU);
+    }
+    (void)boot_ring_write(&ctx->log_ring, record, len);
+}
+
+/* 把环中的记录交给 ops.log_write，发送通道忙时留到下次 */
+static void bootloader_log_drain(easy_bootloader_t *ctx)
+{
+    if (ctx->ops == NULL || !BOOT_PORT_HAS(ctx, boot_port_log_write) || ctx->log_ring.buf == NULL) {
+        return;
+    }
+
+    if (ctx->log_dropped != 0U &&
+        boot_ring_space_len(&ctx->log_ring) >= BOOT_LOG_HEADER_SIZE + 4U) {
+        uint32_t dropped = ctx->log_dropped;
+        ctx->log_dropped = 0U;
+        bootloader_log_record(ctx, NULL, &dropped, 1U);
+    }
+
+    for (;;) {
+        const uint8_t *data;
+        uint32_t len = boot_ring_acquire_read(&ctx->log_ring, &data);
+        if (len == 0U) {
+            break;
+        }
+        uint32_t sent = BOOT_PORT(ctx, boot_port_log_write)(data, len);
+        if (sent == 0U) {
+            break;
+        }
+        boot_ring_commit_read(&ctx->log_ring, (sent < len) ? sent : len);
+    }
+}
+
+/* 跳转、复位前把剩余记录发完，最多等待 BOOT_LOG_FLUSH_TIMEOUT_MS（没有 get_tick 时只发一轮） */
+static void bootloader_log_flush(easy_bootloader_t *ctx)
+{
+    uint32_t start = (ctx->ops != NULL && BOOT_PORT_HAS(ctx, get_tick)) ? BOOT_PORT(ctx, get_tick)() : 0U;
+
+    bootloader_log_drain(ctx);
+    while (ctx->log_ring.buf != NULL && boot_ring_data_len(&ctx->log_ring) != 0U &&
+           ctx->ops != NULL && BOOT_PORT_HAS(ctx, boot_port_log_write) && BOOT_PORT_HAS(ctx, get_tick) &&
+           (uint32_t)(BOOT_PORT(ctx, get_tick)() - start) < BOOT_LOG_FLUSH_TIMEOUT_MS) {
+        bootloader_log_drain(ctx);
+    }
+}
+#endif
+
+#if BOOT_CONFIG_ENABLE_PROFILE
+static uint32_t bootloader_cycle_get(void)
+{
+#if defined(BOOT_CYCLE_GET)
+    return BOOT_CYCLE_GET();
+#elif (BOOT_ARCH == BOOT_ARCH_ARM_CORTEX_M)
+    return BOOT_DWT_CYCCNT;
+#elif (BOOT_ARCH == BOOT_ARCH_RISCV)
+    uint32_t cycle;
+    __asm volatile ("csrr %0, mcycle" : "=r"(cycle));
+    return cycle;
+#endif
+}
+
+static void bootloader_profile_stamp(boot_stage_t stage)
+{
+    BOOT_HANDOFF->stamp[stage] = bootloader_cycle_get();
+}
+#endif
+
+static void bootloader_read_flag_region(easy_bootloader_t *ctx)
 {
-    if (g_boot_ops->boot_port_flash_read(BOOT_FLAG_ADDR, (uint8_t *)&g_boot_ctx.boot_flag, 4U) != BOOT_PORT_OK ||
-        g_boot_ops->boot_port_flash_read(BOOT_VERSION_ADDR, (uint8_t *)&g_boot_ctx.app_version, 4U) != BOOT_PORT_OK ||
-        g_boot_ops->boot_port_flash_read(BOOT_DATE_ADDR, (uint8_t *)&g_boot_ctx.update_date, 4U) != BOOT_PORT_OK) {
-        g_boot_ctx.boot_flag = BOOT_FLAG_ERASED;
-        g_boot_ctx.app_version = BOOT_FLAG_ERASED;
-        g_boot_ctx.update_date = BOOT_FLAG_ERASED;
+    if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_FLAG_ADDR, (uint8_t *)&ctx->boot_flag, 4U) != BOOT_PORT_OK ||
+        BOOT_PORT(ctx, boot_port_flash_read)(BOOT_VERSION_ADDR, (uint8_t *)&ctx->app_version, 4U) != BOOT_PORT_OK ||
+        BOOT_PORT(ctx, boot_port_flash_read)(BOOT_DATE_ADDR, (uint8_t *)&ctx->update_date, 4U) != BOOT_PORT_OK) {
+        ctx->boot_flag = BOOT_FLAG_ERASED;
+        ctx->app_version = BOOT_FLAG_ERASED;
+        ctx->update_date = BOOT_FLAG_ERASED;
         BOOT_LOG("Read flag region failed, fallback to erased defaults\r\n");
     }
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_SIGN_STATE_ADDR, (uint8_t *)&ctx->sign_state, 4U) != BOOT_PORT_OK) {
+        ctx->sign_state = BOOT_FLAG_ERASED;
+    }
+#endif
 }
 
-static bool bootloader_check_app_valid(void)
+static bool bootloader_check_app_valid(easy_bootloader_t *ctx)
 {
-    uint32_t app_word0 = *(volatile uint32_t *)BOOT_APP_START_ADDR;
-    uint32_t app_word1 = *(volatile uint32_t *)(BOOT_APP_START_ADDR + 4U);
+    // 经移植层读取向量表前两个字，不直接访问 APP 地址（外部 Flash、主机测试中 APP 区不在该地址上）
+    uint32_t app_words[2];
+    (void)ctx;   // 关闭日志与签名且静态绑定移植层时未使用
+    if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_APP_START_ADDR, (uint8_t *)app_words, sizeof(app_words)) != BOOT_PORT_OK) {
+        BOOT_LOG("Read APP vector table failed\r\n");
+        return false;
+    }
+    uint32_t app_word0 = app_words[0];
+    uint32_t app_word1 = app_words[1];
 
 #if (BOOT_ARCH == BOOT_ARCH_ARM_CORTEX_M)
     // ARM Cortex-M 架构: 向量表格式为 [栈指针, 复位向量, ...]
@@ -228,26 +706,70 @@ static bool bootloader_check_app_valid(void)
     #error "Unsupported architecture: BOOT_ARCH must be BOOT_ARCH_ARM_CORTEX_M or BOOT_ARCH_RISCV"
 #endif
 
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    // 签名只在完成帧阶段校验一次，启动时只看缓存结果，不增加启动耗时
+    if (ctx->sign_state != BOOT_SIGN_STATE_VERIFIED) {
+        BOOT_LOG("APP signature not verified\r\n");
+        return false;
+    }
+#endif
+
     return true;
 }
 
-void easy_bootloader_run(void)
+void easy_bootloader_ctx_run(easy_bootloader_t *ctx)
 {
-    if (!g_boot_ctx.initialized) {
+    if (ctx == NULL || !ctx->initialized) {
+        return;
+    }
+
+    bootloader_log_drain(ctx);
+
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+    /* 数据帧在接收环中就地处理，只有等待完成帧时才把数据拷入 rx_cache 解析 */
+    if (ctx->state != BOOT_STATE_WAIT_FINISH) {
+        bootloader_poll_ring(ctx);
+    }
+    if (ctx->state == BOOT_STATE_WAIT_FINISH) {
+        bootloader_poll_data(ctx);
+    }
+#else
+    if (BOOT_PORT_HAS(ctx, boot_port_data_peek) && BOOT_PORT_HAS(ctx, boot_port_data_release)) {
+        bootloader_poll_direct(ctx);
+    }
+    bootloader_poll_data(ctx);
+#endif
+
+#if BOOT_CONFIG_ENABLE_FEC
+    /* FEC 会话收齐后直接用启动帧中的摘要校验并提交 */
+    if (ctx->state == BOOT_STATE_WAIT_FINISH && ctx->fec_size != 0U) {
+        bootloader_fec_commit(ctx);
         return;
     }
+#endif
 
-    bootloader_poll_data();
+    /* 单播传输中断超过 BOOT_UART_TIMEOUT_MS 时放弃本次接收，上位机（或网关）重发时从擦除开始 */
+    if (ctx->unicast_active && BOOT_PORT_HAS(ctx, get_tick) &&
+        (uint32_t)(BOOT_PORT(ctx, get_tick)() - ctx->unicast_tick) > BOOT_UART_TIMEOUT_MS) {
+        BOOT_LOG("Transfer timeout, resetting state\r\n");
+        bootloader_reset_context(ctx);
+    }
 
     /* 如果处于等待完成帧状态，优先检测完成帧 */
-    if (g_boot_ctx.state == BOOT_STATE_WAIT_FINISH) {
-        uint32_t version = 0U;
-        uint32_t date = 0U;
-        if (bootloader_try_extract_finish_frame(&version, &date)) {
-            if (bootloader_handle_finish_frame(version, date) != BOOT_PORT_OK) {
+    if (ctx->state == BOOT_STATE_WAIT_FINISH) {
+        boot_finish_frame_t frame;
+        if (bootloader_try_extract_finish_frame(ctx, &frame)) {
+            if (bootloader_handle_finish_frame(ctx, &frame) != BOOT_PORT_OK) {
+#if BOOT_CONFIG_ENABLE_BROADCAST
+                /* 广播镜像已逐帧校验且摘要每次回读 Flash 计算，完成帧出错时保留会话，等待上位机单播重发 */
+                if (ctx->bcast_size != 0U) {
+                    BOOT_LOG("Broadcast finish rejected, waiting for retry\r\n");
+                    return;
+                }
+#endif
                 /* 完成帧处理失败，重置状态允许重新刷写 */
                 BOOT_LOG("Finish frame handling failed, resetting state\r\n");
-                bootloader_reset_context();
+                bootloader_reset_context(ctx);
             }
         }
         return;
@@ -256,144 +778,931 @@ void easy_bootloader_run(void)
     /* 正常状态下处理数据帧 */
     uint32_t remaining = 0U;
     uint16_t payload_len = 0U;
-    while (bootloader_try_extract_frame(&remaining, &payload_len)) {
-        if (bootloader_handle_payload(remaining, payload_len) != BOOT_PORT_OK) {
+    uint16_t frame_size;
+    while ((frame_size = bootloader_try_extract_frame(ctx, &remaining, &payload_len)) > 0U) {
+        /* 数据直接从缓存写入，写完再移出缓存 */
+        boot_port_status_t status = bootloader_handle_payload(ctx, remaining, &ctx->rx_cache[BOOT_FRAME_BODY + 5U],
+                                                              payload_len, NULL, 0U);
+        bootloader_consume_cache(ctx, frame_size);
+        if (status != BOOT_PORT_OK) {
             BOOT_LOG("bootloader handle payload failed, resetting state\r\n");
-            bootloader_reset_context();
+            bootloader_reset_context(ctx);
             break;
         }
+        bootloader_ack_released(ctx);
+    }
+
+    /* 待应答帧达到半个窗口、或链路空闲超过 BOOT_LINK_ACK_DELAY_MS 时合并为一个 ACK */
+    if (ctx->ack_pending > 0U) {
+        if (ctx->ops->link_window <= 1U || !BOOT_PORT_HAS(ctx, get_tick) ||
+            ctx->ack_pending * 2U >= ctx->ops->link_window ||
+            (uint32_t)(BOOT_PORT(ctx, get_tick)() - ctx->ack_pending_tick) >= BOOT_LINK_ACK_DELAY_MS) {
+            bootloader_flush_ack(ctx);
+        }
     }
 }
 
-static void bootloader_reset_context(void)
+static void bootloader_reset_context(easy_bootloader_t *ctx)
 {
-    bool was_initialized = g_boot_ctx.initialized;
-    memset(&g_boot_ctx, 0, sizeof(g_boot_ctx));
-    g_boot_ctx.current_addr = BOOT_APP_START_ADDR;
-    g_boot_ctx.state = BOOT_STATE_IDLE;
-    g_boot_ctx.initialized = was_initialized;  // 保留初始化标志
+    // ops 及之后的成员（绑定、初始化标志、日志环）保留
+    memset(ctx, 0, offsetof(easy_bootloader_t, ops));
+    ctx->current_addr = BOOT_APP_START_ADDR;
+    ctx->state = BOOT_STATE_IDLE;
 }
 
-static void bootloader_poll_data(void)
+static void bootloader_poll_data(easy_bootloader_t *ctx)
 {
     // 计算 rx_cache 剩余空间
-    uint32_t space = sizeof(g_boot_ctx.rx_cache) - g_boot_ctx.rx_cache_len;
+    uint32_t space = sizeof(ctx->rx_cache) - ctx->rx_cache_len;
     if (space == 0U) {
         return;  // 缓存已满，等待解析消费
     }
 
-    // 直接从底层读取数据到线性解析缓存
-    uint32_t received = g_boot_ops->boot_port_data_read(
-        &g_boot_ctx.rx_cache[g_boot_ctx.rx_cache_len],
-        space
-    );
+    // 直接从底层读取数据到线性解析缓存；分包链路每次只交付一个包，读到没有数据或缓存满为止
+    uint32_t received;
+    do {
+        received = BOOT_PORT(ctx, boot_port_data_read)(
+            &ctx->rx_cache[ctx->rx_cache_len],
+            space
+        );
+        ctx->rx_cache_len += (uint16_t)received;
+        space -= received;
+    } while (received > 0U && space > 0U && ctx->ops->link_mtu != 0U);
+}
 
-    if (received > 0U) {
-        g_boot_ctx.rx_cache_len += (uint16_t)received;
+/**
+ * @brief 按链路 MTU 分片发送
+ */
+static void bootloader_link_write(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len)
+{
+    uint32_t mtu = (ctx->ops->link_mtu != 0U) ? ctx->ops->link_mtu : len;
+    while (len > 0U) {
+        uint32_t chunk = (len > mtu) ? mtu : len;
+        (void)BOOT_PORT(ctx, boot_port_data_write)(data, chunk);
+        data += chunk;
+        len -= chunk;
     }
 }
 
-static void bootloader_consume_cache(uint16_t count)
+/**
+ * @brief 发送累计的数据帧 ACK：窗口 <= 1 时逐帧发送原 ACK，否则发送一个计数 ACK
+ */
+static void bootloader_flush_ack(easy_bootloader_t *ctx)
 {
-    if (count >= g_boot_ctx.rx_cache_len) {
-        g_boot_ctx.rx_cache_len = 0U;
+    ctx->ack_urgent = false;
+    if (ctx->ack_pending == 0U) {
+        return;
+    }
+
+    if (ctx->ops->link_window <= 1U) {
+        while (ctx->ack_pending > 0U) {
+            bootloader_link_write(ctx, g_boot_ack, sizeof(g_boot_ack));
+            ctx->ack_pending--;
+        }
         return;
     }
 
-    uint16_t remain = g_boot_ctx.rx_cache_len - count;
-    memmove(g_boot_ctx.rx_cache, &g_boot_ctx.rx_cache[count], remain);
-    g_boot_ctx.rx_cache_len = remain;
+    uint8_t ack[BOOT_ACK_COUNT_LEN] = {BOOT_FRAME_HEADER0, BOOT_FRAME_HEADER1,
+                                       BOOT_ACK_COUNT_BYTE0, BOOT_ACK_COUNT_BYTE1,
+                                       0U, BOOT_FRAME_TAIL0, BOOT_FRAME_TAIL1};
+    ack[4] = ctx->ack_pending;
+    bootloader_link_write(ctx, ack, sizeof(ack));
+    ctx->ack_pending = 0U;
 }
 
-static bool bootloader_try_extract_frame(uint32_t *remaining, uint16_t *payload_len)
+/**
+ * @brief 数据帧已从接收缓冲释放后调用：最后一帧或待应答数将满时立即发送 ACK
+ * @note  接收环直通时释放会报告处理期间的 DMA 覆盖，覆盖后状态已复位，不能再应答这些帧
+ */
+static void bootloader_ack_released(easy_bootloader_t *ctx)
 {
-    if (g_boot_ctx.rx_cache_len < BOOT_FRAME_FIXED_SIZE) {
-        return false;
+    if (ctx->ack_urgent) {
+        bootloader_flush_ack(ctx);
     }
-    //寻找帧头
-    while (g_boot_ctx.rx_cache_len >= BOOT_FRAME_FIXED_SIZE) {
-        if (g_boot_ctx.rx_cache[0] != BOOT_FRAME_HEADER0 ||
-            g_boot_ctx.rx_cache[1] != BOOT_FRAME_HEADER1) {
-            bootloader_consume_cache(1U);
-            continue;
-        }
-
-        uint32_t remain = ((uint32_t)g_boot_ctx.rx_cache[2] << 16) |
-                          ((uint32_t)g_boot_ctx.rx_cache[3] << 8) |
-                          g_boot_ctx.rx_cache[4];
-        uint16_t packet_len = ((uint16_t)g_boot_ctx.rx_cache[5] << 8) |
-                              g_boot_ctx.rx_cache[6];
+}
 
-        if (packet_len > BOOT_PAYLOAD_MAX_SIZE) {
-            bootloader_consume_cache(2U);
-            continue;
-        }
+static void bootloader_consume_cache(easy_bootloader_t *ctx, uint16_t count)
+{
+    if (count >= ctx->rx_cache_len) {
+        ctx->rx_cache_len = 0U;
+        return;
+    }
 
-        uint32_t frame_size = BOOT_FRAME_FIXED_SIZE + packet_len;
-        if (g_boot_ctx.rx_cache_len < frame_size) {
-            return false;
-        }
+    uint16_t remain = ctx->rx_cache_len - count;
+#if BOOT_CONFIG_PROFILE_TINY
+    /* 精简构建只在等待完成帧时用到 rx_cache（最长 110 字节），目标在前逐字节前移即可，不链接 memmove */
+    for (uint16_t i = 0U; i < remain; i++) {
+        ctx->rx_cache[i] = ctx->rx_cache[count + i];
+    }
+#else
+    memmove(ctx->rx_cache, &ctx->rx_cache[count], remain);
+#endif
+    ctx->rx_cache_len = remain;
+}
 
-        uint32_t checksum_pos = 7U + packet_len;
-        uint32_t tail_pos = checksum_pos + 2U;
-        if (tail_pos + 1U >= frame_size) {
-            bootloader_consume_cache(2U);
-            continue;
+#if BOOT_CONFIG_ENABLE_ADDRESS
+/**
+ * @brief 发给其他节点的帧：已整帧收到且按数据帧布局能对上帧尾时整帧跳过（不做校验和累加），
+ *        否则只跳过帧头与地址，从后面继续找帧头
+ */
+static uint16_t bootloader_foreign_frame_size(const uint8_t *buf, uint16_t len)
+{
+    if (len >= BOOT_FRAME_FIXED_SIZE) {
+        uint32_t frame_size = BOOT_FRAME_FIXED_SIZE +
+                              (((uint32_t)buf[BOOT_FRAME_BODY + 3U] << 8) | buf[BOOT_FRAME_BODY + 4U]);
+        if (frame_size <= len &&
+            buf[frame_size - 2U] == BOOT_FRAME_TAIL0 && buf[frame_size - 1U] == BOOT_FRAME_TAIL1) {
+            return (uint16_t)frame_size;
         }
+    }
+    return BOOT_FRAME_BODY;
+}
 
-        uint16_t received_crc = ((uint16_t)g_boot_ctx.rx_cache[checksum_pos] << 8) |
-                                g_boot_ctx.rx_cache[checksum_pos + 1U];
-        uint16_t calc_crc = 0U;
-        for (uint32_t idx = 5U; idx < checksum_pos; idx++) {
-            calc_crc += g_boot_ctx.rx_cache[idx];
-        }
+static void bootloader_send_scan_reply(easy_bootloader_t *ctx)
+{
+    uint8_t reply[BOOT_SCAN_REPLY_LEN] = {BOOT_FRAME_HEADER0, BOOT_FRAME_HEADER1, BOOT_SCAN_BYTE0, BOOT_SCAN_BYTE1};
+    reply[4] = ctx->node_addr;
+    reply[5] = (uint8_t)ctx->state;
+    reply[6] = (uint8_t)(ctx->app_version >> 24);
+    reply[7] = (uint8_t)(ctx->app_version >> 16);
+    reply[8] = (uint8_t)(ctx->app_version >> 8);
+    reply[9] = (uint8_t)ctx->app_version;
+    reply[10] = BOOT_FRAME_TAIL0;
+    reply[11] = BOOT_FRAME_TAIL1;
+    bootloader_link_write(ctx, reply, sizeof(reply));
+}
+#endif
+#if BOOT_CONFIG_ENABLE_BROADCAST
+/**
+ * @brief 处理缓存头部的一个广播帧（地址 0x00）
+ * @return 要丢弃的字节数；帧未收全时返回 0
+ */
+static uint16_t bootloader_bcast_frame(easy_bootloader_t *ctx, const uint8_t *buf, uint16_t len)
+{
+    const uint8_t *body = &buf[BOOT_FRAME_BODY];
+    if (len < BOOT_FRAME_BODY + 2U + BOOT_BCAST_DATA_FIELDS) {
+        return 0U;
+    }
+    if (body[0] != BOOT_BCAST_BYTE0) {
+        return BOOT_FRAME_BODY;
+    }
 
-        if (calc_crc != received_crc ||
-            g_boot_ctx.rx_cache[tail_pos] != BOOT_FRAME_TAIL0 ||
-            g_boot_ctx.rx_cache[tail_pos + 1U] != BOOT_FRAME_TAIL1) {
-            bootloader_consume_cache(2U);
-            continue;
+    uint16_t fields_len;
+    uint16_t data_len = 0U;
+    if (body[1] == BOOT_BCAST_START_BYTE1) {
+        fields_len = BOOT_BCAST_START_FIELDS;
+    } else if (body[1] == BOOT_BCAST_DATA_BYTE1) {
+        fields_len = BOOT_BCAST_DATA_FIELDS;
+        data_len = ((uint16_t)body[5] << 8) | body[6];
+        if (data_len > BOOT_BCAST_CHUNK_MAX) {
+            return BOOT_FRAME_BODY;
         }
+    } else {
+        return BOOT_FRAME_BODY;
+    }
 
-        if (packet_len > 0U) {
-            memcpy(g_boot_ctx.payload_buf, &g_boot_ctx.rx_cache[7], packet_len);
-        }
+    uint32_t checksum_pos = BOOT_FRAME_BODY + 2U + fields_len + data_len;
+    uint32_t frame_size = checksum_pos + 4U;
+    if (len < frame_size) {
+        return 0U;
+    }
 
-        *payload_len = packet_len;
-        *remaining = remain;
-        bootloader_consume_cache((uint16_t)frame_size);
-        return true;
+    uint16_t calc_crc = boot_sum16(buf[2], &buf[BOOT_FRAME_BODY + 2U], checksum_pos - (BOOT_FRAME_BODY + 2U));
+    uint16_t received_crc = ((uint16_t)buf[checksum_pos] << 8) | buf[checksum_pos + 1U];
+    if (calc_crc != received_crc ||
+        buf[checksum_pos + 2U] != BOOT_FRAME_TAIL0 || buf[checksum_pos + 3U] != BOOT_FRAME_TAIL1) {
+        return BOOT_FRAME_BODY;     // 误码帧丢弃，位图中保持未收到，由上位机补发
     }
 
-    return false;
+    if (fields_len == BOOT_BCAST_START_FIELDS) {
+        bootloader_bcast_start(ctx, &body[2]);
+    } else {
+        bootloader_bcast_data(ctx, &body[2], &body[2U + BOOT_BCAST_DATA_FIELDS], data_len);
+    }
+    return (uint16_t)frame_size;
 }
 
-static boot_port_status_t bootloader_write_flag_region(uint32_t flag, uint32_t version, uint32_t date)
+/**
+ * @brief 广播启动帧：擦除 APP 区并清空位图；同一会话的重复启动帧忽略
+ */
+static void bootloader_bcast_start(easy_bootloader_t *ctx, const uint8_t *fields)
 {
-    // 先擦除标志位区
-    boot_port_status_t status = g_boot_ops->boot_port_flash_erase(BOOT_FLAG_REGION_ADDR, BOOT_FLAG_REGION_SIZE);
-    if (status != BOOT_PORT_OK) {
-        BOOT_LOG("Erase flag region failed\r\n");
-        return status;
+    uint8_t session = fields[0];
+    uint32_t size = ((uint32_t)fields[1] << 16) | ((uint32_t)fields[2] << 8) | fields[3];
+    uint16_t chunk = ((uint16_t)fields[4] << 8) | fields[5];
+
+    if (ctx->bcast_size != 0U && session == ctx->bcast_session) {
+        return;
+    }
+    if (session == 0U || size == 0U || size > BOOT_APP_MAX_SIZE ||
+        chunk == 0U || (chunk & 0x3U) != 0U || chunk > BOOT_BCAST_CHUNK_MAX ||
+        (size + chunk - 1U) / chunk > BOOT_BCAST_MAX_FRAMES) {
+        BOOT_LOG("Broadcast start rejected: size=%lu, chunk=%u\r\n", (unsigned long)size, chunk);
+        return;
     }
 
-    // 写入 flag
-    uint8_t buf[4];
-    buf[0] = (uint8_t)(flag & 0xFFU);
-    buf[1] = (uint8_t)((flag >> 8) & 0xFFU);
-    buf[2] = (uint8_t)((flag >> 16) & 0xFFU);
-    buf[3] = (uint8_t)((flag >> 24) & 0xFFU);
-    status = g_boot_ops->boot_port_flash_write(BOOT_FLAG_ADDR, buf, 4U);
+#if BOOT_CONFIG_ENABLE_FEC
+    ctx->fec_size = 0U;
+#endif
+    ctx->bcast_size = 0U;
+    ctx->unicast_active = false;
+    ctx->download_active = false;
+    ctx->ack_pending = 0U;
+    if (bootloader_prepare_download(ctx) != BOOT_PORT_OK) {
+        ctx->state = BOOT_STATE_IDLE;
+        return;
+    }
+
+    ctx->bcast_session = session;
+    ctx->bcast_size = size;
+    ctx->bcast_chunk = chunk;
+    ctx->bcast_frames = (uint16_t)((size + chunk - 1U) / chunk);
+    ctx->bcast_missing = ctx->bcast_frames;
+    memset(ctx->bcast_bitmap, 0, sizeof(ctx->bcast_bitmap));
+    ctx->state = BOOT_STATE_BROADCAST;
+    BOOT_LOG("Broadcast session %u: %lu bytes, %u frames\r\n",
+             session, (unsigned long)size, ctx->bcast_frames);
+}
+
+/**
+ * @brief 广播数据帧：按帧序号写到 APP 区对应位置，已收到的帧（补发）直接忽略
+ */
+static void bootloader_bcast_data(easy_bootloader_t *ctx, const uint8_t *fields, const uint8_t *data, uint16_t data_len)
+{
+    uint16_t index = ((uint16_t)fields[1] << 8) | fields[2];
+
+    if (ctx->state != BOOT_STATE_BROADCAST || fields[0] != ctx->bcast_session ||
+        index >= ctx->bcast_frames ||
+        (ctx->bcast_bitmap[index >> 3] & (1U << (index & 0x7U))) != 0U) {
+        return;
+    }
+
+    uint32_t offset = (uint32_t)index * ctx->bcast_chunk;
+    uint32_t expect = ctx->bcast_size - offset;
+    if (expect > ctx->bcast_chunk) {
+        expect = ctx->bcast_chunk;
+    }
+    if (data_len != expect) {
+        return;
+    }
+
+    if (bootloader_write_chunk(ctx, BOOT_APP_START_ADDR + offset, data, data_len) != BOOT_PORT_OK) {
+        BOOT_LOG("Broadcast frame %u write failed\r\n", index);
+        return;
+    }
+
+    ctx->bcast_bitmap[index >> 3] |= (uint8_t)(1U << (index & 0x7U));
+    ctx->bcast_missing--;
+    if (ctx->bcast_missing == 0U) {
+        ctx->state = BOOT_STATE_WAIT_FINISH;
+        BOOT_LOG("Broadcast image complete, waiting for finish frame...\r\n");
+    }
+}
+
+static void bootloader_bcast_send_status(easy_bootloader_t *ctx)
+{
+    uint8_t reply[BOOT_BCAST_REPLY_MAX] = {BOOT_FRAME_HEADER0, BOOT_FRAME_HEADER1, BOOT_BCAST_BYTE0, BOOT_BCAST_STATUS_BYTE1};
+    bool active = (ctx->bcast_size != 0U);    // 不在广播会话中时 session、帧数均为 0
+    uint16_t frames = active ? ctx->bcast_frames : 0U;
+    uint16_t missing = active ? ctx->bcast_missing : 0U;
+    uint16_t bitmap_len = (uint16_t)((frames + 7U) / 8U);
+    uint16_t pos = 4U;
+
+    reply[pos++] = ctx->node_addr;
+    reply[pos++] = active ? ctx->bcast_session : 0U;
+    reply[pos++] = (uint8_t)(frames >> 8);
+    reply[pos++] = (uint8_t)frames;
+    reply[pos++] = (uint8_t)(missing >> 8);
+    reply[pos++] = (uint8_t)missing;
+    memcpy(&reply[pos], ctx->bcast_bitmap, bitmap_len);
+    pos += bitmap_len;
+    reply[pos++] = BOOT_FRAME_TAIL0;
+    reply[pos++] = BOOT_FRAME_TAIL1;
+    bootloader_link_write(ctx, reply, pos);
+}
+#endif
+
+#if BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+/**
+ * @brief 写入乱序到达的一帧；帧长为 4 的倍数，只有固件最后一帧可能需要在末尾补 0xFF
+ */
+static boot_port_status_t bootloader_write_chunk(easy_bootloader_t *ctx, uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    uint16_t aligned = len & ~0x3U;
+    boot_port_status_t status = BOOT_PORT_OK;
+    if (aligned > 0U) {
+        status = BOOT_PORT(ctx, boot_port_flash_write)(addr, data, aligned);
+    }
+    if (status == BOOT_PORT_OK && aligned < len) {
+        uint8_t padded[4];
+        memset(padded, 0xFF, sizeof(padded));
+        memcpy(padded, &data[aligned], len - aligned);
+        status = BOOT_PORT(ctx, boot_port_flash_write)(addr + aligned, padded, 4U);
+    }
+    return status;
+}
+
+/**
+ * @brief 乱序写入（广播 / FEC 会话）的固件长度，0 表示按顺序接收、摘要已流式累计
+ */
+static uint32_t bootloader_unordered_size(easy_bootloader_t *ctx)
+{
+#if BOOT_CONFIG_ENABLE_BROADCAST
+    if (ctx->bcast_size != 0U) {
+        return ctx->bcast_size;
+    }
+#endif
+#if BOOT_CONFIG_ENABLE_FEC
+    if (ctx->fec_size != 0U) {
+        return ctx->fec_size;
+    }
+#endif
+    return 0U;
+}
+#endif
+
+#if BOOT_CONFIG_ENABLE_FEC
+/**
+ * @brief 处理缓存头部的一个 FEC 帧（调用方已确认命令码）
+ * @return 要丢弃的字节数；帧未收全时返回 0
+ */
+static uint16_t bootloader_fec_frame(easy_bootloader_t *ctx, const uint8_t *buf, uint16_t len)
+{
+    const uint8_t *body = &buf[BOOT_FRAME_BODY];
+    uint16_t fields_len = BOOT_FEC_START_FIELDS;
+    uint16_t data_len = 0U;
+
+    if (body[1] == BOOT_FEC_DATA_BYTE1) {
+        if (len < BOOT_FRAME_BODY + 2U + BOOT_FEC_DATA_FIELDS) {
+            return 0U;
+        }
+        fields_len = BOOT_FEC_DATA_FIELDS;
+        data_len = ((uint16_t)body[6] << 8) | body[7];
+        if (data_len > BOOT_FEC_CHUNK_MAX) {
+            return BOOT_FRAME_BODY;
+        }
+    }
+
+    uint32_t checksum_pos = BOOT_FRAME_BODY + 2U + fields_len + data_len;
+    uint32_t frame_size = checksum_pos + 4U;
+    if (len < frame_size) {
+        return 0U;
+    }
+
+    uint16_t calc_crc = 0U;
+#if BOOT_CONFIG_ENABLE_ADDRESS
+    calc_crc = buf[2];
+#endif
+    calc_crc = boot_sum16(calc_crc, &buf[BOOT_FRAME_BODY + 2U], checksum_pos - (BOOT_FRAME_BODY + 2U));
+    uint16_t received_crc = ((uint16_t)buf[checksum_pos] << 8) | buf[checksum_pos + 1U];
+    if (calc_crc != received_crc ||
+        buf[checksum_pos + 2U] != BOOT_FRAME_TAIL0 || buf[checksum_pos + 3U] != BOOT_FRAME_TAIL1) {
+        return BOOT_FRAME_BODY;     // 误码帧丢弃，由同组校验帧恢复
+    }
+
+    if (fields_len == BOOT_FEC_START_FIELDS) {
+        bootloader_fec_start(ctx, &body[2]);
+    } else {
+        bootloader_fec_data(ctx, &body[2], &body[2U + BOOT_FEC_DATA_FIELDS], data_len);
+    }
+    return (uint16_t)frame_size;
+}
+
+/**
+ * @brief FEC 启动帧：新会话擦除 APP 区并记下提交所需的摘要；同一会话的重复启动帧忽略
+ */
+static void bootloader_fec_start(easy_bootloader_t *ctx, const uint8_t *fields)
+{
+    uint8_t session = fields[0];
+    uint32_t size = ((uint32_t)fields[1] << 16) | ((uint32_t)fields[2] << 8) | fields[3];
+    uint16_t chunk = ((uint16_t)fields[4] << 8) | fields[5];
+    uint8_t k = fields[6];
+    uint8_t m = fields[7];
+
+    if (ctx->fec_size != 0U && session == ctx->fec_session) {
+        return;
+    }
+    if (session == 0U || size == 0U || size > BOOT_APP_MAX_SIZE ||
+        chunk == 0U || (chunk & 0x3U) != 0U || chunk > BOOT_FEC_CHUNK_MAX ||
+        k == 0U || k > BOOT_FEC_MAX_DATA || m > BOOT_FEC_MAX_PARITY ||
+        (size + chunk - 1U) / chunk > BOOT_FEC_MAX_FRAMES) {
+        BOOT_LOG("FEC start rejected: size=%lu, chunk=%u, k=%u, m=%u\r\n", (unsigned long)size, chunk, k, m);
+        return;
+    }
+
+#if BOOT_CONFIG_ENABLE_BROADCAST
+    ctx->bcast_size = 0U;
+#endif
+    ctx->fec_size = 0U;
+    ctx->unicast_active = false;
+    ctx->download_active = false;
+    ctx->ack_pending = 0U;
+    if (bootloader_prepare_download(ctx) != BOOT_PORT_OK) {
+        ctx->state = BOOT_STATE_IDLE;
+        return;
+    }
+
+    boot_finish_frame_t *finish = &ctx->fec_finish;
+    finish->version = ((uint32_t)fields[8] << 24) | ((uint32_t)fields[9] << 16) |
+                      ((uint32_t)fields[10] << 8) | fields[11];
+    finish->date = ((uint32_t)fields[12] << 24) | ((uint32_t)fields[13] << 16) |
+                   ((uint32_t)fields[14] << 8) | fields[15];
+    memcpy(finish->digest, &fields[16], BOOT_DIGEST_SIZE);
+    memcpy(finish->signature, &fields[16U + BOOT_DIGEST_SIZE], BOOT_SIGNATURE_SIZE);
+    finish->has_digest = true;
+    finish->has_signature = true;
+
+    ctx->fec_session = session;
+    ctx->fec_size = size;
+    ctx->fec_chunk = chunk;
+    ctx->fec_k = k;
+    ctx->fec_m = m;
+    ctx->fec_frames = (uint16_t)((size + chunk - 1U) / chunk);
+    ctx->fec_missing = ctx->fec_frames;
+    ctx->fec_group = BOOT_FEC_NO_GROUP;
+    ctx->fec_parity_mask = 0U;
+    memset(ctx->fec_bitmap, 0, sizeof(ctx->fec_bitmap));
+    ctx->state = BOOT_STATE_FEC;
+    BOOT_LOG("FEC session %u: %lu bytes, %u frames, k=%u, m=%u\r\n",
+             session, (unsigned long)size, ctx->fec_frames, k, m);
+}
+
+/**
+ * @brief FEC 数据/校验帧：数据帧直接写入 Flash，校验帧暂存，每收到一帧尝试恢复当前组
+ * @note  只暂存一组的校验帧，换组时丢弃上一组的校验帧；未能恢复的组由上位机下一轮重发补齐
+ */
+static void bootloader_fec_data(easy_bootloader_t *ctx, const uint8_t *fields, const uint8_t *data, uint16_t data_len)
+{
+    uint16_t group = ((uint16_t)fields[1] << 8) | fields[2];
+    uint8_t row = fields[3];
+    uint32_t first = (uint32_t)group * ctx->fec_k;
+
+    if (ctx->state != BOOT_STATE_FEC || fields[0] != ctx->fec_session ||
+        row >= (uint16_t)ctx->fec_k + ctx->fec_m || first >= ctx->fec_frames) {
+        return;
+    }
+    if (group != ctx->fec_group) {
+        ctx->fec_group = group;
+        ctx->fec_parity_mask = 0U;
+    }
+
+    if (row < ctx->fec_k) {
+        uint32_t index = first + row;
+        if (index >= ctx->fec_frames ||
+            (ctx->fec_bitmap[index >> 3] & (1U << (index & 0x7U))) != 0U) {
+            return;
+        }
+        uint32_t offset = index * ctx->fec_chunk;
+        uint32_t expect = ctx->fec_size - offset;
+        if (expect > ctx->fec_chunk) {
+            expect = ctx->fec_chunk;
+        }
+        if (data_len != expect) {
+            return;
+        }
+        if (bootloader_write_chunk(ctx, BOOT_APP_START_ADDR + offset, data, data_len) != BOOT_PORT_OK) {
+            BOOT_LOG("FEC frame %lu write failed\r\n", (unsigned long)index);
+            return;
+        }
+        ctx->fec_bitmap[index >> 3] |= (uint8_t)(1U << (index & 0x7U));
+        ctx->fec_missing--;
+    } else {
+        if (data_len != ctx->fec_chunk) {
+            return;
+        }
+        uint8_t slot = row - ctx->fec_k;
+        memcpy(ctx->fec_parity[slot], data, data_len);
+        ctx->fec_parity_mask |= (uint8_t)(1U << slot);
+    }
+
+    bootloader_fec_decode(ctx);
+    if (ctx->fec_missing == 0U) {
+        ctx->state = BOOT_STATE_WAIT_FINISH;
+    }
+}
+
+/**
+ * @brief 当前组缺失的数据帧数不超过已暂存的校验帧数时恢复缺失帧
+ * @note  先把已收到的数据帧从 Flash 读回（work_buf 作缓冲）并从校验帧中消去，
+ *        剩下 e 个方程 e 个未知帧，对 e x e 系数矩阵求逆后逐帧算出并写入；RAM 只用暂存的校验帧
+ */
+static void bootloader_fec_decode(easy_bootloader_t *ctx)
+{
+    uint8_t rows[BOOT_FEC_MAX_PARITY];
+    uint8_t cols[BOOT_FEC_MAX_PARITY];
+    uint8_t matrix[BOOT_FEC_MAX_PARITY * BOOT_FEC_MAX_PARITY];
+    uint8_t have = 0U;
+    uint8_t lost = 0U;
+    uint16_t chunk = ctx->fec_chunk;
+    uint32_t first = (uint32_t)ctx->fec_group * ctx->fec_k;
+    uint32_t count = ctx->fec_frames - first;
+    if (count > ctx->fec_k) {
+        count = ctx->fec_k;
+    }
+
+    for (uint8_t r = 0U; r < ctx->fec_m; r++) {
+        if ((ctx->fec_parity_mask & (1U << r)) != 0U) {
+            rows[have++] = r;
+        }
+    }
+    for (uint32_t c = 0U; c < count; c++) {
+        uint32_t index = first + c;
+        if ((ctx->fec_bitmap[index >> 3] & (1U << (index & 0x7U))) == 0U) {
+            if (lost == have) {
+                return;     // 校验帧还不够
+            }
+            cols[lost++] = (uint8_t)c;
+        }
+    }
+    ctx->fec_parity_mask = 0U;    // 以下无论成败都会改写校验帧内容
+    if (lost == 0U) {
+        return;
+    }
+
+    /* 1. 从前 lost 个校验帧中消去已收到的数据帧（最后一帧按 0xFF 补齐） */
+    for (uint32_t c = 0U; c < count; c++) {
+        uint32_t index = first + c;
+        if ((ctx->fec_bitmap[index >> 3] & (1U << (index & 0x7U))) == 0U) {
+            continue;
+        }
+        uint32_t offset = index * chunk;
+        uint32_t len = ctx->fec_size - offset;
+        if (len > chunk) {
+            len = chunk;
+        }
+        memset(&ctx->work_buf[len], 0xFF, chunk - len);
+        if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_APP_START_ADDR + offset, ctx->work_buf, len) != BOOT_PORT_OK) {
+            return;
+        }
+        for (uint8_t i = 0U; i < lost; i++) {
+            boot_fec_mul_add(ctx->fec_parity[rows[i]], ctx->work_buf,
+                             boot_fec_coef(rows[i], (uint8_t)c), chunk);
+        }
+    }
+
+    /* 2. 缺失帧的系数矩阵求逆（柯西矩阵的方阵子块总是可逆） */
+    for (uint8_t i = 0U; i < lost; i++) {
+        for (uint8_t j = 0U; j < lost; j++) {
+            matrix[i * lost + j] = boot_fec_coef(rows[i], cols[j]);
+        }
+    }
+    if (!boot_fec_invert(matrix, lost)) {
+        return;
+    }
+
+    /* 3. 缺失帧 j = Σ inv[j][i] * 消元后的校验帧 i */
+    for (uint8_t j = 0U; j < lost; j++) {
+        uint32_t index = first + cols[j];
+        uint32_t offset = index * chunk;
+        uint32_t len = ctx->fec_size - offset;
+        if (len > chunk) {
+            len = chunk;
+        }
+        memset(ctx->work_buf, 0, chunk);
+        for (uint8_t i = 0U; i < lost; i++) {
+            boot_fec_mul_add(ctx->work_buf, ctx->fec_parity[rows[i]], matrix[j * lost + i], chunk);
+        }
+        if (bootloader_write_chunk(ctx, BOOT_APP_START_ADDR + offset, ctx->work_buf, (uint16_t)len) != BOOT_PORT_OK) {
+            BOOT_LOG("FEC frame %lu write failed\r\n", (unsigned long)index);
+            return;
+        }
+        ctx->fec_bitmap[index >> 3] |= (uint8_t)(1U << (index & 0x7U));
+        ctx->fec_missing--;
+    }
+}
+
+/**
+ * @brief FEC 会话收齐后按启动帧中的摘要（及签名）校验并提交，成功时复位
+ */
+static void bootloader_fec_commit(easy_bootloader_t *ctx)
+{
+    BOOT_LOG("FEC image complete, verifying...\r\n");
+    if (bootloader_handle_finish_frame(ctx, &ctx->fec_finish) != BOOT_PORT_OK) {
+        /* 误码帧恰好通过了累加和校验，整个会话作废，下一轮启动帧到来时重新擦除接收 */
+        BOOT_LOG("FEC image rejected, waiting for the session to restart\r\n");
+        bootloader_reset_context(ctx);
+    }
+}
+#endif
+
+/**
+ * @brief 丢弃缓存头部的无关字节，直到缓存以（发给本节点的）帧头开始
+ * @param min_len 候选帧至少需要的字节数
+ * @return 缓存头部是候选帧且已收到 min_len 字节时返回 true
+ * @note  地址模式下，地址不符的帧在这里直接跳过，不进入校验和循环；总线扫描探测帧在这里应答
+ */
+static bool bootloader_seek_frame(easy_bootloader_t *ctx, uint16_t min_len)
+{
+    for (;;) {
+        const uint8_t *buf = ctx->rx_cache;
+        uint16_t len = ctx->rx_cache_len;
+
+        /* 先定位下一个帧头再一次性前移，避免逐字节 memmove */
+        uint16_t pos = 0U;
+        while (pos + 1U < len && (buf[pos] != BOOT_FRAME_HEADER0 || buf[pos + 1U] != BOOT_FRAME_HEADER1)) {
+            pos++;
+        }
+        if (pos > 0U) {
+            bootloader_consume_cache(ctx, pos);
+            len = ctx->rx_cache_len;
+        }
+
+#if BOOT_CONFIG_ENABLE_FEC
+        if (len < BOOT_FRAME_BODY + 2U) {
+            return false;
+        }
+        if (buf[BOOT_FRAME_BODY] == BOOT_FEC_BYTE0 &&
+            (buf[BOOT_FRAME_BODY + 1U] == BOOT_FEC_START_BYTE1 || buf[BOOT_FRAME_BODY + 1U] == BOOT_FEC_DATA_BYTE1)
+#if BOOT_CONFIG_ENABLE_ADDRESS
+            && (buf[2] == BOOT_FEC_BCAST_ADDR || buf[2] == ctx->node_addr)
+#endif
+            ) {
+            uint16_t used = bootloader_fec_frame(ctx, buf, len);
+            if (used == 0U) {
+                return false;
+            }
+            bootloader_consume_cache(ctx, used);
+            continue;
+        }
+#endif
+
+#if BOOT_CONFIG_ENABLE_ADDRESS
+        if (len <= BOOT_FRAME_BODY) {
+            return false;
+        }
+#if BOOT_CONFIG_ENABLE_BROADCAST
+        if (buf[2] == BOOT_BCAST_ADDR) {
+            uint16_t used = bootloader_bcast_frame(ctx, buf, len);
+            if (used == 0U) {
+                return false;
+            }
+            bootloader_consume_cache(ctx, used);
+            continue;
+        }
+#endif
+        if (buf[2] != ctx->node_addr) {
+            bootloader_consume_cache(ctx, bootloader_foreign_frame_size(buf, len));
+            continue;
+        }
+        if (len < BOOT_SCAN_LEN) {
+            return false;
+        }
+        if (buf[3] == BOOT_SCAN_BYTE0 && buf[4] == BOOT_SCAN_BYTE1 &&
+            buf[5] == BOOT_FRAME_TAIL0 && buf[6] == BOOT_FRAME_TAIL1) {
+            bootloader_consume_cache(ctx, BOOT_SCAN_LEN);
+            bootloader_send_scan_reply(ctx);
+            continue;
+        }
+#if BOOT_CONFIG_ENABLE_BROADCAST
+        if (buf[3] == BOOT_BCAST_BYTE0 && buf[4] == BOOT_BCAST_STATUS_BYTE1 &&
+            buf[5] == BOOT_FRAME_TAIL0 && buf[6] == BOOT_FRAME_TAIL1) {
+            bootloader_consume_cache(ctx, BOOT_BCAST_STATUS_LEN);
+            bootloader_bcast_send_status(ctx);
+            continue;
+        }
+#endif
+#endif
+        return len >= min_len;
+    }
+}
+
+/**
+ * @brief 校验 buf 开头的一个数据帧（帧头已确认）
+ * @return 帧长；数据不足返回 0；长度、校验或帧尾错误返回 -1
+ */
+static int32_t bootloader_check_frame(const uint8_t *buf, uint32_t len, uint32_t *remaining, uint16_t *payload_len)
+{
+    uint16_t packet_len = ((uint16_t)buf[BOOT_FRAME_BODY + 3U] << 8) | buf[BOOT_FRAME_BODY + 4U];
+    if (packet_len > BOOT_PAYLOAD_MAX_SIZE) {
+        return -1;
+    }
+
+    uint32_t frame_size = BOOT_FRAME_FIXED_SIZE + packet_len;
+    if (len < frame_size) {
+        return 0;
+    }
+
+    uint32_t checksum_pos = BOOT_FRAME_BODY + 5U + packet_len;
+    uint32_t tail_pos = checksum_pos + 2U;
+    uint16_t received_crc = ((uint16_t)buf[checksum_pos] << 8) | buf[checksum_pos + 1U];
+    uint16_t calc_crc = 0U;
+#if BOOT_CONFIG_ENABLE_ADDRESS
+    calc_crc = buf[2];      // 地址字节参与校验，误码不会让帧落到别的节点
+#endif
+    calc_crc = boot_sum16(calc_crc, &buf[BOOT_FRAME_BODY + 3U], packet_len + 2U);
+
+    if (calc_crc != received_crc ||
+        buf[tail_pos] != BOOT_FRAME_TAIL0 ||
+        buf[tail_pos + 1U] != BOOT_FRAME_TAIL1) {
+        return -1;
+    }
+
+    *remaining = ((uint32_t)buf[BOOT_FRAME_BODY] << 16) | ((uint32_t)buf[BOOT_FRAME_BODY + 1U] << 8) |
+                 buf[BOOT_FRAME_BODY + 2U];
+    *payload_len = packet_len;
+    return (int32_t)frame_size;
+}
+
+/**
+ * @brief 校验缓存头部的数据帧
+ * @return 帧长，数据位于 rx_cache[BOOT_FRAME_BODY + 5] 起，由调用方处理后消费；没有完整帧时返回 0
+ */
+static uint16_t bootloader_try_extract_frame(easy_bootloader_t *ctx, uint32_t *remaining, uint16_t *payload_len)
+{
+    //寻找帧头
+    while (bootloader_seek_frame(ctx, BOOT_FRAME_FIXED_SIZE)) {
+        int32_t frame_size = bootloader_check_frame(ctx->rx_cache, ctx->rx_cache_len,
+                                                    remaining, payload_len);
+        if (frame_size == 0) {
+            return 0U;
+        }
+        if (frame_size < 0) {
+            bootloader_consume_cache(ctx, 2U);
+            continue;
+        }
+        return (uint16_t)frame_size;
+    }
+
+    return 0U;
+}
+
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+/* 接收环中一段数据的视图：最多两段连续区域，第二段为回绕到环起点后的部分 */
+typedef struct {
+    const uint8_t *seg[2];
+    uint32_t len[2];
+} boot_rx_view_t;
+
+static uint8_t bootloader_view_byte(const boot_rx_view_t *view, uint32_t idx)
+{
+    return (idx < view->len[0]) ? view->seg[0][idx] : view->seg[1][idx - view->len[0]];
+}
+
+/**
+ * @brief 取视图中 [pos, pos + len) 的部分（调用方保证不越界）
+ */
+static void bootloader_view_slice(const boot_rx_view_t *view, uint32_t pos, uint32_t len, boot_rx_view_t *part)
+{
+    if (pos >= view->len[0]) {
+        part->seg[0] = &view->seg[1][pos - view->len[0]];
+        part->len[0] = len;
+        part->seg[1] = NULL;
+        part->len[1] = 0U;
+        return;
+    }
+
+    uint32_t first = view->len[0] - pos;
+    if (first > len) {
+        first = len;
+    }
+    part->seg[0] = &view->seg[0][pos];
+    part->len[0] = first;
+    part->seg[1] = view->seg[1];
+    part->len[1] = len - first;
+}
+
+/**
+ * @brief 接收环直通：在移植层的 DMA 接收环中查找数据帧，校验通过后直接从环中写入 Flash，
+ *        帧跨过环末尾时分两段写入；处理完才释放，释放时发现数据已被覆盖则放弃本次接收
+ */
+static void bootloader_poll_ring(easy_bootloader_t *ctx)
+{
+    while (ctx->state != BOOT_STATE_WAIT_FINISH) {
+        boot_rx_view_t view;
+        view.len[0] = BOOT_PORT(ctx, boot_port_rx_peek)(0U, &view.seg[0]);
+        if (view.len[0] == 0U) {
+            return;
+        }
+        view.len[1] = BOOT_PORT(ctx, boot_port_rx_peek)(view.len[0], &view.seg[1]);
+        uint32_t len = view.len[0] + view.len[1];
+
+        /* 丢弃帧头之前的无关字节 */
+        uint32_t pos = 0U;
+        while (pos + 1U < len && (bootloader_view_byte(&view, pos) != BOOT_FRAME_HEADER0 ||
+                                  bootloader_view_byte(&view, pos + 1U) != BOOT_FRAME_HEADER1)) {
+            pos++;
+        }
+        if (pos > 0U) {
+            (void)BOOT_PORT(ctx, boot_port_rx_consume)(pos);
+            continue;
+        }
+        if (len < BOOT_FRAME_FIXED_SIZE) {
+            return;
+        }
+
+        uint16_t packet_len = ((uint16_t)bootloader_view_byte(&view, BOOT_FRAME_BODY + 3U) << 8) |
+                              bootloader_view_byte(&view, BOOT_FRAME_BODY + 4U);
+        if (packet_len > BOOT_PAYLOAD_MAX_SIZE) {
+            (void)BOOT_PORT(ctx, boot_port_rx_consume)(2U);
+            continue;
+        }
+        uint32_t frame_size = BOOT_FRAME_FIXED_SIZE + packet_len;
+        if (len < frame_size) {
+            return;
+        }
+
+        /* 校验和为数据长度与数据各字节的累加和 */
+        boot_rx_view_t part;
+        uint32_t checksum_pos = BOOT_FRAME_BODY + 5U + packet_len;
+        uint16_t calc_crc = 0U;
+        bootloader_view_slice(&view, BOOT_FRAME_BODY + 3U, packet_len + 2U, &part);
+        for (uint32_t i = 0U; i < 2U; i++) {
+            calc_crc = boot_sum16(calc_crc, part.seg[i], part.len[i]);
+        }
+        uint16_t received_crc = ((uint16_t)bootloader_view_byte(&view, checksum_pos) << 8) |
+                                bootloader_view_byte(&view, checksum_pos + 1U);
+        if (calc_crc != received_crc ||
+            bootloader_view_byte(&view, checksum_pos + 2U) != BOOT_FRAME_TAIL0 ||
+            bootloader_view_byte(&view, checksum_pos + 3U) != BOOT_FRAME_TAIL1) {
+            (void)BOOT_PORT(ctx, boot_port_rx_consume)(2U);
+            continue;
+        }
+
+        uint32_t remaining = ((uint32_t)bootloader_view_byte(&view, BOOT_FRAME_BODY) << 16) |
+                             ((uint32_t)bootloader_view_byte(&view, BOOT_FRAME_BODY + 1U) << 8) |
+                             bootloader_view_byte(&view, BOOT_FRAME_BODY + 2U);
+        bootloader_view_slice(&view, BOOT_FRAME_BODY + 5U, packet_len, &part);
+        boot_port_status_t status = bootloader_handle_payload(ctx, remaining, part.seg[0], (uint16_t)part.len[0],
+                                                              part.seg[1], (uint16_t)part.len[1]);
+        if (BOOT_PORT(ctx, boot_port_rx_consume)(frame_size) != BOOT_PORT_OK) {
+            /* 写入期间 DMA 追上了读位置，写进 Flash 的数据不可信，等待上位机重新开始 */
+            BOOT_LOG("RX ring overrun, resetting state\r\n");
+            bootloader_reset_context(ctx);
+            return;
+        }
+        if (status != BOOT_PORT_OK) {
+            BOOT_LOG("bootloader handle payload failed, resetting state\r\n");
+            bootloader_reset_context(ctx);
+            return;
+        }
+        bootloader_ack_released(ctx);
+    }
+}
+#else
+
+/**
+ * @brief 零拷贝接收：链路包恰好是一个完整数据帧时直接在 DMA 缓冲区中校验并写入，
+ *        其余情况（完成帧、命令帧、跨包的帧）拷入线性缓存走原解析路径
+ */
+static void bootloader_poll_direct(easy_bootloader_t *ctx)
+{
+    const uint8_t *packet;
+    uint32_t len;
+
+    while (ctx->rx_cache_len == 0U && ctx->state != BOOT_STATE_WAIT_FINISH &&
+           (len = BOOT_PORT(ctx, boot_port_data_peek)(&packet)) > 0U) {
+        uint32_t remaining = 0U;
+        uint16_t payload_len = 0U;
+
+        if (len >= BOOT_FRAME_FIXED_SIZE &&
+            packet[0] == BOOT_FRAME_HEADER0 && packet[1] == BOOT_FRAME_HEADER1 &&
+#if BOOT_CONFIG_ENABLE_ADDRESS
+            packet[2] == ctx->node_addr &&
+#endif
+            bootloader_check_frame(packet, len, &remaining, &payload_len) == (int32_t)len) {
+            boot_port_status_t status = bootloader_handle_payload(ctx, remaining, &packet[BOOT_FRAME_BODY + 5U], payload_len,
+                                                                  NULL, 0U);
+            BOOT_PORT(ctx, boot_port_data_release)();
+            if (status != BOOT_PORT_OK) {
+                BOOT_LOG("bootloader handle payload failed, resetting state\r\n");
+                bootloader_reset_context(ctx);
+                return;
+            }
+            bootloader_ack_released(ctx);
+            continue;
+        }
+
+        if (len <= sizeof(ctx->rx_cache)) {
+            memcpy(ctx->rx_cache, packet, len);
+            ctx->rx_cache_len = (uint16_t)len;
+        }
+        BOOT_PORT(ctx, boot_port_data_release)();
+    }
+}
+#endif
+
+/**
+ * @brief 擦除并重写标志位区
+ * @note  flag 字最后写入，作为提交点：之前任何一步掉电，flag 都还是擦除值，上电后停在 Bootloader。
+ *        启用签名且 digest 非空时，摘要、签名与校验结果在 flag 之前写入
+ */
+static boot_port_status_t bootloader_write_flag_region(easy_bootloader_t *ctx, uint32_t flag, uint32_t version, uint32_t date,
+                                                       const uint8_t *digest, const uint8_t *signature)
+{
+    // 先擦除标志位区
+    boot_port_status_t status = ctx->ops->boot_port_flash_erase(BOOT_FLAG_REGION_ADDR, BOOT_FLAG_REGION_SIZE);
     if (status != BOOT_PORT_OK) {
+        BOOT_LOG("Erase flag region failed\r\n");
         return status;
     }
 
     // 写入 version
+    uint8_t buf[4];
     buf[0] = (uint8_t)(version & 0xFFU);
     buf[1] = (uint8_t)((version >> 8) & 0xFFU);
     buf[2] = (uint8_t)((version >> 16) & 0xFFU);
     buf[3] = (uint8_t)((version >> 24) & 0xFFU);
-    status = g_boot_ops->boot_port_flash_write(BOOT_VERSION_ADDR, buf, 4U);
+    status = BOOT_PORT(ctx, boot_port_flash_write)(BOOT_VERSION_ADDR, buf, 4U);
     if (status != BOOT_PORT_OK) {
         return status;
     }
@@ -403,180 +1712,662 @@ static boot_port_status_t bootloader_write_flag_region(uint32_t flag, uint32_t v
     buf[1] = (uint8_t)((date >> 8) & 0xFFU);
     buf[2] = (uint8_t)((date >> 16) & 0xFFU);
     buf[3] = (uint8_t)((date >> 24) & 0xFFU);
-    return g_boot_ops->boot_port_flash_write(BOOT_DATE_ADDR, buf, 4U);
+    status = BOOT_PORT(ctx, boot_port_flash_write)(BOOT_DATE_ADDR, buf, 4U);
+    if (status != BOOT_PORT_OK) {
+        return status;
+    }
+
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    if (digest != NULL) {
+        status = bootloader_write_sign_trailer(ctx, digest, signature);
+        if (status != BOOT_PORT_OK) {
+            BOOT_LOG("Failed to write signature trailer\r\n");
+            return status;
+        }
+    }
+#else
+    (void)digest;
+    (void)signature;
+#endif
+
+    // 最后写入 flag
+    buf[0] = (uint8_t)(flag & 0xFFU);
+    buf[1] = (uint8_t)((flag >> 8) & 0xFFU);
+    buf[2] = (uint8_t)((flag >> 16) & 0xFFU);
+    buf[3] = (uint8_t)((flag >> 24) & 0xFFU);
+    return BOOT_PORT(ctx, boot_port_flash_write)(BOOT_FLAG_ADDR, buf, 4U);
+}
+
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+static boot_port_status_t bootloader_write_sign_trailer(easy_bootloader_t *ctx, const uint8_t *digest, const uint8_t *signature)
+{
+    // 标志位区已在 bootloader_write_flag_region 中擦除，这里直接写入；校验结果字在摘要与签名之后写入
+    boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_write)(BOOT_DIGEST_ADDR, digest, BOOT_DIGEST_SIZE);
+    if (status != BOOT_PORT_OK) {
+        return status;
+    }
+
+    status = BOOT_PORT(ctx, boot_port_flash_write)(BOOT_SIGNATURE_ADDR, signature, BOOT_SIGNATURE_SIZE);
+    if (status != BOOT_PORT_OK) {
+        return status;
+    }
+
+    // 写入签名校验结果
+    uint8_t buf[4];
+    buf[0] = (uint8_t)(BOOT_SIGN_STATE_VERIFIED & 0xFFU);
+    buf[1] = (uint8_t)((BOOT_SIGN_STATE_VERIFIED >> 8) & 0xFFU);
+    buf[2] = (uint8_t)((BOOT_SIGN_STATE_VERIFIED >> 16) & 0xFFU);
+    buf[3] = (uint8_t)((BOOT_SIGN_STATE_VERIFIED >> 24) & 0xFFU);
+    return BOOT_PORT(ctx, boot_port_flash_write)(BOOT_SIGN_STATE_ADDR, buf, 4U);
+}
+
+static bool bootloader_verify_signature(easy_bootloader_t *ctx, const uint8_t *digest, const uint8_t *signature)
+{
+    static const uint8_t sign_public_key[BOOT_ED25519_PUBLIC_KEY_SIZE] = BOOT_SIGN_PUBLIC_KEY;
+    (void)ctx;
+#if BOOT_CONFIG_ENABLE_PROFILE && BOOT_CONFIG_ENABLE_LOG
+    uint32_t verify_start = bootloader_cycle_get();
+#endif
+    bool sign_valid = boot_ed25519_verify(signature, digest, BOOT_DIGEST_SIZE, sign_public_key);
+#if BOOT_CONFIG_ENABLE_PROFILE && BOOT_CONFIG_ENABLE_LOG
+    BOOT_LOG("Signature check took %lu cycles\r\n", (unsigned long)(bootloader_cycle_get() - verify_start));
+#endif
+    return sign_valid;
+}
+#endif
+
+#if BOOT_CONFIG_ENABLE_STAGING
+/**
+ * @brief 安装暂存区固件
+ * @note  先校验暂存区摘要（及签名），再按擦除单元复制到主区并整体回读校验，最后写标志位区
+ *        （同时擦掉暂存记录与安装进度）作为提交点。复制过程中掉电时记录仍在，下次上电从进度处继续
+ */
+static void bootloader_install_staged(easy_bootloader_t *ctx)
+{
+    boot_staging_record_t record;
+    uint8_t calc_digest[BOOT_SHA256_DIGEST_SIZE];
+
+    if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_STAGING_RECORD_ADDR, (uint8_t *)&record, sizeof(record)) != BOOT_PORT_OK ||
+        record.magic != BOOT_STAGING_MAGIC) {
+        return;
+    }
+
+    BOOT_LOG("Staged image found: size=%lu, ver=0x%08X\r\n", (unsigned long)record.size, record.version);
+
+#if BOOT_CONFIG_ENABLE_PROFILE
+    uint32_t hash_start = bootloader_cycle_get();   // 摘要耗时，用于比较 ops.flash_read_start 异步读取的效果
+#endif
+    if (record.size == 0U || record.size > BOOT_STAGING_SIZE || record.size > BOOT_APP_MAX_SIZE ||
+        bootloader_hash_region(ctx, BOOT_STAGING_ADDR, record.size, calc_digest) != BOOT_PORT_OK ||
+        memcmp(calc_digest, record.digest, BOOT_SHA256_DIGEST_SIZE) != 0) {
+        BOOT_LOG("Staged image invalid, discarded\r\n");
+        bootloader_discard_staged(ctx);
+        return;
+    }
+#if BOOT_CONFIG_ENABLE_PROFILE
+    BOOT_LOG("Staged digest: %lu cycles/KB\r\n",
+             (unsigned long)((bootloader_cycle_get() - hash_start) / ((record.size + 1023U) / 1024U)));
+    (void)hash_start;   // 关闭日志时未使用
+#endif
+
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    if (!bootloader_verify_signature(ctx, calc_digest, record.signature)) {
+        BOOT_LOG("Staged image signature invalid, discarded\r\n");
+        bootloader_discard_staged(ctx);
+        return;
+    }
+#endif
+
+    BOOT_LOG("Installing staged image...\r\n");
+    if (bootloader_install_copy(ctx, record.size) != BOOT_PORT_OK) {
+        ctx->boot_flag = BOOT_FLAG_BOOTLOADER;
+        return;
+    }
+
+    /* 整体回读确认，失败时保留暂存记录，停在 Bootloader */
+    if (bootloader_hash_region(ctx, BOOT_APP_START_ADDR, record.size, calc_digest) != BOOT_PORT_OK ||
+        memcmp(calc_digest, record.digest, BOOT_SHA256_DIGEST_SIZE) != 0) {
+        BOOT_LOG("Installed image verify failed\r\n");
+        ctx->boot_flag = BOOT_FLAG_BOOTLOADER;
+        return;
+    }
+
+    if (bootloader_write_flag_region(ctx, BOOT_FLAG_APP, record.version, record.date,
+                                     record.digest, record.signature) != BOOT_PORT_OK) {
+        BOOT_LOG("Failed to write flag region\r\n");
+        ctx->boot_flag = BOOT_FLAG_BOOTLOADER;
+        return;
+    }
+
+    BOOT_LOG("Staged image installed: ver=0x%08X, date=0x%08X\r\n", record.version, record.date);
+    bootloader_read_flag_region(ctx);
+}
+
+/**
+ * @brief 丢弃无效的暂存记录，主区标志位（及已校验的签名尾部）原样写回
+ */
+static void bootloader_discard_staged(easy_bootloader_t *ctx)
+{
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    uint8_t digest[BOOT_DIGEST_SIZE];
+    uint8_t signature[BOOT_SIGNATURE_SIZE];
+    bool keep_trailer = (ctx->sign_state == BOOT_SIGN_STATE_VERIFIED) &&
+                        BOOT_PORT(ctx, boot_port_flash_read)(BOOT_DIGEST_ADDR, digest, sizeof(digest)) == BOOT_PORT_OK &&
+                        BOOT_PORT(ctx, boot_port_flash_read)(BOOT_SIGNATURE_ADDR, signature, sizeof(signature)) == BOOT_PORT_OK;
+    boot_port_status_t status = bootloader_write_flag_region(ctx, ctx->boot_flag, ctx->app_version, ctx->update_date,
+                                                             keep_trailer ? digest : NULL, signature);
+#else
+    boot_port_status_t status = bootloader_write_flag_region(ctx, ctx->boot_flag, ctx->app_version, ctx->update_date,
+                                                             NULL, NULL);
+#endif
+    if (status != BOOT_PORT_OK) {
+        BOOT_LOG("Failed to clear staging record\r\n");
+        ctx->boot_flag = BOOT_FLAG_BOOTLOADER;
+        return;
+    }
+    bootloader_read_flag_region(ctx);
+}
+
+/**
+ * @brief 按擦除单元把暂存区复制到主区
+ * @note  每个单元先比较内容，相同则不擦不写；不同则整单元擦除、经 RAM 缓冲复制、回读比较，
+ *        通过后写入进度字。掉电重启后已完成单元直接跳过，未完成单元靠比较结果重做
+ */
+static boot_port_status_t bootloader_install_copy(easy_bootloader_t *ctx, uint32_t image_size)
+{
+    uint32_t image_len = (image_size + 3U) & ~0x3U;
+    uint32_t unit_index = 0U;
+    uint32_t erased_units = 0U;
+    uint32_t erased_bytes = 0U;
+    uint32_t skipped_units = 0U;
+    uint32_t blank_units = 0U;
+    uint32_t start_tick = BOOT_PORT_HAS(ctx, get_tick) ? BOOT_PORT(ctx, get_tick)() : 0U;
+    const uint32_t chunk_max = BOOT_WORK_BUF_SIZE;
+
+    for (uint32_t offset = 0U; offset < image_len; unit_index++) {
+        uint32_t app_addr = BOOT_APP_START_ADDR + offset;
+        uint32_t unit = BOOT_APP_MAX_SIZE - offset;   // 未提供擦除单元时整段作为一个单元
+        if (ctx->ops->boot_port_flash_erase_unit != NULL) {
+            unit = ctx->ops->boot_port_flash_erase_unit(app_addr);
+        }
+        if (unit == 0U || unit > BOOT_APP_MAX_SIZE - offset) {
+            BOOT_LOG("Bad erase unit at 0x%08X\r\n", app_addr);
+            return BOOT_PORT_ERROR;
+        }
+        uint32_t len = image_len - offset;
+        if (len > unit) {
+            len = unit;
+        }
+
+        uint32_t progress_addr = BOOT_INSTALL_PROGRESS_ADDR + unit_index * 4U;
+        uint32_t progress = BOOT_FLAG_ERASED;
+        if (unit_index < BOOT_INSTALL_PROGRESS_COUNT) {
+            (void)BOOT_PORT(ctx, boot_port_flash_read)(progress_addr, (uint8_t *)&progress, 4U);
+        }
+
+        bool same = (progress == BOOT_INSTALL_UNIT_DONE);
+        if (!same && bootloader_compare_region(ctx, BOOT_STAGING_ADDR + offset, app_addr, len, &same) != BOOT_PORT_OK) {
+            return BOOT_PORT_ERROR;
+        }
+
+        if (same) {
+            skipped_units++;
+        } else {
+            /* 整单元仍是擦除值（旧固件没有用到的单元）时省掉擦除，F407 大扇区擦除要 1~2 秒 */
+            bool blank = false;
+            if (bootloader_check_erased(ctx, app_addr, unit, &blank) != BOOT_PORT_OK) {
+                return BOOT_PORT_ERROR;
+            }
+            if (blank) {
+                blank_units++;
+            } else if (ctx->ops->boot_port_flash_erase(app_addr, unit) != BOOT_PORT_OK) {
+                BOOT_LOG("Erase failed at 0x%08X\r\n", app_addr);
+                return BOOT_PORT_ERROR;
+            } else {
+                erased_units++;
+                erased_bytes += unit;
+            }
+
+            for (uint32_t pos = 0U; pos < len; pos += chunk_max) {
+                uint32_t chunk = len - pos;
+                if (chunk > chunk_max) {
+                    chunk = chunk_max;
+                }
+                if (BOOT_PORT(ctx, boot_port_flash_read)(BOOT_STAGING_ADDR + offset + pos, ctx->work_buf, chunk) != BOOT_PORT_OK ||
+                    BOOT_PORT(ctx, boot_port_flash_write)(app_addr + pos, ctx->work_buf, chunk) != BOOT_PORT_OK) {
+                    BOOT_LOG("Copy failed at 0x%08X\r\n", app_addr + pos);
+                    return BOOT_PORT_ERROR;
+                }
+            }
+
+            if (bootloader_compare_region(ctx, BOOT_STAGING_ADDR + offset, app_addr, len, &same) != BOOT_PORT_OK || !same) {
+                BOOT_LOG("Verify failed at 0x%08X\r\n", app_addr);
+                return BOOT_PORT_ERROR;
+            }
+        }
+
+        if (unit_index < BOOT_INSTALL_PROGRESS_COUNT && progress != BOOT_INSTALL_UNIT_DONE) {
+            uint8_t buf[4];
+            buf[0] = (uint8_t)(BOOT_INSTALL_UNIT_DONE & 0xFFU);
+            buf[1] = (uint8_t)((BOOT_INSTALL_UNIT_DONE >> 8) & 0xFFU);
+            buf[2] = (uint8_t)((BOOT_INSTALL_UNIT_DONE >> 16) & 0xFFU);
+            buf[3] = (uint8_t)((BOOT_INSTALL_UNIT_DONE >> 24) & 0xFFU);
+            (void)BOOT_PORT(ctx, boot_port_flash_write)(progress_addr, buf, 4U);
+        }
+        offset += unit;
+    }
+
+    BOOT_LOG("Install copy: %lu ms, erased %lu units (%lu bytes), blank %lu units, skipped %lu units\r\n",
+             (unsigned long)(BOOT_PORT_HAS(ctx, get_tick) ? (BOOT_PORT(ctx, get_tick)() - start_tick) : 0U),
+             (unsigned long)erased_units, (unsigned long)erased_bytes, (unsigned long)blank_units,
+             (unsigned long)skipped_units);
+    (void)start_tick;   // 关闭日志时未使用
+    return BOOT_PORT_OK;
+}
+
+/**
+ * @brief 比较两段 Flash，work_buf 前后两半分别作为两段的读缓冲
+ */
+static boot_port_status_t bootloader_compare_region(easy_bootloader_t *ctx, uint32_t addr_a, uint32_t addr_b, uint32_t len, bool *same)
+{
+    const uint32_t half = BOOT_WORK_BUF_SIZE / 2U;
+    uint8_t *buf_a = ctx->work_buf;
+    uint8_t *buf_b = &ctx->work_buf[half];
+
+    *same = true;
+    for (uint32_t pos = 0U; pos < len; pos += half) {
+        uint32_t chunk = len - pos;
+        if (chunk > half) {
+            chunk = half;
+        }
+        boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_read)(addr_a + pos, buf_a, chunk);
+        if (status == BOOT_PORT_OK) {
+            status = BOOT_PORT(ctx, boot_port_flash_read)(addr_b + pos, buf_b, chunk);
+        }
+        if (status != BOOT_PORT_OK) {
+            return status;
+        }
+        if (memcmp(buf_a, buf_b, chunk) != 0) {
+            *same = false;
+            return BOOT_PORT_OK;
+        }
+    }
+    return BOOT_PORT_OK;
+}
+
+static bool bootloader_erased_chunk(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    return boot_is_erased(data, len, BOOT_FLAG_ERASED);
+}
+
+/**
+ * @brief 检查一段 Flash 是否全部为擦除值
+ */
+static boot_port_status_t bootloader_check_erased(easy_bootloader_t *ctx, uint32_t addr, uint32_t len, bool *erased)
+{
+    return bootloader_scan_region(ctx, addr, len, bootloader_erased_chunk, erased);
+}
+
+#endif
+
+#if BOOT_CONFIG_ENABLE_STAGING || BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+/**
+ * @brief 从 pos 起同步分块读取 [addr, addr + len) 交给 fn 处理
+ */
+static boot_port_status_t bootloader_scan_sync(easy_bootloader_t *ctx, uint32_t addr, uint32_t pos, uint32_t len,
+                                               boot_chunk_fn_t fn, bool *complete)
+{
+    for (; pos < len; pos += BOOT_WORK_BUF_SIZE) {
+        uint32_t chunk = len - pos;
+        if (chunk > BOOT_WORK_BUF_SIZE) {
+            chunk = BOOT_WORK_BUF_SIZE;
+        }
+        boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_read)(addr + pos, ctx->work_buf, chunk);
+        if (status != BOOT_PORT_OK) {
+            return status;
+        }
+        if (!fn(ctx, ctx->work_buf, chunk)) {
+            return BOOT_PORT_OK;
+        }
+    }
+    *complete = true;
+    return BOOT_PORT_OK;
+}
+
+/**
+ * @brief 分块读取一段 Flash 交给 fn 处理，借用 work_buf 作为读缓冲
+ * @note  提供异步读取时 work_buf 前后两半交替使用，fn 处理当前块的同时读取下一块；返回前等在途读取结束。
+ *        移植层拒绝发起（如 work_buf 被链接到 DMA 访问不到的 CCM）或传输出错时，从未处理的位置起改为同步读取。
+ *        *complete 为 false 表示 fn 提前结束
+ */
+static boot_port_status_t bootloader_scan_region(easy_bootloader_t *ctx, uint32_t addr, uint32_t len,
+                                                 boot_chunk_fn_t fn, bool *complete)
+{
+    const uint32_t half = BOOT_WORK_BUF_SIZE / 2U;
+
+    *complete = false;
+    if (ctx->ops->boot_port_flash_read_start == NULL || ctx->ops->boot_port_flash_read_wait == NULL || len == 0U) {
+        return bootloader_scan_sync(ctx, addr, 0U, len, fn, complete);
+    }
+
+    uint8_t *cur = ctx->work_buf;
+    uint8_t *next = &ctx->work_buf[half];
+    uint32_t chunk = (len > half) ? half : len;
+    uint32_t pos = 0U;
+    if (ctx->ops->boot_port_flash_read_start(addr, cur, chunk) != BOOT_PORT_OK) {
+        BOOT_LOG("Async flash read refused, using sync read\r\n");
+        return bootloader_scan_sync(ctx, addr, 0U, len, fn, complete);
+    }
+    while (pos < len) {
+        if (ctx->ops->boot_port_flash_read_wait() != BOOT_PORT_OK) {
+            BOOT_LOG("Async flash read failed at 0x%08X, using sync read\r\n", addr + pos);
+            return bootloader_scan_sync(ctx, addr, pos, len, fn, complete);
+        }
+
+        uint32_t next_pos = pos + chunk;
+        uint32_t next_chunk = len - next_pos;
+        if (next_chunk > half) {
+            next_chunk = half;
+        }
+        bool pending = false;
+        if (next_pos < len) {
+            pending = (ctx->ops->boot_port_flash_read_start(addr + next_pos, next, next_chunk) == BOOT_PORT_OK);
+        }
+
+        if (!fn(ctx, cur, chunk)) {
+            if (pending) {
+                (void)ctx->ops->boot_port_flash_read_wait();
+            }
+            return BOOT_PORT_OK;
+        }
+        if (next_pos < len && !pending) {
+            return bootloader_scan_sync(ctx, addr, next_pos, len, fn, complete);
+        }
+
+        uint8_t *done = cur;
+        cur = next;
+        next = done;
+        pos = next_pos;
+        chunk = next_chunk;
+    }
+    *complete = true;
+    return BOOT_PORT_OK;
 }
 
-static boot_port_status_t bootloader_handle_payload(uint32_t remaining, uint16_t payload_len)
+static bool bootloader_hash_chunk(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len)
 {
-    boot_port_status_t status = bootloader_prepare_download();
+    boot_sha256_update(&ctx->sha_ctx, data, len);
+    return true;
+}
+
+/**
+ * @brief 计算一段 Flash 的 SHA-256
+ */
+static boot_port_status_t bootloader_hash_region(easy_bootloader_t *ctx, uint32_t addr, uint32_t size, uint8_t *digest)
+{
+    bool complete;
+
+    boot_sha256_init(&ctx->sha_ctx);
+    boot_port_status_t status = bootloader_scan_region(ctx, addr, size, bootloader_hash_chunk, &complete);
+    if (status != BOOT_PORT_OK) {
+        return status;
+    }
+    boot_sha256_final(&ctx->sha_ctx, digest);
+    return BOOT_PORT_OK;
+}
+#endif
+
+/**
+ * @brief 写入一个数据帧的数据
+ * @param more/more_len 数据跨过接收环末尾时回绕后的部分，否则为 NULL/0
+ */
+static boot_port_status_t bootloader_handle_payload(easy_bootloader_t *ctx, uint32_t remaining, const uint8_t *payload, uint16_t payload_len,
+                                                    const uint8_t *more, uint16_t more_len)
+{
+#if BOOT_CONFIG_ENABLE_BROADCAST
+    if (ctx->bcast_size != 0U) {
+        /* 单播数据帧中止广播会话，重新擦除后按顺序接收 */
+        ctx->bcast_size = 0U;
+        ctx->download_active = false;
+    }
+#endif
+#if BOOT_CONFIG_ENABLE_FEC
+    if (ctx->fec_size != 0U) {
+        /* 单播数据帧中止 FEC 会话 */
+        ctx->fec_size = 0U;
+        ctx->download_active = false;
+    }
+#endif
+    boot_port_status_t status = bootloader_prepare_download(ctx);
     if (status != BOOT_PORT_OK) {
         return status;
     }
 
     /* 更新状态为接收中 */
-    g_boot_ctx.state = BOOT_STATE_RECEIVING;
+    ctx->state = BOOT_STATE_RECEIVING;
+    ctx->unicast_active = true;
+    if (BOOT_PORT_HAS(ctx, get_tick)) {
+        ctx->unicast_tick = BOOT_PORT(ctx, get_tick)();
+    }
 
-    uint32_t future_bytes = g_boot_ctx.stream_cache_len + payload_len;
+    uint32_t future_bytes = ctx->stream_cache_len + payload_len + more_len;
     uint32_t worst_case = (future_bytes + 3U) & ~0x3U;  //向上取整到 4 的倍数
-    if ((g_boot_ctx.current_addr + worst_case) >
+    if ((ctx->current_addr + worst_case) >
         (BOOT_APP_START_ADDR + BOOT_APP_MAX_SIZE)) {
         BOOT_LOG("flash range overflow\r\n");
         return BOOT_PORT_ERROR;
     }
 
-    status = bootloader_stream_write(g_boot_ctx.payload_buf, payload_len);
+    status = bootloader_stream_write(ctx, payload, payload_len);
+    if (status == BOOT_PORT_OK) {
+        status = bootloader_stream_write(ctx, more, more_len);
+    }
     if (status != BOOT_PORT_OK) {
         return status;
     }
 
     if (remaining == 0U) {
         /* 最后一帧：flush 数据，进入等待完成帧状态 */
-        status = bootloader_stream_flush();
+        status = bootloader_stream_flush(ctx);
         if (status == BOOT_PORT_OK) {
-            g_boot_ctx.download_active = false;
-            g_boot_ctx.state = BOOT_STATE_WAIT_FINISH;
+            ctx->download_active = false;
+            ctx->state = BOOT_STATE_WAIT_FINISH;
             BOOT_LOG("Data complete, total %lu bytes\r\n",
-                          (unsigned long)(g_boot_ctx.current_addr - BOOT_APP_START_ADDR));
+                          (unsigned long)(ctx->current_addr - BOOT_APP_START_ADDR));
             BOOT_LOG("Waiting for finish frame...\r\n");
         }
     }
 
-    /* 无论是否最后一帧，都发送 ACK */
+    /* 无论是否最后一帧都应答，由 easy_bootloader_run 按窗口合并发送，最后一帧在帧释放后立即应答 */
     if (status == BOOT_PORT_OK) {
-        g_boot_ops->boot_port_data_write(g_boot_ack, sizeof(g_boot_ack));
+        ctx->ack_pending++;
+        if (BOOT_PORT_HAS(ctx, get_tick)) {
+            ctx->ack_pending_tick = BOOT_PORT(ctx, get_tick)();
+        }
+        if (remaining == 0U || ctx->ack_pending == UINT8_MAX) {
+            ctx->ack_urgent = true;   // 由调用方在释放接收缓冲、确认数据未被覆盖后发送
+        }
     }
 
     return status;
 }
 
-static boot_port_status_t bootloader_prepare_download(void)
+static boot_port_status_t bootloader_prepare_download(easy_bootloader_t *ctx)
 {
-    if (g_boot_ctx.download_active) {
+    if (ctx->download_active) {
         return BOOT_PORT_OK;
     }
 
     BOOT_LOG("Erasing APP region...\r\n");
-    boot_port_status_t status = g_boot_ops->boot_port_flash_erase(BOOT_APP_START_ADDR, BOOT_APP_MAX_SIZE);
+    boot_port_status_t status = ctx->ops->boot_port_flash_erase(BOOT_APP_START_ADDR, BOOT_APP_MAX_SIZE);
     if (status != BOOT_PORT_OK) {
         BOOT_LOG("Erase failed!\r\n");
         return status;
     }
     BOOT_LOG("Erase done\r\n");
 
-    g_boot_ctx.current_addr = BOOT_APP_START_ADDR;
-    g_boot_ctx.stream_cache_len = 0U;
-    g_boot_ctx.download_active = true;
+    ctx->current_addr = BOOT_APP_START_ADDR;
+    ctx->stream_cache_len = 0U;
+#if BOOT_CONFIG_ENABLE_SHA256
+    boot_sha256_init(&ctx->sha_ctx);
+#endif
+    ctx->download_active = true;
     return BOOT_PORT_OK;
 }
 
-static boot_port_status_t bootloader_stream_write(const uint8_t *data, uint32_t len)
+static boot_port_status_t bootloader_stream_write(easy_bootloader_t *ctx, const uint8_t *data, uint32_t len)
 {
     if (len == 0U) {
         return BOOT_PORT_OK;
     }
 
+#if BOOT_CONFIG_ENABLE_SHA256
+    /* 与写入同步累计摘要，数据仍在缓存中，无需事后回读 Flash */
+    boot_sha256_update(&ctx->sha_ctx, data, len);
+#endif
+
     uint32_t offset = 0U;
-    if (g_boot_ctx.stream_cache_len > 0U) {         
-        while (g_boot_ctx.stream_cache_len < 4U && offset < len) {
-            g_boot_ctx.stream_cache[g_boot_ctx.stream_cache_len++] = data[offset++];
+    if (ctx->stream_cache_len > 0U) {         
+        while (ctx->stream_cache_len < 4U && offset < len) {
+            ctx->stream_cache[ctx->stream_cache_len++] = data[offset++];
         }
 
-        if (g_boot_ctx.stream_cache_len == 4U) {
-            boot_port_status_t status = g_boot_ops->boot_port_flash_write(g_boot_ctx.current_addr,
-                                                              g_boot_ctx.stream_cache,
+        if (ctx->stream_cache_len == 4U) {
+            boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_write)(ctx->current_addr,
+                                                              ctx->stream_cache,
                                                               4U);
             if (status != BOOT_PORT_OK) {
                 return status;
             }
-            g_boot_ctx.current_addr += 4U;
-            g_boot_ctx.stream_cache_len = 0U;
+            ctx->current_addr += 4U;
+            ctx->stream_cache_len = 0U;
         }
     }
 
     uint32_t remaining = len - offset;
     uint32_t aligned = remaining & ~0x3U;   // 向下取整到 4 的倍数
     if (aligned > 0U) {
-        boot_port_status_t status = g_boot_ops->boot_port_flash_write(g_boot_ctx.current_addr,
+        boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_write)(ctx->current_addr,
                                                           &data[offset],
                                                           aligned);
         if (status != BOOT_PORT_OK) {
             return status;
         }
-        g_boot_ctx.current_addr += aligned;
+        ctx->current_addr += aligned;
         offset += aligned;
         remaining -= aligned;
     }
 
     if (remaining > 0U) {
-        memcpy(g_boot_ctx.stream_cache, &data[offset], remaining);
-        g_boot_ctx.stream_cache_len = (uint8_t)remaining;
+        memcpy(ctx->stream_cache, &data[offset], remaining);
+        ctx->stream_cache_len = (uint8_t)remaining;
     }
     return BOOT_PORT_OK;
 }
 
-static boot_port_status_t bootloader_stream_flush(void)
+static boot_port_status_t bootloader_stream_flush(easy_bootloader_t *ctx)
 {
-    if (g_boot_ctx.stream_cache_len == 0U) {
+    if (ctx->stream_cache_len == 0U) {
         return BOOT_PORT_OK;
     }
 
     uint8_t padded[4];
-    memcpy(padded, g_boot_ctx.stream_cache, g_boot_ctx.stream_cache_len);
-    memset(&padded[g_boot_ctx.stream_cache_len], 0xFF, 4U - g_boot_ctx.stream_cache_len);
+    memcpy(padded, ctx->stream_cache, ctx->stream_cache_len);
+    memset(&padded[ctx->stream_cache_len], 0xFF, 4U - ctx->stream_cache_len);
 
-    boot_port_status_t status = g_boot_ops->boot_port_flash_write(g_boot_ctx.current_addr, padded, 4U);
+    boot_port_status_t status = BOOT_PORT(ctx, boot_port_flash_write)(ctx->current_addr, padded, 4U);
     if (status == BOOT_PORT_OK) {
-        g_boot_ctx.current_addr += 4U;
-        g_boot_ctx.stream_cache_len = 0U;
+        ctx->current_addr += 4U;
+        ctx->stream_cache_len = 0U;
     }
     return status;
 }
 
+/*
+ * 各完成帧格式按长度降序排列，命令码位于帧尾 55 55 之前。较短格式的帧尾可能恰好落在较长帧的摘要/签名里
+ * （如扩展完成帧偏移 10..13 为 FF FD 55 55），因此先匹配收全的最长格式；本配置不接受的较短格式不参与匹配
+ */
+static const struct {
+    uint16_t len;
+    uint8_t  cmd0;
+    uint8_t  cmd1;
+} g_finish_formats[] = {
+    {BOOT_FINISH_SIGNED_LEN, BOOT_FINISH_SIGNED_BYTE0, BOOT_FINISH_SIGNED_BYTE1},
+#if !BOOT_CONFIG_ENABLE_SIGNATURE
+    {BOOT_FINISH_EXT_LEN,    BOOT_FINISH_EXT_BYTE0,    BOOT_FINISH_EXT_BYTE1},
+#endif
+#if !BOOT_CONFIG_ENABLE_SHA256
+    {BOOT_FINISH_FRAME_LEN,  BOOT_FINISH_FRAME_BYTE0,  BOOT_FINISH_FRAME_BYTE1},
+#endif
+};
+
+#define BOOT_FINISH_FORMATS       (sizeof(g_finish_formats) / sizeof(g_finish_formats[0]))
+
 /**
  * @brief 尝试从缓存中提取完成帧
- * @param version 输出参数，版本号
- * @param date    输出参数，日期
+ * @param frame 输出参数，版本号、日期及可选的摘要与签名
  * @return true=成功提取完成帧, false=数据不完整或格式错误
- * @note  完成帧格式: 55 AA [ver 4B] [date 4B] FF FD 55 55 (14字节)
+ * @note  完成帧格式:     55 AA [ver 4B] [date 4B] FF FD 55 55 (14字节)
+ *        扩展完成帧格式: 55 AA [ver 4B] [date 4B] [sha256 32B] FF FB 55 55 (46字节)
+ *        签名完成帧格式: 55 AA [ver 4B] [date 4B] [sha256 32B] [sig 64B] FF FA 55 55 (110字节)
+ *        只匹配 g_finish_formats 中的格式，收全的最长格式优先，更长格式未收全且较短格式都不匹配时等待
  */
-static bool bootloader_try_extract_finish_frame(uint32_t *version, uint32_t *date)
+static bool bootloader_try_extract_finish_frame(easy_bootloader_t *ctx, boot_finish_frame_t *frame)
 {
-    if (g_boot_ctx.rx_cache_len < BOOT_FINISH_FRAME_LEN) {
-        return false;
-    }
-
     /* 查找帧头 */
-    while (g_boot_ctx.rx_cache_len >= BOOT_FINISH_FRAME_LEN) {
-        if (g_boot_ctx.rx_cache[0] != BOOT_FRAME_HEADER0 ||
-            g_boot_ctx.rx_cache[1] != BOOT_FRAME_HEADER1) {
-            bootloader_consume_cache(1U);
-            continue;
+    while (bootloader_seek_frame(ctx, g_finish_formats[BOOT_FINISH_FORMATS - 1U].len)) {
+        const uint8_t *body = &ctx->rx_cache[BOOT_FRAME_BODY];
+        uint16_t frame_len = 0U;
+        bool pending = false;
+        for (uint32_t i = 0U; i < BOOT_FINISH_FORMATS; i++) {
+            uint16_t len = g_finish_formats[i].len;
+            if (ctx->rx_cache_len < len) {
+                pending = true;
+                continue;
+            }
+            if (ctx->rx_cache[len - 4U] == g_finish_formats[i].cmd0 &&
+                ctx->rx_cache[len - 3U] == g_finish_formats[i].cmd1 &&
+                ctx->rx_cache[len - 2U] == BOOT_FRAME_TAIL0 &&
+                ctx->rx_cache[len - 1U] == BOOT_FRAME_TAIL1) {
+                frame_len = len;
+                break;
+            }
         }
 
-        /* 检查完成帧格式: 55 AA [ver 4B] [date 4B] FF FD 55 55 */
-        if (g_boot_ctx.rx_cache[10] == BOOT_FINISH_FRAME_BYTE0 &&
-            g_boot_ctx.rx_cache[11] == BOOT_FINISH_FRAME_BYTE1 &&
-            g_boot_ctx.rx_cache[12] == BOOT_FRAME_TAIL0 &&
-            g_boot_ctx.rx_cache[13] == BOOT_FRAME_TAIL1) {
+        if (frame_len == 0U && pending) {
+            /* 可能是尚未收全的更长完成帧，等待更多数据 */
+            return false;
+        }
 
+        if (frame_len > 0U) {
             /* 解析版本号 (大端序) */
-            *version = ((uint32_t)g_boot_ctx.rx_cache[2] << 24) |
-                       ((uint32_t)g_boot_ctx.rx_cache[3] << 16) |
-                       ((uint32_t)g_boot_ctx.rx_cache[4] << 8)  |
-                       (uint32_t)g_boot_ctx.rx_cache[5];
+            frame->version = ((uint32_t)body[0] << 24) |
+                             ((uint32_t)body[1] << 16) |
+                             ((uint32_t)body[2] << 8)  |
+                             (uint32_t)body[3];
 
             /* 解析日期 (大端序) */
-            *date = ((uint32_t)g_boot_ctx.rx_cache[6] << 24) |
-                    ((uint32_t)g_boot_ctx.rx_cache[7] << 16) |
-                    ((uint32_t)g_boot_ctx.rx_cache[8] << 8)  |
-                    (uint32_t)g_boot_ctx.rx_cache[9];
+            frame->date = ((uint32_t)body[4] << 24) |
+                          ((uint32_t)body[5] << 16) |
+                          ((uint32_t)body[6] << 8)  |
+                          (uint32_t)body[7];
+
+            frame->has_digest = (frame_len >= BOOT_FINISH_EXT_LEN);
+            frame->has_signature = (frame_len == BOOT_FINISH_SIGNED_LEN);
+            if (frame->has_digest) {
+                memcpy(frame->digest, &body[8], BOOT_DIGEST_SIZE);
+            }
+            if (frame->has_signature) {
+                memcpy(frame->signature, &body[8U + BOOT_DIGEST_SIZE], BOOT_SIGNATURE_SIZE);
+            }
 
-            bootloader_consume_cache(BOOT_FINISH_FRAME_LEN);
+            bootloader_consume_cache(ctx, frame_len);
             return true;
         }
 
         /* 帧头匹配但格式不对，跳过继续查找 */
-        bootloader_consume_cache(2U);
+        bootloader_consume_cache(ctx, 2U);
     }
 
     return false;
@@ -584,23 +2375,68 @@ static bool bootloader_try_extract_finish_frame(uint32_t *version, uint32_t *dat
 
 /**
  * @brief 处理完成帧
- * @param version 版本号
- * @param date    日期
+ * @param frame 解析出的完成帧
  * @return 操作状态
- * @note  写入版本号、日期、flag=2，然后发送 ACK 并复位
+ * @note  启用 BOOT_CONFIG_ENABLE_SHA256 时必须携带摘要且与接收过程中累计的摘要一致，
+ *        启用 BOOT_CONFIG_ENABLE_SIGNATURE 时还须携带摘要的有效签名，
+ *        否则不写 flag、不回 ACK；通过后写入版本号、日期、flag=2（及签名尾部），然后发送 ACK 并复位
  */
-static boot_port_status_t bootloader_handle_finish_frame(uint32_t version, uint32_t date)
+static boot_port_status_t bootloader_handle_finish_frame(easy_bootloader_t *ctx, const boot_finish_frame_t *frame)
 {
+    uint32_t version = frame->version;
+    uint32_t date = frame->date;
+
     BOOT_LOG("Finish frame received: ver=0x%08X, date=0x%08X\r\n", version, date);
 
     /* 检查状态 */
-    if (g_boot_ctx.state != BOOT_STATE_WAIT_FINISH) {
-        BOOT_LOG("Unexpected finish frame (state=%d)\r\n", g_boot_ctx.state);
+    if (ctx->state != BOOT_STATE_WAIT_FINISH) {
+        BOOT_LOG("Unexpected finish frame (state=%d)\r\n", ctx->state);
         return BOOT_PORT_ERROR;
     }
 
-    /* 写入标志位区：flag=2 + 版本号 + 日期 */
-    boot_port_status_t status = bootloader_write_flag_region(BOOT_FLAG_APP, version, date);
+#if BOOT_CONFIG_ENABLE_SHA256
+    if (!frame->has_digest) {
+        BOOT_LOG("Finish frame without digest rejected\r\n");
+        return BOOT_PORT_ERROR;
+    }
+
+    uint8_t calc_digest[BOOT_SHA256_DIGEST_SIZE];
+#if BOOT_CONFIG_ENABLE_BROADCAST || BOOT_CONFIG_ENABLE_FEC
+    uint32_t unordered_size = bootloader_unordered_size(ctx);
+    if (unordered_size != 0U) {
+        /* 广播 / FEC 会话的帧乱序写入，摘要回读 Flash 计算 */
+        if (bootloader_hash_region(ctx, BOOT_APP_START_ADDR, unordered_size, calc_digest) != BOOT_PORT_OK) {
+            return BOOT_PORT_ERROR;
+        }
+    } else {
+        boot_sha256_final(&ctx->sha_ctx, calc_digest);
+    }
+#else
+    boot_sha256_final(&ctx->sha_ctx, calc_digest);
+#endif
+    if (memcmp(calc_digest, frame->digest, BOOT_SHA256_DIGEST_SIZE) != 0) {
+        BOOT_LOG("Image digest mismatch, flag not committed\r\n");
+        return BOOT_PORT_ERROR;
+    }
+    BOOT_LOG("Image digest verified\r\n");
+#endif
+
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    if (!frame->has_signature) {
+        BOOT_LOG("Finish frame without signature rejected\r\n");
+        return BOOT_PORT_ERROR;
+    }
+
+    if (!bootloader_verify_signature(ctx, calc_digest, frame->signature)) {
+        BOOT_LOG("Image signature invalid, flag not committed\r\n");
+        return BOOT_PORT_ERROR;
+    }
+    BOOT_LOG("Image signature verified\r\n");
+#endif
+
+    /* 写入标志位区：版本号 + 日期（+ 摘要与签名尾部），flag=2 最后写入 */
+    boot_port_status_t status = bootloader_write_flag_region(ctx, BOOT_FLAG_APP, version, date,
+                                                             frame->digest, frame->signature);
     if (status != BOOT_PORT_OK) {
         BOOT_LOG("Failed to write flag region\r\n");
         return status;
@@ -609,16 +2445,17 @@ static boot_port_status_t bootloader_handle_finish_frame(uint32_t version, uint3
     BOOT_LOG("Flag region updated: flag=APP, ver=0x%08X, date=0x%08X\r\n", version, date);
 
     /* 发送 ACK */
-    g_boot_ops->boot_port_data_write(g_boot_ack, sizeof(g_boot_ack));
+    bootloader_link_write(ctx, g_boot_ack, sizeof(g_boot_ack));
     BOOT_LOG("ACK sent\r\n");
 
     /* 短暂延时确保 ACK 发送完成 */
     for (volatile uint32_t i = 0; i < 100000; i++);
 
     BOOT_LOG("Upgrade complete! Resetting to run APP...\r\n");
+    bootloader_log_flush(ctx);
 
     /* 系统复位，复位后根据 flag=2 自动跳转到 APP */
-    g_boot_ops->boot_port_system_reset();
+    ctx->ops->boot_port_system_reset();
 
     return BOOT_PORT_OK;
 }
@@ -51,7 +51,7 @@
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
-
+extern void bootloader_fast_boot(void);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -66,7 +66,7 @@ void SystemClock_Config(void);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-
+	bootloader_fast_boot();	//flag=APP 时直接跳转，不初始化时钟与串口
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -1,79 +1,148 @@
 #include "myusart.h"
 
 extern UART_HandleTypeDef huart1;
-extern DMA_HandleTypeDef hdma_usart1_rx;
-uint8_t uart1_rx_dmabuffer[128];	//空闲中端数据缓存
-uint8_t uart1_read_buffer[128];
+extern UART_HandleTypeDef huart2;
 
-struct rt_ringbuffer uart1_ringbuffer_struct;	//串口环形缓存区结构体用于管理我的环形缓存区
-rt_uint8_t uart1_ringbuffer[128];	//环形缓存区实际大小
+/* DMA 缓冲区本身就是环形缓存区，DMA 以循环模式一直运行，不再停止后重启 */
+uint8_t uart1_rx_dmabuffer[128];
+uint8_t uart1_read_buffer[128];
+uart_dma_ring_t uart1_rx_ring = {&huart1, uart1_rx_dmabuffer, sizeof(uart1_rx_dmabuffer)};
 
-extern UART_HandleTypeDef huart2;
-extern DMA_HandleTypeDef hdma_usart2_rx;
-uint8_t uart2_rx_dmabuffer[1024];	//空闲中端数据缓存
-uint8_t uart2_read_buffer[1024];
+uint8_t uart2_rx_dmabuffer[UART2_RX_BUFFER_SIZE];	//升级数据只存在这里：核心直接在环中校验数据帧并写 Flash
+uart_dma_ring_t uart2_rx_ring = {&huart2, uart2_rx_dmabuffer, sizeof(uart2_rx_dmabuffer)};
 
-struct rt_ringbuffer uart2_ringbuffer_struct;	//串口环形缓存区结构体用于管理我的环形缓存区
-rt_uint8_t uart2_ringbuffer[1024];	//环形缓存区实际大小
 void myusart_init(void)
 {
-		rt_ringbuffer_init(&uart2_ringbuffer_struct,uart2_ringbuffer,sizeof(uart2_ringbuffer));//初始化环形缓存区
-    rt_ringbuffer_init(&uart1_ringbuffer_struct,uart1_ringbuffer,sizeof(uart1_ringbuffer));//初始化环形缓存区
+	//接收环在 MX_USARTx_UART_Init 中已启动，这里保留给其他串口相关初始化
+}
+
+//启动循环 DMA 接收，DMA 从缓冲区起点重新写入：写计数对齐到下一圈起点，只由接收事件一侧修改
+void uart_dma_ring_start(uart_dma_ring_t *ring)
+{
+	if (ring->ring.buf == NULL)
+		boot_ring_init(&ring->ring, ring->buf, ring->size);
+	else
+		boot_ring_commit_write(&ring->ring, (ring->size - (ring->ring.head & ring->ring.mask)) & ring->ring.mask);
+	HAL_UARTEx_ReceiveToIdle_DMA(ring->huart, ring->buf, ring->size);	//需配合 DMA_CIRCULAR，空闲/半满/全满事件都会回调
+}
+
+//接收事件：按 DMA 计数器取当前写到的位置，只提交写入
+//不用回调参数：半满回调固定报告 size/2，排在空闲事件之后处理时会把写位置算回上一圈
+static void uart_dma_ring_advance(uart_dma_ring_t *ring)
+{
+	uint16_t pos = (uint16_t)(ring->size - __HAL_DMA_GET_COUNTER(ring->huart->hdmarx));
+	uint32_t add = (pos - ring->ring.head) & ring->ring.mask;	//计数器重装时 pos == size，与 0 等价
+	if (add == 0)
+		return;
+
+	if (boot_ring_data_len(&ring->ring) + add >= ring->size)	//DMA 追上读位置，未读数据已被覆盖
+	{
+		ring->overrun = 1;
+		ring->lost++;
+	}
+	boot_ring_commit_write(&ring->ring, add);
+}
+
+uint16_t uart_dma_ring_data_len(const uart_dma_ring_t *ring)
+{
+	uint32_t len = boot_ring_data_len(&ring->ring);
+	return (uint16_t)((len > ring->size) ? ring->size : len);
+}
+
+//未读数据是否已被覆盖：除接收事件置的标志外，再按 DMA 计数器算出尚未提交的写入，覆盖发生后不必等到下一次接收事件
+static uint8_t uart_dma_ring_overrun(const uart_dma_ring_t *ring)
+{
+	uint32_t head = ring->ring.head;
+	uint32_t pos = ring->size - __HAL_DMA_GET_COUNTER(ring->huart->hdmarx);
+	uint32_t written = head + ((pos - head) & ring->ring.mask);
+	return ring->overrun || written - ring->ring.tail >= ring->size;
+}
+
+//丢弃全部未读数据，读位置对齐到写位置
+static void uart_dma_ring_resync(uart_dma_ring_t *ring)
+{
+	ring->overrun = 0;
+	boot_ring_commit_read(&ring->ring, boot_ring_data_len(&ring->ring));
+}
+
+uint16_t uart_dma_ring_read(uart_dma_ring_t *ring, uint8_t *buf, uint16_t max_len)
+{
+	if (ring->overrun)
+	{
+		uart_dma_ring_resync(ring);
+		return 0;
+	}
+
+	uint16_t len = (uint16_t)boot_ring_read(&ring->ring, buf, max_len);
+	if (uart_dma_ring_overrun(ring))	//拷贝期间被覆盖，本次读到的数据不可信，下次读取时重新同步
+	{
+		ring->overrun = 1;
+		return 0;
+	}
+	return len;
+}
+
+//就地读取：返回未读数据中 offset 处起到环末尾的连续区域，不移动读位置；覆盖后 offset 为 0 的调用重新同步
+uint16_t uart_dma_ring_peek(uart_dma_ring_t *ring, uint16_t offset, const uint8_t **data)
+{
+	if (ring->overrun)
+	{
+		if (offset != 0)
+			return 0;
+		uart_dma_ring_resync(ring);
+	}
+	return (uint16_t)boot_ring_peek(&ring->ring, offset, data);
+}
+
+//释放就地处理完的 len 字节；返回 1 表示处理期间数据已被覆盖，此时丢弃全部未读数据
+uint8_t uart_dma_ring_consume(uart_dma_ring_t *ring, uint16_t len)
+{
+	if (uart_dma_ring_overrun(ring))
+	{
+		uart_dma_ring_resync(ring);
+		return 1;
+	}
+	boot_ring_commit_read(&ring->ring, len);
+	return 0;
 }
 
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
-    if (huart->Instance == USART1)
-    {
-        HAL_UART_DMAStop(huart);	//暂停DMA传输，保证我的DMA传输的完整性(因为我的DMA可能任然是活跃的没有搬运到128字节，它还在检测数据)
-
-				if(rt_ringbuffer_space_len(&uart1_ringbuffer_struct)!=0)	//判断缓存区空间
-				{
-					uint16_t putsize=rt_ringbuffer_put(&uart1_ringbuffer_struct,uart1_rx_dmabuffer,Size);
-					if(putsize!=Size)	//环形缓存区数据未全部放入
-						uart_printf(&huart1,"Ringbuffer Size too Small\r\n");
-				}
-					
-        HAL_UARTEx_ReceiveToIdle_DMA(huart, uart1_rx_dmabuffer, sizeof(uart1_rx_dmabuffer));	//打开DMA运输
-			__HAL_DMA_DISABLE_IT(&hdma_usart1_rx, DMA_IT_HT);	//关闭DMA半中断
-    }else if (huart->Instance==USART2)
-    {
-        HAL_UART_DMAStop(huart);	//暂停DMA传输，保证我的DMA传输的完整性(因为我的DMA可能任然是活跃的没有搬运到128字节，它还在检测数据)
-
-				if(rt_ringbuffer_space_len(&uart2_ringbuffer_struct)!=0)	//判断缓存区空间
-				{
-					uint16_t putsize=rt_ringbuffer_put(&uart2_ringbuffer_struct,uart2_rx_dmabuffer,Size);
-					if(putsize!=Size)	//环形缓存区数据未全部放入
-						uart_printf(&huart2,"Ringbuffer Size too Small\r\n");
-				}
-					
-        HAL_UARTEx_ReceiveToIdle_DMA(huart, uart2_rx_dmabuffer, sizeof(uart2_rx_dmabuffer));	//打开DMA运输
-			__HAL_DMA_DISABLE_IT(&hdma_usart2_rx, DMA_IT_HT);	//关闭DMA半中断        
-    }
+	if (huart->Instance == USART1)
+	{
+		uart_dma_ring_advance(&uart1_rx_ring);
+		scheduler_post(TASK_UART1);
+	}
+	else if (huart->Instance == USART2)
+	{
+		uart_dma_ring_advance(&uart2_rx_ring);
+		scheduler_post(TASK_BOOTLOADER);
+	}
 }
 
-void uart1_task(void)
+//DMA 接收下帧错误、噪声、溢出都会中止接收：重新启动，并由读取方把读位置对齐到写位置（中断里不改读位置）
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 {
-	uint16_t data_size=rt_ringbuffer_data_len(&uart1_ringbuffer_struct);	//获取缓存区数据大小
-	if(data_size>0)
+	uart_dma_ring_t *ring = NULL;
+	if (huart->Instance == USART1)
+		ring = &uart1_rx_ring;
+	else if (huart->Instance == USART2)
+		ring = &uart2_rx_ring;
+
+	if (ring != NULL)
 	{
-		rt_ringbuffer_get(&uart1_ringbuffer_struct,uart1_read_buffer,data_size);
-		uart_printf(&huart1,"bootloader:%s\r\n",uart1_read_buffer);	//打印接收到的数据
-		rt_ringbuffer_reset(&uart1_ringbuffer_struct);
-    memset(uart1_read_buffer,0,data_size);  
-		
+		uart_dma_ring_start(ring);
+		ring->overrun = 1;
 	}
 }
 
-void uart2_task(void)
+void uart1_task(void)
 {
-	uint16_t data_size=rt_ringbuffer_data_len(&uart2_ringbuffer_struct);	//获取缓存区数据大小
+	uint16_t data_size = uart_dma_ring_read(&uart1_rx_ring, uart1_read_buffer, sizeof(uart1_read_buffer) - 1);
 	if(data_size>0)
 	{
-		rt_ringbuffer_get(&uart2_ringbuffer_struct,uart2_read_buffer,data_size);
-		uart_printf(&huart2,"%s\r\n",uart2_read_buffer);	//打印接收到的数据
-		rt_ringbuffer_reset(&uart2_ringbuffer_struct);
-    memset(uart1_read_buffer,0,data_size);  		
+		uart1_read_buffer[data_size] = 0;
+		uart_printf(&huart1,"bootloader:%s\r\n",uart1_read_buffer);	//打印接收到的数据
 	}
 }
 
@@ -2,10 +2,30 @@
 #define _MYUSART_H_
 
 #include "bsp_sys.h"
+#include "boot_ring.h"
+
+#define UART2_RX_BUFFER_SIZE	4096U	//容纳上位机窗口内的全部在途帧（默认 3 帧 * 1024 字节）
+
+/* 循环 DMA 接收环：DMA 为生产者，空闲/半满/全满事件按 DMA 写位置提交写入，读取方直接从 buf 取数据 */
+typedef struct {
+	UART_HandleTypeDef *huart;
+	uint8_t *buf;
+	uint16_t size;				//须为 2 的幂
+	boot_ring_t ring;
+	volatile uint8_t overrun;	//未读数据被覆盖或接收重启，读取方丢弃全部未读数据
+	volatile uint32_t lost;		//覆盖次数，调试用
+} uart_dma_ring_t;
+
+extern uart_dma_ring_t uart1_rx_ring;
+extern uart_dma_ring_t uart2_rx_ring;
 
 int uart_printf(UART_HandleTypeDef* huart, const char* format, ...) ;
 void uart1_task(void);
-void uart2_task(void);
 void myusart_init(void);
+void uart_dma_ring_start(uart_dma_ring_t *ring);
+uint16_t uart_dma_ring_data_len(const uart_dma_ring_t *ring);
+uint16_t uart_dma_ring_read(uart_dma_ring_t *ring, uint8_t *buf, uint16_t max_len);
+uint16_t uart_dma_ring_peek(uart_dma_ring_t *ring, uint16_t offset, const uint8_t **data);
+uint8_t uart_dma_ring_consume(uart_dma_ring_t *ring, uint16_t len);
 
 #endif
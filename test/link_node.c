@@ -0,0 +1,612 @@
+// 分包链路节点：核心按 ops.link_mtu / link_window 运行，标准输入输出上每个报文为 [长度 2B 小端][数据]，
+// 由 test_link_window.py 接上模拟链路（MTU 限制、注入延迟）与上位机 serial_terminal.py 的刷写逻辑；
+// 按配置另编译 FEC（test_fec.py）与多点总线（test_rs485_bus.py，多个进程挂在同一条模拟总线上）版本；
+// 定义 LINK_NODE_UDP 时改经 boot_udp.c 收发：本机 UDP 套接字上的报文包装成以太网帧放入模拟的接收描述符，
+// 由 test_udp_link.py 以上位机 udp_flash.py 刷写
+#include "boot_config.h"
+#include "easy_bootloader.h"
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+#if LINK_NODE_UDP
+#include "boot_udp.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+#error "link_node needs BOOT_CONFIG_ENABLE_RX_DIRECT = 0 (packet links use the copy path)"
+#endif
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE       0x100000
+#endif
+
+#define FLASH_SIZE                (BOOT_FLASH_END_ADDR - BOOT_FLASH_START_ADDR)
+#define FLASH_PTR(addr)           ((uint8_t *)(uintptr_t)(addr))
+#define LINK_PACKET_MAX           2048U
+
+static uint8_t g_packet[LINK_PACKET_MAX];   // 已读入、还没交给核心的报文
+static uint32_t g_packet_len;
+static uint32_t g_mtu;
+static int g_verbose;
+static int g_input_fd = STDIN_FILENO;       // 空闲时等待的输入：标准输入或 UDP 套接字
+
+static bool link_read_exact(uint8_t *buf, uint32_t len)
+{
+    while (len > 0U) {
+        ssize_t n = read(STDIN_FILENO, buf, len);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= (uint32_t)n;
+    }
+    return true;
+}
+
+/* 等待输入可读，最多 timeout_us 微秒 */
+static bool link_wait_input(long timeout_us)
+{
+    fd_set fds;
+    struct timeval tv = {0, timeout_us};
+    FD_ZERO(&fds);
+    FD_SET(g_input_fd, &fds);
+    return select(g_input_fd + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
+static uint32_t host_get_tick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+static boot_port_status_t host_flash_erase(uint32_t addr, uint32_t size)
+{
+    if (addr < BOOT_FLASH_START_ADDR || size > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    memset(FLASH_PTR(addr), 0xFF, size);
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t host_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (addr < BOOT_FLASH_START_ADDR || len > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    for (uint32_t i = 0U; i < len; i++) {
+        FLASH_PTR(addr)[i] &= data[i];
+    }
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t host_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    if (addr < BOOT_FLASH_START_ADDR || len > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    memcpy(data, FLASH_PTR(addr), len);
+    return BOOT_PORT_OK;
+}
+
+/* 每次发送即一个报文，超过 MTU 视为链路错误直接退出 */
+static boot_port_status_t host_data_write(const uint8_t *data, uint32_t len)
+{
+    if (g_mtu != 0U && len > g_mtu) {
+        fprintf(stderr, "link_node: %lu-byte write exceeds MTU %lu\n", (unsigned long)len, (unsigned long)g_mtu);
+        exit(2);
+    }
+    uint8_t head[2] = {(uint8_t)(len & 0xFFU), (uint8_t)(len >> 8)};
+    if (write(STDOUT_FILENO, head, 2U) != 2 || write(STDOUT_FILENO, data, len) != (ssize_t)len) {
+        exit(3);
+    }
+    return BOOT_PORT_OK;
+}
+
+/* 每次交付一个完整报文，放不下时留到下次（核心在缓存满时停止读取） */
+static uint32_t host_data_read(uint8_t *buf, uint32_t max_len)
+{
+    if (g_packet_len == 0U && link_wait_input(0)) {
+        uint8_t head[2];
+        if (!link_read_exact(head, 2U)) {
+            exit(0);   // 上位机关闭链路
+        }
+        g_packet_len = head[0] | ((uint32_t)head[1] << 8);
+        if (g_packet_len > LINK_PACKET_MAX || !link_read_exact(g_packet, g_packet_len)) {
+            exit(4);
+        }
+    }
+    if (g_packet_len == 0U || g_packet_len > max_len) {
+        return 0U;
+    }
+    uint32_t len = g_packet_len;
+    memcpy(buf, g_packet, len);
+    g_packet_len = 0U;
+    return len;
+}
+
+#if LINK_NODE_UDP
+/*
+ * 模拟以太网 MAC：接收描述符环中每个描述符放一帧，帧在描述符中由 boot_udp.c 就地解析；
+ * 发送帧逐帧检查（最小帧长、IP / UDP / ICMP 校验和、地址），UDP 载荷经套接字转发给上位机。
+ * 上位机报文之间按轮次插入必须丢弃的坏帧（UDP / IP 校验和错误、端口或目的 IP 不符），
+ * 启动时先放入 ARP 请求（本机与其他地址各一）与一个 ICMP 回显请求
+ */
+#define ETH_RX_DESC_NUM           6U
+#define ETH_BUF_SIZE              1536U
+#define ETH_MIN_FRAME             60U
+#define LINK_UDP_PORT             47000U
+#define LINK_UDP_BAD_EVERY        4U        // 每 4 个上位机报文前插入一个坏帧
+
+typedef struct {
+    uint8_t  buf[ETH_BUF_SIZE];
+    uint32_t len;
+    uint8_t  must_drop;
+} link_eth_desc_t;
+
+static const uint8_t g_dev_mac[BOOT_UDP_MAC_SIZE] = {0x02U, 0x45U, 0x42U, 0x4CU, 0xFFU, 0x37U};
+/* 由上面 MAC 按 RFC 3927 派生的期望地址 169.254.(1 + 0xFF % 254).0x37，独立写出以核对被测代码的选择 */
+static const uint8_t g_dev_ip[BOOT_UDP_IP_SIZE] = {169U, 254U, 2U, 55U};
+static const uint8_t g_host_mac[BOOT_UDP_MAC_SIZE] = {0x02U, 0x48U, 0x4FU, 0x53U, 0x54U, 0x01U};
+static const uint8_t g_host_ip[BOOT_UDP_IP_SIZE] = {169U, 254U, 2U, 1U};
+static const uint8_t g_other_ip[BOOT_UDP_IP_SIZE] = {169U, 254U, 2U, 56U};
+static const uint8_t g_icmp_data[] = "link_node icmp echo, odd length.";
+
+static boot_udp_t g_udp;
+static link_eth_desc_t g_eth_rx[ETH_RX_DESC_NUM];
+static uint32_t g_eth_rx_head;
+static uint32_t g_eth_rx_tail;
+static uint8_t g_eth_tx[ETH_BUF_SIZE];
+static int g_sock = -1;
+static struct sockaddr_in g_host_addr;
+static uint16_t g_host_port;
+static uint32_t g_datagrams;
+
+/* 统计，复位时打印：任何违规或缺少 ARP / ICMP 应答都使节点以非 0 退出 */
+static uint32_t g_bad_injected;
+static uint32_t g_peeks;
+static uint32_t g_arp_replies;
+static uint32_t g_arp_announces;
+static uint32_t g_icmp_replies;
+static uint32_t g_udp_sent;
+static uint32_t g_violations;
+
+static void link_violation(const char *what)
+{
+    fprintf(stderr, "link_node: %s\n", what);
+    g_violations++;
+}
+
+static void eth_put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static uint16_t eth_get16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+/* 参考实现的反码和，与 boot_udp.c 分开编写 */
+static uint16_t eth_checksum(uint32_t sum, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0U; i + 1U < len; i += 2U) {
+        sum += eth_get16(&data[i]);
+    }
+    if ((len & 1U) != 0U) {
+        sum += (uint32_t)data[len - 1U] << 8;
+    }
+    while ((sum >> 16) != 0U) {
+        sum = (sum & 0xFFFFU) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+static uint16_t eth_udp_checksum(const uint8_t *ip, const uint8_t *udp, uint32_t udp_len)
+{
+    uint32_t sum = 17U + udp_len;
+    for (uint32_t i = 12U; i < 20U; i += 2U) {
+        sum += eth_get16(&ip[i]);
+    }
+    return eth_checksum(sum, udp, udp_len);
+}
+
+static link_eth_desc_t *eth_rx_slot(void)
+{
+    link_eth_desc_t *desc = &g_eth_rx[g_eth_rx_tail % ETH_RX_DESC_NUM];
+    memset(desc->buf, 0, ETH_BUF_SIZE);
+    desc->must_drop = 0U;
+    return desc;
+}
+
+/* 帧长不足 60 字节时按以太网补齐，IP 总长度小于帧长 */
+static void eth_rx_push(link_eth_desc_t *desc, uint32_t len)
+{
+    desc->len = (len < ETH_MIN_FRAME) ? ETH_MIN_FRAME : len;
+    g_eth_rx_tail++;
+}
+
+static void eth_build_ip(uint8_t *frame, const uint8_t *dst_ip, uint8_t proto, uint32_t payload_len)
+{
+    uint8_t *ip = &frame[14];
+    memcpy(&frame[0], g_dev_mac, BOOT_UDP_MAC_SIZE);
+    memcpy(&frame[6], g_host_mac, BOOT_UDP_MAC_SIZE);
+    eth_put16(&frame[12], 0x0800U);
+    ip[0] = 0x45U;
+    eth_put16(&ip[2], (uint16_t)(20U + payload_len));
+    eth_put16(&ip[4], (uint16_t)g_datagrams);
+    eth_put16(&ip[6], 0x4000U);
+    ip[8] = 64U;
+    ip[9] = proto;
+    memcpy(&ip[12], g_host_ip, BOOT_UDP_IP_SIZE);
+    memcpy(&ip[16], dst_ip, BOOT_UDP_IP_SIZE);
+    eth_put16(&ip[10], eth_checksum(0U, ip, 20U));
+}
+
+static void eth_push_arp_request(const uint8_t *target_ip)
+{
+    link_eth_desc_t *desc = eth_rx_slot();
+    uint8_t *arp = &desc->buf[14];
+    memset(&desc->buf[0], 0xFF, BOOT_UDP_MAC_SIZE);
+    memcpy(&desc->buf[6], g_host_mac, BOOT_UDP_MAC_SIZE);
+    eth_put16(&desc->buf[12], 0x0806U);
+    eth_put16(&arp[0], 1U);
+    eth_put16(&arp[2], 0x0800U);
+    arp[4] = BOOT_UDP_MAC_SIZE;
+    arp[5] = BOOT_UDP_IP_SIZE;
+    eth_put16(&arp[6], 1U);
+    memcpy(&arp[8], g_host_mac, BOOT_UDP_MAC_SIZE);
+    memcpy(&arp[14], g_host_ip, BOOT_UDP_IP_SIZE);
+    memcpy(&arp[24], target_ip, BOOT_UDP_IP_SIZE);
+    eth_rx_push(desc, 14U + 28U);
+}
+
+static void eth_push_icmp_echo(void)
+{
+    link_eth_desc_t *desc = eth_rx_slot();
+    uint8_t *icmp = &desc->buf[34];
+    uint32_t len = 8U + (uint32_t)sizeof(g_icmp_data);
+    icmp[0] = 8U;
+    eth_put16(&icmp[4], 0x1234U);
+    eth_put16(&icmp[6], 1U);
+    memcpy(&icmp[8], g_icmp_data, sizeof(g_icmp_data));
+    eth_put16(&icmp[2], eth_checksum(0U, icmp, len));
+    eth_build_ip(desc->buf, g_dev_ip, 1U, len);
+    eth_rx_push(desc, 34U + len);
+}
+
+/*
+ * 一个上位机报文包装成以太网帧；bad 非 0 时生成同一报文的坏帧（1 UDP 校验和错 2 IP 首部校验和错
+ * 3 目的端口不符 4 目的 IP 不符），标记为必须丢弃。首个报文按广播发现发往 255.255.255.255，
+ * 每 3 个报文有一个不带 UDP 校验和（IPv4 允许为 0）
+ */
+static void eth_push_datagram(const uint8_t *data, uint32_t len, uint32_t bad)
+{
+    static const uint8_t broadcast_ip[BOOT_UDP_IP_SIZE] = {0xFFU, 0xFFU, 0xFFU, 0xFFU};
+    link_eth_desc_t *desc = eth_rx_slot();
+    uint8_t *ip = &desc->buf[14];
+    uint8_t *udp = &desc->buf[34];
+    uint32_t udp_len = 8U + len;
+
+    eth_build_ip(desc->buf, (bad == 4U) ? g_other_ip : ((g_datagrams == 0U) ? broadcast_ip : g_dev_ip), 17U, udp_len);
+    eth_put16(&udp[0], g_host_port);
+    eth_put16(&udp[2], (uint16_t)((bad == 3U) ? LINK_UDP_PORT + 1U : LINK_UDP_PORT));
+    eth_put16(&udp[4], (uint16_t)udp_len);
+    memcpy(&udp[8], data, len);
+    if (bad != 0U || g_datagrams % 3U != 2U) {
+        uint16_t checksum = eth_udp_checksum(ip, udp, udp_len);
+        eth_put16(&udp[6], (checksum == 0U) ? 0xFFFFU : checksum);
+    }
+    if (bad == 1U) {
+        udp[8U + len / 2U] ^= 0x01U;
+    } else if (bad == 2U) {
+        ip[10] ^= 0x01U;
+    }
+    desc->must_drop = (bad != 0U);
+    eth_rx_push(desc, 34U + udp_len);
+}
+
+/* 描述符有空位（坏帧与正常帧各一个）时才从套接字取报文，其余留在内核缓冲中 */
+static void eth_pump(void)
+{
+    uint8_t data[ETH_BUF_SIZE];
+
+    while (ETH_RX_DESC_NUM - (g_eth_rx_tail - g_eth_rx_head) >= 2U) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t n = recvfrom(g_sock, data, BOOT_UDP_PAYLOAD_MAX, MSG_DONTWAIT, (struct sockaddr *)&from, &from_len);
+        if (n <= 0) {
+            return;
+        }
+        g_host_addr = from;
+        g_host_port = ntohs(from.sin_port);
+        if (g_datagrams % LINK_UDP_BAD_EVERY == 1U) {
+            eth_push_datagram(data, (uint32_t)n, 1U + (g_datagrams / LINK_UDP_BAD_EVERY) % 4U);
+            g_bad_injected++;
+        }
+        eth_push_datagram(data, (uint32_t)n, 0U);
+        g_datagrams++;
+    }
+}
+
+static uint32_t eth_rx_peek(const uint8_t **frame)
+{
+    eth_pump();
+    if (g_eth_rx_head == g_eth_rx_tail) {
+        return 0U;
+    }
+    const link_eth_desc_t *desc = &g_eth_rx[g_eth_rx_head % ETH_RX_DESC_NUM];
+    *frame = desc->buf;
+    return desc->len;
+}
+
+static void eth_rx_release(void)
+{
+    if (g_eth_rx_head == g_eth_rx_tail) {
+        link_violation("eth_rx_release with no frame");
+        return;
+    }
+    g_eth_rx_head++;
+}
+
+static uint8_t *eth_tx_acquire(void)
+{
+    return g_eth_tx;
+}
+
+static void eth_check_arp(const uint8_t *frame)
+{
+    const uint8_t *arp = &frame[14];
+    if (memcmp(&arp[8], g_dev_mac, BOOT_UDP_MAC_SIZE) != 0 || memcmp(&arp[14], g_dev_ip, BOOT_UDP_IP_SIZE) != 0) {
+        link_violation("ARP sender is not the link-local address derived from the MAC");
+    } else if (eth_get16(&arp[6]) == 1U && memcmp(&arp[24], g_dev_ip, BOOT_UDP_IP_SIZE) == 0) {
+        g_arp_announces++;
+    } else if (eth_get16(&arp[6]) == 2U && memcmp(&frame[0], g_host_mac, BOOT_UDP_MAC_SIZE) == 0 &&
+               memcmp(&arp[18], g_host_mac, BOOT_UDP_MAC_SIZE) == 0 &&
+               memcmp(&arp[24], g_host_ip, BOOT_UDP_IP_SIZE) == 0) {
+        g_arp_replies++;
+    } else {
+        link_violation("unexpected ARP frame");
+    }
+}
+
+static void eth_tx_submit(uint32_t len)
+{
+    const uint8_t *ip = &g_eth_tx[14];
+
+    if (len < ETH_MIN_FRAME || len > BOOT_UDP_FRAME_MAX) {
+        link_violation("transmit frame length out of range");
+        return;
+    }
+    if (eth_get16(&g_eth_tx[12]) == 0x0806U) {
+        eth_check_arp(g_eth_tx);
+        return;
+    }
+    uint32_t total = eth_get16(&ip[2]);
+    if (eth_get16(&g_eth_tx[12]) != 0x0800U || ip[0] != 0x45U || total + 14U > len ||
+        eth_checksum(0U, ip, 20U) != 0U || memcmp(&g_eth_tx[0], g_host_mac, BOOT_UDP_MAC_SIZE) != 0 ||
+        memcmp(&ip[12], g_dev_ip, BOOT_UDP_IP_SIZE) != 0 || memcmp(&ip[16], g_host_ip, BOOT_UDP_IP_SIZE) != 0) {
+        link_violation("bad IPv4 header or addresses in transmit frame");
+        return;
+    }
+    if (ip[9] == 1U) {
+        if (total != 20U + 8U + sizeof(g_icmp_data) || ip[20] != 0U || eth_checksum(0U, &ip[20], total - 20U) != 0U ||
+            memcmp(&ip[28], g_icmp_data, sizeof(g_icmp_data)) != 0) {
+            link_violation("bad ICMP echo reply");
+            return;
+        }
+        g_icmp_replies++;
+        return;
+    }
+    const uint8_t *udp = &ip[20];
+    uint32_t udp_len = eth_get16(&udp[4]);
+    if (ip[9] != 17U || udp_len + 20U != total || eth_get16(&udp[6]) == 0U ||
+        eth_udp_checksum(ip, udp, udp_len) != 0U || eth_get16(&udp[0]) != LINK_UDP_PORT ||
+        eth_get16(&udp[2]) != g_host_port) {
+        link_violation("bad UDP datagram in transmit frame");
+        return;
+    }
+    g_udp_sent++;
+    (void)sendto(g_sock, &udp[8], udp_len - 8U, 0, (const struct sockaddr *)&g_host_addr, sizeof(g_host_addr));
+}
+
+static const boot_udp_ops_t g_udp_ops = {
+    .eth_rx_peek = eth_rx_peek,
+    .eth_rx_release = eth_rx_release,
+    .eth_tx_acquire = eth_tx_acquire,
+    .eth_tx_submit = eth_tx_submit,
+    .get_tick = host_get_tick,
+};
+
+/* boot_udp.c 接受的载荷必须来自排在最前的描述符（读完即归还的取前一个），且不是坏帧 */
+static void udp_check_accepted(void)
+{
+    uint32_t index = (g_udp.rx_payload != NULL) ? g_eth_rx_head : g_eth_rx_head - 1U;
+    if (g_eth_rx[index % ETH_RX_DESC_NUM].must_drop != 0U) {
+        link_violation("a frame that must be dropped reached the core");
+    }
+}
+
+static boot_port_status_t udp_data_write(const uint8_t *data, uint32_t len)
+{
+    return (boot_udp_write(&g_udp, data, len) == BOOT_UDP_OK) ? BOOT_PORT_OK : BOOT_PORT_ERROR;
+}
+
+static uint32_t udp_data_read(uint8_t *buf, uint32_t max_len)
+{
+    uint32_t len = boot_udp_read(&g_udp, buf, max_len);
+    if (len > 0U) {
+        udp_check_accepted();
+    }
+    return len;
+}
+
+/* 零拷贝：返回的地址须直接指向接收描述符中的 UDP 载荷 */
+static uint32_t udp_data_peek(const uint8_t **data)
+{
+    uint32_t len = boot_udp_peek(&g_udp, data);
+    if (len > 0U) {
+        const link_eth_desc_t *desc = &g_eth_rx[g_eth_rx_head % ETH_RX_DESC_NUM];
+        if (*data != &desc->buf[BOOT_UDP_HEADER_SIZE + g_udp.rx_offset]) {
+            link_violation("data_peek did not point into the receive descriptor");
+        }
+        udp_check_accepted();
+        g_peeks++;
+    }
+    return len;
+}
+
+static void udp_data_release(void)
+{
+    boot_udp_release(&g_udp);
+}
+
+static bool udp_node_report(void)
+{
+    bool ok = g_violations == 0U && g_arp_replies == 1U && g_arp_announces == 1U && g_icmp_replies == 1U &&
+              g_peeks > 0U && g_bad_injected > 0U;
+    fprintf(stderr, "udp: %lu datagrams in, %lu bad frames dropped, %lu zero-copy peeks, %lu datagrams out, "
+            "arp reply %lu, announce %lu, icmp reply %lu, %lu violations\n",
+            (unsigned long)g_datagrams, (unsigned long)g_bad_injected, (unsigned long)g_peeks,
+            (unsigned long)g_udp_sent, (unsigned long)g_arp_replies, (unsigned long)g_arp_announces,
+            (unsigned long)g_icmp_replies, (unsigned long)g_violations);
+    return ok;
+}
+
+/* 绑定 127.0.0.1 的任意端口并在标准输出打印端口号，IP 配置为全 0 以使用链路本地地址 */
+static bool udp_node_init(boot_ops_t *ops)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    boot_udp_config_t cfg;
+
+    g_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (g_sock < 0 || bind(g_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(g_sock, (struct sockaddr *)&addr, &addr_len) != 0) {
+        perror("link_node: udp socket");
+        return false;
+    }
+    g_input_fd = g_sock;
+    printf("udp port %u\n", (unsigned)ntohs(addr.sin_port));
+    fflush(stdout);
+
+    memset(&cfg, 0, sizeof(cfg));
+    memcpy(cfg.mac, g_dev_mac, BOOT_UDP_MAC_SIZE);
+    cfg.port = LINK_UDP_PORT;
+    if (boot_udp_init(&g_udp, &g_udp_ops, &cfg) != BOOT_UDP_OK) {
+        return false;
+    }
+    boot_udp_announce(&g_udp);
+    eth_push_arp_request(g_other_ip);
+    eth_push_arp_request(g_dev_ip);
+    eth_push_icmp_echo();
+
+    ops->boot_port_data_write = udp_data_write;
+    ops->boot_port_data_read = udp_data_read;
+    ops->boot_port_data_peek = udp_data_peek;
+    ops->boot_port_data_release = udp_data_release;
+    return true;
+}
+#endif
+
+static void host_log(const char *fmt, ...)
+{
+    if (g_verbose) {
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+    }
+}
+
+static void host_jump_to_app(uint32_t app_addr)
+{
+    (void)app_addr;
+}
+
+/* 完成帧处理后复位：Flash 内容已在映射文件中，直接退出 */
+static void host_system_reset(void)
+{
+    msync(FLASH_PTR(BOOT_FLASH_START_ADDR), FLASH_SIZE, MS_SYNC);
+#if LINK_NODE_UDP
+    if (!udp_node_report()) {
+        exit(5);
+    }
+#endif
+    exit(0);
+}
+
+static boot_ops_t g_ops = {
+    .get_tick = host_get_tick,
+    .boot_port_flash_erase = host_flash_erase,
+    .boot_port_flash_write = host_flash_write,
+    .boot_port_flash_read = host_flash_read,
+    .boot_port_data_write = host_data_write,
+    .boot_port_data_read = host_data_read,
+    .boot_port_log = host_log,
+    .boot_port_jump_to_app = host_jump_to_app,
+    .boot_port_system_reset = host_system_reset,
+};
+
+/* 用法: link_node <flash 文件> <link_mtu> <link_window> [-a 节点地址] [-v] */
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <flash file> <link_mtu> <link_window> [-a node_addr] [-v]\n", argv[0]);
+        return 1;
+    }
+    g_mtu = (uint32_t)strtoul(argv[2], NULL, 0);
+    g_ops.link_mtu = (uint16_t)g_mtu;
+    g_ops.link_window = (uint8_t)strtoul(argv[3], NULL, 0);
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            g_verbose = 1;
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            g_ops.node_addr = (uint8_t)strtoul(argv[++i], NULL, 0);   // 多点总线（BOOT_CONFIG_ENABLE_ADDRESS）
+        }
+    }
+
+    int fd = open(argv[1], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, FLASH_SIZE) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    void *flash = mmap((void *)(uintptr_t)BOOT_FLASH_START_ADDR, FLASH_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    if (flash != FLASH_PTR(BOOT_FLASH_START_ADDR)) {
+        fprintf(stderr, "link_node: cannot map flash at 0x%08lX\n", (unsigned long)BOOT_FLASH_START_ADDR);
+        return 1;
+    }
+    memset(flash, 0xFF, FLASH_SIZE);
+
+#if LINK_NODE_UDP
+    if (!udp_node_init(&g_ops)) {
+        return 1;
+    }
+#endif
+    if (easy_bootloader_init(&g_ops) != BOOT_PORT_OK) {
+        return 1;
+    }
+    for (;;) {
+        easy_bootloader_run();
+        if (g_packet_len == 0U) {
+            (void)link_wait_input(1000);   // 空闲时最多等 1ms，让合并 ACK 的超时照常到期
+        }
+    }
+}
@@ -0,0 +1,481 @@
+// boot_isotp 单元测试：以脚本化的对端驱动接收重组（SF / FF / CF、序号错误、缓存背压与溢出）
+// 和发送流控（CTS 分块与 STmin、WAIT 重新计时、OVERFLOW、等流控超时）
+#include "boot_isotp.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_TX_ID                 0x7E8U
+#define SIM_RX_ID                 0x7E0U
+#define SIM_MAX_FRAMES            1024U
+#define SIM_MAX_SCRIPT            16U
+
+typedef struct {
+    uint32_t id;
+    uint8_t  len;
+    uint8_t  data[BOOT_ISOTP_CANFD_DLEN];
+    uint32_t tick;
+} sim_frame_t;
+
+/* 对端脚本：本端已发出 after_sent 帧且时间到达 at_tick 后，对端发出 frame */
+typedef struct {
+    uint32_t    after_sent;
+    uint32_t    at_tick;
+    sim_frame_t frame;
+} sim_script_t;
+
+static uint32_t g_tick;                     // 每次 get_tick 前进 1ms，忙等循环也能推进时间
+static sim_frame_t g_sent[SIM_MAX_FRAMES];  // 本端发出的帧
+static uint32_t g_sent_count;
+static sim_frame_t g_rx[SIM_MAX_FRAMES];    // 等待本端接收的帧
+static uint32_t g_rx_head;
+static uint32_t g_rx_tail;
+static sim_script_t g_script[SIM_MAX_SCRIPT];
+static uint32_t g_script_count;
+static uint32_t g_script_next;
+
+static uint32_t sim_get_tick(void)
+{
+    return g_tick++;
+}
+
+static int sim_can_send(uint32_t id, const uint8_t *data, uint8_t len)
+{
+    if (g_sent_count >= SIM_MAX_FRAMES) {
+        return 1;
+    }
+    sim_frame_t *f = &g_sent[g_sent_count++];
+    f->id = id;
+    f->len = len;
+    memcpy(f->data, data, len);
+    f->tick = g_tick;
+    return 0;
+}
+
+static int sim_can_recv(uint32_t *id, uint8_t *data, uint8_t *len)
+{
+    if (g_script_next < g_script_count && g_sent_count >= g_script[g_script_next].after_sent &&
+        g_tick >= g_script[g_script_next].at_tick) {
+        g_rx[g_rx_tail++ % SIM_MAX_FRAMES] = g_script[g_script_next++].frame;
+    }
+    if (g_rx_head == g_rx_tail) {
+        return 0;
+    }
+    const sim_frame_t *f = &g_rx[g_rx_head++ % SIM_MAX_FRAMES];
+    *id = f->id;
+    *len = f->len;
+    memcpy(data, f->data, f->len);
+    return 1;
+}
+
+static const boot_isotp_ops_t g_ops = {
+    .can_send = sim_can_send,
+    .can_recv = sim_can_recv,
+    .get_tick = sim_get_tick,
+};
+
+static void sim_reset(void)
+{
+    g_tick = 0U;
+    g_sent_count = 0U;
+    g_rx_head = 0U;
+    g_rx_tail = 0U;
+    g_script_count = 0U;
+    g_script_next = 0U;
+}
+
+static sim_frame_t sim_make(uint32_t id, const uint8_t *data, uint8_t len)
+{
+    sim_frame_t f;
+    memset(&f, 0, sizeof(f));
+    f.id = id;
+    f.len = len;
+    memcpy(f.data, data, len);
+    return f;
+}
+
+static void sim_push(const uint8_t *data, uint8_t len)
+{
+    g_rx[g_rx_tail++ % SIM_MAX_FRAMES] = sim_make(SIM_RX_ID, data, len);
+}
+
+static void sim_script_fc(uint32_t after_sent, uint32_t at_tick, uint8_t status, uint8_t bs, uint8_t st_min)
+{
+    const uint8_t fc[8] = {(uint8_t)(0x30U | status), bs, st_min, 0xCCU, 0xCCU, 0xCCU, 0xCCU, 0xCCU};
+    g_script[g_script_count].after_sent = after_sent;
+    g_script[g_script_count].at_tick = at_tick;
+    g_script[g_script_count].frame = sim_make(SIM_RX_ID, fc, 8U);
+    g_script_count++;
+}
+
+static uint8_t sim_pattern(uint32_t pos)
+{
+    return (uint8_t)(pos * 37U + (pos >> 8) + 11U);
+}
+
+/* 对端发出 msg 的首帧；长度超过 12 位时使用 32 位转义长度 */
+static void sim_push_ff(const uint8_t *msg, uint32_t size, uint8_t frame_len)
+{
+    uint8_t frame[BOOT_ISOTP_CANFD_DLEN];
+    uint32_t offset = 2U;
+    if (size <= 0x0FFFU) {
+        frame[0] = (uint8_t)(0x10U | (size >> 8));
+        frame[1] = (uint8_t)size;
+    } else {
+        frame[0] = 0x10U;
+        frame[1] = 0U;
+        frame[2] = (uint8_t)(size >> 24);
+        frame[3] = (uint8_t)(size >> 16);
+        frame[4] = (uint8_t)(size >> 8);
+        frame[5] = (uint8_t)size;
+        offset = 6U;
+    }
+    memcpy(&frame[offset], msg, frame_len - offset);
+    sim_push(frame, frame_len);
+}
+
+static uint32_t sim_ff_chunk(uint32_t size, uint8_t frame_len)
+{
+    return frame_len - (size <= 0x0FFFU ? 2U : 6U);
+}
+
+/* 对端发出 msg 的第 index 个连续帧（从 0 计），序号由调用方给出以便构造跳号 */
+static void sim_push_cf(const uint8_t *msg, uint32_t size, uint8_t frame_len, uint32_t index, uint8_t sn)
+{
+    uint8_t frame[BOOT_ISOTP_CANFD_DLEN];
+    uint32_t pos = sim_ff_chunk(size, frame_len) + index * (frame_len - 1U);
+    uint32_t chunk = size - pos;
+    if (chunk > frame_len - 1U) {
+        chunk = frame_len - 1U;
+    }
+    frame[0] = (uint8_t)(0x20U | (sn & 0x0FU));
+    memcpy(&frame[1], &msg[pos], chunk);
+    memset(&frame[1U + chunk], BOOT_ISOTP_PADDING, frame_len - 1U - chunk);
+    sim_push(frame, frame_len);
+}
+
+static uint32_t sim_cf_count(uint32_t size, uint8_t frame_len)
+{
+    uint32_t rest = size - sim_ff_chunk(size, frame_len);
+    return (rest + frame_len - 2U) / (frame_len - 1U);
+}
+
+/* 本端发出的第 from 帧之后有几个流控帧，最后一个的状态与 BS 写入 status / bs */
+static uint32_t sim_count_fc(uint32_t from, uint8_t *status, uint8_t *bs)
+{
+    uint32_t n = 0U;
+    for (uint32_t i = from; i < g_sent_count; i++) {
+        if ((g_sent[i].data[0] & 0xF0U) == 0x30U) {
+            n++;
+            if (status != NULL) {
+                *status = g_sent[i].data[0] & 0x0FU;
+            }
+            if (bs != NULL) {
+                *bs = g_sent[i].data[1];
+            }
+        }
+    }
+    return n;
+}
+
+static bool check(bool ok, const char *name, const char *detail)
+{
+    printf("%-4s %-34s %s\n", ok ? "ok" : "FAIL", name, detail);
+    return ok;
+}
+
+static bool init_ctx(boot_isotp_t *ctx, uint8_t frame_len, uint8_t block_size, uint8_t st_min)
+{
+    const boot_isotp_config_t cfg = {
+        .tx_id = SIM_TX_ID,
+        .rx_id = SIM_RX_ID,
+        .frame_len = frame_len,
+        .block_size = block_size,
+        .st_min = st_min,
+    };
+    sim_reset();
+    return boot_isotp_init(ctx, &g_ops, &cfg) == BOOT_ISOTP_OK;
+}
+
+/* 经典单帧、CAN-FD 转义单帧、非本端 ID 与非法长度单帧 */
+static bool case_single_frame(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t buf[128];
+    char detail[96];
+    bool ok = init_ctx(&ctx, 64U, 0U, 0U);
+
+    const uint8_t sf[8] = {0x05U, 'h', 'e', 'l', 'l', 'o', 0xCCU, 0xCCU};
+    sim_push(sf, 8U);
+    uint8_t other[8] = {0x03U, 'x', 'y', 'z'};
+    g_rx[g_rx_tail++ % SIM_MAX_FRAMES] = sim_make(0x123U, other, 8U);   // 其他 ID 忽略
+    const uint8_t bad[8] = {0x07U, 1, 2, 3};                               // 长度超出帧长
+    sim_push(bad, 4U);
+    uint8_t fd[64];
+    fd[0] = 0x00U;
+    fd[1] = 60U;
+    for (uint32_t i = 0U; i < 60U; i++) {
+        fd[2U + i] = sim_pattern(i);
+    }
+    fd[62] = fd[63] = BOOT_ISOTP_PADDING;
+    sim_push(fd, 64U);
+
+    uint32_t n = boot_isotp_read(&ctx, buf, sizeof(buf));
+    ok = ok && n == 65U && memcmp(buf, "hello", 5U) == 0 && memcmp(&buf[5], &fd[2], 60U) == 0 &&
+         g_sent_count == 0U;
+    snprintf(detail, sizeof(detail), "read %lu bytes, %lu frames sent", (unsigned long)n,
+             (unsigned long)g_sent_count);
+    return check(ok, "single frame (classic + FD escape)", detail);
+}
+
+/*
+ * FF + CF 重组：每块结束回一个 CTS，序号 15 之后回绕到 0；
+ * size 超过 12 位时使用 32 位长度首帧，接收缓存装不下整条报文，边读边放行
+ */
+static bool case_multi_frame(const char *name, uint8_t frame_len, uint8_t block_size, uint32_t size)
+{
+    static boot_isotp_t ctx;
+    static uint8_t msg[8192];
+    static uint8_t out[8192];
+    char detail[128];
+    bool ok = init_ctx(&ctx, frame_len, block_size, 0U);
+    uint32_t bs = (block_size != 0U) ? block_size : ((BOOT_ISOTP_RX_BUF_SIZE / 2U) / (frame_len - 1U));
+    if (bs > 0xFFU) {
+        bs = 0xFFU;
+    }
+
+    for (uint32_t i = 0U; i < size; i++) {
+        msg[i] = sim_pattern(i);
+    }
+    uint32_t got = 0U;
+    uint32_t cfs = sim_cf_count(size, frame_len);
+    uint32_t fc_seen = 0U;
+    uint32_t waits = 0U;
+    bool fc_ok = true;
+
+    sim_push_ff(msg, size, frame_len);
+    boot_isotp_poll(&ctx);
+    for (uint32_t index = 0U; index < cfs && ok;) {
+        /* 对端只在收到 CTS 后发送一块 */
+        uint8_t status = 0xFFU;
+        uint8_t fc_bs = 0U;
+        uint32_t fc = sim_count_fc(0U, &status, &fc_bs);
+        if (fc == fc_seen) {
+            uint32_t n = boot_isotp_read(&ctx, &out[got], 100U);   // 等流控：读走部分数据腾出空间
+            got += n;
+            waits++;
+            if (n == 0U) {
+                ok = false;
+            }
+            continue;
+        }
+        fc_ok = fc_ok && fc == fc_seen + 1U && status == 0U && fc_bs == bs;
+        fc_seen = fc;
+        for (uint32_t k = 0U; k < bs && index < cfs; k++, index++) {
+            sim_push_cf(msg, size, frame_len, index, (uint8_t)(index + 1U));
+        }
+        boot_isotp_poll(&ctx);
+    }
+    for (uint32_t n; (n = boot_isotp_read(&ctx, &out[got], sizeof(out) - got)) > 0U;) {
+        got += n;
+    }
+
+    ok = ok && fc_ok && got == size && memcmp(out, msg, size) == 0 && ctx.rx_overflow == 0U &&
+         fc_seen == (cfs + bs - 1U) / bs && (size <= BOOT_ISOTP_RX_BUF_SIZE || waits > 0U);
+    snprintf(detail, sizeof(detail), "size=%lu frame=%u bs=%lu: %lu CF, %lu FC, %lu reads while held",
+             (unsigned long)size, (unsigned)frame_len, (unsigned long)bs, (unsigned long)cfs,
+             (unsigned long)fc_seen, (unsigned long)waits);
+    return check(ok, name, detail);
+}
+
+/* CF 序号跳变：放弃本报文并计入 rx_overflow，后续 CF 忽略，新的 SF 照常接收 */
+static bool case_wrong_sn(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t msg[40];
+    uint8_t buf[64];
+    char detail[96];
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+
+    for (uint32_t i = 0U; i < sizeof(msg); i++) {
+        msg[i] = sim_pattern(i);
+    }
+    sim_push_ff(msg, sizeof(msg), 8U);
+    sim_push_cf(msg, sizeof(msg), 8U, 0U, 1U);
+    sim_push_cf(msg, sizeof(msg), 8U, 2U, 3U);     // 序号 2 丢失
+    sim_push_cf(msg, sizeof(msg), 8U, 3U, 4U);
+    const uint8_t sf[8] = {0x03U, 'n', 'e', 'w', 0xCCU, 0xCCU, 0xCCU, 0xCCU};
+    sim_push(sf, 8U);
+
+    uint32_t n = boot_isotp_read(&ctx, buf, sizeof(buf));
+    /* 序号错误之前的 6 + 7 字节已进入字节流（由上层协议按帧头重新同步），之后只有新单帧 */
+    ok = ok && n == 6U + 7U + 3U && memcmp(buf, msg, 13U) == 0 && memcmp(&buf[13], "new", 3U) == 0 &&
+         ctx.rx_overflow == 1U && ctx.rx_remain == 0U && sim_count_fc(0U, NULL, NULL) == 1U;
+    snprintf(detail, sizeof(detail), "read %lu bytes, dropped %u", (unsigned long)n, (unsigned)ctx.rx_overflow);
+    return check(ok, "wrong sequence number", detail);
+}
+
+/* 连续帧中断：超过 N_Cr 后放弃未完成的报文 */
+static bool case_cf_timeout(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t msg[40];
+    uint8_t buf[64];
+    char detail[96];
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+
+    for (uint32_t i = 0U; i < sizeof(msg); i++) {
+        msg[i] = sim_pattern(i);
+    }
+    sim_push_ff(msg, sizeof(msg), 8U);
+    sim_push_cf(msg, sizeof(msg), 8U, 0U, 1U);
+    boot_isotp_poll(&ctx);
+    bool pending = ctx.rx_remain != 0U;
+    g_tick += BOOT_ISOTP_TIMEOUT_MS;
+    (void)boot_isotp_read(&ctx, buf, sizeof(buf));
+    sim_push_cf(msg, sizeof(msg), 8U, 1U, 2U);     // 超时后迟到的 CF 不再接收
+    uint32_t late = boot_isotp_read(&ctx, buf, sizeof(buf));
+
+    ok = ok && pending && ctx.rx_remain == 0U && ctx.rx_overflow == 1U && late == 0U;
+    snprintf(detail, sizeof(detail), "dropped %u, late CF read %lu", (unsigned)ctx.rx_overflow, (unsigned long)late);
+    return check(ok, "consecutive frame timeout", detail);
+}
+
+/* 接收缓存装不下首帧载荷：回 FC OVERFLOW；装不下单帧：丢弃 */
+static bool case_rx_overflow(void)
+{
+    static boot_isotp_t ctx;
+    static uint8_t buf[BOOT_ISOTP_RX_BUF_SIZE];
+    uint8_t msg[100];
+    char detail[96];
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+
+    uint8_t sf[8] = {0x07U};
+    uint32_t filled = 0U;
+    while (filled + 7U <= BOOT_ISOTP_RX_BUF_SIZE) {
+        memset(&sf[1], (uint8_t)filled, 7U);
+        sim_push(sf, 8U);
+        filled += 7U;
+    }
+    sim_push(sf, 8U);                               // 剩余空间不足 7 字节：丢弃
+    boot_isotp_poll(&ctx);
+    uint8_t dropped_sf = ctx.rx_overflow;
+
+    for (uint32_t i = 0U; i < sizeof(msg); i++) {
+        msg[i] = sim_pattern(i);
+    }
+    sim_push_ff(msg, sizeof(msg), 8U);
+    boot_isotp_poll(&ctx);
+    uint8_t status = 0xFFU;
+    uint32_t fc = sim_count_fc(0U, &status, NULL);
+    sim_push_cf(msg, sizeof(msg), 8U, 0U, 1U);      // 对端应放弃发送；即使发来也不接收
+    boot_isotp_poll(&ctx);
+    uint32_t n = boot_isotp_read(&ctx, buf, sizeof(buf));
+
+    ok = ok && dropped_sf == 1U && fc == 1U && status == 0x02U && ctx.rx_overflow == 2U && n == filled &&
+         ctx.rx_remain == 0U;
+    snprintf(detail, sizeof(detail), "buffered %lu, dropped %u, FC status %u", (unsigned long)n,
+             (unsigned)ctx.rx_overflow, (unsigned)status);
+    return check(ok, "receive buffer overflow", detail);
+}
+
+/* 发送：CTS BS=2 STmin=5ms 分块，第二个流控 BS=0 一次发完；检查序号、分块与帧间隔 */
+static bool case_tx_blocks(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t msg[60];
+    char detail[128];
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+
+    for (uint32_t i = 0U; i < sizeof(msg); i++) {
+        msg[i] = sim_pattern(i);
+    }
+    sim_script_fc(1U, 0U, 0U, 2U, 5U);             // FF 之后
+    sim_script_fc(3U, 0U, 0U, 0U, 0U);             // 2 个 CF 之后
+    boot_isotp_status_t status = boot_isotp_write(&ctx, msg, sizeof(msg));
+
+    /* 60 字节：FF 6 + 8 个 CF（7*7 + 5） */
+    uint8_t out[64];
+    uint32_t got = 0U;
+    bool frames_ok = g_sent_count == 9U && g_sent[0].data[0] == 0x10U && g_sent[0].data[1] == sizeof(msg);
+    if (frames_ok) {
+        memcpy(out, &g_sent[0].data[2], 6U);
+        got = 6U;
+    }
+    for (uint32_t i = 1U; frames_ok && i < g_sent_count; i++) {
+        uint32_t chunk = sizeof(msg) - got < 7U ? sizeof(msg) - got : 7U;
+        frames_ok = g_sent[i].id == SIM_TX_ID && g_sent[i].len == 8U && g_sent[i].data[0] == (0x20U | (i & 0x0FU));
+        memcpy(&out[got], &g_sent[i].data[1], chunk);
+        got += chunk;
+    }
+    frames_ok = frames_ok && g_sent[8].data[6] == BOOT_ISOTP_PADDING && g_sent[8].data[7] == BOOT_ISOTP_PADDING;
+    bool gap_ok = g_sent_count == 9U && g_sent[2].tick - g_sent[1].tick > 5U;
+
+    ok = ok && status == BOOT_ISOTP_OK && frames_ok && gap_ok && got == sizeof(msg) && memcmp(out, msg, got) == 0;
+    snprintf(detail, sizeof(detail), "status %d, %lu frames, CF gap %lu ms", (int)status,
+             (unsigned long)g_sent_count, g_sent_count >= 3U ? (unsigned long)(g_sent[2].tick - g_sent[1].tick) : 0UL);
+    return check(ok, "transmit blocks + STmin", detail);
+}
+
+/* 发送：WAIT 重新计时，累计等待超过 N_Bs 仍继续；之后的 CTS 放行 */
+static bool case_tx_wait(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t msg[20];
+    char detail[96];
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+
+    memset(msg, 0x5AU, sizeof(msg));
+    uint32_t step = BOOT_ISOTP_TIMEOUT_MS * 3U / 4U;
+    sim_script_fc(1U, step, 1U, 0U, 0U);
+    sim_script_fc(1U, step * 2U, 1U, 0U, 0U);
+    sim_script_fc(1U, step * 3U, 0U, 0U, 0U);
+    boot_isotp_status_t status = boot_isotp_write(&ctx, msg, sizeof(msg));
+
+    ok = ok && status == BOOT_ISOTP_OK && g_sent_count == 3U && g_sent[1].tick >= step * 3U;
+    snprintf(detail, sizeof(detail), "status %d, %lu frames, first CF at %lu ms", (int)status,
+             (unsigned long)g_sent_count, g_sent_count >= 2U ? (unsigned long)g_sent[1].tick : 0UL);
+    return check(ok, "transmit flow control WAIT", detail);
+}
+
+/* 发送：对端回 OVERFLOW 时返回错误，不发 CF；对端不回流控时超时 */
+static bool case_tx_overflow_timeout(void)
+{
+    static boot_isotp_t ctx;
+    uint8_t msg[20];
+    char detail[96];
+
+    memset(msg, 0xA5U, sizeof(msg));
+    bool ok = init_ctx(&ctx, 8U, 0U, 0U);
+    sim_script_fc(1U, 0U, 2U, 0U, 0U);
+    boot_isotp_status_t overflow = boot_isotp_write(&ctx, msg, sizeof(msg));
+    uint32_t overflow_sent = g_sent_count;
+
+    ok = init_ctx(&ctx, 8U, 0U, 0U) && ok;
+    boot_isotp_status_t timeout = boot_isotp_write(&ctx, msg, sizeof(msg));
+    uint32_t timeout_tick = g_tick;
+
+    ok = ok && overflow == BOOT_ISOTP_ERROR && overflow_sent == 1U && timeout == BOOT_ISOTP_TIMEOUT &&
+         g_sent_count == 1U && timeout_tick >= BOOT_ISOTP_TIMEOUT_MS;
+    snprintf(detail, sizeof(detail), "overflow -> %d (%lu sent), silent -> %d after %lu ms", (int)overflow,
+             (unsigned long)overflow_sent, (int)timeout, (unsigned long)timeout_tick);
+    return check(ok, "transmit OVERFLOW / N_Bs timeout", detail);
+}
+
+int main(void)
+{
+    int failures = 0;
+    failures += !case_single_frame();
+    failures += !case_multi_frame("classic FF + CF, bs=4", 8U, 4U, 100U);
+    failures += !case_multi_frame("classic, sn wraps, backpressure", 8U, 0U, 3000U);
+    failures += !case_multi_frame("CAN-FD, 32-bit FF length", 64U, 0U, 6000U);
+    failures += !case_wrong_sn();
+    failures += !case_cf_timeout();
+    failures += !case_rx_overflow();
+    failures += !case_tx_blocks();
+    failures += !case_tx_wait();
+    failures += !case_tx_overflow_timeout();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// boot_kernel 等价性测试：累加和、CRC32 与擦除值比较在各种起始对齐、尾长与长输入下与逐字节参考实现逐一比较
+// 默认编译得到主机上的可移植实现（按字 SWAR 累加和）；定义 TEST_KERNEL_USADA8 时用 C 仿真 USADA8 指令，
+// 直接包含 boot_kernel.c 编译 Cortex-M DSP 路径
+#include "boot_kernel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TEST_KERNEL_USADA8
+/* USADA8 Rd, Rn, Rm, Ra：Ra 加上 Rn、Rm 四个字节差的绝对值之和，Rm 为 0 时即 4 字节之和 */
+static uint32_t test_usada8(uint32_t x, uint32_t acc)
+{
+    return acc + (x & 0xFFU) + ((x >> 8) & 0xFFU) + ((x >> 16) & 0xFFU) + (x >> 24);
+}
+#define KERNEL_USADA8(x, acc)         test_usada8((x), (acc))
+#include "boot_kernel.c"
+#define TEST_SUM_PATH                 "USADA8 (emulated)"
+#else
+#define TEST_SUM_PATH                 "SWAR"
+#endif
+
+#define TEST_BUF_SIZE                 (70000U + 16U)
+#define TEST_RANDOM_ITERS             20000U
+
+static uint8_t g_buf[TEST_BUF_SIZE];
+static uint8_t g_erased_buf[TEST_BUF_SIZE];
+static unsigned long g_checks;
+static unsigned long g_failures;
+
+static uint32_t test_rand(void)
+{
+    static uint32_t state = 49U;
+    state = state * 1103515245U + 12345U;
+    return state >> 8;
+}
+
+static uint16_t ref_sum16(uint16_t sum, const uint8_t *data, uint32_t len)
+{
+    while (len-- > 0U) {
+        sum = (uint16_t)(sum + *data++);
+    }
+    return sum;
+}
+
+/* 逐位计算，不依赖任何表 */
+static uint32_t ref_crc32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    crc = ~crc;
+    while (len-- > 0U) {
+        crc ^= *data++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+static bool ref_is_erased(const uint8_t *data, uint32_t len, uint32_t erased)
+{
+    for (uint32_t i = 0U; i < len; i++) {
+        if (data[i] != (uint8_t)(erased >> (8U * (i & 3U)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void expect(bool ok, const char *what, uint32_t offset, uint32_t len)
+{
+    g_checks++;
+    if (!ok) {
+        if (g_failures < 10U) {
+            printf("mismatch: %s offset=%lu len=%lu\n", what, (unsigned long)offset, (unsigned long)len);
+        }
+        g_failures++;
+    }
+}
+
+/* 在 buf + offset 处比较一段：累加和（含非 0 初值与分段调用）、CRC32（含分段调用） */
+static void check_sum_crc(const uint8_t *buf, uint32_t offset, uint32_t len)
+{
+    const uint8_t *p = &buf[offset];
+    uint16_t sum0 = (uint16_t)test_rand();
+    uint32_t cut = (len != 0U) ? test_rand() % len : 0U;
+
+    expect(boot_sum16(0U, p, len) == ref_sum16(0U, p, len), "sum16", offset, len);
+    expect(boot_sum16(sum0, p, len) == ref_sum16(sum0, p, len), "sum16 seeded", offset, len);
+    expect(boot_sum16(boot_sum16(sum0, p, cut), &p[cut], len - cut) == ref_sum16(sum0, p, len), "sum16 split",
+           offset, len);
+    expect(boot_crc32(0U, p, len) == ref_crc32(0U, p, len), "crc32", offset, len);
+    expect(boot_crc32(boot_crc32(0U, p, cut), &p[cut], len - cut) == ref_crc32(0U, p, len), "crc32 split", offset,
+           len);
+}
+
+/* 擦除比较：全擦除值为真，任意一字节的任意一位翻转后为假 */
+static void check_erased(uint32_t offset, uint32_t len, uint32_t erased, bool flip_all)
+{
+    uint8_t *p = &g_erased_buf[offset];
+    for (uint32_t i = 0U; i < len; i++) {
+        p[i] = (uint8_t)(erased >> (8U * (i & 3U)));
+    }
+    expect(boot_is_erased(p, len, erased) && ref_is_erased(p, len, erased), "is_erased clean", offset, len);
+
+    uint32_t positions = flip_all ? len : ((len != 0U) ? 3U : 0U);
+    for (uint32_t n = 0U; n < positions; n++) {
+        uint32_t pos = flip_all ? n : ((n == 0U) ? 0U : (n == 1U) ? len - 1U : test_rand() % len);
+        uint8_t bit = (uint8_t)(1U << (test_rand() & 7U));
+        p[pos] ^= bit;
+        expect(!boot_is_erased(p, len, erased), "is_erased flipped", offset, len);
+        p[pos] ^= bit;
+    }
+}
+
+int main(void)
+{
+    static const uint32_t erased_values[] = {0xFFFFFFFFU, 0xE339E339U, 0x00000000U};
+    static const uint32_t long_lens[] = {511U, 512U, 513U, 1024U, 4096U + 5U, 65536U + 3U, 70000U};
+
+    for (uint32_t i = 0U; i < TEST_BUF_SIZE; i++) {
+        g_buf[i] = (uint8_t)test_rand();
+    }
+
+    // 已知向量（与 zlib crc32 一致）
+    expect(boot_crc32(0U, (const uint8_t *)"123456789", 9U) == 0xCBF43926U, "crc32 check value", 0U, 9U);
+    expect(boot_crc32(0U, (const uint8_t *)"The quick brown fox jumps over the lazy dog", 43U) == 0x414FA339U,
+           "crc32 zlib value", 0U, 43U);
+    expect(boot_crc32(0U, g_buf, 0U) == 0U, "crc32 empty", 0U, 0U);
+
+    // 起始对齐 0~7 × 长度 0~71（覆盖各种头部与 0~7 字节尾部，以及一次 16 字节展开）
+    for (uint32_t offset = 0U; offset < 8U; offset++) {
+        for (uint32_t len = 0U; len < 72U; len++) {
+            check_sum_crc(g_buf, offset, len);
+            for (uint32_t e = 0U; e < sizeof(erased_values) / sizeof(erased_values[0]); e++) {
+                check_erased(offset, len, erased_values[e], true);
+            }
+        }
+    }
+
+    // 长输入：跨过 SWAR 的 128 字折叠边界；全 0xFF 数据让每个 16 位通道取到最大增量
+    static uint8_t ones[TEST_BUF_SIZE];
+    memset(ones, 0xFF, sizeof(ones));
+    for (uint32_t offset = 0U; offset < 8U; offset++) {
+        for (uint32_t n = 0U; n < sizeof(long_lens) / sizeof(long_lens[0]); n++) {
+            for (uint32_t tail = 0U; tail < 8U; tail++) {
+                uint32_t len = long_lens[n] + tail;
+                if (offset + len > TEST_BUF_SIZE) {
+                    continue;
+                }
+                check_sum_crc(g_buf, offset, len);
+                check_sum_crc(ones, offset, len);
+                check_erased(offset, len, erased_values[(offset + tail) % 3U], false);
+            }
+        }
+    }
+
+    // 随机起始与长度
+    for (uint32_t it = 0U; it < TEST_RANDOM_ITERS; it++) {
+        uint32_t offset = test_rand() % 8U;
+        uint32_t len = (it % 16U == 0U) ? test_rand() % 70000U : test_rand() % 1100U;
+        check_sum_crc(g_buf, offset, len);
+        check_erased(offset, len, erased_values[it % 3U], false);
+    }
+
+    printf("boot_kernel [%s sum16, slicing-by-4 crc32, is_erased]: %lu checks, %lu failures: %s\n", TEST_SUM_PATH,
+           g_checks, g_failures, g_failures == 0U ? "PASS" : "FAIL");
+    return g_failures == 0U ? 0 : 1;
+}
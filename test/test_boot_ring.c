@@ -0,0 +1,171 @@
+// boot_ring 压力测试：生产者、消费者各一个线程，变长写入数百万次，逐字节检查顺序且不丢不重
+#include "boot_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RING_SIZE                 256U
+#define RING_WRITE_MAX            97U       // 单次写入最大长度，不整除容量，写入位置在环内不断错开
+#define RING_DEFAULT_WRITES       4000000UL
+
+static boot_ring_t g_ring;
+static uint8_t g_ring_buf[RING_SIZE];
+static unsigned long g_writes = RING_DEFAULT_WRITES;
+static volatile unsigned long g_total_bytes;   // 生产者写完后发布总字节数，消费者读到这个数为止
+static volatile int g_producer_done;
+
+/* 数据流第 pos 字节的取值，消费者据此检查顺序 */
+static uint8_t ring_pattern(uint64_t pos)
+{
+    uint64_t x = pos * 0x9E3779B97F4A7C15ULL;
+    return (uint8_t)(x >> 56);
+}
+
+static uint32_t ring_rand(uint32_t *state)
+{
+    *state = *state * 1664525U + 1013904223U;
+    return *state >> 8;
+}
+
+/**
+ * @brief 生产者：交替用拷贝接口 boot_ring_write 与零拷贝接口 acquire/commit_write 写入变长数据
+ */
+static void *ring_producer(void *arg)
+{
+    uint8_t chunk[RING_WRITE_MAX];
+    uint64_t pos = 0U;
+    uint32_t seed = 0x12345678U;
+    (void)arg;
+
+    for (unsigned long n = 0; n < g_writes; n++) {
+        uint32_t len = 1U + ring_rand(&seed) % RING_WRITE_MAX;
+        for (uint32_t i = 0U; i < len; i++) {
+            chunk[i] = ring_pattern(pos + i);
+        }
+        uint32_t done = 0U;
+        bool zero_copy = (n & 3U) == 3U;
+        while (done < len) {
+            uint32_t wrote;
+            if (zero_copy) {
+                uint8_t *dst;
+                wrote = boot_ring_acquire_write(&g_ring, &dst);
+                if (wrote > len - done) {
+                    wrote = len - done;
+                }
+                memcpy(dst, &chunk[done], wrote);
+                boot_ring_commit_write(&g_ring, wrote);
+            } else {
+                wrote = boot_ring_write(&g_ring, &chunk[done], len - done);
+            }
+            if (wrote == 0U) {
+                sched_yield();   // 环满，让消费者运行
+            }
+            done += wrote;
+        }
+        pos += len;
+        if ((ring_rand(&seed) & 7U) == 0U) {
+            sched_yield();   // 随机让出，单核主机上也能让读写位置在环内任意交错
+        }
+    }
+
+    g_total_bytes = (unsigned long)pos;
+    __atomic_store_n(&g_producer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * @brief 检查 data 是否为数据流 pos 起的 len 字节，不一致时直接退出（生产者可能正阻塞在环满上）
+ */
+static void ring_check(const uint8_t *data, uint32_t len, uint64_t pos)
+{
+    for (uint32_t i = 0U; i < len; i++) {
+        if (data[i] != ring_pattern(pos + i)) {
+            printf("mismatch at byte %llu: got 0x%02X, expected 0x%02X\nFAIL\n",
+                   (unsigned long long)(pos + i), data[i], ring_pattern(pos + i));
+            exit(1);
+        }
+    }
+}
+
+/**
+ * @brief 消费者：交替用 boot_ring_read 拷贝读取，以及用 boot_ring_peek 取回绕两侧的两段、
+ *        检查后一次提交（与核心在接收环中校验跨环末尾整帧的用法相同）
+ */
+static void *ring_consumer(void *arg)
+{
+    uint8_t buf[RING_SIZE];
+    uint64_t pos = 0U;
+    uint32_t seed = 0x87654321U;
+    unsigned long reads = 0;
+    bool *ok = (bool *)arg;
+
+    for (;;) {
+        uint32_t got;
+        if ((reads++ & 1U) == 0U) {
+            got = boot_ring_read(&g_ring, buf, 1U + ring_rand(&seed) % RING_SIZE);
+            ring_check(buf, got, pos);
+        } else {
+            const uint8_t *first;
+            const uint8_t *second;
+            uint32_t len1 = boot_ring_peek(&g_ring, 0U, &first);
+            uint32_t len2 = boot_ring_peek(&g_ring, len1, &second);
+            ring_check(first, len1, pos);
+            ring_check(second, len2, pos + len1);
+            // 只提交一部分，下一轮从中间继续 peek
+            got = len1 + len2;
+            if (got > 1U) {
+                got -= ring_rand(&seed) % (got / 2U);
+            }
+            boot_ring_commit_read(&g_ring, got);
+        }
+        pos += got;
+
+        if (got == 0U) {
+            if (__atomic_load_n(&g_producer_done, __ATOMIC_ACQUIRE) && boot_ring_data_len(&g_ring) == 0U) {
+                break;
+            }
+            sched_yield();   // 环空，让生产者运行
+        } else if ((ring_rand(&seed) & 7U) == 0U) {
+            sched_yield();
+        }
+    }
+
+    if (pos != g_total_bytes) {
+        printf("consumed %llu bytes, produced %lu\n", (unsigned long long)pos, g_total_bytes);
+        *ok = false;
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        g_writes = strtoul(argv[1], NULL, 0);
+    }
+    if (boot_ring_init(&g_ring, g_ring_buf, RING_SIZE) != BOOT_RING_OK) {
+        printf("boot_ring_init failed\n");
+        return 1;
+    }
+    // 计数从回绕点前开始，覆盖 head / tail 越过 2^32 的情况
+    g_ring.head = 0xFFFFF000U;
+    g_ring.tail = 0xFFFFF000U;
+
+    bool ok = true;
+    pthread_t producer;
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, ring_consumer, &ok) != 0 ||
+        pthread_create(&producer, NULL, ring_producer, NULL) != 0) {
+        printf("pthread_create failed\n");
+        return 1;
+    }
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    printf("boot_ring: %lu writes, %lu bytes through a %u-byte ring, head=0x%08lX: %s\n",
+           g_writes, g_total_bytes, RING_SIZE, (unsigned long)g_ring.head, ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
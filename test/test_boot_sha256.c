@@ -0,0 +1,98 @@
+// boot_sha256 已知答案测试：FIPS 180-2 附录 B 的三个消息（含两块填充）与 100 万个 'a'（奇数长度分段流式输入）
+#include "boot_sha256.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MILLION_A_LEN             1000000U
+
+typedef struct {
+    const char *name;
+    const char *msg;
+    uint8_t digest[BOOT_SHA256_DIGEST_SIZE];
+} sha256_vector_t;
+
+static const sha256_vector_t g_vectors[] = {
+    {
+        "empty", "",
+        {0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+         0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C, 0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55},
+    },
+    {
+        "abc", "abc",
+        {0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+         0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD},
+    },
+    {
+        /* 56 字节：长度字段放不进第一块，填充占满第二块 */
+        "56-byte", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+        {0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8, 0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+         0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67, 0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1},
+    },
+};
+
+static const uint8_t g_million_a_digest[BOOT_SHA256_DIGEST_SIZE] = {
+    0xCD, 0xC7, 0x6E, 0x5C, 0x99, 0x14, 0xFB, 0x92, 0x81, 0xA1, 0xC7, 0xE2, 0x84, 0xD7, 0x3E, 0x67,
+    0xF1, 0x80, 0x9A, 0x48, 0xA4, 0x97, 0x20, 0x0E, 0x04, 0x6D, 0x39, 0xCC, 0xC7, 0x11, 0x2C, 0xD0,
+};
+
+/* 分段长度循环使用，均为奇数且不整除块长，残留数据在各种偏移处与新输入拼接 */
+static const uint32_t g_chunks[] = {1U, 3U, 63U, 65U, 127U, 7U, 129U, 1001U};
+
+static uint8_t g_million_a[MILLION_A_LEN];
+
+static int check(bool ok, const char *name, const char *what)
+{
+    printf("%-4s %-10s %s\n", ok ? "ok" : "FAIL", name, what);
+    return ok ? 0 : 1;
+}
+
+int main(void)
+{
+    int failures = 0;
+    uint8_t digest[BOOT_SHA256_DIGEST_SIZE];
+    boot_sha256_ctx_t sha;
+
+    for (size_t i = 0U; i < sizeof(g_vectors) / sizeof(g_vectors[0]); i++) {
+        const sha256_vector_t *v = &g_vectors[i];
+        uint32_t len = (uint32_t)strlen(v->msg);
+
+        boot_sha256_init(&sha);
+        boot_sha256_update(&sha, (const uint8_t *)v->msg, len);
+        boot_sha256_final(&sha, digest);
+        failures += check(memcmp(digest, v->digest, sizeof(digest)) == 0, v->name, "single update");
+
+        /* 在每个位置切成两段输入，结果必须相同 */
+        bool split_ok = true;
+        for (uint32_t cut = 0U; cut <= len; cut++) {
+            boot_sha256_init(&sha);
+            boot_sha256_update(&sha, (const uint8_t *)v->msg, cut);
+            boot_sha256_update(&sha, (const uint8_t *)v->msg + cut, len - cut);
+            boot_sha256_final(&sha, digest);
+            split_ok = split_ok && memcmp(digest, v->digest, sizeof(digest)) == 0;
+        }
+        failures += check(split_ok, v->name, "split at every offset");
+    }
+
+    memset(g_million_a, 'a', sizeof(g_million_a));
+    boot_sha256_init(&sha);
+    for (uint32_t offset = 0U, k = 0U; offset < MILLION_A_LEN; k++) {
+        uint32_t n = g_chunks[k % (sizeof(g_chunks) / sizeof(g_chunks[0]))];
+        if (n > MILLION_A_LEN - offset) {
+            n = MILLION_A_LEN - offset;
+        }
+        boot_sha256_update(&sha, &g_million_a[offset], n);
+        offset += n;
+    }
+    boot_sha256_final(&sha, digest);
+    failures += check(memcmp(digest, g_million_a_digest, sizeof(digest)) == 0, "1M 'a'", "odd-sized updates");
+
+    boot_sha256_init(&sha);
+    boot_sha256_update(&sha, g_million_a, MILLION_A_LEN);
+    boot_sha256_final(&sha, digest);
+    failures += check(memcmp(digest, g_million_a_digest, sizeof(digest)) == 0, "1M 'a'", "single update");
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// boot_ed25519 校验测试：RFC 8032 第 7.1 节 TEST 1 / TEST 2 必须通过，篡改 R、篡改消息、S + L（可塑签名）与错误公钥必须拒绝
+#include "boot_ed25519.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    uint8_t pub[BOOT_ED25519_PUBLIC_KEY_SIZE];
+    uint8_t msg[1];
+    uint32_t msg_len;
+    uint8_t sig[BOOT_ED25519_SIGNATURE_SIZE];
+} ed25519_vector_t;
+
+static const ed25519_vector_t g_vectors[] = {
+    {
+        "RFC 8032 TEST 1",
+        {0xD7, 0x5A, 0x98, 0x01, 0x82, 0xB1, 0x0A, 0xB7, 0xD5, 0x4B, 0xFE, 0xD3, 0xC9, 0x64, 0x07, 0x3A,
+         0x0E, 0xE1, 0x72, 0xF3, 0xDA, 0xA6, 0x23, 0x25, 0xAF, 0x02, 0x1A, 0x68, 0xF7, 0x07, 0x51, 0x1A},
+        {0x00},
+        0U,
+        {0xE5, 0x56, 0x43, 0x00, 0xC3, 0x60, 0xAC, 0x72, 0x90, 0x86, 0xE2, 0xCC, 0x80, 0x6E, 0x82, 0x8A,
+         0x84, 0x87, 0x7F, 0x1E, 0xB8, 0xE5, 0xD9, 0x74, 0xD8, 0x73, 0xE0, 0x65, 0x22, 0x49, 0x01, 0x55,
+         0x5F, 0xB8, 0x82, 0x15, 0x90, 0xA3, 0x3B, 0xAC, 0xC6, 0x1E, 0x39, 0x70, 0x1C, 0xF9, 0xB4, 0x6B,
+         0xD2, 0x5B, 0xF5, 0xF0, 0x59, 0x5B, 0xBE, 0x24, 0x65, 0x51, 0x41, 0x43, 0x8E, 0x7A, 0x10, 0x0B},
+    },
+    {
+        "RFC 8032 TEST 2",
+        {0x3D, 0x40, 0x17, 0xC3, 0xE8, 0x43, 0x89, 0x5A, 0x92, 0xB7, 0x0A, 0xA7, 0x4D, 0x1B, 0x7E, 0xBC,
+         0x9C, 0x98, 0x2C, 0xCF, 0x2E, 0xC4, 0x96, 0x8C, 0xC0, 0xCD, 0x55, 0xF1, 0x2A, 0xF4, 0x66, 0x0C},
+        {0x72},
+        1U,
+        {0x92, 0xA0, 0x09, 0xA9, 0xF0, 0xD4, 0xCA, 0xB8, 0x72, 0x0E, 0x82, 0x0B, 0x5F, 0x64, 0x25, 0x40,
+         0xA2, 0xB2, 0x7B, 0x54, 0x16, 0x50, 0x3F, 0x8F, 0xB3, 0x76, 0x22, 0x23, 0xEB, 0xDB, 0x69, 0xDA,
+         0x08, 0x5A, 0xC1, 0xE4, 0x3E, 0x15, 0x99, 0x6E, 0x45, 0x8F, 0x36, 0x13, 0xD0, 0xF1, 0x1D, 0x8C,
+         0x38, 0x7B, 0x2E, 0xAE, 0xB4, 0x30, 0x2A, 0xEE, 0xB0, 0x0D, 0x29, 0x16, 0x12, 0xBB, 0x0C, 0x00},
+    },
+};
+
+/* 群阶 L = 2^252 + 27742317777372353535851937790883648493，小端 */
+static const uint8_t g_order[32] = {
+    0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2, 0xDE, 0xF9, 0xDE, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+};
+
+static int check(bool ok, const char *name, const char *what)
+{
+    printf("%-4s %-16s %s\n", ok ? "ok" : "FAIL", name, what);
+    return ok ? 0 : 1;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    for (size_t i = 0U; i < sizeof(g_vectors) / sizeof(g_vectors[0]); i++) {
+        const ed25519_vector_t *v = &g_vectors[i];
+        uint8_t sig[BOOT_ED25519_SIGNATURE_SIZE];
+        uint8_t msg[1];
+        uint8_t pub[BOOT_ED25519_PUBLIC_KEY_SIZE];
+
+        failures += check(boot_ed25519_verify(v->sig, v->msg, v->msg_len, v->pub), v->name, "valid signature accepted");
+
+        memcpy(sig, v->sig, sizeof(sig));
+        sig[0] ^= 0x01U;
+        failures += check(!boot_ed25519_verify(sig, v->msg, v->msg_len, v->pub), v->name, "tampered R rejected");
+
+        memcpy(sig, v->sig, sizeof(sig));
+        sig[40] ^= 0x10U;
+        failures += check(!boot_ed25519_verify(sig, v->msg, v->msg_len, v->pub), v->name, "tampered S rejected");
+
+        /* 空消息追加一个字节，单字节消息改一位 */
+        msg[0] = (uint8_t)(v->msg[0] ^ 0x01U);
+        failures += check(!boot_ed25519_verify(v->sig, msg, 1U, v->pub), v->name, "tampered message rejected");
+
+        /* S + L 与 S 对同一消息在数学上等价，RFC 8032 要求拒绝 S >= L 以杜绝可塑签名 */
+        memcpy(sig, v->sig, sizeof(sig));
+        uint32_t carry = 0U;
+        for (uint32_t k = 0U; k < 32U; k++) {
+            carry += (uint32_t)sig[32U + k] + g_order[k];
+            sig[32U + k] = (uint8_t)carry;
+            carry >>= 8;
+        }
+        failures += check(carry == 0U && !boot_ed25519_verify(sig, v->msg, v->msg_len, v->pub), v->name,
+                          "S + L rejected");
+
+        memcpy(pub, g_vectors[(i + 1U) % 2U].pub, sizeof(pub));
+        failures += check(!boot_ed25519_verify(v->sig, v->msg, v->msg_len, pub), v->name, "other public key rejected");
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
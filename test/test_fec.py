@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+前向纠错（FEC）解码测试
+----------------
+帧流由上位机 fec_flash.py 的编码器生成（encode_groups / build_fec_start / stream_frames），设备侧为启用
+BOOT_CONFIG_ENABLE_FEC 的 link_node（真实核心与 boot_fec.c）。按用例丢弃指定的数据帧 / 校验帧后单向送入，
+检查恢复出的固件与标志位：摘要一致时核心自行提交（flag=APP、版本与日期写入）并复位，摘要不符时不提交：
+
+    python3 test_fec.py build/link_node_fec
+"""
+
+from __future__ import annotations
+
+import hashlib
+import random
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "PC tool" / "source"))
+
+from fec_flash import build_fec_start, encode_groups, stream_frames  # noqa: E402
+
+APP_START_ADDR = 0x08010000   # 与 boot_memmap.h 一致
+FLAG_REGION_ADDR = 0x080E0000
+FLASH_START_ADDR = 0x08000000
+FLAG_APP = 2
+FLAG_ERASED = 0xFFFFFFFF
+SESSION = 0x5A
+VERSION = 7
+DATE = 0x20261016
+
+
+def make_image(size: int, seed: int) -> bytes:
+    rng = random.Random(seed)
+    image = bytearray(rng.randrange(256) for _ in range(size))
+    image[0:8] = (0x20020000).to_bytes(4, "little") + (APP_START_ADDR + 0x1C1).to_bytes(4, "little")
+    return bytes(image)
+
+
+def run_case(node: str, workdir: Path, name: str, image: bytes, chunk: int, k: int, m: int,
+             drops: list[set[tuple[int, int]]], digest_ok: bool = True, idle: float = 2.0) -> tuple[bool, str]:
+    """
+    drops[p] 为第 p 轮丢弃的 (group, row)，轮数即 len(drops)；row < k 为数据帧，row >= k 为校验帧
+    """
+    groups = encode_groups(image, chunk, k, m)
+    digest = hashlib.sha256(image).digest()
+    if not digest_ok:
+        digest = bytes([digest[0] ^ 0x01]) + digest[1:]
+    start = build_fec_start(SESSION, len(image), chunk, k, m, VERSION, DATE, digest, None)
+
+    stream = bytearray()
+    sent = dropped = 0
+    for pass_drops in drops:
+        for group, row, frame in stream_frames(groups, SESSION, k, start, None):
+            if (group, row) in pass_drops:
+                dropped += 1
+                continue
+            stream += len(frame).to_bytes(2, "little") + frame
+            sent += 1
+
+    flash_path = workdir / f"flash_fec_{name}.bin"
+    # 送完后保持链路打开，等待节点自行提交复位；不提交的用例等满 idle 秒后关闭链路（节点随之退出）
+    proc = subprocess.Popen([node, str(flash_path), "0", "0"], stdin=subprocess.PIPE, stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE)
+    proc.stdin.write(bytes(stream))
+    proc.stdin.flush()
+    try:
+        proc.wait(timeout=idle)
+    except subprocess.TimeoutExpired:
+        pass
+    try:
+        proc.stdin.close()
+    except BrokenPipeError:
+        pass
+    proc.wait(timeout=10)
+    log = proc.stderr.read()
+    flash = flash_path.read_bytes()
+    app = flash[APP_START_ADDR - FLASH_START_ADDR :][: len(image) + 4]
+    region = flash[FLAG_REGION_ADDR - FLASH_START_ADDR :]
+    flag = int.from_bytes(region[0:4], "little")
+    version = int.from_bytes(region[4:8], "little")
+    date = int.from_bytes(region[8:12], "little")
+
+    image_ok = app[: len(image)] == image and app[len(image) :] == b"\xFF" * 4
+    if digest_ok:
+        ok = proc.returncode == 0 and image_ok and flag == FLAG_APP and version == VERSION and date == DATE
+    else:
+        ok = proc.returncode == 0 and flag == FLAG_ERASED   # 摘要不符：不提交，会话作废
+    text = (f"{name:<28} size={len(image):5d} chunk={chunk} k={k} m={m} passes={len(drops)}: "
+            f"{sent} frames sent, {dropped} dropped, image={'ok' if image_ok else 'BAD'}, "
+            f"flag=0x{flag:X}, exit={proc.returncode}")
+    if not ok:
+        text += "\n  " + "\n  ".join(log.decode(errors="replace").splitlines()[-5:])
+    return ok, text
+
+
+def main(argv: list[str]) -> int:
+    node = argv[1] if len(argv) > 1 else str(Path(__file__).resolve().parent / "build" / "link_node_fec")
+    # 27 帧：前 3 组各 8 帧，最后一组 3 帧且最后一帧只有 77 字节（按 0xFF 补齐参与编码）
+    image = make_image(26 * 256 + 77, 36)
+    large = make_image(40 * 512 + 300, 37)
+    k, m = 8, 3
+    last_group = 3
+    every_group_m = [{(0, 0), (0, 1), (0, 2)}, {(1, 3), (1, k), (1, k + 2)},
+                     {(2, 5), (2, 6), (2, 7)}, {(last_group, 0), (last_group, 1), (last_group, 2)}]
+
+    cases = [
+        # (名称, 固件, chunk, k, m, 各轮丢帧, 摘要正确)
+        ("no loss", image, 256, k, m, [set()], True),
+        ("m lost in every group", image, 256, k, m, [set().union(*every_group_m)], True),
+        ("short last frame lost", image, 256, k, m, [{(last_group, 2)}], True),
+        ("short last frame kept", image, 256, k, m, [{(last_group, 0), (last_group, 1), (last_group, k)}], True),
+        ("only parity left in group", image, 256, k, m,
+         [{(last_group, 0), (last_group, 1), (last_group, 2), (0, 4), (0, 5), (0, k)}], True),
+        ("m+1 lost, next pass fills", image, 256, k, m,
+         [{(1, 0), (1, 1), (1, 2), (1, 3)}, {(0, 0), (2, 1)}], True),
+        ("chunk 512, k=16 m=4", large, 512, 16, 4,
+         [{(0, 0), (0, 7), (0, 15), (0, 16), (1, 2), (1, 3), (1, 4), (1, 5), (2, 0), (2, 8)}], True),
+        ("digest mismatch", image, 256, k, m, [set().union(*every_group_m)], False),
+    ]
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, data, chunk, group_k, group_m, drops, digest_ok in cases:
+            ok, text = run_case(node, Path(tmp), name.replace(" ", "_").replace(",", "").replace("=", ""),
+                                data, chunk, group_k, group_m, drops, digest_ok)
+            print(("ok   " if ok else "FAIL ") + text)
+            failures += 0 if ok else 1
+    print("PASS" if failures == 0 else "FAIL")
+    return 0 if failures == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
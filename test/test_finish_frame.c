@@ -0,0 +1,102 @@
+// 完成帧提取测试：较短格式的帧尾（FF FD 55 55 / FF FB 55 55）落在较长完成帧的摘要或签名中时，
+// 必须按收全的最长格式解析；未收全时等待，不能按较短格式提前截断。直接包含 easy_bootloader.c 调用内部函数
+#include "easy_bootloader.c"
+
+#include <stdio.h>
+
+#if BOOT_CONFIG_ENABLE_ADDRESS
+#error "test_finish_frame builds frames without the node address byte"
+#endif
+
+static easy_bootloader_t g_ctx;
+static int g_failures;
+
+/* 构造完成帧：版本/日期之后的摘要与签名均以 0x5A 填充，再把 trap 写到 trap_at 处模拟碰巧出现的较短帧尾 */
+static uint16_t build_finish(uint8_t *buf, uint16_t len, uint8_t cmd1, uint16_t trap_at, uint8_t trap_cmd1)
+{
+    memset(buf, 0x5A, len);
+    buf[0] = BOOT_FRAME_HEADER0;
+    buf[1] = BOOT_FRAME_HEADER1;
+    buf[2] = 0x00U;
+    buf[3] = 0x01U;
+    buf[4] = 0x02U;
+    buf[5] = 0x03U;
+    memcpy(&buf[6], "\x20\x26\x10\x16", 4U);
+    if (trap_at != 0U) {
+        buf[trap_at] = 0xFFU;
+        buf[trap_at + 1U] = trap_cmd1;
+        buf[trap_at + 2U] = BOOT_FRAME_TAIL0;
+        buf[trap_at + 3U] = BOOT_FRAME_TAIL1;
+    }
+    buf[len - 4U] = 0xFFU;
+    buf[len - 3U] = cmd1;
+    buf[len - 2U] = BOOT_FRAME_TAIL0;
+    buf[len - 1U] = BOOT_FRAME_TAIL1;
+    return len;
+}
+
+/*
+ * 把 frame 的前 fed 字节放入缓存后提取一次，检查结果：expect_len 为 0 表示应等待（缓存原样保留），
+ * 否则应解析出该长度的完成帧并从缓存中取走
+ */
+static void check_extract(const char *what, const uint8_t *frame, uint16_t fed, uint16_t expect_len)
+{
+    boot_finish_frame_t result;
+    memset(&g_ctx, 0, sizeof(g_ctx));
+    memcpy(g_ctx.rx_cache, frame, fed);
+    g_ctx.rx_cache_len = fed;
+
+    bool got = bootloader_try_extract_finish_frame(&g_ctx, &result);
+    bool ok;
+    if (expect_len == 0U) {
+        ok = !got && g_ctx.rx_cache_len == fed;
+    } else {
+        ok = got && g_ctx.rx_cache_len == fed - expect_len && result.version == 0x00010203U &&
+             result.date == 0x20261016U &&
+             result.has_digest == (expect_len >= BOOT_FINISH_EXT_LEN) &&
+             result.has_signature == (expect_len == BOOT_FINISH_SIGNED_LEN);
+        if (ok && result.has_digest) {
+            ok = memcmp(result.digest, &frame[BOOT_FRAME_BODY + 8U], BOOT_DIGEST_SIZE) == 0;
+        }
+        if (ok && result.has_signature) {
+            ok = memcmp(result.signature, &frame[BOOT_FRAME_BODY + 8U + BOOT_DIGEST_SIZE], BOOT_SIGNATURE_SIZE) == 0;
+        }
+    }
+    printf("%-4s %s\n", ok ? "ok" : "FAIL", what);
+    g_failures += ok ? 0 : 1;
+}
+
+int main(void)
+{
+    uint8_t plain[BOOT_FINISH_FRAME_LEN];
+    uint8_t ext[BOOT_FINISH_EXT_LEN];
+    uint8_t signed_frame[BOOT_FINISH_SIGNED_LEN];
+
+    /* 扩展完成帧偏移 10..13 恰为 FF FD 55 55，签名完成帧偏移 42..45 恰为 FF FB 55 55 */
+    build_finish(ext, BOOT_FINISH_EXT_LEN, BOOT_FINISH_EXT_BYTE1, BOOT_FINISH_FRAME_LEN - 4U, BOOT_FINISH_FRAME_BYTE1);
+    build_finish(signed_frame, BOOT_FINISH_SIGNED_LEN, BOOT_FINISH_SIGNED_BYTE1,
+                 BOOT_FINISH_EXT_LEN - 4U, BOOT_FINISH_EXT_BYTE1);
+    build_finish(plain, BOOT_FINISH_FRAME_LEN, BOOT_FINISH_FRAME_BYTE1, 0U, 0U);
+
+    check_extract("signed frame with FF FB 55 55 at 42..45 parsed as 110-byte frame",
+                  signed_frame, BOOT_FINISH_SIGNED_LEN, BOOT_FINISH_SIGNED_LEN);
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    /* 只接受签名完成帧：扩展完成帧与签名完成帧的前段都不能截出来 */
+    check_extract("extended frame not accepted", ext, BOOT_FINISH_EXT_LEN, 0U);
+    check_extract("first 46 bytes of signed frame: wait", signed_frame, BOOT_FINISH_EXT_LEN, 0U);
+    check_extract("first 109 bytes of signed frame: wait", signed_frame, BOOT_FINISH_SIGNED_LEN - 1U, 0U);
+#else
+    check_extract("extended frame with FF FD 55 55 at 10..13 parsed as 46-byte frame",
+                  ext, BOOT_FINISH_EXT_LEN, BOOT_FINISH_EXT_LEN);
+#endif
+#if BOOT_CONFIG_ENABLE_SHA256
+    /* 摘要为必需项：不接受 14 字节完成帧，也不会在未收全的长帧中截出短帧 */
+    check_extract("first 14 bytes of extended frame: wait", ext, BOOT_FINISH_FRAME_LEN, 0U);
+    check_extract("plain 14-byte frame not accepted", plain, BOOT_FINISH_FRAME_LEN, 0U);
+#else
+    check_extract("plain 14-byte frame parsed", plain, BOOT_FINISH_FRAME_LEN, BOOT_FINISH_FRAME_LEN);
+#endif
+
+    printf("%s\n", g_failures == 0 ? "PASS" : "FAIL");
+    return g_failures == 0 ? 0 : 1;
+}
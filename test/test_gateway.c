@@ -0,0 +1,334 @@
+// 存储转发网关测试：在主机上编译 boot_gateway.c，每个下游链路接一个 link_node 子进程（真实 Bootloader 核心，
+// 各自的 Flash 文件），经管道并行刷写；按链路注入丢帧、静默与分段带噪声的应答，检查各子节点的状态迁移与结果
+#include "boot_config_app.h"
+#include "boot_gateway.h"
+#include "boot_sha256.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !BOOT_APP_CONFIG_ENABLE_GATEWAY || BOOT_APP_GATEWAY_CHILDREN < 4U
+#error "test_gateway needs BOOT_APP_CONFIG_ENABLE_GATEWAY = 1 and BOOT_APP_GATEWAY_CHILDREN >= 4"
+#endif
+
+#define SIM_IMAGE_ADDR            0x08080000U     // 网关暂存区中固件的起始地址（只经 ops 访问）
+#define SIM_IMAGE_SIZE            (9U * BOOT_APP_GATEWAY_CHUNK + 99U)
+#define SIM_VERSION               0x00020001U
+#define SIM_DATE                  0x20261016U
+#define SIM_RX_CAPACITY           4096U
+#define SIM_DEADLINE_MS           20000U
+
+/* 子节点 Flash 文件中的位置，与 Bootloader 侧 boot_memmap.h 一致 */
+#define CHILD_FLASH_START         0x08000000U
+#define CHILD_APP_START           0x08010000U
+#define CHILD_FLAG_ADDR           0x080E0000U
+
+typedef enum {
+    LINK_NORMAL = 0,
+    LINK_DROP_ONCE,     // 第 3 个数据帧丢失一次：ACK 超时，等待子节点接收超时后从头重发
+    LINK_SILENT,        // 下游断开：发送的帧全部丢失，重试用尽后放弃
+    LINK_NOISY,         // 应答前夹带子节点的其他输出（含 ACK 前缀），每次轮询只交付 2 字节
+} link_mode_t;
+
+typedef struct {
+    link_mode_t mode;
+    pid_t pid;
+    int to_child;
+    int from_child;
+    uint32_t writes;
+    uint32_t enters;            // 发出的升级命令数（首次 + 每次重试）
+    uint32_t seen;              // 出现过的状态（1 << state）
+    uint32_t done_tick;
+    uint8_t rx[SIM_RX_CAPACITY];   // 子节点已发出、还没交给网关的字节
+    uint32_t rx_len;
+    uint32_t budget;            // 本轮轮询还能交付的字节数
+    uint8_t packet_head[2];
+    uint32_t head_len;
+} sim_link_t;
+
+static sim_link_t g_links[BOOT_APP_GATEWAY_CHILDREN];
+static uint8_t g_image[SIM_IMAGE_SIZE];
+static int g_verbose;
+
+static const uint8_t g_noise[] = "child app: idle\r\n\x55\xAA\xFF";
+
+static uint32_t host_get_tick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+static boot_port_app_status_t host_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    if (addr < SIM_IMAGE_ADDR || len > SIM_IMAGE_SIZE - (addr - SIM_IMAGE_ADDR)) {
+        return BOOT_PORT_APP_ERROR;
+    }
+    memcpy(data, &g_image[addr - SIM_IMAGE_ADDR], len);
+    return BOOT_PORT_APP_OK;
+}
+
+static void host_log(const char *fmt, ...)
+{
+    if (g_verbose) {
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+    }
+}
+
+/* 每次发送即一个报文 [长度 2B 小端][数据]，与 link_node 的标准输入格式一致 */
+static boot_port_app_status_t host_child_write(uint8_t child, const uint8_t *data, uint32_t len)
+{
+    sim_link_t *link = &g_links[child];
+    link->writes++;
+    if (len == 6U && data[2] == 0xFFU && data[3] == 0xEEU) {
+        link->enters++;
+    }
+    if (link->mode == LINK_SILENT || (link->mode == LINK_DROP_ONCE && link->writes == 4U)) {
+        return BOOT_PORT_APP_OK;    // 升级命令、数据帧 1、2 之后的第 3 个数据帧
+    }
+    uint8_t head[2] = {(uint8_t)(len & 0xFFU), (uint8_t)(len >> 8)};
+    if (link->pid > 0 && (write(link->to_child, head, 2U) != 2 || write(link->to_child, data, len) != (ssize_t)len)) {
+        return BOOT_PORT_APP_ERROR;   // 子节点已提交复位
+    }
+    return BOOT_PORT_APP_OK;
+}
+
+static uint32_t host_child_read(uint8_t child, uint8_t *buf, uint32_t max_len)
+{
+    sim_link_t *link = &g_links[child];
+    uint32_t len = link->rx_len;
+    if (len > max_len) {
+        len = max_len;
+    }
+    if (len > link->budget) {
+        len = link->budget;
+    }
+    memcpy(buf, link->rx, len);
+    memmove(link->rx, &link->rx[len], link->rx_len - len);
+    link->rx_len -= len;
+    link->budget -= len;
+    return len;
+}
+
+static void sim_append(sim_link_t *link, const uint8_t *data, uint32_t len)
+{
+    if (len <= SIM_RX_CAPACITY - link->rx_len) {
+        memcpy(&link->rx[link->rx_len], data, len);
+        link->rx_len += len;
+    }
+}
+
+/* 把子节点发出的报文拆包放入接收字节流，带噪声的链路在每个报文前插入其他输出 */
+static void sim_pump(sim_link_t *link)
+{
+    uint8_t packet[256];
+    while (link->pid > 0) {
+        if (link->head_len < 2U) {
+            ssize_t n = read(link->from_child, &link->packet_head[link->head_len], 2U - link->head_len);
+            if (n <= 0) {
+                return;
+            }
+            link->head_len += (uint32_t)n;
+            continue;
+        }
+        uint32_t len = link->packet_head[0] | ((uint32_t)link->packet_head[1] << 8);
+        if (len > sizeof(packet)) {
+            return;
+        }
+        uint32_t got = 0U;
+        while (got < len) {
+            ssize_t n = read(link->from_child, &packet[got], len - got);
+            if (n > 0) {
+                got += (uint32_t)n;
+            }
+        }
+        link->head_len = 0U;
+        if (link->mode == LINK_NOISY) {
+            sim_append(link, g_noise, sizeof(g_noise) - 1U);
+        }
+        sim_append(link, packet, len);
+    }
+}
+
+static void sim_spawn(sim_link_t *link, const char *node, uint8_t index)
+{
+    int down[2];
+    int up[2];
+    char flash[32];
+    snprintf(flash, sizeof(flash), "gateway_child_%u.bin", index);
+    if (pipe(down) != 0 || pipe(up) != 0) {
+        exit(1);
+    }
+    link->pid = fork();
+    if (link->pid == 0) {
+        dup2(down[0], STDIN_FILENO);
+        dup2(up[1], STDOUT_FILENO);
+        close(down[1]);
+        close(up[0]);
+        execl(node, node, flash, "0", "0", (char *)NULL);
+        _exit(127);
+    }
+    close(down[0]);
+    close(up[1]);
+    link->to_child = down[1];
+    link->from_child = up[0];
+    fcntl(link->from_child, F_SETFL, O_NONBLOCK);
+}
+
+/* 子节点复位退出后读回它的 Flash 文件：APP 区与固件一致、标志位为 APP、版本已写入 */
+static bool sim_child_committed(uint8_t index)
+{
+    char path[32];
+    uint8_t app[SIM_IMAGE_SIZE];
+    uint32_t flag[2];
+    snprintf(path, sizeof(path), "gateway_child_%u.bin", index);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = fseek(f, (long)(CHILD_APP_START - CHILD_FLASH_START), SEEK_SET) == 0 &&
+              fread(app, 1U, sizeof(app), f) == sizeof(app) &&
+              fseek(f, (long)(CHILD_FLAG_ADDR - CHILD_FLASH_START), SEEK_SET) == 0 &&
+              fread(flag, 1U, sizeof(flag), f) == sizeof(flag);
+    fclose(f);
+    return ok && memcmp(app, g_image, sizeof(app)) == 0 && flag[0] == 2U && flag[1] == SIM_VERSION;
+}
+
+static const boot_app_ops_t g_ops = {
+    .get_tick = host_get_tick,
+    .boot_port_app_flash_read = host_flash_read,
+    .boot_port_app_log = host_log,
+    .boot_port_app_child_write = host_child_write,
+    .boot_port_app_child_read = host_child_read,
+};
+
+static int check(bool ok, const char *what)
+{
+    printf("%-4s %s\n", ok ? "ok" : "FAIL", what);
+    return ok ? 0 : 1;
+}
+
+/* 用法: test_gateway <link_node 路径> [-v]，子节点 Flash 文件写在当前目录 */
+int main(int argc, char **argv)
+{
+    static const link_mode_t modes[4] = {LINK_NORMAL, LINK_DROP_ONCE, LINK_SILENT, LINK_NOISY};
+    uint8_t finish[42];
+    boot_sha256_ctx_t sha;
+    int failures = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <link_node> [-v]\n", argv[0]);
+        return 1;
+    }
+    g_verbose = (argc > 2) && (strcmp(argv[2], "-v") == 0);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (uint32_t i = 0U; i < SIM_IMAGE_SIZE; i++) {
+        g_image[i] = (uint8_t)(i * 7U + (i >> 8));
+    }
+    g_image[0] = 0x00U;   // 向量表：栈顶 0x20020000，复位向量在 APP 区内
+    g_image[1] = 0x00U;
+    g_image[2] = 0x02U;
+    g_image[3] = 0x20U;
+    g_image[4] = 0xC1U;
+    g_image[5] = 0x01U;
+    g_image[6] = 0x01U;
+    g_image[7] = 0x08U;
+
+    // 扩展完成帧去掉帧头帧尾：ver 4B、date 4B、sha256、FF FB
+    for (int k = 0; k < 4; k++) {
+        finish[k] = (uint8_t)(SIM_VERSION >> (24 - 8 * k));
+        finish[4 + k] = (uint8_t)(SIM_DATE >> (24 - 8 * k));
+    }
+    boot_sha256_init(&sha);
+    boot_sha256_update(&sha, g_image, SIM_IMAGE_SIZE);
+    boot_sha256_final(&sha, &finish[8]);
+    finish[40] = 0xFFU;
+    finish[41] = 0xFBU;
+
+    for (uint8_t i = 0U; i < 4U; i++) {
+        g_links[i].mode = modes[i];
+        if (modes[i] != LINK_SILENT) {
+            sim_spawn(&g_links[i], argv[1], i);
+        }
+    }
+
+    boot_gateway_init(&g_ops);
+    failures += check(!boot_gateway_start(0U, SIM_IMAGE_ADDR, SIM_IMAGE_SIZE, finish, sizeof(finish)) &&
+                      !boot_gateway_start(1U << BOOT_APP_GATEWAY_CHILDREN, SIM_IMAGE_ADDR, SIM_IMAGE_SIZE,
+                                          finish, sizeof(finish)) &&
+                      !boot_gateway_start(1U, SIM_IMAGE_ADDR, SIM_IMAGE_SIZE, finish, BOOT_GATEWAY_FINISH_MAX + 1U),
+                      "start rejects an empty mask, a child beyond BOOT_APP_GATEWAY_CHILDREN and an oversized finish");
+    failures += check(boot_gateway_start(0x0FU, SIM_IMAGE_ADDR, SIM_IMAGE_SIZE, finish, sizeof(finish)),
+                      "start forwarding to children 0-3");
+    failures += check(!boot_gateway_start(0x01U, SIM_IMAGE_ADDR, SIM_IMAGE_SIZE, finish, sizeof(finish)),
+                      "start rejected while busy");
+
+    uint32_t start = host_get_tick();
+    while (boot_gateway_busy() && (uint32_t)(host_get_tick() - start) < SIM_DEADLINE_MS) {
+        for (uint8_t i = 0U; i < 4U; i++) {
+            sim_link_t *link = &g_links[i];
+            sim_pump(link);
+            link->budget = (link->mode == LINK_NOISY) ? 2U : SIM_RX_CAPACITY;
+        }
+        boot_gateway_poll();
+        for (uint8_t i = 0U; i < 4U; i++) {
+            uint8_t percent;
+            boot_gateway_child_state_t state = boot_gateway_child_state(i, &percent);
+            g_links[i].seen |= 1U << state;
+            if (state == BOOT_GATEWAY_CHILD_DONE && g_links[i].done_tick == 0U) {
+                g_links[i].done_tick = host_get_tick() - start;
+            }
+        }
+        usleep(200);
+    }
+    uint32_t elapsed = host_get_tick() - start;
+
+    for (uint8_t i = 0U; i < 4U; i++) {
+        if (g_links[i].pid > 0) {
+            int status = -1;
+            close(g_links[i].to_child);   // 未复位的子节点随链路关闭退出
+            waitpid(g_links[i].pid, &status, 0);
+        }
+    }
+
+    const uint32_t data_path = (1U << BOOT_GATEWAY_CHILD_ENTER) | (1U << BOOT_GATEWAY_CHILD_DATA) |
+                               (1U << BOOT_GATEWAY_CHILD_FINISH) | (1U << BOOT_GATEWAY_CHILD_DONE);
+    uint8_t percent[4];
+    boot_gateway_child_state_t state[4];
+    for (uint8_t i = 0U; i < 4U; i++) {
+        state[i] = boot_gateway_child_state(i, &percent[i]);
+        printf("     child %u: state %d, %u%%, %lu writes, %lu enter commands, done at %lu ms\n", i, (int)state[i],
+               percent[i], (unsigned long)g_links[i].writes, (unsigned long)g_links[i].enters,
+               (unsigned long)g_links[i].done_tick);
+    }
+    failures += check(!boot_gateway_busy(), "all children finished before the deadline");
+    failures += check(state[0] == BOOT_GATEWAY_CHILD_DONE && percent[0] == 100U &&
+                      (g_links[0].seen & data_path) == data_path &&
+                      (g_links[0].seen & (1U << BOOT_GATEWAY_CHILD_RETRY)) == 0U && sim_child_committed(0U),
+                      "child 0: ENTER -> DATA -> FINISH -> DONE, image committed");
+    failures += check(state[1] == BOOT_GATEWAY_CHILD_DONE && (g_links[1].seen & (1U << BOOT_GATEWAY_CHILD_RETRY)) != 0U &&
+                      g_links[1].enters == 2U && sim_child_committed(1U),
+                      "child 1: lost data frame -> ACK timeout -> RETRY -> DONE, image committed");
+    failures += check(state[2] == BOOT_GATEWAY_CHILD_FAILED && percent[2] == 0U &&
+                      g_links[2].enters == 1U + BOOT_APP_GATEWAY_RETRIES &&
+                      (g_links[2].seen & (1U << BOOT_GATEWAY_CHILD_RETRY)) != 0U,
+                      "child 2: silent link -> ACK timeout -> RETRY x BOOT_APP_GATEWAY_RETRIES -> FAILED");
+    failures += check(state[3] == BOOT_GATEWAY_CHILD_DONE && g_links[3].enters == 1U && sim_child_committed(3U),
+                      "child 3: ACKs split across polls behind other output (prefix kept), image committed");
+    failures += check(g_links[0].done_tick < g_links[1].done_tick && g_links[0].done_tick < elapsed,
+                      "children progress independently (child 0 done before child 1 retried)");
+
+    printf("gateway: %lu ms, %s\n", (unsigned long)elapsed, failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""
+分包链路窗口 / 合并 ACK 测试
+----------------
+上位机侧直接使用 serial_terminal.py 中的 BootloaderUploader，设备侧为 link_node（真实核心，配置 ops.link_mtu /
+link_window），两者之间是模拟的报文链路：每个方向按 MTU 切包、每包固定单程延迟并按最小包间隔排队。
+检查各组合下固件与标志位写入正确、设备发出的报文不超过 MTU，窗口 > 1 时 ACK 报文数少于数据帧数：
+
+    python3 test_link_window.py build/link_node
+"""
+
+from __future__ import annotations
+
+import heapq
+import itertools
+import random
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import types
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "PC tool" / "source"))
+
+
+def _stub_gui_modules() -> None:
+    """没有安装 pyserial / tkinter 的环境下用空模块代替，只用到上传逻辑"""
+    try:
+        import serial  # noqa: F401
+        import serial.tools.list_ports  # noqa: F401
+    except ImportError:
+        serial_mod = types.ModuleType("serial")
+        for name in ("FIVEBITS", "SIXBITS", "SEVENBITS", "EIGHTBITS", "PARITY_NONE", "PARITY_EVEN", "PARITY_ODD",
+                     "PARITY_MARK", "PARITY_SPACE", "STOPBITS_ONE", "STOPBITS_ONE_POINT_FIVE", "STOPBITS_TWO"):
+            setattr(serial_mod, name, name)
+        serial_mod.Serial = object
+        serial_mod.SerialException = OSError
+        serial_mod.tools = types.ModuleType("serial.tools")
+        serial_mod.tools.list_ports = types.ModuleType("serial.tools.list_ports")
+        sys.modules.update({"serial": serial_mod, "serial.tools": serial_mod.tools,
+                            "serial.tools.list_ports": serial_mod.tools.list_ports})
+    try:
+        import tkinter  # noqa: F401
+        from tkinter import filedialog, messagebox, scrolledtext, ttk  # noqa: F401
+    except ImportError:
+        tk_mod = types.ModuleType("tkinter")
+        tk_mod.Tk = object
+        for name in ("filedialog", "messagebox", "scrolledtext", "ttk"):
+            setattr(tk_mod, name, types.ModuleType("tkinter." + name))
+            sys.modules["tkinter." + name] = getattr(tk_mod, name)
+        sys.modules["tkinter"] = tk_mod
+
+
+_stub_gui_modules()
+from serial_terminal import BootloaderUploader  # noqa: E402
+
+APP_START_ADDR = 0x08010000   # 与 boot_memmap.h 一致
+FLAG_REGION_ADDR = 0x080E0000
+FLASH_START_ADDR = 0x08000000
+FLAG_APP = 2
+
+
+class SimLink:
+    """模拟报文链路，接口与 SerialWorker 相同（write / add_listener / remove_listener）"""
+
+    def __init__(self, node: str, flash: Path, mtu: int, window: int, latency: float, gap: float) -> None:
+        self.mtu = mtu
+        self.latency = latency
+        self.gap = gap
+        self.serial = True   # BootloaderUploader 只检查是否已打开
+        self.up_packets = 0
+        self.down_packets = 0
+        self._listeners: list = []
+        self._queue: list = []
+        self._seq = itertools.count()
+        self._last = {"down": 0.0, "up": 0.0}
+        self._cond = threading.Condition()
+        self._closed = False
+        self.proc = subprocess.Popen([node, str(flash), str(mtu), str(window)],
+                                     stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+        threading.Thread(target=self._read_device, daemon=True).start()
+        threading.Thread(target=self._deliver, daemon=True).start()
+
+    def add_listener(self, listener) -> None:
+        self._listeners.append(listener)
+
+    def remove_listener(self, listener) -> None:
+        if listener in self._listeners:
+            self._listeners.remove(listener)
+
+    def write(self, data: bytes) -> None:
+        step = self.mtu or len(data)
+        for pos in range(0, len(data), step):
+            self._schedule("down", data[pos : pos + step])
+
+    def close(self) -> int:
+        with self._cond:
+            self._closed = True
+            self._cond.notify_all()
+        try:
+            self.proc.stdin.close()
+        except OSError:
+            pass
+        return self.proc.wait(timeout=10)
+
+    def _schedule(self, direction: str, packet: bytes) -> None:
+        with self._cond:
+            due = max(time.monotonic() + self.latency, self._last[direction] + self.gap)
+            self._last[direction] = due
+            heapq.heappush(self._queue, (due, next(self._seq), direction, packet))
+            self._cond.notify_all()
+
+    def _read_device(self) -> None:
+        while True:
+            head = self.proc.stdout.read(2)
+            if len(head) < 2:
+                return
+            length = int.from_bytes(head, "little")
+            packet = self.proc.stdout.read(length) if length else b""
+            self.up_packets += 1
+            self._schedule("up", packet)
+
+    def _deliver(self) -> None:
+        while True:
+            with self._cond:
+                while not self._closed and (not self._queue or self._queue[0][0] > time.monotonic()):
+                    timeout = self._queue[0][0] - time.monotonic() if self._queue else None
+                    self._cond.wait(timeout)
+                if self._closed:
+                    return
+                _, _, direction, packet = heapq.heappop(self._queue)
+            if direction == "down":
+                self.down_packets += 1
+                try:
+                    self.proc.stdin.write(len(packet).to_bytes(2, "little") + packet)
+                except (BrokenPipeError, ValueError):
+                    return
+            else:
+                for listener in list(self._listeners):
+                    listener(packet)
+
+
+def run_case(node: str, workdir: Path, image: bytes, mtu: int, port_window: int, host_window: int,
+             frame_size: int, latency: float, gap: float) -> tuple[bool, str]:
+    fw_path = workdir / "firmware.bin"
+    fw_path.write_bytes(image)
+    flash_path = workdir / f"flash_link_{mtu}_{port_window}_{host_window}.bin"
+    link = SimLink(node, flash_path, mtu, port_window, latency, gap)
+
+    done = threading.Event()
+    result = {}
+    log: list[str] = []
+    uploader = BootloaderUploader(link, log.append, lambda _text: None,
+                                  finish_cb=lambda ok: (result.setdefault("ok", ok), done.set()))
+    uploader.window = host_window
+    uploader.set_max_payload(frame_size)
+    uploader.set_file(fw_path)
+    start = time.monotonic()
+    uploader.start()
+    done.wait(120)
+    elapsed = time.monotonic() - start
+    code = link.close()
+
+    frames = -(-len(image) // uploader.max_payload)
+    flash = flash_path.read_bytes()
+    app = flash[APP_START_ADDR - FLASH_START_ADDR :][: len(image)]
+    flag = int.from_bytes(flash[FLAG_REGION_ADDR - FLASH_START_ADDR :][:4], "little")
+    ok = result.get("ok") is True and code == 0 and app == image and flag == FLAG_APP
+    if ok and port_window > 1 and host_window > 1:
+        ok = link.up_packets < frames   # 合并 ACK：报文数少于数据帧数（含完成帧 ACK）
+    if ok and port_window <= 1:
+        ok = link.up_packets == frames + 1   # 逐帧 ACK，与原协议一致
+    text = (f"mtu={mtu:4d} window={port_window}/{host_window} frame={frame_size:4d} "
+            f"latency={latency * 1000:.0f}ms: {elapsed * 1000:6.0f} ms, {frames} frames, "
+            f"{link.down_packets} down / {link.up_packets} up packets, exit={code}, "
+            f"image={'ok' if app == image else 'BAD'}, flag={flag}")
+    if not ok:
+        text += "\n  " + "\n  ".join(log[-5:])
+    return ok, text
+
+
+def main(argv: list[str]) -> int:
+    node = argv[1] if len(argv) > 1 else str(Path(__file__).resolve().parent / "build" / "link_node")
+    rng = random.Random(31)
+    image = bytearray(rng.randrange(256) for _ in range(24 * 1024 + 77))
+    image[0:8] = (0x20020000).to_bytes(4, "little") + (APP_START_ADDR + 0x1C1).to_bytes(4, "little")
+
+    # (MTU, 端口窗口, 上位机窗口, 整帧长度, 单程延迟 s, 最小包间隔 s)
+    cases = [
+        (0, 0, 1, 1024, 0.005, 0.0),        # 字节流串口：原协议逐帧 ACK
+        (244, 1, 1, 1024, 0.015, 0.001),    # 分包链路、窗口 1：ACK 按 MTU 发送
+        (244, 8, 8, 244, 0.015, 0.001),     # BLE 大 MTU、窗口 8：半窗口合并 ACK
+        (20, 4, 4, 128, 0.005, 0.0005),     # BLE 最小 MTU：帧与 ACK 都要分片
+        (244, 8, 2, 244, 0.015, 0.001),     # 上位机窗口小于端口窗口：靠空闲超时发出 ACK
+    ]
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for mtu, port_window, host_window, frame_size, latency, gap in cases:
+            ok, text = run_case(node, Path(tmp), bytes(image), mtu, port_window, host_window,
+                                frame_size, latency, gap)
+            print(("ok   " if ok else "FAIL ") + text)
+            failures += 0 if ok else 1
+    print("PASS" if failures == 0 else "FAIL")
+    return 0 if failures == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
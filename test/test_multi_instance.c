@@ -0,0 +1,334 @@
+// 多实例仿真：一个进程内 1000 个核心实例各自接收、校验并提交一份不同的固件，再各自上电跳转
+#include "boot_config.h"
+#include "boot_sha256.h"
+#include "easy_bootloader.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !BOOT_CONFIG_ENABLE_SHA256
+#error "test_multi_instance sends extended finish frames and needs BOOT_CONFIG_ENABLE_SHA256 = 1"
+#endif
+
+#define SIM_INSTANCES             1000U
+#define SIM_APP_CAPACITY          0x4000U     // 每个实例仿真的 APP 区大小（只映射用到的部分）
+#define SIM_FLAG_CAPACITY         0x200U      // 每个实例仿真的标志位区大小
+#define SIM_RX_CAPACITY           4096U
+#define SIM_IMAGE_SIZE            12000U
+#define SIM_FRAME_PAYLOAD         1013U       // 整帧 1024 字节
+#define SIM_VERSION               0x00010003U
+#define SIM_DATE                  0x20261016U
+
+/* 一个仿真节点：核心实例 + 它的 Flash 与接收缓冲，移植层函数经 g_cur 找到当前节点 */
+typedef struct {
+    easy_bootloader_t boot;
+    uint8_t app[SIM_APP_CAPACITY];
+    uint8_t flag[SIM_FLAG_CAPACITY];
+    uint8_t rx[SIM_RX_CAPACITY];
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    uint32_t acks;
+    uint32_t jumps;
+} sim_node_t;
+
+uint32_t host_handoff[(sizeof(boot_handoff_t) + 3U) / 4U];   // 启动打点交接区（boot_config.h 中 BOOT_HANDOFF_BASE）
+
+static sim_node_t *g_nodes;
+static sim_node_t *g_cur;
+static uint32_t g_now;
+
+uint32_t host_cycle_get(void)
+{
+    return g_now;
+}
+
+/* 把 Flash 地址映射到当前节点的存储，len 截到映射区域内；不在映射区域时返回 NULL */
+static uint8_t *sim_map(uint32_t addr, uint32_t *len)
+{
+    uint8_t *base = NULL;
+    uint32_t offset = 0U;
+    uint32_t size = 0U;
+    if (addr >= BOOT_APP_START_ADDR && addr - BOOT_APP_START_ADDR < SIM_APP_CAPACITY) {
+        base = g_cur->app;
+        offset = addr - BOOT_APP_START_ADDR;
+        size = SIM_APP_CAPACITY;
+    } else if (addr >= BOOT_FLAG_REGION_ADDR && addr - BOOT_FLAG_REGION_ADDR < SIM_FLAG_CAPACITY) {
+        base = g_cur->flag;
+        offset = addr - BOOT_FLAG_REGION_ADDR;
+        size = SIM_FLAG_CAPACITY;
+    } else {
+        return NULL;
+    }
+    if (*len > size - offset) {
+        *len = size - offset;
+    }
+    return base + offset;
+}
+
+static uint32_t sim_get_tick(void)
+{
+    return g_now;
+}
+
+static boot_port_status_t sim_flash_erase(uint32_t addr, uint32_t size)
+{
+    uint8_t *p = sim_map(addr, &size);
+    if (p != NULL) {
+        memset(p, 0xFF, size);
+    }
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t sim_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    uint8_t *p = sim_map(addr, &len);
+    if (p == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+    for (uint32_t i = 0U; i < len; i++) {
+        p[i] &= data[i];
+    }
+    return BOOT_PORT_OK;
+}
+
+/* 未映射的地址读出擦除值 */
+static boot_port_status_t sim_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t mapped = len;
+    const uint8_t *p = sim_map(addr, &mapped);
+    if (p == NULL) {
+        mapped = 0U;
+    } else {
+        memcpy(data, p, mapped);
+    }
+    memset(&data[mapped], 0xFF, len - mapped);
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t sim_data_write(const uint8_t *data, uint32_t len)
+{
+    if (len == 6U && data[2] == 0xFFU && data[3] == 0xFEU) {
+        g_cur->acks++;
+    }
+    return BOOT_PORT_OK;
+}
+
+static uint32_t sim_data_read(uint8_t *buf, uint32_t max_len)
+{
+    uint32_t len = g_cur->rx_tail - g_cur->rx_head;
+    if (len > max_len) {
+        len = max_len;
+    }
+    memcpy(buf, &g_cur->rx[g_cur->rx_head], len);
+    g_cur->rx_head += len;
+    return len;
+}
+
+static uint32_t sim_rx_peek(uint32_t offset, const uint8_t **data)
+{
+    uint32_t pos = g_cur->rx_head + offset;
+    if (pos >= g_cur->rx_tail) {
+        return 0U;
+    }
+    *data = &g_cur->rx[pos];
+    return g_cur->rx_tail - pos;
+}
+
+static boot_port_status_t sim_rx_consume(uint32_t len)
+{
+    g_cur->rx_head += len;
+    return BOOT_PORT_OK;
+}
+
+static void sim_log(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+static void sim_jump_to_app(uint32_t app_addr)
+{
+    (void)app_addr;
+    g_cur->jumps++;
+}
+
+static void sim_system_reset(void)
+{
+}
+
+static const boot_ops_t g_sim_ops = {
+    .get_tick = sim_get_tick,
+    .boot_port_flash_erase = sim_flash_erase,
+    .boot_port_flash_write = sim_flash_write,
+    .boot_port_flash_read = sim_flash_read,
+    .boot_port_data_write = sim_data_write,
+    .boot_port_data_read = sim_data_read,
+    .boot_port_log = sim_log,
+    .boot_port_jump_to_app = sim_jump_to_app,
+    .boot_port_system_reset = sim_system_reset,
+#if BOOT_CONFIG_ENABLE_RX_DIRECT
+    .boot_port_rx_peek = sim_rx_peek,
+    .boot_port_rx_consume = sim_rx_consume,
+#endif
+};
+
+/* 向节点的接收缓冲追加数据，已读完的部分先移走 */
+static void sim_push(sim_node_t *node, const uint8_t *data, uint32_t len)
+{
+    memmove(node->rx, &node->rx[node->rx_head], node->rx_tail - node->rx_head);
+    node->rx_tail -= node->rx_head;
+    node->rx_head = 0U;
+    memcpy(&node->rx[node->rx_tail], data, len);
+    node->rx_tail += len;
+}
+
+/* 数据帧: 55 AA [剩余 3B] [长度 2B] 数据 [累加和 2B] 55 55 */
+static uint32_t sim_data_frame(uint8_t *frame, const uint8_t *payload, uint32_t len, uint32_t remaining)
+{
+    uint32_t k = 0U;
+    uint16_t sum = 0U;
+    frame[k++] = 0x55U;
+    frame[k++] = 0xAAU;
+    frame[k++] = (uint8_t)(remaining >> 16);
+    frame[k++] = (uint8_t)(remaining >> 8);
+    frame[k++] = (uint8_t)remaining;
+    frame[k++] = (uint8_t)(len >> 8);
+    frame[k++] = (uint8_t)len;
+    memcpy(&frame[k], payload, len);
+    k += len;
+    for (uint32_t i = 5U; i < k; i++) {
+        sum = (uint16_t)(sum + frame[i]);
+    }
+    frame[k++] = (uint8_t)(sum >> 8);
+    frame[k++] = (uint8_t)sum;
+    frame[k++] = 0x55U;
+    frame[k++] = 0x55U;
+    return k;
+}
+
+/* 扩展完成帧: 55 AA [版本 4B] [日期 4B] [SHA-256 32B] FF FB 55 55 */
+static uint32_t sim_finish_frame(uint8_t *frame, const uint8_t *image, uint32_t size)
+{
+    boot_sha256_ctx_t sha;
+    uint32_t k = 0U;
+    frame[k++] = 0x55U;
+    frame[k++] = 0xAAU;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        frame[k++] = (uint8_t)(SIM_VERSION >> shift);
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        frame[k++] = (uint8_t)(SIM_DATE >> shift);
+    }
+    boot_sha256_init(&sha);
+    boot_sha256_update(&sha, image, size);
+    boot_sha256_final(&sha, &frame[k]);
+    k += BOOT_SHA256_DIGEST_SIZE;
+    frame[k++] = 0xFFU;
+    frame[k++] = 0xFBU;
+    frame[k++] = 0x55U;
+    frame[k++] = 0x55U;
+    return k;
+}
+
+static double sim_elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * 1e3 + (double)(now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+int main(void)
+{
+    static uint8_t frame[SIM_FRAME_PAYLOAD + 16U];
+    uint8_t *images = malloc((size_t)SIM_INSTANCES * SIM_IMAGE_SIZE);
+    g_nodes = calloc(SIM_INSTANCES, sizeof(sim_node_t));
+    if (images == NULL || g_nodes == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    // 每个实例一份不同的固件，向量表有效
+    uint32_t seed = 46U;
+    for (uint32_t i = 0U; i < SIM_INSTANCES * SIM_IMAGE_SIZE; i++) {
+        seed = seed * 1103515245U + 12345U;
+        images[i] = (uint8_t)(seed >> 16);
+    }
+    for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+        uint32_t vectors[2] = {BOOT_SRAM_END_ADDR, BOOT_APP_START_ADDR + 0x1C1U};
+        memcpy(&images[n * SIM_IMAGE_SIZE], vectors, sizeof(vectors));
+        memset(g_nodes[n].app, 0xFF, SIM_APP_CAPACITY);
+        memset(g_nodes[n].flag, 0xFF, SIM_FLAG_CAPACITY);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+        g_cur = &g_nodes[n];
+        if (easy_bootloader_ctx_init(&g_cur->boot, &g_sim_ops) != BOOT_PORT_OK) {
+            printf("instance %lu: init failed\n", (unsigned long)n);
+            return 1;
+        }
+    }
+
+    // 所有实例轮流处理同一轮的数据帧，模拟多个节点同时升级
+    for (uint32_t offset = 0U; offset < SIM_IMAGE_SIZE; offset += SIM_FRAME_PAYLOAD) {
+        uint32_t len = (SIM_IMAGE_SIZE - offset > SIM_FRAME_PAYLOAD) ? SIM_FRAME_PAYLOAD : SIM_IMAGE_SIZE - offset;
+        g_now++;
+        for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+            g_cur = &g_nodes[n];
+            sim_push(g_cur, frame, sim_data_frame(frame, &images[n * SIM_IMAGE_SIZE + offset], len,
+                                                  SIM_IMAGE_SIZE - offset - len));
+            easy_bootloader_ctx_run(&g_cur->boot);
+            easy_bootloader_ctx_run(&g_cur->boot);
+        }
+    }
+    for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+        g_cur = &g_nodes[n];
+        sim_push(g_cur, frame, sim_finish_frame(frame, &images[n * SIM_IMAGE_SIZE], SIM_IMAGE_SIZE));
+        for (int k = 0; k < 4; k++) {
+            easy_bootloader_ctx_run(&g_cur->boot);
+        }
+    }
+    double upgrade_ms = sim_elapsed_ms(&start);
+
+    // 各实例重新上电：标志位为 APP、向量表有效时跳转
+    for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+        g_cur = &g_nodes[n];
+        (void)easy_bootloader_ctx_init(&g_cur->boot, &g_sim_ops);
+    }
+
+    uint32_t frames = (SIM_IMAGE_SIZE + SIM_FRAME_PAYLOAD - 1U) / SIM_FRAME_PAYLOAD;
+    uint32_t ok = 0U;
+    for (uint32_t n = 0U; n < SIM_INSTANCES; n++) {
+        const sim_node_t *node = &g_nodes[n];
+        uint32_t flag;
+        uint32_t version;
+        memcpy(&flag, &node->flag[BOOT_FLAG_OFFSET], 4U);
+        memcpy(&version, &node->flag[BOOT_VERSION_OFFSET], 4U);
+        if (memcmp(node->app, &images[n * SIM_IMAGE_SIZE], SIM_IMAGE_SIZE) == 0 && flag == BOOT_FLAG_APP &&
+            version == SIM_VERSION && node->acks == frames + 1U && node->jumps == 1U) {
+            ok++;
+        } else if (SIM_INSTANCES - ok <= 5U) {
+            printf("instance %lu: flag=0x%08lX acks=%lu jumps=%lu\n", (unsigned long)n, (unsigned long)flag,
+                   (unsigned long)node->acks, (unsigned long)node->jumps);
+        }
+    }
+#if BOOT_CONFIG_ENABLE_PROFILE
+    bool handoff_ok = (host_handoff[0] == BOOT_HANDOFF_MAGIC);
+#else
+    bool handoff_ok = true;
+#endif
+
+    printf("instances=%lu ctx=%lu bytes, %lu-byte image each: %lu/%lu installed and jumped, handoff %s, "
+           "upgrade %.1f ms (%.2f us per frame per instance)\n",
+           (unsigned long)SIM_INSTANCES, (unsigned long)sizeof(easy_bootloader_t), (unsigned long)SIM_IMAGE_SIZE,
+           (unsigned long)ok, (unsigned long)SIM_INSTANCES, handoff_ok ? "ok" : "BAD", upgrade_ms,
+           upgrade_ms * 1e3 / ((double)SIM_INSTANCES * (frames + 1U)));
+    bool pass = (ok == SIM_INSTANCES) && handoff_ok;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    free(images);
+    free(g_nodes);
+    return pass ? 0 : 1;
+}
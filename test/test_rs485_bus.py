@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+RS-485 多点总线测试
+----------------
+多个 link_node 进程（真实核心，启用 BOOT_CONFIG_ENABLE_ADDRESS，各自 -a 地址、各自的 Flash 文件）挂在同一条
+模拟总线上：上位机发出的每一帧送给所有节点（可按节点注入丢帧），各节点发出的报文合并成一个接收字节流。
+上位机侧直接使用 rs485_flash.py 的帧构造与流程，设备侧不经任何 Python 模型：
+
+    python3 test_rs485_bus.py build/link_node_addr
+    python3 test_rs485_bus.py build/link_node_bcast --broadcast
+
+寻址（BOOT_CONFIG_ENABLE_ADDRESS）：
+  - 扫描：rs485_flash.scan_bus 探测一段地址，每个在线节点恰好应答一次，空地址无应答
+  - 单播：LinkFlasher 按地址刷写一个节点，其余节点全程不发送任何报文、Flash 不被改写，目标节点提交
+--broadcast（节点需同时启用 BOOT_CONFIG_ENABLE_BROADCAST）：
+  - 位图：按节点丢弃指定的广播数据帧后查询状态，核对各节点上报的缺帧数与位图，并与 bus_sim.py 的 SimNode
+    对同一帧序列给出的应答逐字节比较；按位图并集补发后逐个节点发送完成帧，摘要错误的完成帧不能提交
+  - 整体流程：rs485_flash.broadcast_flash 在随机丢帧下刷写全部节点，检查各节点的固件与标志位
+"""
+
+from __future__ import annotations
+
+import hashlib
+import random
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+from typing import Callable, Optional
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "PC tool" / "source"))
+
+from bus_sim import SimNode  # noqa: E402
+from link_flash import LinkFlasher, build_finish_frame  # noqa: E402
+from rs485_flash import (  # noqa: E402
+    broadcast_flash,
+    build_bcast_data,
+    build_bcast_start,
+    finish_node,
+    query_status,
+    scan_bus,
+)
+
+APP_START_ADDR = 0x08010000   # 与 boot_memmap.h 一致
+FLAG_REGION_ADDR = 0x080E0000
+FLASH_START_ADDR = 0x08000000
+FLAG_APP = 2
+FLAG_ERASED = 0xFFFFFFFF
+VERSION = 9
+DATE = 0x20261016
+
+
+def is_bcast_data(msg: bytes) -> bool:
+    return len(msg) > 5 and msg[2] == 0x00 and msg[3:5] == b"\xFF\xF6"
+
+
+class NodeBus:
+    """模拟总线，接口与 rs485_flash.SerialLink 相同（send / poll / rx_data）"""
+
+    def __init__(self, node: str, workdir: Path, addrs: list[int],
+                 drop: Optional[Callable[[int, bytes], bool]] = None) -> None:
+        self.rx_data = bytearray()
+        self.drop = drop
+        self.sent: dict[int, int] = {addr: 0 for addr in addrs}   # 各节点发出的报文数
+        self.flash_paths = {addr: workdir / f"flash_bus_{addr}.bin" for addr in addrs}
+        self._pending = bytearray()
+        self._cond = threading.Condition()
+        self.procs = {}
+        for addr in addrs:
+            self.procs[addr] = subprocess.Popen([node, str(self.flash_paths[addr]), "0", "0", "-a", str(addr)],
+                                                stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+            threading.Thread(target=self._read_node, args=(addr,), daemon=True).start()
+
+    def send(self, msg: bytes) -> None:
+        for addr, proc in self.procs.items():
+            if proc.poll() is not None or (self.drop is not None and self.drop(addr, msg)):
+                continue
+            try:
+                proc.stdin.write(len(msg).to_bytes(2, "little") + msg)
+            except BrokenPipeError:
+                pass   # 节点已提交复位
+
+    def poll(self, timeout: float) -> bool:
+        with self._cond:
+            if not self._pending:
+                self._cond.wait(timeout)
+            if not self._pending:
+                return False
+            self.rx_data.extend(self._pending)
+            self._pending.clear()
+            return True
+
+    def close(self) -> dict[int, int]:
+        for proc in self.procs.values():
+            try:
+                proc.stdin.close()
+            except BrokenPipeError:
+                pass
+        return {addr: proc.wait(timeout=10) for addr, proc in self.procs.items()}
+
+    def wait_reset(self, addr: int, timeout: float = 5.0) -> bool:
+        """完成帧提交后节点复位（link_node 退出）"""
+        try:
+            return self.procs[addr].wait(timeout=timeout) == 0
+        except subprocess.TimeoutExpired:
+            return False
+
+    def flash(self, addr: int) -> tuple[bytes, int, int]:
+        """返回 (APP 区, 标志, 版本)"""
+        data = self.flash_paths[addr].read_bytes()
+        region = data[FLAG_REGION_ADDR - FLASH_START_ADDR :]
+        return (data[APP_START_ADDR - FLASH_START_ADDR :], int.from_bytes(region[0:4], "little"),
+                int.from_bytes(region[4:8], "little"))
+
+    def _read_node(self, addr: int) -> None:
+        stdout = self.procs[addr].stdout
+        while True:
+            head = stdout.read(2)
+            if len(head) < 2:
+                return
+            length = int.from_bytes(head, "little")
+            packet = stdout.read(length) if length else b""
+            with self._cond:
+                self.sent[addr] += 1
+                self._pending.extend(packet)
+                self._cond.notify_all()
+
+
+def make_image(size: int, seed: int) -> bytes:
+    rng = random.Random(seed)
+    image = bytearray(rng.randrange(256) for _ in range(size))
+    image[0:8] = (0x20020000).to_bytes(4, "little") + (APP_START_ADDR + 0x1C1).to_bytes(4, "little")
+    return bytes(image)
+
+
+def image_committed(bus: NodeBus, addr: int, image: bytes) -> bool:
+    app, flag, version = bus.flash(addr)
+    return app[: len(image)] == image and flag == FLAG_APP and version == VERSION
+
+
+def case_scan(node: str, workdir: Path) -> tuple[bool, str]:
+    """扫描 1~8：在线节点 2、3、5、8 各应答一次（Bootloader 空闲、版本为擦除值），其余地址无应答"""
+    addrs = [2, 3, 5, 8]
+    bus = NodeBus(node, workdir, addrs)
+    try:
+        found = scan_bus(bus, range(1, 9), timeout=0.5)
+        time.sleep(0.1)   # 收齐可能迟到的重复应答
+    finally:
+        bus.close()
+    expect = [(addr, 0, 0xFFFFFFFF) for addr in addrs]
+    ok = found == expect and all(count == 1 for count in bus.sent.values()) and not bus.rx_data
+    text = f"scan: found {[hex(addr) for addr, _state, _version in found]}, replies per node {bus.sent}"
+    return ok, text
+
+
+def case_unicast(node: str, workdir: Path) -> tuple[bool, str]:
+    """按地址单播刷写节点 3，节点 2、4 收到全部帧但不应答、不写 Flash"""
+    image = make_image(6 * 1024 + 33, 33)
+    target, others = 3, [2, 4]
+    bus = NodeBus(node, workdir, [others[0], target, others[1]])
+    try:
+        flasher = LinkFlasher(bus, 1, 512, addr=target)
+        flashed = flasher.flash(image, VERSION, DATE, None)
+        reset = bus.wait_reset(target)
+    finally:
+        bus.close()
+    frames = -(-len(image) // flasher.max_payload)
+    silent = all(bus.sent[addr] == 0 for addr in others)
+    untouched = all(bus.flash(addr)[0][:64 * 1024] == b"\xFF" * (64 * 1024) and bus.flash(addr)[1] == FLAG_ERASED
+                    for addr in others)
+    ok = (flashed and reset and image_committed(bus, target, image) and bus.sent[target] == frames + 1
+          and silent and untouched)
+    text = (f"unicast: node {target} {'committed' if image_committed(bus, target, image) else 'NOT committed'}, "
+            f"{frames} frames, packets sent per node {bus.sent}, others untouched={untouched}")
+    return ok, text
+
+
+def case_bitmap(node: str, workdir: Path) -> tuple[bool, str]:
+    """按节点丢弃指定的广播数据帧，核对状态应答与位图补发、逐个提交"""
+    chunk = 256
+    image = make_image(19 * chunk + 45, 35)   # 20 帧，最后一帧 45 字节
+    frames = 20
+    session = 0x21
+    lost = {1: set(), 2: {0}, 3: {frames - 1}, 4: set(range(1, frames, 2)), 5: set(range(frames))}
+    models = {addr: SimNode(addr) for addr in lost}
+    bus = NodeBus(node, workdir, list(lost),
+                  drop=lambda addr, msg: is_bcast_data(msg) and int.from_bytes(msg[6:8], "big") in lost[addr])
+    errors: list[str] = []
+
+    def deliver(msg: bytes) -> None:
+        bus.send(msg)
+        for addr, model in models.items():
+            if bus.drop is None or not bus.drop(addr, msg):
+                model.handle(msg)
+
+    def status_of(addr: int):
+        bus.rx_data.clear()
+        status = query_status(bus, addr, timeout=2.0)
+        reply = b"\x55\xAA\xFF\xF5" + bytes([addr]) + (b"" if status is None else (
+            bytes([status[0]]) + status[1].to_bytes(2, "big") + status[2].to_bytes(2, "big") + status[3])) + b"\x55\x55"
+        expect = models[addr].handle(b"\x55\xAA" + bytes([addr]) + b"\xFF\xF5\x55\x55")
+        if reply != expect:
+            errors.append(f"node {addr}: status {reply.hex()} differs from SimNode {expect.hex()}")
+        return status
+
+    try:
+        deliver(build_bcast_start(session, len(image), chunk))
+        for index in range(frames):
+            deliver(build_bcast_data(session, index, image[index * chunk : (index + 1) * chunk]))
+
+        union: set[int] = set()
+        for addr, dropped in lost.items():
+            status = status_of(addr)
+            if status is None:
+                errors.append(f"node {addr}: no status reply")
+                continue
+            got_session, got_frames, missing, bitmap = status
+            absent = {i for i in range(got_frames) if not bitmap[i >> 3] & (1 << (i & 7))}
+            if got_session != session or got_frames != frames or missing != len(dropped) or absent != dropped:
+                errors.append(f"node {addr}: session={got_session} frames={got_frames} missing={missing} "
+                              f"absent={sorted(absent)}, expected {sorted(dropped)}")
+            union |= absent
+
+        # 按位图并集补发（补发不丢），此后所有节点都应收齐；已收到的帧重复到达时忽略
+        bus.drop = None
+        for index in sorted(union):
+            deliver(build_bcast_data(session, index, image[index * chunk : (index + 1) * chunk]))
+        for addr in lost:
+            status = status_of(addr)
+            if status is None or status[2] != 0:
+                errors.append(f"node {addr}: still missing frames after repair: {status}")
+
+        digest = hashlib.sha256(image).digest()
+        bad = bytes([digest[0] ^ 0x80]) + digest[1:]
+        if finish_node(bus, 1, build_finish_frame(VERSION, DATE, bad, None, 1), timeout=0.3):
+            errors.append("node 1: finish frame with a wrong digest was acknowledged")
+        for addr in lost:
+            if not finish_node(bus, addr, build_finish_frame(VERSION, DATE, digest, None, addr), timeout=2.0):
+                errors.append(f"node {addr}: finish frame not acknowledged")
+            elif not bus.wait_reset(addr) or not image_committed(bus, addr, image):
+                errors.append(f"node {addr}: image or flag wrong after commit")
+    finally:
+        bus.close()
+    ok = not errors
+    text = f"bitmap: {len(lost)} nodes, {frames} frames, resent {len(union)}"
+    if errors:
+        text += "\n  " + "\n  ".join(errors)
+    return ok, text
+
+
+def case_broadcast_flash(node: str, workdir: Path, count: int, loss: float) -> tuple[bool, str]:
+    """rs485_flash.broadcast_flash 的完整流程：每个节点独立丢弃 loss 比例的广播数据帧"""
+    image = make_image(24 * 1024 + 77, 34)
+    rng = random.Random(count)
+    addrs = list(range(1, count + 1))
+    bus = NodeBus(node, workdir, addrs, drop=lambda _addr, msg: is_bcast_data(msg) and rng.random() < loss)
+    start = time.monotonic()
+    try:
+        result = broadcast_flash(bus, addrs, image, VERSION, DATE, chunk=1008, gap=0.0, rounds=10,
+                                 finish_timeout=2.0)
+        for addr in addrs:
+            bus.wait_reset(addr)
+    finally:
+        codes = bus.close()
+    elapsed = time.monotonic() - start
+    bad = [addr for addr in addrs if not result.get(addr) or codes[addr] != 0 or not image_committed(bus, addr, image)]
+    text = f"broadcast_flash: {count} nodes, loss {loss:.0%}, {elapsed:.2f}s, failed nodes {bad}"
+    return not bad, text
+
+
+def main(argv: list[str]) -> int:
+    node = argv[1] if len(argv) > 1 else str(Path(__file__).resolve().parent / "build" / "link_node_bcast")
+    broadcast = "--broadcast" in argv[2:]
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        cases = [
+            lambda: case_scan(node, Path(tmp)),
+            lambda: case_unicast(node, Path(tmp)),
+        ]
+        if broadcast:
+            cases += [
+                lambda: case_bitmap(node, Path(tmp)),
+                lambda: case_broadcast_flash(node, Path(tmp), 8, 0.2),
+            ]
+        for case in cases:
+            ok, text = case()
+            print(("ok   " if ok else "FAIL ") + text)
+            failures += 0 if ok else 1
+    print("PASS" if failures == 0 else "FAIL")
+    return 0 if failures == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
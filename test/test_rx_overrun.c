@@ -0,0 +1,233 @@
+// 接收环直通的覆盖测试：数据帧写入 Flash 后 rx_consume 报告 DMA 覆盖时，核心不能应答这一帧，并放弃本次接收
+#include "boot_config.h"
+#include "easy_bootloader.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !BOOT_CONFIG_ENABLE_RX_DIRECT
+#error "test_rx_overrun needs BOOT_CONFIG_ENABLE_RX_DIRECT = 1"
+#endif
+
+#define SIM_APP_CAPACITY          0x2000U
+#define SIM_FLAG_CAPACITY         0x200U
+#define SIM_RX_CAPACITY           4096U
+#define SIM_FRAME_PAYLOAD         256U
+
+static uint8_t g_app[SIM_APP_CAPACITY];
+static uint8_t g_flag[SIM_FLAG_CAPACITY];
+static uint8_t g_rx[SIM_RX_CAPACITY];
+static uint32_t g_rx_head;
+static uint32_t g_rx_tail;
+static uint32_t g_overrun_frame;   // 第几次释放整帧时报告覆盖，0 不覆盖
+static uint32_t g_frame_consumes;
+static uint32_t g_acks;            // 收到的应答帧数（逐帧 ACK 记 1，计数 ACK 记其中的帧数）
+static uint32_t g_ack_writes;
+
+static uint8_t *sim_map(uint32_t addr, uint32_t *len)
+{
+    uint8_t *base;
+    uint32_t offset;
+    uint32_t size;
+    if (addr >= BOOT_APP_START_ADDR && addr - BOOT_APP_START_ADDR < SIM_APP_CAPACITY) {
+        base = g_app;
+        offset = addr - BOOT_APP_START_ADDR;
+        size = SIM_APP_CAPACITY;
+    } else if (addr >= BOOT_FLAG_REGION_ADDR && addr - BOOT_FLAG_REGION_ADDR < SIM_FLAG_CAPACITY) {
+        base = g_flag;
+        offset = addr - BOOT_FLAG_REGION_ADDR;
+        size = SIM_FLAG_CAPACITY;
+    } else {
+        return NULL;
+    }
+    if (*len > size - offset) {
+        *len = size - offset;
+    }
+    return base + offset;
+}
+
+static uint32_t sim_get_tick(void)
+{
+    return 0U;
+}
+
+static boot_port_status_t sim_flash_erase(uint32_t addr, uint32_t size)
+{
+    uint8_t *p = sim_map(addr, &size);
+    if (p != NULL) {
+        memset(p, 0xFF, size);
+    }
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t sim_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    uint8_t *p = sim_map(addr, &len);
+    if (p == NULL) {
+        return BOOT_PORT_ERROR;
+    }
+    for (uint32_t i = 0U; i < len; i++) {
+        p[i] &= data[i];
+    }
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t sim_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t mapped = len;
+    const uint8_t *p = sim_map(addr, &mapped);
+    if (p == NULL) {
+        mapped = 0U;
+    } else {
+        memcpy(data, p, mapped);
+    }
+    memset(&data[mapped], 0xFF, len - mapped);
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t sim_data_write(const uint8_t *data, uint32_t len)
+{
+    if (len >= 6U && data[2] == 0xFFU && data[3] == 0xFEU) {
+        g_acks++;
+    } else if (len >= 7U && data[2] == 0xFFU && data[3] == 0xF9U) {
+        g_acks += data[4];
+    }
+    g_ack_writes++;
+    return BOOT_PORT_OK;
+}
+
+static uint32_t sim_data_read(uint8_t *buf, uint32_t max_len)
+{
+    (void)buf;
+    (void)max_len;
+    return 0U;
+}
+
+static uint32_t sim_rx_peek(uint32_t offset, const uint8_t **data)
+{
+    uint32_t pos = g_rx_head + offset;
+    if (pos >= g_rx_tail) {
+        return 0U;
+    }
+    *data = &g_rx[pos];
+    return g_rx_tail - pos;
+}
+
+/* 释放整帧（长于帧头）时计数，到达 g_overrun_frame 时报告写入期间被 DMA 覆盖 */
+static boot_port_status_t sim_rx_consume(uint32_t len)
+{
+    g_rx_head += len;
+    if (len > 2U && ++g_frame_consumes == g_overrun_frame) {
+        return BOOT_PORT_ERROR;
+    }
+    return BOOT_PORT_OK;
+}
+
+static void sim_log(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+static void sim_jump_to_app(uint32_t app_addr)
+{
+    (void)app_addr;
+}
+
+static void sim_system_reset(void)
+{
+}
+
+static boot_ops_t g_ops = {
+    .get_tick = sim_get_tick,
+    .boot_port_flash_erase = sim_flash_erase,
+    .boot_port_flash_write = sim_flash_write,
+    .boot_port_flash_read = sim_flash_read,
+    .boot_port_data_write = sim_data_write,
+    .boot_port_data_read = sim_data_read,
+    .boot_port_log = sim_log,
+    .boot_port_jump_to_app = sim_jump_to_app,
+    .boot_port_system_reset = sim_system_reset,
+    .boot_port_rx_peek = sim_rx_peek,
+    .boot_port_rx_consume = sim_rx_consume,
+};
+
+/* 数据帧: 55 AA [剩余 3B] [长度 2B] 数据 [累加和 2B] 55 55，追加到接收环 */
+static void sim_push_data_frame(uint32_t index, uint32_t remaining)
+{
+    uint8_t *frame = &g_rx[g_rx_tail];
+    uint32_t k = 0U;
+    uint16_t sum = 0U;
+    frame[k++] = 0x55U;
+    frame[k++] = 0xAAU;
+    frame[k++] = (uint8_t)(remaining >> 16);
+    frame[k++] = (uint8_t)(remaining >> 8);
+    frame[k++] = (uint8_t)remaining;
+    frame[k++] = (uint8_t)(SIM_FRAME_PAYLOAD >> 8);
+    frame[k++] = (uint8_t)SIM_FRAME_PAYLOAD;
+    for (uint32_t i = 0U; i < SIM_FRAME_PAYLOAD; i++) {
+        frame[k++] = (uint8_t)(index * 31U + i);
+    }
+    for (uint32_t i = 5U; i < k; i++) {
+        sum = (uint16_t)(sum + frame[i]);
+    }
+    frame[k++] = (uint8_t)(sum >> 8);
+    frame[k++] = (uint8_t)sum;
+    frame[k++] = 0x55U;
+    frame[k++] = 0x55U;
+    g_rx_tail += k;
+}
+
+/**
+ * @brief 一次接收：连续送入 frames 个数据帧（一次全部到达接收环），第 overrun 帧释放时报告覆盖
+ * @return 覆盖的帧没有得到应答时返回 true；overrun 为 0 时要求每帧都得到应答
+ */
+static bool run_case(uint8_t window, uint32_t frames, uint32_t overrun)
+{
+    static easy_bootloader_t ctx;
+    memset(g_flag, 0xFF, sizeof(g_flag));
+    memset(g_app, 0xFF, sizeof(g_app));
+    g_rx_head = 0U;
+    g_rx_tail = 0U;
+    g_overrun_frame = overrun;
+    g_frame_consumes = 0U;
+    g_acks = 0U;
+    g_ack_writes = 0U;
+    g_ops.link_window = window;
+
+    if (easy_bootloader_ctx_init(&ctx, &g_ops) != BOOT_PORT_OK) {
+        return false;
+    }
+    g_acks = 0U;
+    for (uint32_t n = 0U; n < frames; n++) {
+        sim_push_data_frame(n, (frames - 1U - n) * SIM_FRAME_PAYLOAD);
+    }
+    for (int k = 0; k < 4; k++) {
+        easy_bootloader_ctx_run(&ctx);
+    }
+
+    bool ok;
+    if (overrun == 0U) {
+        ok = (g_acks == frames);
+    } else {
+        // 覆盖之前已释放的帧可能已按窗口应答，覆盖的帧不能应答
+        ok = (g_acks < overrun) && (g_frame_consumes == overrun);
+    }
+    printf("%-4s window=%u frames=%lu overrun at %lu: %lu frames acked in %lu writes\n", ok ? "ok" : "FAIL",
+           (unsigned)window, (unsigned long)frames, (unsigned long)overrun, (unsigned long)g_acks,
+           (unsigned long)g_ack_writes);
+    return ok;
+}
+
+int main(void)
+{
+    int failures = 0;
+    failures += !run_case(0U, 1U, 0U);   // 对照：单帧固件正常应答
+    failures += !run_case(0U, 1U, 1U);   // 最后一帧（原先在释放前立即应答）覆盖
+    failures += !run_case(0U, 4U, 4U);
+    failures += !run_case(8U, 4U, 0U);
+    failures += !run_case(8U, 4U, 4U);   // 计数 ACK：最后一帧覆盖
+    failures += !run_case(1U, 2U, 2U);   // 窗口 1：逐帧 ACK
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,434 @@
+// 暂存安装掉电测试：Flash 映射到文件，在每一次擦除/写入处模拟掉电，检查重新上电后安装能否续上；
+// 另以启用签名的配置编译，覆盖标志位区中签名尾部与 flag 之间的掉电点
+#include "boot_config.h"
+#include "boot_sha256.h"
+#include "easy_bootloader.h"
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if !BOOT_CONFIG_ENABLE_STAGING
+#error "test_staging_powercut needs BOOT_CONFIG_ENABLE_STAGING = 1"
+#endif
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE       0x100000
+#endif
+
+#define FLASH_SIZE                (BOOT_FLASH_END_ADDR - BOOT_FLASH_START_ADDR)
+#define FLASH_PTR(addr)           ((uint8_t *)(uintptr_t)(addr))
+
+/*
+ * 测试固件：旧固件 192KB，新固件 200KB。F407 扇区表下 APP 区前三个擦除单元为 64KB/128KB/128KB，
+ * 新旧固件只有第 0 单元不同（需擦除重写）、第 1 单元相同（跳过）、第 2 单元旧固件未用到（免擦除直接写）
+ */
+#define OLD_IMAGE_SIZE            (192U * 1024U)
+#define NEW_IMAGE_SIZE            (200U * 1024U)
+#define DIFF_SIZE                 (64U * 1024U)
+#define NEW_VERSION               0x00020000U
+#define NEW_DATE                  0x20261016U
+
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+/*
+ * 新固件摘要的签名，由 PC tool/source/image_sign.py 以 RFC 8032 TEST 1 的种子生成，
+ * Makefile 把对应公钥写入 BOOT_SIGN_PUBLIC_KEY；修改固件生成方式后需重新签名
+ */
+static const uint8_t g_new_signature[BOOT_SIGNATURE_SIZE] = {
+    0x73U, 0x77U, 0x14U, 0x9AU, 0xAAU, 0x71U, 0xEAU, 0xCDU, 0xEFU, 0xBBU, 0x76U, 0x2BU, 0xA3U, 0xACU, 0x62U, 0x7EU,
+    0xDEU, 0xE0U, 0xC9U, 0xEAU, 0x55U, 0x24U, 0xDCU, 0x8EU, 0xE0U, 0x87U, 0xFBU, 0x6FU, 0x81U, 0x5BU, 0x38U, 0x40U,
+    0xCDU, 0x68U, 0x6AU, 0xBEU, 0x95U, 0xF2U, 0x3EU, 0x43U, 0x0FU, 0xBEU, 0xE9U, 0x0BU, 0x81U, 0x01U, 0x92U, 0x71U,
+    0x45U, 0x59U, 0x35U, 0x37U, 0x10U, 0xB3U, 0x13U, 0x29U, 0xEBU, 0x76U, 0x53U, 0x5EU, 0x49U, 0x49U, 0x66U, 0x05U,
+};
+#endif
+
+/* 子进程（一次上电）的退出码 */
+#define BOOT_EXIT_JUMPED          10
+#define BOOT_EXIT_STAYED          11
+#define BOOT_EXIT_CUT             12
+
+/* 各子进程共享的统计，放在共享匿名映射中 */
+typedef struct {
+    uint32_t ops;          // 本次上电的擦除 + 写入次数
+    uint32_t erases;       // 本次上电擦除 APP 区单元的次数
+} boot_stats_t;
+
+static const uint32_t g_sector_starts[] = BOOT_FLASH_SECTOR_STARTS;
+static boot_stats_t *g_stats;
+static uint32_t g_cut_at;     // 第几次擦除/写入时掉电，0 不掉电
+static int g_async;           // 0 同步读取 1 注册 flash_read_start/wait，覆盖双缓冲读取路径
+                              // 2 flash_read_start 拒绝缓冲区（work_buf 被链接到 DMA 访问不到的 CCM），覆盖回退到同步读取
+static int g_verbose;
+
+static uint8_t *g_flash_init; // 安装前的 Flash 内容，每轮测试从这里恢复
+static uint8_t g_old_image[OLD_IMAGE_SIZE];
+static uint8_t g_new_image[NEW_IMAGE_SIZE];
+static uint8_t g_new_digest[BOOT_DIGEST_SIZE];
+
+static uint32_t g_async_addr;
+static uint8_t *g_async_data;
+static uint32_t g_async_len;
+
+/**
+ * @brief 计数一次擦除/写入，到达掉电点时只完成前一半后退出，模拟操作进行到中途断电
+ */
+static bool host_power_cut(uint8_t *dst, const uint8_t *src, uint32_t len, bool erase)
+{
+    g_stats->ops++;
+    if (g_cut_at == 0U || g_stats->ops != g_cut_at) {
+        return false;
+    }
+    for (uint32_t i = 0U; i < len / 2U; i++) {
+        dst[i] = erase ? 0xFFU : (uint8_t)(dst[i] & src[i]);
+    }
+    _exit(BOOT_EXIT_CUT);
+}
+
+static uint32_t host_get_tick(void)
+{
+    return 0U;
+}
+
+static boot_port_status_t host_flash_erase(uint32_t addr, uint32_t size)
+{
+    if (addr < BOOT_FLASH_START_ADDR || size > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    if (addr >= BOOT_APP_START_ADDR && addr < BOOT_STAGING_ADDR) {
+        g_stats->erases++;
+    }
+    host_power_cut(FLASH_PTR(addr), NULL, size, true);
+    memset(FLASH_PTR(addr), 0xFF, size);
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t host_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (addr < BOOT_FLASH_START_ADDR || len > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    // NOR Flash 编程只能把 1 写成 0
+    host_power_cut(FLASH_PTR(addr), data, len, false);
+    for (uint32_t i = 0U; i < len; i++) {
+        FLASH_PTR(addr)[i] &= data[i];
+    }
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t host_flash_read(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    if (addr < BOOT_FLASH_START_ADDR || len > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    memcpy(data, FLASH_PTR(addr), len);
+    return BOOT_PORT_OK;
+}
+
+/* 异步读取：发起时只记下请求，等待时才拷贝，缓冲区在等待之前被核心提前读到会得到旧内容 */
+static boot_port_status_t host_flash_read_start(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    if (g_async == 2 || g_async_data != NULL || addr < BOOT_FLASH_START_ADDR || len > BOOT_FLASH_END_ADDR - addr) {
+        return BOOT_PORT_ERROR;
+    }
+    memset(data, 0xA5, len);
+    g_async_addr = addr;
+    g_async_data = data;
+    g_async_len = len;
+    return BOOT_PORT_OK;
+}
+
+static boot_port_status_t host_flash_read_wait(void)
+{
+    if (g_async_data != NULL) {
+        memcpy(g_async_data, FLASH_PTR(g_async_addr), g_async_len);
+        g_async_data = NULL;
+    }
+    return BOOT_PORT_OK;
+}
+
+static uint32_t host_flash_erase_unit(uint32_t addr)
+{
+    for (uint32_t i = 0U; i < BOOT_FLASH_SECTOR_COUNT; i++) {
+        if (addr >= g_sector_starts[i] && addr < g_sector_starts[i + 1U]) {
+            return g_sector_starts[i + 1U] - addr;
+        }
+    }
+    return 0U;
+}
+
+static boot_port_status_t host_data_write(const uint8_t *data, uint32_t len)
+{
+    (void)data;
+    (void)len;
+    return BOOT_PORT_OK;
+}
+
+static uint32_t host_data_read(uint8_t *buf, uint32_t max_len)
+{
+    (void)buf;
+    (void)max_len;
+    return 0U;
+}
+
+static uint32_t host_rx_peek(uint32_t offset, const uint8_t **data)
+{
+    (void)offset;
+    (void)data;
+    return 0U;
+}
+
+static boot_port_status_t host_rx_consume(uint32_t len)
+{
+    (void)len;
+    return BOOT_PORT_OK;
+}
+
+static void host_log(const char *fmt, ...)
+{
+    if (g_verbose) {
+        va_list args;
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+    }
+}
+
+static void host_jump_to_app(uint32_t app_addr)
+{
+    (void)app_addr;
+    _exit(BOOT_EXIT_JUMPED);
+}
+
+static void host_system_reset(void)
+{
+}
+
+static boot_ops_t g_ops = {
+    .get_tick = host_get_tick,
+    .boot_port_flash_erase = host_flash_erase,
+    .boot_port_flash_write = host_flash_write,
+    .boot_port_flash_read = host_flash_read,
+    .boot_port_data_write = host_data_write,
+    .boot_port_data_read = host_data_read,
+    .boot_port_log = host_log,
+    .boot_port_jump_to_app = host_jump_to_app,
+    .boot_port_system_reset = host_system_reset,
+    .boot_port_flash_erase_unit = host_flash_erase_unit,
+    .boot_port_rx_peek = host_rx_peek,
+    .boot_port_rx_consume = host_rx_consume,
+};
+
+/**
+ * @brief 在子进程中上电一次，cut_at 为 0 时不掉电
+ * @return 子进程退出码（BOOT_EXIT_*）
+ */
+static int host_boot(uint32_t cut_at)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        static easy_bootloader_t ctx;
+        g_cut_at = cut_at;
+        memset(g_stats, 0, sizeof(*g_stats));
+        if (g_async) {
+            g_ops.boot_port_flash_read_start = host_flash_read_start;
+            g_ops.boot_port_flash_read_wait = host_flash_read_wait;
+        }
+        if (easy_bootloader_ctx_init(&ctx, &g_ops) != BOOT_PORT_OK) {
+            _exit(1);
+        }
+        _exit(BOOT_EXIT_STAYED);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+static uint32_t host_word(uint32_t addr)
+{
+    uint32_t value;
+    memcpy(&value, FLASH_PTR(addr), 4U);
+    return value;
+}
+
+/**
+ * @brief 构造安装前的 Flash：主区为旧固件，暂存区为新固件，标志位区有 APP 标志与暂存记录
+ */
+static void host_prepare_flash(void)
+{
+    uint32_t seed = 1U;
+    for (uint32_t i = 0U; i < NEW_IMAGE_SIZE; i++) {
+        seed = seed * 1103515245U + 12345U;
+        g_new_image[i] = (uint8_t)(seed >> 16);
+    }
+    memcpy(g_old_image, g_new_image, OLD_IMAGE_SIZE);
+    for (uint32_t i = 0U; i < DIFF_SIZE; i++) {
+        g_old_image[i] ^= 0x5AU;
+    }
+    // 两份固件的向量表都有效：栈顶在 SRAM 末尾，复位向量指向 APP 区内的 Thumb 地址
+    uint32_t vectors[2] = {BOOT_SRAM_END_ADDR, BOOT_APP_START_ADDR + 0x1C1U};
+    memcpy(g_new_image, vectors, sizeof(vectors));
+    vectors[1] = BOOT_APP_START_ADDR + 0x101U;
+    memcpy(g_old_image, vectors, sizeof(vectors));
+
+    memset(FLASH_PTR(BOOT_FLASH_START_ADDR), 0xFF, FLASH_SIZE);
+    memcpy(FLASH_PTR(BOOT_APP_START_ADDR), g_old_image, OLD_IMAGE_SIZE);
+    memcpy(FLASH_PTR(BOOT_STAGING_ADDR), g_new_image, NEW_IMAGE_SIZE);
+
+    uint32_t flag[4] = {BOOT_FLAG_APP, 0x00010000U, 0x20250101U, BOOT_FLAG_ERASED};
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    flag[3] = BOOT_SIGN_STATE_VERIFIED;   // 旧固件已通过签名校验（尾部内容启动时不再校验）
+#endif
+    memcpy(FLASH_PTR(BOOT_FLAG_ADDR), flag, sizeof(flag));
+
+    uint32_t record[4] = {BOOT_STAGING_MAGIC, NEW_IMAGE_SIZE, NEW_VERSION, NEW_DATE};
+    boot_sha256_ctx_t sha;
+    boot_sha256_init(&sha);
+    boot_sha256_update(&sha, g_new_image, NEW_IMAGE_SIZE);
+    boot_sha256_final(&sha, g_new_digest);
+    memcpy(FLASH_PTR(BOOT_STAGING_RECORD_ADDR) + sizeof(record), g_new_digest, sizeof(g_new_digest));
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+    memcpy(FLASH_PTR(BOOT_STAGING_RECORD_ADDR) + sizeof(record) + BOOT_DIGEST_SIZE, g_new_signature,
+           sizeof(g_new_signature));
+#endif
+    memcpy(FLASH_PTR(BOOT_STAGING_RECORD_ADDR), record, sizeof(record));
+
+    memcpy(g_flash_init, FLASH_PTR(BOOT_FLASH_START_ADDR), FLASH_SIZE);
+}
+
+/* 主区固件未完成的单元数（进度字不是 BOOT_INSTALL_UNIT_DONE） */
+static uint32_t host_units_pending(void)
+{
+    uint32_t pending = 0U;
+    uint32_t index = 0U;
+    for (uint32_t offset = 0U; offset < NEW_IMAGE_SIZE; index++) {
+        if (host_word(BOOT_INSTALL_PROGRESS_ADDR + index * 4U) != BOOT_INSTALL_UNIT_DONE) {
+            pending++;
+        }
+        offset += host_flash_erase_unit(BOOT_APP_START_ADDR + offset);
+    }
+    return pending;
+}
+
+/**
+ * @brief 检查掉电后再次上电的结果
+ * @note  跳转时主区必须是完整的新固件且标志位为 APP（启用签名时尾部为新固件的摘要、签名与校验结果）；
+ *        停在 Bootloader 只允许出现在标志位区擦除后、标志位写入前掉电的窗口内（主区已是新固件，
+ *        暂存记录已随标志位区擦除）。flag 先于签名尾部写入时，两者之间掉电会留下 flag=APP 却未校验的
+ *        标志位区，停在 Bootloader 而 flag 为 APP，判为失败
+ */
+static bool host_check_result(int result, uint32_t *window)
+{
+    bool installed = memcmp(FLASH_PTR(BOOT_APP_START_ADDR), g_new_image, NEW_IMAGE_SIZE) == 0;
+    if (result == BOOT_EXIT_JUMPED) {
+#if BOOT_CONFIG_ENABLE_SIGNATURE
+        if (host_word(BOOT_SIGN_STATE_ADDR) != BOOT_SIGN_STATE_VERIFIED ||
+            memcmp(FLASH_PTR(BOOT_DIGEST_ADDR), g_new_digest, BOOT_DIGEST_SIZE) != 0 ||
+            memcmp(FLASH_PTR(BOOT_SIGNATURE_ADDR), g_new_signature, BOOT_SIGNATURE_SIZE) != 0) {
+            return false;
+        }
+#endif
+        return installed && host_word(BOOT_FLAG_ADDR) == BOOT_FLAG_APP;
+    }
+    if (result == BOOT_EXIT_STAYED && installed && host_word(BOOT_STAGING_RECORD_ADDR) != BOOT_STAGING_MAGIC &&
+        host_word(BOOT_FLAG_ADDR) != BOOT_FLAG_APP) {
+        (*window)++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 一轮扫描：依次在第 1 ~ N 次擦除/写入处掉电，再上电直到完成；
+ *        second_cut 非 0 时在恢复上电中再掉电一次（位置随第一次掉电点变化）
+ */
+static int host_sweep(uint32_t total_ops, uint32_t second_cut, uint32_t *window)
+{
+    int failures = 0;
+    for (uint32_t cut = 1U; cut <= total_ops; cut++) {
+        memcpy(FLASH_PTR(BOOT_FLASH_START_ADDR), g_flash_init, FLASH_SIZE);
+        if (host_boot(cut) != BOOT_EXIT_CUT) {
+            printf("cut %lu: power cut not reached\n", (unsigned long)cut);
+            failures++;
+            continue;
+        }
+        if (second_cut != 0U) {
+            uint32_t cut2 = 1U + (cut * 7919U) % second_cut;
+            int result = host_boot(cut2);
+            if (result != BOOT_EXIT_CUT && !host_check_result(result, window)) {
+                printf("cut %lu/%lu: bad result %d after second cut\n", (unsigned long)cut, (unsigned long)cut2, result);
+                failures++;
+                continue;
+            }
+        }
+
+        uint32_t pending = host_units_pending();
+        int result = host_boot(0U);
+        if (!host_check_result(result, window)) {
+            printf("cut %lu: bad result %d, flag=0x%08lX\n", (unsigned long)cut, result,
+                   (unsigned long)host_word(BOOT_FLAG_ADDR));
+            failures++;
+        } else if (g_stats->erases > pending) {
+            // 已记录完成的单元不应再擦除
+            printf("cut %lu: resume erased %lu units, only %lu pending\n", (unsigned long)cut,
+                   (unsigned long)g_stats->erases, (unsigned long)pending);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "flash_powercut.bin";
+    g_verbose = (argc > 2) && (strcmp(argv[2], "-v") == 0);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, FLASH_SIZE) != 0) {
+        perror(path);
+        return 1;
+    }
+    // 文件以共享方式映射到 Flash 的真实地址：核心直接读向量表，各次上电（子进程）看到同一份内容
+    void *flash = mmap((void *)(uintptr_t)BOOT_FLASH_START_ADDR, FLASH_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    g_stats = mmap(NULL, sizeof(*g_stats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    g_flash_init = malloc(FLASH_SIZE);
+    if (flash != FLASH_PTR(BOOT_FLASH_START_ADDR) || g_stats == MAP_FAILED || g_flash_init == NULL) {
+        printf("cannot map flash at 0x%08lX\n", (unsigned long)BOOT_FLASH_START_ADDR);
+        return 1;
+    }
+
+    host_prepare_flash();
+    int failures = 0;
+    for (g_async = 0; g_async <= 2; g_async++) {
+        memcpy(FLASH_PTR(BOOT_FLASH_START_ADDR), g_flash_init, FLASH_SIZE);
+        int result = host_boot(0U);
+        uint32_t total_ops = g_stats->ops;
+        uint32_t window = 0U;
+        if (result != BOOT_EXIT_JUMPED || !host_check_result(result, &window)) {
+            printf("async=%d: uninterrupted install failed (%d)\n", g_async, result);
+            return 1;
+        }
+
+        int single = host_sweep(total_ops, 0U, &window);
+        uint32_t single_window = window;
+        window = 0U;
+        int twice = host_sweep(total_ops, total_ops, &window);
+        printf("async=%d: %lu flash ops, single cut: %d failures, %lu in flag window; "
+               "double cut: %d failures, %lu in flag window\n",
+               g_async, (unsigned long)total_ops, single, (unsigned long)single_window, twice, (unsigned long)window);
+        failures += single + twice;
+    }
+
+    munmap(flash, FLASH_SIZE);
+    close(fd);
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
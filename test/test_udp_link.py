@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+UDP 链路测试
+----------------
+上位机侧直接使用 udp_flash.py 的 UdpLink 与 link_flash.py 的 LinkFlasher，经 127.0.0.1 刷写 link_node_udp
+（真实核心 + boot_udp.c，ops 提供 data_peek / data_release 零拷贝接收）。节点把收到的报文包装成以太网帧放入
+模拟的接收描述符，并插入 ARP / ICMP 请求与必须丢弃的坏帧（校验和错误、端口或地址不符），逐帧检查设备发出的
+ARP / ICMP / UDP 帧；节点复位时报告统计，有违规则以非 0 退出。这里检查固件、标志位与节点退出码：
+
+    python3 test_udp_link.py build/link_node_udp
+"""
+
+from __future__ import annotations
+
+import contextlib
+import io
+import random
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "PC tool" / "source"))
+
+from link_flash import LinkFlasher  # noqa: E402
+from udp_flash import UdpLink  # noqa: E402
+
+APP_START_ADDR = 0x08010000   # 与 boot_memmap.h 一致
+FLAG_REGION_ADDR = 0x080E0000
+FLASH_START_ADDR = 0x08000000
+FLAG_APP = 2
+VERSION = 5
+DATE = 0x20261016
+UDP_PAYLOAD_MAX = 1472        # BOOT_UDP_PAYLOAD_MAX
+
+
+def make_image(size: int, seed: int) -> bytes:
+    rng = random.Random(seed)
+    image = bytearray(rng.randrange(256) for _ in range(size))
+    image[0:8] = (0x20020000).to_bytes(4, "little") + (APP_START_ADDR + 0x1C1).to_bytes(4, "little")
+    return bytes(image)
+
+
+def run_case(node: str, workdir: Path, window: int, packet: int, image: bytes) -> tuple[bool, str]:
+    flash_path = workdir / f"flash_udp_{window}_{packet}.bin"
+    proc = subprocess.Popen([node, str(flash_path), str(UDP_PAYLOAD_MAX), str(window)], stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE)
+    port = int(proc.stdout.readline().split()[-1])
+    link = UdpLink("127.0.0.1", port)
+    with contextlib.redirect_stdout(io.StringIO()):
+        flashed = LinkFlasher(link, window, packet).flash(image, VERSION, DATE, None)
+    try:
+        proc.wait(timeout=5)
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        proc.wait()
+    link.sock.close()
+    log = proc.stderr.read().decode(errors="replace").strip().splitlines()
+
+    flash = flash_path.read_bytes()
+    app = flash[APP_START_ADDR - FLASH_START_ADDR :][: len(image)]
+    region = flash[FLAG_REGION_ADDR - FLASH_START_ADDR :]
+    flag = int.from_bytes(region[0:4], "little")
+    version = int.from_bytes(region[4:8], "little")
+    ok = flashed and proc.returncode == 0 and app == image and flag == FLAG_APP and version == VERSION
+    text = (f"window={window} packet={packet:4d} size={len(image)}: flashed={flashed}, "
+            f"image={'ok' if app == image else 'BAD'}, flag=0x{flag:X}, exit={proc.returncode}")
+    stats = [line for line in log if line.startswith("udp:")]
+    text += "\n     " + (stats[-1] if stats else "(no udp report)")
+    if not ok:
+        text += "\n  " + "\n  ".join(log[-5:])
+    return ok, text
+
+
+def main(argv: list[str]) -> int:
+    node = argv[1] if len(argv) > 1 else str(Path(__file__).resolve().parent / "build" / "link_node_udp")
+    cases = [
+        # (窗口, 报文长度, 固件)；报文长度不超过 BOOT_PACKET_MAX_SIZE，奇数长度的报文覆盖校验和的奇数字节
+        (1, 1024, make_image(20 * 1024 + 333, 41)),
+        (4, 1024, make_image(48 * 1024 + 77, 42)),
+        (4, 301, make_image(16 * 1024 + 1, 43)),
+    ]
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for window, packet, image in cases:
+            ok, text = run_case(node, Path(tmp), window, packet, image)
+            print(("ok   " if ok else "FAIL ") + text)
+            failures += 0 if ok else 1
+    print("PASS" if failures == 0 else "FAIL")
+    return 0 if failures == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))